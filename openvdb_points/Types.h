@@ -34,8 +34,22 @@
 #include <openvdb/version.h>
 #include <openvdb/Platform.h>
 #include <openvdb/Types.h>
+#include <openvdb/math/Mat3.h>
+#include <openvdb/math/Quat.h>
+#include <openvdb/math/Vec4.h>
 #include <OpenEXR/half.h>
 
+
+// file format versions of point attribute data, persisted in the attribute set descriptor
+
+enum {
+    OPENVDB_POINTS_FILE_VERSION_INITIAL = 0,
+    OPENVDB_POINTS_FILE_VERSION_GROUP_TYPE = 1  // groups have their own type and a sparse threshold
+};
+
+#define OPENVDB_POINTS_FILE_VERSION OPENVDB_POINTS_FILE_VERSION_GROUP_TYPE
+
+
 namespace openvdb {
 OPENVDB_USE_VERSION_NAMESPACE
 namespace OPENVDB_VERSION_NAME {
@@ -50,6 +64,12 @@ template<> inline const char* typeNameAsString<math::Vec2<half> >()      { retur
 template<> inline const char* typeNameAsString<math::Vec3<half> >()      { return "vec3h"; }
 template<> inline const char* typeNameAsString<math::Vec3<uint8_t> >()   { return "vec3u8"; }
 template<> inline const char* typeNameAsString<math::Vec3<uint16_t> >()  { return "vec3u16"; }
+template<> inline const char* typeNameAsString<math::Vec4<float> >()     { return "vec4s"; }
+template<> inline const char* typeNameAsString<math::Vec4<double> >()    { return "vec4d"; }
+template<> inline const char* typeNameAsString<math::Quat<float> >()     { return "quats"; }
+template<> inline const char* typeNameAsString<math::Quat<double> >()    { return "quatd"; }
+template<> inline const char* typeNameAsString<math::Mat3<float> >()     { return "mat3s"; }
+template<> inline const char* typeNameAsString<math::Mat3<double> >()    { return "mat3d"; }
 
 
 ////////////////////////////////////////
@@ -58,6 +78,10 @@ template<> inline const char* typeNameAsString<math::Vec3<uint16_t> >()  { retur
 
 const std::string META_GROUP_VIEWPORT = "group_viewport";
 
+// metadata name for the file format version of an attribute set descriptor
+
+const std::string META_FILE_VERSION = "file_version";
+
 } // namespace OPENVDB_VERSION_NAME
 } // namespace openvdb
 
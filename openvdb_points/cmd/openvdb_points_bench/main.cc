@@ -0,0 +1,807 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2015-2016 Double Negative Visual Effects
+//
+// All rights reserved. This software is distributed under the
+// Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
+//
+// Redistributions of source code must retain the above copyright
+// and license notice and the following restrictions and disclaimer.
+//
+// *     Neither the name of Double Negative Visual Effects nor the names
+// of its contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// IN NO EVENT SHALL THE COPYRIGHT HOLDERS' AND CONTRIBUTORS' AGGREGATE
+// LIABILITY FOR ALL CLAIMS REGARDLESS OF THEIR BASIS EXCEED US$250.00.
+//
+///////////////////////////////////////////////////////////////////////////
+
+/// @file main.cc
+///
+/// @brief  Reproducible benchmarks of the OpenVDB Points library on synthetic point
+///         distributions, reported as JSON.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <tbb/parallel_reduce.h>
+#include <tbb/task_scheduler_init.h>
+#include <tbb/tick_count.h>
+
+#include <openvdb/openvdb.h>
+#include <openvdb/io/File.h>
+#include <openvdb/tools/LevelSetSphere.h>
+#include <openvdb/tools/PointIndexGrid.h>
+#include <openvdb/tree/LeafManager.h>
+
+#include <openvdb_points/openvdb.h>
+#include <openvdb_points/version.h>
+#include <openvdb_points/tools/AttributeArray.h>
+#include <openvdb_points/tools/IndexFilter.h>
+#include <openvdb_points/tools/PointAttribute.h>
+#include <openvdb_points/tools/PointConversion.h>
+#include <openvdb_points/tools/PointCount.h>
+#include <openvdb_points/tools/PointDataGrid.h>
+#include <openvdb_points/tools/PointGroup.h>
+#include <openvdb_points/tools/PointLoad.h>
+
+namespace {
+
+using namespace openvdb;
+using namespace openvdb::tools;
+
+const char* gProgName = "";
+
+
+void
+usage(int exitStatus = EXIT_FAILURE)
+{
+    std::cerr <<
+"Usage: " << gProgName << " [options]\n" <<
+"Which: benchmarks OpenVDB Points on synthetic points and prints the results as JSON\n" <<
+"Options:\n" <<
+"    -n, -points N       number of points (default 1000000)\n" <<
+"    -d, -density D      target average points per voxel (default 8)\n" <<
+"    -dist NAME          point distribution: uniform, clustered or surface (default uniform)\n" <<
+"    -r, -repeats N      timed runs per benchmark, the fastest is reported (default 3)\n" <<
+"    -seed N             random seed for the point distribution (default 0)\n" <<
+"    -filter STR         only run benchmarks with names containing STR\n" <<
+"    -tmpdir DIR         directory for temporary files (default $TMPDIR)\n" <<
+"    -o FILE             write the JSON to FILE instead of standard output\n" <<
+"Notes:\n" <<
+"    Throughput in bytes per second is computed from the in-memory size of the grid\n" <<
+"    for traversal and group benchmarks, the size of the uncompressed values for\n" <<
+"    codec benchmarks and the size of the file for I/O benchmarks.\n";
+    exit(exitStatus);
+}
+
+
+////////////////////////////////////////
+
+
+// some common typedefs
+typedef TypedAttributeArray<Vec3f>                                          AttributeVec3f;
+typedef TypedAttributeArray<Vec3f, NullAttributeCodec<Vec3<half> > >        AttributeVec3fTruncate;
+typedef TypedAttributeArray<Vec3f, FixedPointAttributeCodec<Vec3<uint8_t> > >   AttributeVec3fFxpt8;
+typedef TypedAttributeArray<Vec3f, FixedPointAttributeCodec<Vec3<uint16_t> > >  AttributeVec3fFxpt16;
+typedef TypedAttributeArray<Vec3f, UnitVecAttributeCodec>                   AttributeVec3fUnitVec;
+typedef TypedAttributeArray<float>                                          AttributeF;
+typedef TypedAttributeArray<float, NullAttributeCodec<half> >               AttributeFTruncate;
+typedef TypedAttributeArray<int32_t>                                        AttributeI;
+
+
+/// Shared state for all benchmarks, built once before any benchmarks are run
+struct Context
+{
+    Context()
+        : density(8.0f)
+        , voxelSize(0.0f)
+        , seed(0) { }
+
+    std::vector<Vec3f>          positions;
+    std::vector<Vec3f>          offsets;
+    std::vector<Vec3f>          normals;
+    std::vector<float>          scales;
+    std::vector<int32_t>        ids;
+    std::vector<short>          membership;
+
+    float                       density;
+    float                       voxelSize;
+    unsigned int                seed;
+    std::string                 distribution;
+    std::string                 filename;
+
+    math::Transform::Ptr        transform;
+    PointIndexGrid::Ptr         indexGrid;
+    PointDataGrid::Ptr          grid;
+    FloatGrid::Ptr              levelSet;
+}; // struct Context
+
+
+/// Populate the positions of a synthetic point distribution within a 100 unit cube
+void
+generatePositions(Context& context, const size_t count, const std::string& distribution)
+{
+    math::Random01 randNumber(context.seed);
+
+    context.positions.clear();
+    context.positions.reserve(count);
+
+    if (distribution == "uniform") {
+        for (size_t i = 0; i < count; i++) {
+            context.positions.push_back(Vec3f(randNumber(), randNumber(), randNumber()) * 100.0f);
+        }
+    }
+    else if (distribution == "clustered") {
+        // points are approximately normally distributed around one of 64 cluster centers
+
+        std::vector<Vec3f> centers;
+        for (int i = 0; i < 64; i++) {
+            centers.push_back(Vec3f(randNumber(), randNumber(), randNumber()) * 80.0f + Vec3f(10.0f));
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            Vec3f offset(0.0f);
+            for (int j = 0; j < 3; j++) {
+                offset += Vec3f(randNumber(), randNumber(), randNumber()) * 2.0f - Vec3f(1.0f);
+            }
+            context.positions.push_back(centers[i % centers.size()] + offset * 3.0f);
+        }
+    }
+    else if (distribution == "surface") {
+        // points lie on the surface of a sphere
+
+        for (size_t i = 0; i < count; i++) {
+            Vec3f direction;
+            do {
+                direction = Vec3f(randNumber(), randNumber(), randNumber()) * 2.0f - Vec3f(1.0f);
+            } while (direction.lengthSqr() > 1.0f || direction.lengthSqr() < 1e-6f);
+            context.positions.push_back(Vec3f(50.0f) + direction.unit() * 40.0f);
+        }
+    }
+    else {
+        OPENVDB_THROW(ValueError, "Unknown point distribution - " + distribution + ".");
+    }
+
+    context.distribution = distribution;
+}
+
+
+/// Build the attribute values, the transform and the reference grid used by the benchmarks
+void
+initializeContext(Context& context)
+{
+    const size_t count = context.positions.size();
+
+    math::Random01 randNumber(context.seed + 1);
+
+    context.offsets.resize(count);
+    context.normals.resize(count);
+    context.scales.resize(count);
+    context.ids.resize(count);
+    context.membership.resize(count);
+
+    for (size_t i = 0; i < count; i++) {
+        context.offsets[i] = Vec3f(randNumber(), randNumber(), randNumber()) - Vec3f(0.5f);
+        const Vec3f normal = Vec3f(randNumber(), randNumber(), randNumber()) - Vec3f(0.5f);
+        context.normals[i] = normal.lengthSqr() > 0.0f ? normal.unit() : Vec3f(0, 1, 0);
+        context.scales[i] = float(randNumber());
+        context.ids[i] = int32_t(i);
+        context.membership[i] = short(randNumber() < 0.5);
+    }
+
+    const PointAttributeVector<Vec3f> positionWrapper(context.positions);
+
+    context.voxelSize = computeVoxelSize(positionWrapper, context.density);
+    if (context.voxelSize <= 0.0f)  context.voxelSize = 1.0f;
+
+    context.transform = math::Transform::createLinearTransform(context.voxelSize);
+
+    context.indexGrid = createPointIndexGrid<PointIndexGrid>(positionWrapper, *context.transform);
+
+    context.grid = createPointDataGrid<PointDataGrid>(*context.indexGrid, positionWrapper,
+                                                      AttributeVec3f::attributeType(), *context.transform);
+
+    PointDataTree& tree = context.grid->tree();
+
+    appendAttribute(tree, AttributeSet::Descriptor::NameAndType("id", AttributeI::attributeType()));
+    populateAttribute(tree, context.indexGrid->tree(), "id", PointAttributeVector<int32_t>(context.ids));
+
+    appendAttribute(tree, AttributeSet::Descriptor::NameAndType("pscale", AttributeF::attributeType()));
+    populateAttribute(tree, context.indexGrid->tree(), "pscale", PointAttributeVector<float>(context.scales));
+
+    appendGroup(tree, "groupA");
+    setGroup(tree, context.indexGrid->tree(), context.membership, "groupA");
+
+    appendGroup(tree, "groupB");
+    std::vector<short> membershipB(count);
+    for (size_t i = 0; i < count; i++)  membershipB[i] = short(i % 10 == 0);
+    setGroup(tree, context.indexGrid->tree(), membershipB, "groupB");
+
+    // a sphere in the center of the points for level set filtering
+
+    context.levelSet = createLevelSetSphere<FloatGrid>(25.0f, Vec3f(50.0f), 1.0f);
+
+    // write the reference grid for the I/O benchmarks
+
+    GridCPtrVec grids;
+    grids.push_back(context.grid);
+
+    io::File file(context.filename);
+    file.write(grids);
+    file.close();
+}
+
+
+/// Return the size of a file in bytes
+Index64
+fileSize(const std::string& filename)
+{
+    std::ifstream file(filename.c_str(), std::ios_base::binary | std::ios_base::ate);
+    return file ? Index64(file.tellg()) : Index64(0);
+}
+
+
+////////////////////////////////////////
+
+
+/// @brief Base class for a benchmark, only run() is timed
+struct Benchmark
+{
+    typedef boost::shared_ptr<Benchmark> Ptr;
+
+    Benchmark(const std::string& _name, const Context& _context)
+        : name(_name), context(_context) { }
+    virtual ~Benchmark() { }
+
+    virtual void setUp() { }
+    virtual void run() = 0;
+    virtual void tearDown() { }
+
+    /// Return the number of points processed by each run
+    virtual Index64 points() const { return Index64(context.positions.size()); }
+    /// Return the number of bytes processed by each run
+    virtual Index64 bytes() const = 0;
+
+    const std::string name;
+    const Context& context;
+}; // struct Benchmark
+
+
+struct ConversionBenchmark : public Benchmark
+{
+    ConversionBenchmark(const std::string& _name, const Context& _context, const NamePair& _type)
+        : Benchmark(_name, _context), type(_type) { }
+
+    virtual void setUp() { grid.reset(); }
+
+    virtual void run() {
+        const PointAttributeVector<Vec3f> positionWrapper(context.positions);
+        PointIndexGrid::Ptr indexGrid = createPointIndexGrid<PointIndexGrid>(positionWrapper, *context.transform);
+        grid = createPointDataGrid<PointDataGrid>(*indexGrid, positionWrapper, type, *context.transform);
+    }
+
+    virtual Index64 bytes() const { return this->points() * sizeof(Vec3f); }
+
+    const NamePair type;
+    PointDataGrid::Ptr grid;
+}; // struct ConversionBenchmark
+
+
+struct PopulateBenchmark : public Benchmark
+{
+    PopulateBenchmark(const std::string& _name, const Context& _context)
+        : Benchmark(_name, _context) { }
+
+    virtual void setUp() {
+        grid = context.grid->deepCopy();
+        appendAttribute(grid->tree(), AttributeSet::Descriptor::NameAndType("N", AttributeVec3f::attributeType()));
+    }
+
+    virtual void run() {
+        populateAttribute(grid->tree(), context.indexGrid->tree(), "N", PointAttributeVector<Vec3f>(context.normals));
+    }
+
+    virtual Index64 bytes() const { return this->points() * sizeof(Vec3f); }
+
+    PointDataGrid::Ptr grid;
+}; // struct PopulateBenchmark
+
+
+/// Sum the positions of all points to measure unfiltered traversal
+struct PositionSumOp
+{
+    typedef tree::LeafManager<const PointDataTree> LeafManagerT;
+
+    PositionSumOp() : sum(0.0) { }
+    PositionSumOp(const PositionSumOp&, tbb::split) : sum(0.0) { }
+
+    void operator()(const LeafManagerT::LeafRange& range) {
+        for (LeafManagerT::LeafRange::Iterator leaf = range.begin(); leaf; ++leaf) {
+            AttributeHandle<Vec3f>::Ptr handle = AttributeHandle<Vec3f>::create(leaf->constAttributeArray("P"));
+            for (PointDataTree::LeafNodeType::IndexAllIter iter = leaf->beginIndexAll(); iter; ++iter) {
+                sum += handle->get(Index(*iter)).x();
+            }
+        }
+    }
+
+    void join(const PositionSumOp& other) { sum += other.sum; }
+
+    double sum;
+}; // struct PositionSumOp
+
+
+struct TraversalBenchmark : public Benchmark
+{
+    TraversalBenchmark(const std::string& _name, const Context& _context)
+        : Benchmark(_name, _context), sum(0.0) { }
+
+    virtual void run() {
+        PositionSumOp op;
+        PositionSumOp::LeafManagerT leafManager(context.grid->constTree());
+        tbb::parallel_reduce(leafManager.leafRange(), op);
+        sum = op.sum;
+    }
+
+    virtual Index64 bytes() const { return context.grid->memUsage(); }
+
+    double sum;
+}; // struct TraversalBenchmark
+
+
+template <typename FilterT>
+struct FilterBenchmark : public Benchmark
+{
+    FilterBenchmark(const std::string& _name, const Context& _context, const typename FilterT::Data& _data)
+        : Benchmark(_name, _context), data(_data), count(0) { }
+
+    virtual void run() {
+        count = filterPointCount<PointDataTree, FilterT>(context.grid->constTree(), data);
+    }
+
+    virtual Index64 bytes() const { return context.grid->memUsage(); }
+
+    const typename FilterT::Data data;
+    Index64 count;
+}; // struct FilterBenchmark
+
+
+struct GroupBenchmark : public Benchmark
+{
+    enum Operation { APPEND = 0, SET, UNION, DROP };
+
+    GroupBenchmark(const std::string& _name, const Context& _context, const Operation _operation)
+        : Benchmark(_name, _context), operation(_operation) { }
+
+    virtual void setUp() {
+        grid = context.grid->deepCopy();
+        if (operation == SET || operation == UNION)  appendGroup(grid->tree(), "bench");
+    }
+
+    virtual void run() {
+        PointDataTree& tree = grid->tree();
+        if (operation == APPEND)        appendGroup(tree, "bench");
+        else if (operation == SET)      setGroup(tree, context.indexGrid->tree(), context.membership, "bench");
+        else if (operation == UNION)    unionGroups(tree, "groupA", "groupB", "bench");
+        else if (operation == DROP)     dropGroup(tree, "groupA");
+    }
+
+    virtual Index64 bytes() const { return context.grid->memUsage(); }
+
+    const Operation operation;
+    PointDataGrid::Ptr grid;
+}; // struct GroupBenchmark
+
+
+template <typename AttributeT>
+struct CodecBenchmark : public Benchmark
+{
+    typedef typename AttributeT::ValueType ValueType;
+
+    enum Operation { ENCODE = 0, DECODE, COMPRESS, DECOMPRESS };
+
+    CodecBenchmark( const std::string& _name, const Context& _context,
+                    const std::vector<ValueType>& _values, const Operation _operation)
+        : Benchmark(_name, _context), values(_values), operation(_operation), sum(zeroVal<ValueType>()) { }
+
+    virtual void setUp() {
+        array.reset(new AttributeT(values.size()));
+        array->expand(/*fill=*/false);
+        if (operation == ENCODE)    return;
+        for (size_t n = 0; n < values.size(); n++)  array->set(Index(n), values[n]);
+        if (operation == DECOMPRESS)    array->compress();
+    }
+
+    virtual void run() {
+        if (operation == ENCODE) {
+            for (size_t n = 0; n < values.size(); n++)  array->set(Index(n), values[n]);
+        }
+        else if (operation == DECODE) {
+            ValueType total = zeroVal<ValueType>();
+            for (size_t n = 0; n < values.size(); n++)  total += array->get(Index(n));
+            sum = total;
+        }
+        else if (operation == COMPRESS) {
+            array->compress();
+        }
+        else if (operation == DECOMPRESS) {
+            array->decompress();
+        }
+    }
+
+    virtual void tearDown() { array.reset(); }
+
+    virtual Index64 bytes() const { return Index64(values.size() * sizeof(ValueType)); }
+
+    const std::vector<ValueType>& values;
+    const Operation operation;
+    boost::shared_ptr<AttributeT> array;
+    ValueType sum;
+}; // struct CodecBenchmark
+
+
+struct IOBenchmark : public Benchmark
+{
+    enum Operation { WRITE = 0, READ, READ_DELAYED, LOAD };
+
+    IOBenchmark(const std::string& _name, const Context& _context, const Operation _operation)
+        : Benchmark(_name, _context), operation(_operation)
+        , filename(_context.filename + ".bench") { }
+
+    virtual void setUp() {
+        grids.reset();
+        if (operation == LOAD)  grids = this->read(/*delayLoad=*/true);
+    }
+
+    virtual void run() {
+        if (operation == WRITE) {
+            GridCPtrVec output;
+            output.push_back(context.grid);
+            io::File file(filename);
+            file.write(output);
+            file.close();
+        }
+        else if (operation == READ) {
+            grids = this->read(/*delayLoad=*/false);
+        }
+        else if (operation == READ_DELAYED) {
+            grids = this->read(/*delayLoad=*/true);
+        }
+        else if (operation == LOAD) {
+            for (GridPtrVec::iterator it = grids->begin(); it != grids->end(); ++it) {
+                PointDataGrid::Ptr grid = gridPtrCast<PointDataGrid>(*it);
+                if (grid)   loadPoints(*grid);
+            }
+        }
+    }
+
+    virtual void tearDown() {
+        grids.reset();
+        if (operation == WRITE)     std::remove(filename.c_str());
+    }
+
+    virtual Index64 bytes() const { return fileSize(context.filename); }
+
+    GridPtrVecPtr read(const bool delayLoad) const {
+        io::File file(context.filename);
+        file.open(delayLoad);
+        GridPtrVecPtr result = file.getGrids();
+        file.close();
+        return result;
+    }
+
+    const Operation operation;
+    const std::string filename;
+    GridPtrVecPtr grids;
+}; // struct IOBenchmark
+
+
+////////////////////////////////////////
+
+
+/// The result of a benchmark, the fastest of a number of runs
+struct Result
+{
+    std::string name;
+    double seconds;
+    Index64 points;
+    Index64 bytes;
+};
+
+
+Result
+runBenchmark(Benchmark& benchmark, const int repeats)
+{
+    Result result;
+    result.name = benchmark.name;
+    result.seconds = std::numeric_limits<double>::max();
+
+    for (int i = 0; i < repeats; i++) {
+        benchmark.setUp();
+        const tbb::tick_count start = tbb::tick_count::now();
+        benchmark.run();
+        const double seconds = (tbb::tick_count::now() - start).seconds();
+        benchmark.tearDown();
+        result.seconds = std::min(result.seconds, seconds);
+    }
+
+    result.points = benchmark.points();
+    result.bytes = benchmark.bytes();
+
+    return result;
+}
+
+
+double
+throughput(const Index64 amount, const double seconds)
+{
+    return seconds > 0.0 ? double(amount) / seconds : 0.0;
+}
+
+
+void
+writeJSON(std::ostream& os, const Context& context, const int repeats, const std::vector<Result>& results)
+{
+    os << std::setprecision(9);
+
+    os << "{\n";
+    os << "  \"library\": \"openvdb_points\",\n";
+    os << "  \"version\": \"" << OPENVDB_POINTS_LIBRARY_VERSION_STRING << "\",\n";
+    os << "  \"config\": {\n";
+    os << "    \"points\": " << context.positions.size() << ",\n";
+    os << "    \"density\": " << context.density << ",\n";
+    os << "    \"distribution\": \"" << context.distribution << "\",\n";
+    os << "    \"seed\": " << context.seed << ",\n";
+    os << "    \"voxelSize\": " << context.voxelSize << ",\n";
+    os << "    \"leaves\": " << context.grid->tree().leafCount() << ",\n";
+    os << "    \"repeats\": " << repeats << ",\n";
+    os << "    \"threads\": " << tbb::task_scheduler_init::default_num_threads() << "\n";
+    os << "  },\n";
+    os << "  \"benchmarks\": [";
+
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& result = results[i];
+        os << (i == 0 ? "\n" : ",\n");
+        os << "    {";
+        os << "\"name\": \"" << result.name << "\", ";
+        os << "\"seconds\": " << result.seconds << ", ";
+        os << "\"points\": " << result.points << ", ";
+        os << "\"bytes\": " << result.bytes << ", ";
+        os << "\"pointsPerSecond\": " << throughput(result.points, result.seconds) << ", ";
+        os << "\"bytesPerSecond\": " << throughput(result.bytes, result.seconds);
+        os << "}";
+    }
+
+    os << "\n  ]\n";
+    os << "}\n";
+}
+
+
+////////////////////////////////////////
+
+
+void
+createBenchmarks(const Context& context, std::vector<Benchmark::Ptr>& benchmarks)
+{
+    typedef Benchmark::Ptr Ptr;
+
+    typedef RandomLeafFilter<boost::mt11213b>               RandomFilter;
+    typedef AttributeHashFilter<boost::mt11213b, int32_t>   HashFilter;
+    typedef LevelSetFilter<FloatGrid>                       LSFilter;
+    typedef BinaryFilter<GroupFilter, BBoxFilter>           GroupBBoxFilter;
+
+    const PointDataTree& tree = context.grid->constTree();
+
+    // conversion and populate
+
+    benchmarks.push_back(Ptr(new ConversionBenchmark("convert/float", context, AttributeVec3f::attributeType())));
+    benchmarks.push_back(Ptr(new ConversionBenchmark("convert/fxpt16", context, AttributeVec3fFxpt16::attributeType())));
+    benchmarks.push_back(Ptr(new PopulateBenchmark("populate", context)));
+
+    // traversal with each filter type
+
+    benchmarks.push_back(Ptr(new TraversalBenchmark("iterate/none", context)));
+
+    benchmarks.push_back(Ptr(new FilterBenchmark<GroupFilter>("iterate/group", context, GroupFilter::Data("groupA"))));
+
+    {
+        std::vector<Name> include, exclude;
+        include.push_back("groupA");
+        exclude.push_back("groupB");
+        benchmarks.push_back(Ptr(new FilterBenchmark<MultiGroupFilter>("iterate/multigroup", context,
+                                                    MultiGroupFilter::Data(include, exclude))));
+    }
+
+    {
+        RandomFilter::Data data;
+        data.populateByPercentagePoints(tree, 10.0f, context.seed);
+        benchmarks.push_back(Ptr(new FilterBenchmark<RandomFilter>("iterate/random", context, data)));
+    }
+
+    {
+        const size_t index = tree.cbeginLeaf() ? tree.cbeginLeaf()->attributeSet().descriptor().find("id") : 0;
+        benchmarks.push_back(Ptr(new FilterBenchmark<HashFilter>("iterate/hash", context,
+                                                    HashFilter::Data(index, 10.0, context.seed))));
+    }
+
+    // all distributions lie within a 100 unit cube, the box covers one octant
+
+    const BBoxd bbox(Vec3d(0.0), Vec3d(50.0));
+
+    benchmarks.push_back(Ptr(new FilterBenchmark<BBoxFilter>("iterate/bbox", context,
+                                                BBoxFilter::Data(*context.transform, bbox))));
+
+    benchmarks.push_back(Ptr(new FilterBenchmark<LSFilter>("iterate/levelset", context,
+                        LSFilter::Data(*context.levelSet, *context.transform, -std::numeric_limits<float>::max(), 0.0f))));
+
+    benchmarks.push_back(Ptr(new FilterBenchmark<GroupBBoxFilter>("iterate/binary", context,
+                            GroupBBoxFilter::Data(GroupFilter::Data("groupA"), BBoxFilter::Data(*context.transform, bbox)))));
+
+    // group operations
+
+    benchmarks.push_back(Ptr(new GroupBenchmark("group/append", context, GroupBenchmark::APPEND)));
+    benchmarks.push_back(Ptr(new GroupBenchmark("group/set", context, GroupBenchmark::SET)));
+    benchmarks.push_back(Ptr(new GroupBenchmark("group/union", context, GroupBenchmark::UNION)));
+    benchmarks.push_back(Ptr(new GroupBenchmark("group/drop", context, GroupBenchmark::DROP)));
+
+    // compression codecs
+
+    typedef CodecBenchmark<AttributeVec3f>              CodecVec3f;
+    typedef CodecBenchmark<AttributeVec3fTruncate>      CodecVec3fTruncate;
+    typedef CodecBenchmark<AttributeVec3fFxpt8>         CodecVec3fFxpt8;
+    typedef CodecBenchmark<AttributeVec3fFxpt16>        CodecVec3fFxpt16;
+    typedef CodecBenchmark<AttributeVec3fUnitVec>       CodecVec3fUnitVec;
+    typedef CodecBenchmark<AttributeF>                  CodecF;
+    typedef CodecBenchmark<AttributeFTruncate>          CodecFTruncate;
+
+    benchmarks.push_back(Ptr(new CodecVec3f("codec/vec3f/null/encode", context, context.offsets, CodecVec3f::ENCODE)));
+    benchmarks.push_back(Ptr(new CodecVec3f("codec/vec3f/null/decode", context, context.offsets, CodecVec3f::DECODE)));
+    benchmarks.push_back(Ptr(new CodecVec3fTruncate("codec/vec3f/trnc/encode", context, context.offsets, CodecVec3fTruncate::ENCODE)));
+    benchmarks.push_back(Ptr(new CodecVec3fTruncate("codec/vec3f/trnc/decode", context, context.offsets, CodecVec3fTruncate::DECODE)));
+    benchmarks.push_back(Ptr(new CodecVec3fFxpt8("codec/vec3f/fxpt8/encode", context, context.offsets, CodecVec3fFxpt8::ENCODE)));
+    benchmarks.push_back(Ptr(new CodecVec3fFxpt8("codec/vec3f/fxpt8/decode", context, context.offsets, CodecVec3fFxpt8::DECODE)));
+    benchmarks.push_back(Ptr(new CodecVec3fFxpt16("codec/vec3f/fxpt16/encode", context, context.offsets, CodecVec3fFxpt16::ENCODE)));
+    benchmarks.push_back(Ptr(new CodecVec3fFxpt16("codec/vec3f/fxpt16/decode", context, context.offsets, CodecVec3fFxpt16::DECODE)));
+    benchmarks.push_back(Ptr(new CodecVec3fUnitVec("codec/vec3f/uvec/encode", context, context.normals, CodecVec3fUnitVec::ENCODE)));
+    benchmarks.push_back(Ptr(new CodecVec3fUnitVec("codec/vec3f/uvec/decode", context, context.normals, CodecVec3fUnitVec::DECODE)));
+    benchmarks.push_back(Ptr(new CodecF("codec/float/null/encode", context, context.scales, CodecF::ENCODE)));
+    benchmarks.push_back(Ptr(new CodecF("codec/float/null/decode", context, context.scales, CodecF::DECODE)));
+    benchmarks.push_back(Ptr(new CodecFTruncate("codec/float/trnc/encode", context, context.scales, CodecFTruncate::ENCODE)));
+    benchmarks.push_back(Ptr(new CodecFTruncate("codec/float/trnc/decode", context, context.scales, CodecFTruncate::DECODE)));
+    benchmarks.push_back(Ptr(new CodecVec3f("codec/vec3f/blosc/compress", context, context.offsets, CodecVec3f::COMPRESS)));
+    benchmarks.push_back(Ptr(new CodecVec3f("codec/vec3f/blosc/decompress", context, context.offsets, CodecVec3f::DECOMPRESS)));
+
+    // I/O
+
+    benchmarks.push_back(Ptr(new IOBenchmark("io/write", context, IOBenchmark::WRITE)));
+    benchmarks.push_back(Ptr(new IOBenchmark("io/read", context, IOBenchmark::READ)));
+    benchmarks.push_back(Ptr(new IOBenchmark("io/read/delayed", context, IOBenchmark::READ_DELAYED)));
+    benchmarks.push_back(Ptr(new IOBenchmark("io/load", context, IOBenchmark::LOAD)));
+}
+
+} // unnamed namespace
+
+
+int
+main(int argc, char *argv[])
+{
+    OPENVDB_START_THREADSAFE_STATIC_WRITE
+    gProgName = argv[0];
+    if (const char* ptr = ::strrchr(gProgName, '/')) gProgName = ptr + 1;
+    OPENVDB_FINISH_THREADSAFE_STATIC_WRITE
+
+    int exitStatus = EXIT_SUCCESS;
+
+    Context context;
+
+    size_t count = 1000 * 1000;
+    int repeats = 3;
+    std::string distribution("uniform");
+    std::string filter, outputFilename;
+
+    std::string tempDir;
+    if (const char* dir = std::getenv("TMPDIR"))    tempDir = dir;
+    if (tempDir.empty())    tempDir = P_tmpdir;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "-h" || arg == "-help" || arg == "--help") {
+            usage(EXIT_SUCCESS);
+        } else if ((arg == "-n" || arg == "-points") && hasValue) {
+            count = size_t(std::atol(argv[++i]));
+        } else if ((arg == "-d" || arg == "-density") && hasValue) {
+            context.density = float(std::atof(argv[++i]));
+        } else if (arg == "-dist" && hasValue) {
+            distribution = argv[++i];
+        } else if ((arg == "-r" || arg == "-repeats") && hasValue) {
+            repeats = std::atoi(argv[++i]);
+        } else if (arg == "-seed" && hasValue) {
+            context.seed = unsigned(std::atol(argv[++i]));
+        } else if (arg == "-filter" && hasValue) {
+            filter = argv[++i];
+        } else if (arg == "-tmpdir" && hasValue) {
+            tempDir = argv[++i];
+        } else if (arg == "-o" && hasValue) {
+            outputFilename = argv[++i];
+        } else {
+            std::cerr << gProgName << ": \"" << arg << "\" is not a valid option\n";
+            usage();
+        }
+    }
+
+    if (count == 0 || repeats < 1 || context.density < 1.0f) {
+        std::cerr << gProgName << ": expected a positive point count, repeat count and a density of at least one\n";
+        usage();
+    }
+
+    context.filename = tempDir + "/openvdb_points_bench.vdb";
+
+    try {
+        openvdb::initialize();
+        openvdb::points::initialize();
+
+        generatePositions(context, count, distribution);
+        initializeContext(context);
+
+        std::vector<Benchmark::Ptr> benchmarks;
+        createBenchmarks(context, benchmarks);
+
+        std::vector<Result> results;
+
+        for (std::vector<Benchmark::Ptr>::const_iterator it = benchmarks.begin(); it != benchmarks.end(); ++it) {
+            Benchmark& benchmark = **it;
+            if (!filter.empty() && benchmark.name.find(filter) == std::string::npos)    continue;
+            std::cerr << benchmark.name << std::endl;
+            results.push_back(runBenchmark(benchmark, repeats));
+        }
+
+        if (outputFilename.empty()) {
+            writeJSON(std::cout, context, repeats, results);
+        }
+        else {
+            std::ofstream file(outputFilename.c_str());
+            writeJSON(file, context, repeats, results);
+        }
+
+        std::remove(context.filename.c_str());
+    }
+    catch (const std::exception& e) {
+        OPENVDB_LOG_FATAL(e.what());
+        exitStatus = EXIT_FAILURE;
+    }
+    catch (...) {
+        OPENVDB_LOG_FATAL("Exception caught (unexpected type)");
+        std::unexpected();
+    }
+
+    return exitStatus;
+}
+
+// Copyright (c) 2015-2016 Double Negative Visual Effects
+// All rights reserved. This software is distributed under the
+// Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
@@ -28,20 +28,31 @@
 //
 ///////////////////////////////////////////////////////////////////////////
 
+#include <algorithm> // std::min, std::max
+#include <cstdlib> // std::atof
+#include <iomanip> // std::setprecision, std::setw
 #include <iostream>
+#include <limits>
 #include <sstream>
 #include <string>
 #include <vector>
 #include <openvdb/openvdb.h>
+#include <openvdb/tree/LeafManager.h>
 #include <openvdb_points/openvdb.h>
+#include <openvdb_points/tools/AttributeGroup.h>
 #include <openvdb_points/tools/PointDataGrid.h>
+#include <openvdb_points/tools/PointCompression.h>
 #include <openvdb_points/tools/PointCount.h>
+#include <openvdb_points/tools/Instrumentation.h>
+
+#include <tbb/parallel_reduce.h>
 
 namespace {
 
 typedef std::vector<std::string> StringVec;
 
 const char* INDENT = "   ";
+const double DEFAULT_TOLERANCE = 1e-3;
 const char* gProgName = "";
 
 
@@ -52,8 +63,13 @@ usage(int exitStatus = EXIT_FAILURE)
 "Usage: " << gProgName << " in.vdb [in.vdb ...] [options]\n" <<
 "Which: prints information about OpenVDB (and OpenVDB Points) grids\n" <<
 "Options:\n" <<
-"    -l, -stats     long printout, including grid statistics\n" <<
-"    -m, -metadata  print per-file and per-grid metadata\n";
+"    -i, -instrumentation  print attribute counters and timers gathered while reading\n" <<
+"    -l, -stats            long printout, including grid statistics\n" <<
+"    -m, -metadata         print per-file and per-grid metadata\n" <<
+"    -s, -storage          print per-attribute storage statistics, group counts\n" <<
+"                          and a histogram of points per leaf for point grids\n" <<
+"    -t, -tolerance <t>    maximum error of the codecs suggested by -storage\n" <<
+"                          (default " << DEFAULT_TOLERANCE << ", in voxel units for P)\n";
     exit(exitStatus);
 }
 
@@ -327,6 +343,398 @@ printShortListing(const StringVec& filenames, bool metadata)
     }
 }
 
+////////////////////////////////////////
+
+// Attribute storage statistics
+
+
+typedef openvdb::tools::point_compression_internal::CodecCandidate<float>                FloatCandidate;
+typedef openvdb::tools::point_compression_internal::CodecCandidate<openvdb::Vec3f>       Vec3fCandidate;
+
+
+/// Storage statistics for one attribute, accumulated over all leaf nodes
+struct AttributeStats
+{
+    AttributeStats()
+        : arrays(0), uniformArrays(0), values(0)
+        , memoryBytes(0), storageBytes(0), valueBytes(0)
+        , components(0)
+    {
+        for (int i = 0; i < 3; i++) {
+            min[i] = std::numeric_limits<double>::max();
+            max[i] = -std::numeric_limits<double>::max();
+        }
+    }
+
+    void join(const AttributeStats& other)
+    {
+        arrays += other.arrays;
+        uniformArrays += other.uniformArrays;
+        values += other.values;
+        memoryBytes += other.memoryBytes;
+        storageBytes += other.storageBytes;
+        valueBytes = std::max(valueBytes, other.valueBytes);
+        components = std::max(components, other.components);
+        for (int i = 0; i < 3; i++) {
+            min[i] = std::min(min[i], other.min[i]);
+            max[i] = std::max(max[i], other.max[i]);
+        }
+        if (errors.empty())     errors = other.errors;
+        for (size_t i = 0; i < other.errors.size() && i < errors.size(); i++) {
+            errors[i] = std::max(errors[i], other.errors[i]);
+        }
+    }
+
+    openvdb::Index64 arrays, uniformArrays, values;
+    openvdb::Index64 memoryBytes, storageBytes;
+    openvdb::Index valueBytes;  // bytes used to store a single value
+    int components;             // zero if min and max are not available for this value type
+    double min[3], max[3];
+    std::vector<double> errors; // maximum error of each codec candidate, if any are available
+}; // struct AttributeStats
+
+
+template <typename T> inline int componentCount(const T&) { return 1; }
+template <typename T> inline int componentCount(const openvdb::math::Vec2<T>&) { return 2; }
+template <typename T> inline int componentCount(const openvdb::math::Vec3<T>&) { return 3; }
+
+template <typename T> inline double component(const T& v, int) { return double(v); }
+template <typename T> inline double component(const openvdb::math::Vec2<T>& v, int i) { return double(v[i]); }
+template <typename T> inline double component(const openvdb::math::Vec3<T>& v, int i) { return double(v[i]); }
+
+
+/// @brief Accumulate the value range of an attribute array with value type @c T and,
+/// if codec @a candidates are provided, the maximum error of each candidate
+template <typename T>
+void
+accumulateValues(const openvdb::tools::AttributeArray& array, AttributeStats& stats,
+    const std::vector<openvdb::tools::point_compression_internal::CodecCandidate<T> >* candidates = NULL)
+{
+    using openvdb::tools::point_compression_internal::accumulateErrors;
+
+    typedef openvdb::tools::AttributeHandle<T> HandleT;
+
+    HandleT handle(array);
+
+    if (candidates)     stats.errors.resize(candidates->size(), 0.0);
+
+    // a uniform array only needs to evaluate the first value
+
+    const size_t size = handle.isUniform() ? std::min(size_t(1), handle.size()) : handle.size();
+
+    for (size_t n = 0; n < size; n++) {
+        const T value = handle.get(openvdb::Index(n));
+        stats.components = componentCount(value);
+        for (int i = 0; i < stats.components; i++) {
+            const double x = component(value, i);
+            stats.min[i] = std::min(stats.min[i], x);
+            stats.max[i] = std::max(stats.max[i], x);
+        }
+        if (candidates)     accumulateErrors(value, *candidates, stats.errors);
+    }
+}
+
+
+/// Accumulate the value range of an attribute array of any registered value type
+void
+accumulateValues(const openvdb::tools::AttributeArray& array, AttributeStats& stats)
+{
+    using namespace openvdb;
+
+    const Name& valueType = array.type().first;
+
+    if (valueType == typeNameAsString<bool>())                      accumulateValues<bool>(array, stats);
+    else if (valueType == typeNameAsString<int16_t>())              accumulateValues<int16_t>(array, stats);
+    else if (valueType == typeNameAsString<int32_t>())              accumulateValues<int32_t>(array, stats);
+    else if (valueType == typeNameAsString<int64_t>())              accumulateValues<int64_t>(array, stats);
+    else if (valueType == typeNameAsString<half>())                 accumulateValues<half>(array, stats);
+    else if (valueType == typeNameAsString<double>())               accumulateValues<double>(array, stats);
+    else if (valueType == typeNameAsString<math::Vec2<half> >())    accumulateValues<math::Vec2<half> >(array, stats);
+    else if (valueType == typeNameAsString<math::Vec2<float> >())   accumulateValues<math::Vec2<float> >(array, stats);
+    else if (valueType == typeNameAsString<math::Vec2<double> >())  accumulateValues<math::Vec2<double> >(array, stats);
+    else if (valueType == typeNameAsString<math::Vec3<half> >())    accumulateValues<math::Vec3<half> >(array, stats);
+    else if (valueType == typeNameAsString<math::Vec3<double> >())  accumulateValues<math::Vec3<double> >(array, stats);
+}
+
+
+/// Parallel reduction of attribute storage statistics and points per leaf
+struct StorageStatsOp
+{
+    typedef openvdb::tree::LeafManager<const PointDataTree> LeafManagerT;
+
+    StorageStatsOp( const size_t attributes,
+                    const std::vector<FloatCandidate>& floatCandidates,
+                    const std::vector<Vec3fCandidate>& vec3fCandidates)
+        : mStats(attributes)
+        , mHistogram(65, 0)
+        , mFloatCandidates(floatCandidates)
+        , mVec3fCandidates(vec3fCandidates) { }
+
+    StorageStatsOp(const StorageStatsOp& other, tbb::split)
+        : mStats(other.mStats.size())
+        , mHistogram(other.mHistogram.size(), 0)
+        , mFloatCandidates(other.mFloatCandidates)
+        , mVec3fCandidates(other.mVec3fCandidates) { }
+
+    void operator()(const LeafManagerT::LeafRange& range)
+    {
+        using namespace openvdb;
+        using openvdb::tools::AttributeArray;
+        using openvdb::tools::GroupAttributeArray;
+
+        for (LeafManagerT::LeafRange::Iterator leaf = range.begin(); leaf; ++leaf) {
+
+            // points per leaf are binned by powers of two (0, 1, 2-3, 4-7, ...)
+
+            const Index64 points = leaf->pointCount();
+            size_t bin = 0;
+            for (Index64 n = points; n > 0; n >>= 1)  bin++;
+            mHistogram[bin]++;
+
+            const AttributeSet& attributeSet = leaf->attributeSet();
+
+            for (size_t pos = 0; pos < attributeSet.size() && pos < mStats.size(); pos++) {
+                const AttributeArray& array = leaf->attributeArray(pos);
+                AttributeStats& stats = mStats[pos];
+
+                stats.arrays++;
+                if (array.isUniform())  stats.uniformArrays++;
+                stats.values += array.size();
+
+                // the uncompressed storage is computed from the size of each value rather
+                // than by serializing the array, which would load a delay-loaded array
+
+                stats.valueBytes = array.storageTypeSize();
+                stats.storageBytes += array.isUniform() ?
+                    Index64(stats.valueBytes) : Index64(array.size()) * stats.valueBytes;
+                stats.memoryBytes += array.memUsage();
+
+                if (GroupAttributeArray::isGroup(array))    continue;
+
+                const Name& valueType = array.type().first;
+
+                if (valueType == typeNameAsString<float>()) {
+                    accumulateValues<float>(array, stats, &mFloatCandidates);
+                }
+                else if (valueType == typeNameAsString<Vec3f>()) {
+                    accumulateValues<Vec3f>(array, stats, &mVec3fCandidates);
+                }
+                else {
+                    accumulateValues(array, stats);
+                }
+            }
+        }
+    }
+
+    void join(const StorageStatsOp& other)
+    {
+        for (size_t i = 0; i < mStats.size(); i++)      mStats[i].join(other.mStats[i]);
+        for (size_t i = 0; i < mHistogram.size(); i++)  mHistogram[i] += other.mHistogram[i];
+    }
+
+    std::vector<AttributeStats> mStats;
+    std::vector<openvdb::Index64> mHistogram;
+    const std::vector<FloatCandidate>& mFloatCandidates;
+    const std::vector<Vec3fCandidate>& mVec3fCandidates;
+}; // struct StorageStatsOp
+
+
+/// @brief Print the registered codec with the smallest storage whose measured maximum
+/// error is within @a tolerance, if it uses less storage than the existing codec.
+template <typename T>
+void
+printBestCodec( const std::vector<openvdb::tools::point_compression_internal::CodecCandidate<T> >& candidates,
+                const openvdb::NamePair& type,
+                const AttributeStats& stats,
+                const double tolerance,
+                const std::string& indent)
+{
+    using namespace openvdb;
+
+    if (stats.errors.size() != candidates.size())   return;
+
+    const size_t index = tools::point_compression_internal::selectCandidate(
+        candidates, stats.errors, tolerance);
+
+    if (candidates[index].type == type)                     return;
+    if (candidates[index].bytes >= stats.valueBytes)        return;
+
+    const Index64 savings = stats.values * (stats.valueBytes - candidates[index].bytes);
+
+    std::ostringstream ostr;
+    ostr << std::setprecision(3);
+    ostr << "best codec: " << candidates[index].type.second
+         << " (max error: " << stats.errors[index]
+         << ", saves ~" << bytesAsString(savings) << " in memory)";
+    std::cout << indent << ostr.str() << "\n";
+}
+
+
+std::string
+rangeAsString(const double* values, const int components)
+{
+    std::ostringstream ostr;
+    ostr << std::setprecision(6);
+    if (components > 1)     ostr << "[";
+    for (int i = 0; i < components; i++) {
+        if (i > 0)  ostr << ", ";
+        ostr << values[i];
+    }
+    if (components > 1)     ostr << "]";
+    return ostr.str();
+}
+
+
+/// Print per-attribute storage statistics, per-group point counts and
+/// a histogram of points per leaf for a PointDataGrid.
+void
+printStorageStats(const PointDataGrid& grid, const double tolerance, const std::string& indent)
+{
+    using namespace openvdb;
+    using tools::point_compression_internal::CodecCandidates;
+
+    const PointDataTree& tree = grid.tree();
+
+    PointDataTree::LeafCIter iter = tree.cbeginLeaf();
+    if (!iter) {
+        std::cout << indent << "no points\n";
+        return;
+    }
+
+    const std::string indent2(indent + INDENT), indent3(indent2 + INDENT);
+
+    const AttributeSet::Descriptor& descriptor = iter->attributeSet().descriptor();
+
+    std::vector<FloatCandidate> floatCandidates;
+    CodecCandidates<float>::get(floatCandidates);
+    std::vector<Vec3fCandidate> vec3fCandidates;
+    CodecCandidates<Vec3f>::get(vec3fCandidates);
+
+    StorageStatsOp op(descriptor.size(), floatCandidates, vec3fCandidates);
+    StorageStatsOp::LeafManagerT leafManager(tree);
+    tbb::parallel_reduce(leafManager.leafRange(), op);
+
+    std::cout << indent << "leaves: " << leafManager.leafCount()
+              << ", points: " << pointCount(tree) << "\n";
+
+    // attributes
+
+    std::cout << indent << "attributes:\n";
+
+    Index64 totalMemory(0), totalStorage(0);
+
+    typedef AttributeSet::Descriptor::NameToPosMap NameToPosMap;
+    const NameToPosMap& map = descriptor.map();
+
+    for (NameToPosMap::const_iterator it = map.begin(); it != map.end(); ++it) {
+        const AttributeStats& stats = op.mStats[it->second];
+        const NamePair& type = descriptor.type(it->second);
+
+        totalMemory += stats.memoryBytes;
+        totalStorage += stats.storageBytes;
+
+        std::cout << indent2 << it->first << " (" << type.first << ", " << type.second << ")\n";
+
+        std::ostringstream ostr;
+        ostr << std::setprecision(3);
+        ostr << "memory: " << bytesAsString(stats.memoryBytes)
+             << ", uncompressed: " << bytesAsString(stats.storageBytes);
+        if (stats.memoryBytes > 0) {
+            ostr << ", ratio: " << (double(stats.storageBytes) / double(stats.memoryBytes));
+        }
+        if (stats.arrays > 0) {
+            ostr << ", uniform: " << (100.0 * double(stats.uniformArrays) / double(stats.arrays)) << "%";
+        }
+        std::cout << indent3 << ostr.str() << "\n";
+
+        if (stats.components > 0 && stats.values > 0) {
+            std::cout << indent3 << "min: " << rangeAsString(stats.min, stats.components)
+                      << ", max: " << rangeAsString(stats.max, stats.components) << "\n";
+        }
+
+        if (type.first == typeNameAsString<float>()) {
+            printBestCodec(floatCandidates, type, stats, tolerance, indent3);
+        }
+        else if (type.first == typeNameAsString<Vec3f>()) {
+            printBestCodec(vec3fCandidates, type, stats, tolerance, indent3);
+        }
+    }
+
+    std::cout << indent2 << "total memory: " << bytesAsString(totalMemory)
+              << ", uncompressed: " << bytesAsString(totalStorage) << "\n";
+
+    // groups
+
+    const NameToPosMap& groupMap = descriptor.groupMap();
+
+    if (!groupMap.empty()) {
+        std::cout << indent << "groups:\n";
+        for (NameToPosMap::const_iterator it = groupMap.begin(); it != groupMap.end(); ++it) {
+            std::cout << indent2 << std::left << std::setw(20) << it->first << std::right
+                      << " " << groupPointCount(tree, it->first) << " points\n";
+        }
+    }
+
+    // histogram of points per leaf
+
+    std::cout << indent << "points per leaf:\n";
+
+    for (size_t bin = 0; bin < op.mHistogram.size(); bin++) {
+        if (op.mHistogram[bin] == 0)    continue;
+
+        std::ostringstream ostr;
+        if (bin <= 1)   ostr << bin;
+        else            ostr << (Index64(1) << (bin - 1)) << "-" << ((Index64(1) << bin) - 1);
+
+        std::cout << indent2 << std::left << std::setw(20) << ostr.str() << std::right
+                  << " " << op.mHistogram[bin] << " leaves\n";
+    }
+}
+
+
+/// Print attribute storage statistics for all PointDataGrids in the given VDB files.
+void
+printStorageListing(const StringVec& filenames, const double tolerance)
+{
+    bool oneFile = (filenames.size() == 1), firstFile = true;
+
+    for (size_t i = 0, N = filenames.size(); i < N; ++i, firstFile = false) {
+        openvdb::io::File file(filenames[i]);
+        openvdb::GridPtrVecPtr grids;
+        try {
+            file.open();
+            grids = file.getGrids();
+            file.close();
+        } catch (openvdb::Exception& e) {
+            OPENVDB_LOG_ERROR(e.what() << " (" << filenames[i] << ")");
+        }
+        if (!grids) continue;
+
+        if (!oneFile) {
+            if (!firstFile) {
+                std::cout << "\n" << std::string(40, '-') << "\n\n";
+            }
+            std::cout << filenames[i] << "\n\n";
+        }
+
+        // For each point data grid in the file...
+        bool firstGrid = true;
+        for (openvdb::GridPtrVec::const_iterator it = grids->begin(); it != grids->end(); ++it) {
+            const openvdb::GridBase::ConstPtr grid = *it;
+            if (!grid || !grid->isType<PointDataGrid>())   continue;
+
+            if (!firstGrid) std::cout << "\n";
+            std::cout << "Name: " << grid->getName() << std::endl;
+
+            PointDataGrid::ConstPtr pointDataGrid = openvdb::gridConstPtrCast<PointDataGrid>(grid);
+            printStorageStats(*pointDataGrid, tolerance, INDENT);
+
+            firstGrid = false;
+        }
+    }
+}
+
+
 } // unnamed namespace
 
 
@@ -342,7 +750,8 @@ main(int argc, char *argv[])
 
     if (argc == 1) usage();
 
-    bool stats = false, metadata = false;
+    bool longListing = false, storage = false, metadata = false, instrument = false;
+    double tolerance = DEFAULT_TOLERANCE;
     StringVec filenames;
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
@@ -350,7 +759,17 @@ main(int argc, char *argv[])
             if (arg == "-m" || arg == "-metadata") {
                 metadata = true;
             } else if (arg == "-l" || arg == "-stats") {
-                stats = true;
+                longListing = true;
+            } else if (arg == "-s" || arg == "-storage") {
+                storage = true;
+            } else if (arg == "-t" || arg == "-tolerance") {
+                if (i + 1 >= argc) {
+                    std::cerr << gProgName << ": \"" << arg << "\" expects a tolerance\n";
+                    usage();
+                }
+                tolerance = std::atof(argv[++i]);
+            } else if (arg == "-i" || arg == "-instrumentation") {
+                instrument = true;
             } else if (arg == "-h" || arg == "-help" || arg == "--help") {
                 usage(EXIT_SUCCESS);
             } else {
@@ -383,11 +802,23 @@ main(int argc, char *argv[])
         openvdb::Grid<openvdb::tree::Tree4<openvdb::Vec3f, 4, 3, 3>::Type>::registerGrid();
         openvdb::Grid<openvdb::tree::Tree4<openvdb::Vec3d, 4, 3, 3>::Type>::registerGrid();
 
-        if (stats) {
+        if (instrument) {
+            openvdb::tools::instrumentation::setEnabled(true);
+            openvdb::tools::instrumentation::reset();
+        }
+
+        if (storage) {
+            printStorageListing(filenames, tolerance);
+        } else if (longListing) {
             printLongListing(filenames);
         } else {
             printShortListing(filenames, metadata);
         }
+
+        if (instrument) {
+            std::cout << "Instrumentation:" << std::endl;
+            openvdb::tools::instrumentation::print(std::cout, INDENT);
+        }
     }
     catch (const std::exception& e) {
         OPENVDB_LOG_FATAL(e.what());
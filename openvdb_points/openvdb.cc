@@ -32,10 +32,15 @@
 
 #include <openvdb_points/tools/AttributeArray.h>
 #include <openvdb_points/tools/AttributeGroup.h>
+#include <openvdb_points/tools/AttributeString.h>
+#include <openvdb_points/tools/AttributeVariable.h>
+#include <openvdb_points/tools/Instrumentation.h>
 #include <openvdb_points/tools/PointDataGrid.h>
 
 #include <tbb/mutex.h>
 
+#include <cstdlib> // std::getenv
+
 namespace openvdb {
 OPENVDB_USE_VERSION_NAMESPACE
 namespace OPENVDB_VERSION_NAME {
@@ -60,6 +65,7 @@ initialize()
     // no compression
 
     TypedAttributeArray<bool>::registerType();
+    TypedAttributeArray<uint8_t>::registerType();
     TypedAttributeArray<int16_t>::registerType();
     TypedAttributeArray<int32_t>::registerType();
     TypedAttributeArray<int64_t>::registerType();
@@ -72,11 +78,30 @@ initialize()
     TypedAttributeArray<Vec3<half> >::registerType();
     TypedAttributeArray<Vec3<float> >::registerType();
     TypedAttributeArray<Vec3<double> >::registerType();
+    TypedAttributeArray<Vec4<float> >::registerType();
+    TypedAttributeArray<Vec4<double> >::registerType();
+    TypedAttributeArray<Quat<float> >::registerType();
+    TypedAttributeArray<Quat<double> >::registerType();
+    TypedAttributeArray<Mat3<float> >::registerType();
+    TypedAttributeArray<Mat3<double> >::registerType();
 
     // group attribute
 
     GroupAttributeArray::registerType();
 
+    // string attribute
+
+    StringAttributeArray::registerType();
+
+    // variable-length attributes
+
+    VariableAttributeArray<int32_t>::registerType();
+    VariableAttributeArray<int64_t>::registerType();
+    VariableAttributeArray<float>::registerType();
+    VariableAttributeArray<double>::registerType();
+    VariableAttributeArray<Vec3<float> >::registerType();
+    VariableAttributeArray<Vec3<double> >::registerType();
+
     // truncate compression
 
     TypedAttributeArray<float, NullAttributeCodec<half> >::registerType();
@@ -90,12 +115,32 @@ initialize()
     // unit vector compression
 
     TypedAttributeArray<Vec3<float>, UnitVecAttributeCodec>::registerType();
+    TypedAttributeArray<Vec3<float>, OctahedralAttributeCodec<uint16_t> >::registerType();
+    TypedAttributeArray<Vec3<float>, OctahedralAttributeCodec<uint32_t> >::registerType();
+    TypedAttributeArray<Vec3<float>, OctahedralAttributeCodec<Vec2<half> > >::registerType();
+
+    // quaternion compression
+
+    TypedAttributeArray<Quat<float>, SmallestThreeAttributeCodec>::registerType();
+
+    // integer compression
+
+    TypedAttributeArray<int32_t, DeltaAttributeCodec<int32_t> >::registerType();
+    TypedAttributeArray<int64_t, DeltaAttributeCodec<int64_t> >::registerType();
+    TypedAttributeArray<int32_t, FrameOfReferenceAttributeCodec<int32_t> >::registerType();
+    TypedAttributeArray<int64_t, FrameOfReferenceAttributeCodec<int64_t> >::registerType();
 
     // Register types associated with point data grids.
     Metadata::registerType(typeNameAsString<PointDataIndex32>(), Int32Metadata::createMetadata);
     Metadata::registerType(typeNameAsString<PointDataIndex64>(), Int64Metadata::createMetadata);
     tools::PointDataGrid::registerGrid();
 
+    // optionally enable instrumentation from the environment
+
+    if (std::getenv("OPENVDB_POINTS_INSTRUMENTATION")) {
+        tools::instrumentation::setEnabled(true);
+    }
+
 #ifdef __ICC
 // Disable ICC "assignment to statically allocated variable" warning.<
 // This assignment is mutex-protected and therefore thread-safe.
@@ -32,9 +32,15 @@
 ///
 /// @authors Dan Bailey, Mihai Alden, Peter Cucka
 
+#include <algorithm>
 #include <map>
 
 #include <openvdb_points/tools/AttributeArray.h>
+#include <openvdb_points/tools/Instrumentation.h>
+
+#include <tbb/enumerable_thread_specific.h>
+
+#include <boost/shared_array.hpp>
 
 #ifdef OPENVDB_USE_BLOSC
 #include <blosc.h>
@@ -100,6 +106,8 @@ size_t compressedSize( const char* buffer, const size_t typeSize, const size_t u
 char* compress( char* buffer, const size_t typeSize,
                 const size_t uncompressedBytes, size_t& compressedBytes, const bool cleanup)
 {
+    instrumentation::ScopedTimer timer(instrumentation::COMPRESS_TIMER);
+
     size_t tempBytes = uncompressedBytes + BLOSC_MAX_OVERHEAD;
     const bool outOfRange = tempBytes > BLOSC_MAX_BUFFERSIZE;
     boost::scoped_array<char> outBuf(outOfRange ? new char[1] : new char[tempBytes]);
@@ -130,6 +138,8 @@ char* compress( char* buffer, const size_t typeSize,
 
     compressedBytes = size_t(_compressedBytes);
 
+    instrumentation::increment(instrumentation::BYTES_COMPRESSED, uncompressedBytes);
+
     char* outData = new char[compressedBytes];
     std::memcpy(outData, outBuf.get(), compressedBytes);
     return outData;
@@ -138,6 +148,8 @@ char* compress( char* buffer, const size_t typeSize,
 
 char* decompress(char* buffer, const size_t expectedBytes, const bool cleanup)
 {
+    instrumentation::ScopedTimer timer(instrumentation::DECOMPRESS_TIMER);
+
     size_t tempBytes = expectedBytes + BLOSC_MAX_OVERHEAD;
     const bool outOfRange = tempBytes > BLOSC_MAX_BUFFERSIZE;
     if (outOfRange)     tempBytes = 1;
@@ -161,6 +173,8 @@ char* decompress(char* buffer, const size_t expectedBytes, const bool cleanup)
             << uncompressedBytes << " byte" << (uncompressedBytes == 1 ? "" : "s"));
     }
 
+    instrumentation::increment(instrumentation::BYTES_DECOMPRESSED, uncompressedBytes);
+
     // optionally cleanup compressed buffer if requested (prior to allocating new uncompressed buffer)
 
     if (cleanup)    delete[] buffer;
@@ -172,6 +186,30 @@ char* decompress(char* buffer, const size_t expectedBytes, const bool cleanup)
 }
 
 
+namespace {
+
+/// Decompress a buffer directly into @a outBuffer which must hold @a expectedBytes
+void decompressInto(const char* buffer, char* outBuffer, const size_t expectedBytes)
+{
+    instrumentation::ScopedTimer timer(instrumentation::DECOMPRESS_TIMER);
+
+    const int uncompressedBytes = blosc_decompress_ctx( /*src=*/buffer,
+                                                        /*dest=*/outBuffer,
+                                                        expectedBytes,
+                                                        /*numthreads=*/1);
+
+    if (uncompressedBytes < 1 || size_t(uncompressedBytes) != expectedBytes) {
+        OPENVDB_THROW(RuntimeError, "Expected to decompress " << expectedBytes
+            << " byte" << (expectedBytes == 1 ? "" : "s") << ", blosc returned "
+            << uncompressedBytes);
+    }
+
+    instrumentation::increment(instrumentation::BYTES_DECOMPRESSED, expectedBytes);
+}
+
+} // unnamed namespace
+
+
 #else
 
 
@@ -208,6 +246,16 @@ char* decompress(char*, const size_t, const bool)
 }
 
 
+namespace {
+
+void decompressInto(const char*, char*, const size_t)
+{
+    OPENVDB_THROW(RuntimeError, "Can't extract compressed data without the blosc library.");
+}
+
+} // unnamed namespace
+
+
 #endif // OPENVDB_USE_BLOSC
 
 
@@ -224,12 +272,194 @@ char* decompress(const char* buffer, const size_t expectedBytes)
 }
 
 
+////////////////////////////////////////
+
+// PagedBuffer implementation
+
+
+namespace {
+
+/// Small cache of recently decompressed pages owned by each thread
+struct PageCache
+{
+    enum { SIZE = 4 };
+
+    struct Entry
+    {
+        Entry(): id(0), page(0) { }
+        Index64 id;
+        size_t page;
+        std::vector<char> data;
+    };
+
+    PageCache(): next(0) { }
+
+    Entry entries[SIZE];
+    int next;
+};
+
+// Declare these at file scope to ensure thread-safe initialization.
+tbb::enumerable_thread_specific<PageCache> sPageCaches;
+tbb::atomic<Index64> sPagedBufferId;
+
+} // unnamed namespace
+
+
+PagedBuffer::PagedBuffer(const size_t pageBytes, const size_t uncompressedBytes)
+    : mData()
+    , mOffsets(1, size_t(0))
+    , mPageBytes(pageBytes)
+    , mUncompressedBytes(uncompressedBytes)
+    , mId(++sPagedBufferId)
+{
+}
+
+
+PagedBuffer::Ptr
+PagedBuffer::create(const char* buffer, const size_t typeSize,
+                    const size_t uncompressedBytes, const size_t pageBytes,
+                    TransformPtr encode)
+{
+    if (!canCompress() || pageBytes == 0)   return Ptr();
+
+    Ptr paged(new PagedBuffer(pageBytes, uncompressedBytes));
+
+    const size_t pages = (uncompressedBytes + pageBytes - 1) / pageBytes;
+
+    std::vector<boost::shared_array<char> > compressedPages(pages);
+    boost::scoped_array<char> transformed(encode ? new char[pageBytes] : 0);
+
+    // compress each page, applying the transform to a copy of the page if requested
+
+    for (size_t n = 0; n < pages; n++) {
+        const size_t inBytes = std::min(pageBytes, uncompressedBytes - n * pageBytes);
+        const char* page = buffer + n * pageBytes;
+
+        if (encode) {
+            std::memcpy(transformed.get(), page, inBytes);
+            encode(transformed.get(), inBytes);
+            page = transformed.get();
+        }
+
+        size_t outBytes = 0;
+        compressedPages[n].reset(compress(page, typeSize, inBytes, outBytes));
+        if (!compressedPages[n])    return Ptr();
+
+        paged->mOffsets.push_back(paged->mOffsets.back() + outBytes);
+    }
+
+    // concatenate the compressed pages into a single buffer
+
+    paged->mData.reset(new char[paged->mOffsets.back()]);
+
+    for (size_t n = 0; n < pages; n++) {
+        std::memcpy(paged->mData.get() + paged->mOffsets[n], compressedPages[n].get(),
+            paged->mOffsets[n + 1] - paged->mOffsets[n]);
+    }
+
+    return paged;
+}
+
+
+size_t
+PagedBuffer::memUsage() const
+{
+    return mOffsets.back() + mOffsets.size() * sizeof(size_t);
+}
+
+
+size_t
+PagedBuffer::uncompressedPageBytes(const size_t n) const
+{
+    return std::min(mPageBytes, mUncompressedBytes - n * mPageBytes);
+}
+
+
+void
+PagedBuffer::decompress(char* buffer, TransformPtr decode) const
+{
+    for (size_t n = 0; n < this->pages(); n++) {
+        char* page = buffer + n * mPageBytes;
+        const size_t bytes = this->uncompressedPageBytes(n);
+        decompressInto(mData.get() + mOffsets[n], page, bytes);
+        if (decode)     decode(page, bytes);
+    }
+}
+
+
+const char*
+PagedBuffer::page(const size_t n, TransformPtr decode) const
+{
+    assert(n < this->pages());
+
+    PageCache& cache = sPageCaches.local();
+
+    for (int i = 0; i < PageCache::SIZE; i++) {
+        const PageCache::Entry& entry = cache.entries[i];
+        if (entry.id == mId && entry.page == n) {
+            instrumentation::increment(instrumentation::PAGE_CACHE_HITS);
+            return &entry.data[0];
+        }
+    }
+
+    // replace the least recently decompressed page
+
+    PageCache::Entry& entry = cache.entries[cache.next];
+    cache.next = (cache.next + 1) % PageCache::SIZE;
+
+    const size_t bytes = this->uncompressedPageBytes(n);
+
+    // invalidate the entry first in case decompression fails
+
+    entry.id = 0;
+    entry.data.resize(bytes);
+
+    decompressInto(mData.get() + mOffsets[n], &entry.data[0], bytes);
+    if (decode)     decode(&entry.data[0], bytes);
+
+    entry.id = mId;
+    entry.page = n;
+
+    instrumentation::increment(instrumentation::PAGES_DECOMPRESSED);
+
+    return &entry.data[0];
+}
+
+
 } // namespace attribute_compression
 
 
 ////////////////////////////////////////
 
 
+namespace {
+
+// the version is stored offset by one, so that an unset stream (zero) reads as the
+// current version rather than OPENVDB_POINTS_FILE_VERSION_INITIAL
+
+const int sPointsFormatVersionIndex = std::ios_base::xalloc();
+
+} // unnamed namespace
+
+
+uint32_t
+getPointsFormatVersion(std::ios_base& ios)
+{
+    const long version = ios.iword(sPointsFormatVersionIndex);
+    return version == 0 ? uint32_t(OPENVDB_POINTS_FILE_VERSION) : uint32_t(version - 1);
+}
+
+
+void
+setPointsFormatVersion(std::ios_base& ios, const uint32_t version)
+{
+    ios.iword(sPointsFormatVersionIndex) = long(version) + 1;
+}
+
+
+////////////////////////////////////////
+
+
 namespace {
 
 typedef std::map<NamePair, AttributeArray::FactoryMethod> AttributeFactoryMap;
@@ -280,9 +510,14 @@ __pragma(warning(default:1711))
 // AttributeArray implementation
 
 
+const Index AttributeArray::DEFAULT_PAGE_SIZE;
+
+
 AttributeArray::Ptr
 AttributeArray::create(const NamePair& type, size_t length)
 {
+    instrumentation::increment(instrumentation::REGISTRY_LOOKUPS);
+
     LockedAttributeRegistry* registry = getAttributeRegistry();
     tbb::spin_mutex::scoped_lock lock(registry->mMutex);
 
@@ -299,6 +534,8 @@ AttributeArray::create(const NamePair& type, size_t length)
 bool
 AttributeArray::isRegistered(const NamePair& type)
 {
+    instrumentation::increment(instrumentation::REGISTRY_LOOKUPS);
+
     LockedAttributeRegistry* registry = getAttributeRegistry();
     tbb::spin_mutex::scoped_lock lock(registry->mMutex);
     return (registry->mMap.find(type) != registry->mMap.end());
@@ -358,6 +595,25 @@ AttributeArray::setHidden(bool state)
 }
 
 
+void
+AttributeArray::copyValuesUnsafe(const Index n, const AttributeArray& sourceArray,
+                                 const Index sourceIndex, const Index count)
+{
+    const bool uniform = sourceArray.isUniform();
+
+    for (Index i = 0; i < count; i++) {
+        this->set(n + i, sourceArray, uniform ? sourceIndex : sourceIndex + i);
+    }
+}
+
+
+bool
+AttributeArray::compressPaged(const Index)
+{
+    return this->compress();
+}
+
+
 IndexIter
 AttributeArray::beginIndex() const
 {
@@ -47,13 +47,17 @@
 #include <openvdb/io/Compression.h> // COMPRESS_BLOSC
 
 #include <openvdb_points/tools/IndexIterator.h>
+#include <openvdb_points/tools/Instrumentation.h>
 
 #include <tbb/spin_mutex.h>
 #include <tbb/atomic.h>
 
 #include <boost/scoped_array.hpp>
+#include <boost/type_traits/make_unsigned.hpp>
 
+#include <algorithm>
 #include <string>
+#include <vector>
 
 
 class TestAttributeArray;
@@ -128,9 +132,85 @@ char* decompress(char* buffer, const size_t expectedBytes, const bool cleanup =
 /// @note Unlike the non-const buffer version, the buffer will never be deleted.
 char* decompress(const char* buffer, const size_t expectedBytes);
 
+
+/// @brief A buffer split into fixed-size pages that are compressed independently, so that
+/// a single page can be decompressed without decompressing the entire buffer. Recently
+/// accessed pages are held uncompressed in a small cache owned by each thread.
+///
+/// @note Paged buffers are immutable once created and so may be shared between threads.
+class PagedBuffer
+{
+public:
+    typedef boost::shared_ptr<PagedBuffer>          Ptr;
+    typedef boost::shared_ptr<const PagedBuffer>    ConstPtr;
+
+    /// In-place transform of an uncompressed page of the given number of bytes
+    typedef void (*TransformPtr)(char* buffer, const size_t bytes);
+
+    /// @brief Compress a buffer page by page and return the paged buffer
+    /// (or an empty pointer if compression is unavailable or fails).
+    ///
+    /// @param buffer the buffer to compress
+    /// @param typeSize the size of the data type
+    /// @param uncompressedBytes number of uncompressed bytes
+    /// @param pageBytes number of uncompressed bytes in each page (the last page may be shorter)
+    /// @param encode optional transform applied to a copy of each page prior to compression
+    static Ptr create(  const char* buffer, const size_t typeSize,
+                        const size_t uncompressedBytes, const size_t pageBytes,
+                        TransformPtr encode = NULL);
+
+    /// Return the number of pages.
+    size_t pages() const { return mOffsets.size() - 1; }
+    /// Return the number of uncompressed bytes in each page.
+    size_t pageBytes() const { return mPageBytes; }
+    /// Return the total number of uncompressed bytes.
+    size_t uncompressedBytes() const { return mUncompressedBytes; }
+    /// Return the number of bytes of memory used by the compressed pages and page table.
+    size_t memUsage() const;
+
+    /// @brief Decompress every page into @a buffer, which must hold uncompressedBytes().
+    /// @param buffer the destination buffer
+    /// @param decode optional transform applied to each page after decompression
+    void decompress(char* buffer, TransformPtr decode = NULL) const;
+
+    /// @brief Return the uncompressed data of page @a n, decompressing it into
+    /// the cache of the calling thread unless it is already resident.
+    /// @param n the index of the page
+    /// @param decode optional transform applied to the page after decompression
+    /// @note The data is only guaranteed to be valid until the next call to page()
+    /// from the same thread.
+    const char* page(const size_t n, TransformPtr decode = NULL) const;
+
+private:
+    PagedBuffer(const size_t pageBytes, const size_t uncompressedBytes);
+
+    /// Return the number of uncompressed bytes in page @a n.
+    size_t uncompressedPageBytes(const size_t n) const;
+
+    boost::scoped_array<char>   mData;
+    std::vector<size_t>         mOffsets;
+    const size_t                mPageBytes;
+    const size_t                mUncompressedBytes;
+    const Index64               mId;
+}; // class PagedBuffer
+
 } // namespace attribute_compression
 
 
+////////////////////////////////////////
+
+// File format version
+
+
+/// @brief Return the file format version of the point attribute data being read from
+/// the given stream, or OPENVDB_POINTS_FILE_VERSION if none has been set.
+uint32_t getPointsFormatVersion(std::ios_base& ios);
+
+/// @brief Associate a file format version of point attribute data with the given stream.
+/// @note  AttributeSet::Descriptor::read() sets the version from the descriptor metadata.
+void setPointsFormatVersion(std::ios_base& ios, const uint32_t version);
+
+
 ////////////////////////////////////////
 
 // Utility methods
@@ -176,6 +256,82 @@ fixedPointToFloatingPoint(const math::Vec3<IntegerT>& v)
 }
 
 
+/// @brief Quantize a value in the range [-1, 1] to an unsigned integer of the given
+/// number of @a Bits where -1, 0 and 1 are exactly representable.
+template <typename UIntegerT, int Bits>
+inline UIntegerT
+floatToSnorm(const float s)
+{
+    const float scale = float((1 << (Bits - 1)) - 1);
+    const float clamped = s < -1.0f ? -1.0f : (s > 1.0f ? 1.0f : s);
+    return UIntegerT(std::floor(clamped * scale + 0.5f) + scale);
+}
+
+
+template <typename UIntegerT, int Bits>
+inline float
+snormToFloat(const UIntegerT s)
+{
+    const float scale = float((1 << (Bits - 1)) - 1);
+    const float value = (float(s) - scale) / scale;
+    return value > 1.0f ? 1.0f : value;
+}
+
+
+/// @brief Map a unit vector onto the [-1, 1] square by projection onto an octahedron
+/// and unfolding of the lower hemisphere.
+/// @note A zero-length vector maps to the origin which decodes as (0, 0, 1).
+template <typename T>
+inline math::Vec2<T>
+unitVecToOctahedral(const math::Vec3<T>& v)
+{
+    const T l1 = std::abs(v.x()) + std::abs(v.y()) + std::abs(v.z());
+    if (l1 == T(0))     return math::Vec2<T>(T(0), T(0));
+
+    const T x = v.x() / l1, y = v.y() / l1;
+    if (v.z() >= T(0))  return math::Vec2<T>(x, y);
+
+    return math::Vec2<T>(
+        (T(1) - std::abs(y)) * (x >= T(0) ? T(1) : T(-1)),
+        (T(1) - std::abs(x)) * (y >= T(0) ? T(1) : T(-1)));
+}
+
+
+template <typename T>
+inline math::Vec3<T>
+octahedralToUnitVec(const math::Vec2<T>& e)
+{
+    math::Vec3<T> v(e.x(), e.y(), T(1) - std::abs(e.x()) - std::abs(e.y()));
+    if (v.z() < T(0)) {
+        v.x() = (T(1) - std::abs(e.y())) * (e.x() >= T(0) ? T(1) : T(-1));
+        v.y() = (T(1) - std::abs(e.x())) * (e.y() >= T(0) ? T(1) : T(-1));
+    }
+    v.normalize();
+    return v;
+}
+
+
+/// @brief Map a signed difference (stored as unsigned) to an unsigned integer so that
+/// values of small magnitude have small encodings (0, -1, 1, -2, 2 => 0, 1, 2, 3, 4).
+template <typename UIntegerT>
+inline UIntegerT
+zigZagEncode(const UIntegerT s)
+{
+    BOOST_STATIC_ASSERT(boost::is_unsigned<UIntegerT>::value);
+    const int bits = int(sizeof(UIntegerT) * 8);
+    return UIntegerT(UIntegerT(s << 1) ^ UIntegerT(UIntegerT(0) - UIntegerT(s >> (bits - 1))));
+}
+
+
+template <typename UIntegerT>
+inline UIntegerT
+zigZagDecode(const UIntegerT s)
+{
+    BOOST_STATIC_ASSERT(boost::is_unsigned<UIntegerT>::value);
+    return UIntegerT(UIntegerT(s >> 1) ^ UIntegerT(UIntegerT(0) - UIntegerT(s & 1)));
+}
+
+
 ////////////////////////////////////////
 
 // Attribute codec schemes
@@ -209,6 +365,103 @@ struct UnitVecAttributeCodec
 };
 
 
+/// @brief Unit vector codec using an octahedral mapping, which distributes precision
+/// evenly over the sphere and represents the axis directions exactly.
+/// @note Supported storage types are uint16_t (8 bits per coordinate), uint32_t
+/// (16 bits per coordinate) and math::Vec2<half>.
+template<typename StorageType_>
+struct OctahedralAttributeCodec
+{
+    typedef StorageType_ StorageType;
+    template<typename T> static void decode(const StorageType&, math::Vec3<T>&);
+    template<typename T> static void encode(const math::Vec3<T>&, StorageType&);
+    static const char* name() { return "oct"; }
+
+private:
+    static void pack(const math::Vec2<float>&, uint16_t&);
+    static void pack(const math::Vec2<float>&, uint32_t&);
+    static void pack(const math::Vec2<float>&, math::Vec2<half>&);
+    static math::Vec2<float> unpack(const uint16_t&);
+    static math::Vec2<float> unpack(const uint32_t&);
+    static math::Vec2<float> unpack(const math::Vec2<half>&);
+};
+
+
+/// @brief Unit quaternion codec using the "smallest three" scheme, which drops the
+/// largest component (recovered from the unit length constraint) and stores its index
+/// in 2 bits alongside the three remaining components quantized to 10 bits each.
+/// @note As q and -q represent the same rotation, the decoded quaternion is the one
+/// with a non-negative largest component. Quaternions are normalized on encode.
+struct SmallestThreeAttributeCodec
+{
+    typedef uint32_t StorageType;
+    template<typename T> static void decode(const StorageType&, math::Quat<T>&);
+    template<typename T> static void encode(const math::Quat<T>&, StorageType&);
+    static const char* name() { return "sm3"; }
+};
+
+
+/// @brief Integer codec that stores the difference between consecutive values
+/// (zig-zag encoded) when the array is compressed, suited to near-sequential ids.
+/// @note Values are stored unmodified in an uncompressed array, see CodecBufferTransform.
+template<typename IntType>
+struct DeltaAttributeCodec
+{
+    typedef IntType StorageType;
+    template<typename ValueType> static void decode(const StorageType&, ValueType&);
+    template<typename ValueType> static void encode(const ValueType&, StorageType&);
+    static const char* name() { return "dlta"; }
+};
+
+
+/// @brief Integer codec that stores the offset (zig-zag encoded) of each value from
+/// the first value in the array when the array is compressed, suited to clustered values.
+/// @note Values are stored unmodified in an uncompressed array, see CodecBufferTransform.
+template<typename IntType>
+struct FrameOfReferenceAttributeCodec
+{
+    typedef IntType StorageType;
+    template<typename ValueType> static void decode(const StorageType&, ValueType&);
+    template<typename ValueType> static void encode(const ValueType&, StorageType&);
+    static const char* name() { return "for"; }
+};
+
+
+////////////////////////////////////////
+
+// Attribute codec buffer transforms
+
+
+/// @brief Reversible transform applied to the storage of a non-uniform array prior to
+/// Blosc compression (both in-memory and on-disk) and inverted after decompression.
+/// Codecs may specialize this to improve the compression ratio of their storage.
+template<typename Codec>
+struct CodecBufferTransform
+{
+    static const bool Enabled = false;
+    static void encode(typename Codec::StorageType*, const size_t) { }
+    static void decode(typename Codec::StorageType*, const size_t) { }
+};
+
+
+template<typename IntType>
+struct CodecBufferTransform<DeltaAttributeCodec<IntType> >
+{
+    static const bool Enabled = true;
+    static void encode(IntType* data, const size_t size);
+    static void decode(IntType* data, const size_t size);
+};
+
+
+template<typename IntType>
+struct CodecBufferTransform<FrameOfReferenceAttributeCodec<IntType> >
+{
+    static const bool Enabled = true;
+    static void encode(IntType* data, const size_t size);
+    static void decode(IntType* data, const size_t size);
+};
+
+
 ////////////////////////////////////////
 
 
@@ -223,7 +476,8 @@ protected:
 
 public:
     enum Flag { TRANSIENT = 0x1, HIDDEN = 0x2, GROUP=0x4, WRITEUNIFORM=0x8,
-                WRITEMEMCOMPRESS=0x10, WRITEDISKCOMPRESS=0x20, OUTOFCORE=0x40 };
+                WRITEMEMCOMPRESS=0x10, WRITEDISKCOMPRESS=0x20, OUTOFCORE=0x40,
+                WRITESPARSE=0x80, PAGED=0x100 };
 
 #ifndef OPENVDB_2_ABI_COMPATIBLE
     struct FileInfo
@@ -243,6 +497,9 @@ public:
 
     typedef Ptr (*FactoryMethod)(size_t);
 
+    /// Default number of elements in each page of a paged compressed array
+    static const Index DEFAULT_PAGE_SIZE = 1024;
+
     AttributeArray() : mCompressedBytes(0), mFlags(0) {}
     virtual ~AttributeArray() {}
 
@@ -258,6 +515,9 @@ public:
     /// Return the number of bytes of memory used by this attribute.
     virtual size_t memUsage() const = 0;
 
+    /// Return the number of bytes used to store a single value in this array.
+    virtual Index storageTypeSize() const = 0;
+
     /// Create a new attribute array of the given (registered) type and length.
     static Ptr create(const NamePair& type, size_t length);
     /// Return @c true if the given attribute type name is registered.
@@ -278,6 +538,13 @@ public:
     /// Set value at given index @a n from @a sourceIndex of another @a sourceArray
     virtual void set(const Index n, const AttributeArray& sourceArray, const Index sourceIndex) = 0;
 
+    /// @brief Copy @a count values from @a sourceIndex of another @a sourceArray of the same
+    /// type into this array starting at index @a n (assumes uncompressed and in-core).
+    /// @note A uniform @a sourceArray provides its value for all @a count elements.
+    /// @note The default implementation copies the values one at a time.
+    virtual void copyValuesUnsafe(const Index n, const AttributeArray& sourceArray,
+                                  const Index sourceIndex, const Index count);
+
     /// Return @c true if this array is stored as a single uniform value.
     virtual bool isUniform() const = 0;
     /// @brief  If this array is uniform, replace it with an array of length size().
@@ -295,6 +562,14 @@ public:
     /// Uncompress the attribute array.
     virtual bool decompress() = 0;
 
+    /// Return @c true if this array is compressed in independently accessible pages.
+    bool isPaged() const { return bool(mFlags & PAGED); }
+    /// @brief   Compress the attribute array in pages of @a pageSize elements.
+    /// @details Reading values from a paged array decompresses only the pages that
+    ///          are accessed and leaves the array compressed in memory.
+    /// @note    Arrays that do not support paging are compressed as a whole.
+    virtual bool compressPaged(const Index pageSize = DEFAULT_PAGE_SIZE);
+
     /// @brief   Specify whether this attribute should be hidden (e.g., from UI or iterators).
     /// @details This is useful if the attribute is used for blind data or as scratch space
     ///          for a calculation.
@@ -383,6 +658,9 @@ struct AttributeArray::Accessor : public AttributeArray::AccessorBase
 ////////////////////////////////////////
 
 
+template<typename ValueType_, typename Codec_> class VariableAttributeArray;
+
+
 /// Typed class for storing attribute data
 template<typename ValueType_, typename Codec_ = NullAttributeCodec<ValueType_> >
 class TypedAttributeArray: public AttributeArray
@@ -440,6 +718,9 @@ public:
     /// Return the number of bytes of memory used by this attribute.
     virtual size_t memUsage() const;
 
+    /// Return the number of bytes used to store a single value in this array.
+    virtual Index storageTypeSize() const { return Index(sizeof(StorageType)); }
+
     /// Return the value at index @a n (assumes uncompressed and in-core)
     ValueType getUnsafe(Index n) const;
     /// Return the value at index @a n
@@ -452,6 +733,8 @@ public:
     /// Non-member equivalent to getUnsafe() that static_casts array to this TypedAttributeArray
     /// (assumes uncompressed and in-core)
     static ValueType getUnsafe(const AttributeArray* array, const Index n);
+    /// Non-member equivalent to get() that static_casts array to this TypedAttributeArray
+    static ValueType get(const AttributeArray* array, const Index n);
 
     /// Set @a value at the given index @a n (assumes uncompressed and in-core)
     void setUnsafe(Index n, const ValueType& value);
@@ -469,6 +752,13 @@ public:
     /// Set value at given index @a n from @a sourceIndex of another @a sourceArray
     virtual void set(const Index n, const AttributeArray& sourceArray, const Index sourceIndex);
 
+    /// @brief Copy @a count values from @a sourceIndex of another @a sourceArray of the same
+    /// type into this array starting at index @a n (assumes uncompressed and in-core).
+    /// @details The encoded values are copied directly, a uniform array remains uniform if
+    /// the values copied from a uniform source match or overwrite the entire array.
+    virtual void copyValuesUnsafe(const Index n, const AttributeArray& sourceArray,
+                                  const Index sourceIndex, const Index count);
+
     /// Return @c true if this array is stored as a single uniform value.
     virtual bool isUniform() const { return mIsUniform; }
     /// @brief  Replace the single value storage with an array of length size().
@@ -495,6 +785,11 @@ public:
     virtual bool compress();
     /// Uncompress the attribute array.
     virtual bool decompress();
+    /// @brief   Compress the attribute array in pages of @a pageSize elements.
+    /// @details Reading values with get() decompresses only the accessed pages into a small
+    ///          thread-local cache and the array remains compressed until it is modified.
+    /// @note    Paging is not serialized, a paged array is written as an uncompressed array.
+    virtual bool compressPaged(const Index pageSize = DEFAULT_PAGE_SIZE);
 
     /// Read attribute data from a stream.
     virtual void read(std::istream& is);
@@ -510,7 +805,20 @@ public:
 protected:
     virtual AccessorBasePtr getAccessor() const;
 
+    /// @brief Read the attribute data that follows the header.
+    /// @param is     the input stream.
+    /// @param bytes  the number of bytes of data (excluding the header).
+    /// @param flags  the flags read from the header.
+    /// @param size   the length of the array read from the header.
+    void readBuffer(std::istream& is, const Index64 bytes, const Int16 flags, const Index64 size);
+
+    /// Compare the this data to another attribute array. Used by the base class comparison operator
+    virtual bool isEqual(const AttributeArray& other) const;
+
 private:
+    template <typename, typename> friend class VariableAttributeArray;
+    friend class GroupAttributeArray;
+
     /// Load data from memory-mapped file.
     inline void doLoad() const;
     /// Load data from memory-mapped file (unsafe as this function is not protected by a mutex).
@@ -519,8 +827,12 @@ private:
     /// Toggle out-of-core state
     inline void setOutOfCore(const bool);
 
-    /// Compare the this data to another attribute array. Used by the base class comparison operator
-    virtual bool isEqual(const AttributeArray& other) const;
+    /// Return the value at index @a n of a paged array, decompressing only its page.
+    ValueType getPaged(Index n) const;
+
+    /// Buffer transforms applied to each page of a paged array
+    static void encodePage(char* buffer, const size_t bytes);
+    static void decodePage(char* buffer, const size_t bytes);
 
     size_t arrayMemUsage() const;
     void allocate(const size_t size);
@@ -534,6 +846,9 @@ private:
     size_t          mSize;
     bool            mIsUniform;
     tbb::spin_mutex mMutex;
+
+    /// Compressed pages (replaces mData when paged)
+    attribute_compression::PagedBuffer::Ptr mPages;
 }; // class TypedAttributeArray
 
 
@@ -685,6 +1000,252 @@ UnitVecAttributeCodec::encode(const math::Vec3<T>& val, StorageType& data)
 }
 
 
+template<typename StorageType_>
+template<typename T>
+inline void
+OctahedralAttributeCodec<StorageType_>::decode(const StorageType& data, math::Vec3<T>& val)
+{
+    const math::Vec3<float> v = octahedralToUnitVec(unpack(data));
+    val = math::Vec3<T>(T(v.x()), T(v.y()), T(v.z()));
+}
+
+
+template<typename StorageType_>
+template<typename T>
+inline void
+OctahedralAttributeCodec<StorageType_>::encode(const math::Vec3<T>& val, StorageType& data)
+{
+    const math::Vec3<float> v(float(val.x()), float(val.y()), float(val.z()));
+    pack(unitVecToOctahedral(v), data);
+}
+
+
+template<typename StorageType_>
+inline void
+OctahedralAttributeCodec<StorageType_>::pack(const math::Vec2<float>& e, uint16_t& data)
+{
+    data = uint16_t((floatToSnorm<uint16_t, 8>(e.x()) << 8) | floatToSnorm<uint16_t, 8>(e.y()));
+}
+
+
+template<typename StorageType_>
+inline void
+OctahedralAttributeCodec<StorageType_>::pack(const math::Vec2<float>& e, uint32_t& data)
+{
+    data = (uint32_t(floatToSnorm<uint16_t, 16>(e.x())) << 16) | uint32_t(floatToSnorm<uint16_t, 16>(e.y()));
+}
+
+
+template<typename StorageType_>
+inline void
+OctahedralAttributeCodec<StorageType_>::pack(const math::Vec2<float>& e, math::Vec2<half>& data)
+{
+    data = math::Vec2<half>(half(e.x()), half(e.y()));
+}
+
+
+template<typename StorageType_>
+inline math::Vec2<float>
+OctahedralAttributeCodec<StorageType_>::unpack(const uint16_t& data)
+{
+    return math::Vec2<float>(snormToFloat<uint16_t, 8>(uint16_t(data >> 8)),
+                             snormToFloat<uint16_t, 8>(uint16_t(data & 0xFF)));
+}
+
+
+template<typename StorageType_>
+inline math::Vec2<float>
+OctahedralAttributeCodec<StorageType_>::unpack(const uint32_t& data)
+{
+    return math::Vec2<float>(snormToFloat<uint16_t, 16>(uint16_t(data >> 16)),
+                             snormToFloat<uint16_t, 16>(uint16_t(data & 0xFFFF)));
+}
+
+
+template<typename StorageType_>
+inline math::Vec2<float>
+OctahedralAttributeCodec<StorageType_>::unpack(const math::Vec2<half>& data)
+{
+    return math::Vec2<float>(float(data.x()), float(data.y()));
+}
+
+
+template<typename T>
+inline void
+SmallestThreeAttributeCodec::decode(const StorageType& data, math::Quat<T>& val)
+{
+    // the three smallest components of a unit quaternion lie in [-1/sqrt(2), 1/sqrt(2)]
+
+    const float invScale = 0.70710678f;
+
+    const int largest = int(data >> 30);
+
+    float q[4];
+    float lengthSqr = 0.0f;
+    int shift = 20;
+
+    for (int i = 0; i < 4; i++) {
+        if (i == largest)   continue;
+        q[i] = snormToFloat<uint32_t, 10>((data >> shift) & 0x3FF) * invScale;
+        lengthSqr += q[i] * q[i];
+        shift -= 10;
+    }
+
+    q[largest] = std::sqrt(std::max(0.0f, 1.0f - lengthSqr));
+
+    val = math::Quat<T>(T(q[0]), T(q[1]), T(q[2]), T(q[3]));
+}
+
+
+template<typename T>
+inline void
+SmallestThreeAttributeCodec::encode(const math::Quat<T>& val, StorageType& data)
+{
+    const float scale = 1.41421356f;
+
+    float q[4] = { float(val.x()), float(val.y()), float(val.z()), float(val.w()) };
+
+    const float length = std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+
+    // encode a zero-length quaternion as the identity rotation
+
+    if (length == 0.0f) {
+        q[0] = q[1] = q[2] = 0.0f;
+        q[3] = 1.0f;
+    }
+    else {
+        for (int i = 0; i < 4; i++)     q[i] /= length;
+    }
+
+    int largest = 0;
+    for (int i = 1; i < 4; i++) {
+        if (std::abs(q[i]) > std::abs(q[largest]))  largest = i;
+    }
+
+    // negate the quaternion if required so that the dropped component is positive
+
+    const float sign = q[largest] < 0.0f ? -1.0f : 1.0f;
+
+    data = uint32_t(largest) << 30;
+    int shift = 20;
+
+    for (int i = 0; i < 4; i++) {
+        if (i == largest)   continue;
+        data |= floatToSnorm<uint32_t, 10>(sign * q[i] * scale) << shift;
+        shift -= 10;
+    }
+}
+
+
+template<typename IntType>
+template<typename ValueType>
+inline void
+DeltaAttributeCodec<IntType>::decode(const StorageType& data, ValueType& val)
+{
+    val = static_cast<ValueType>(data);
+}
+
+
+template<typename IntType>
+template<typename ValueType>
+inline void
+DeltaAttributeCodec<IntType>::encode(const ValueType& val, StorageType& data)
+{
+    data = static_cast<StorageType>(val);
+}
+
+
+template<typename IntType>
+template<typename ValueType>
+inline void
+FrameOfReferenceAttributeCodec<IntType>::decode(const StorageType& data, ValueType& val)
+{
+    val = static_cast<ValueType>(data);
+}
+
+
+template<typename IntType>
+template<typename ValueType>
+inline void
+FrameOfReferenceAttributeCodec<IntType>::encode(const ValueType& val, StorageType& data)
+{
+    data = static_cast<StorageType>(val);
+}
+
+
+////////////////////////////////////////
+
+// Attribute codec buffer transform implementation
+
+// integer arithmetic is performed on the unsigned type so that differences wrap
+
+
+template<typename IntType>
+inline void
+CodecBufferTransform<DeltaAttributeCodec<IntType> >::encode(IntType* data, const size_t size)
+{
+    typedef typename boost::make_unsigned<IntType>::type UIntType;
+
+    UIntType* udata = reinterpret_cast<UIntType*>(data);
+
+    // iterate backwards so that each difference uses the original preceding value
+
+    for (size_t i = size; i > 1; i--) {
+        udata[i-1] = zigZagEncode(UIntType(udata[i-1] - udata[i-2]));
+    }
+}
+
+
+template<typename IntType>
+inline void
+CodecBufferTransform<DeltaAttributeCodec<IntType> >::decode(IntType* data, const size_t size)
+{
+    typedef typename boost::make_unsigned<IntType>::type UIntType;
+
+    UIntType* udata = reinterpret_cast<UIntType*>(data);
+
+    for (size_t i = 1; i < size; i++) {
+        udata[i] = UIntType(udata[i-1] + zigZagDecode(udata[i]));
+    }
+}
+
+
+template<typename IntType>
+inline void
+CodecBufferTransform<FrameOfReferenceAttributeCodec<IntType> >::encode(IntType* data, const size_t size)
+{
+    typedef typename boost::make_unsigned<IntType>::type UIntType;
+
+    if (size == 0)  return;
+
+    UIntType* udata = reinterpret_cast<UIntType*>(data);
+    const UIntType base = udata[0];
+
+    for (size_t i = 1; i < size; i++) {
+        udata[i] = zigZagEncode(UIntType(udata[i] - base));
+    }
+}
+
+
+template<typename IntType>
+inline void
+CodecBufferTransform<FrameOfReferenceAttributeCodec<IntType> >::decode(IntType* data, const size_t size)
+{
+    typedef typename boost::make_unsigned<IntType>::type UIntType;
+
+    if (size == 0)  return;
+
+    UIntType* udata = reinterpret_cast<UIntType*>(data);
+    const UIntType base = udata[0];
+
+    // each value is independent of the others so this loop is vectorized by the compiler
+
+    for (size_t i = 1; i < size; i++) {
+        udata[i] = UIntType(base + zigZagDecode(udata[i]));
+    }
+}
+
+
 ////////////////////////////////////////
 
 // TypedAttributeArray implementation
@@ -727,6 +1288,15 @@ TypedAttributeArray<ValueType_, Codec_>::TypedAttributeArray(const TypedAttribut
         mData[0] = rhs.mData[0];
     } else if (this->isOutOfCore()) {
         // do nothing
+    } else if (this->isPaged()) {
+        if (uncompress) {
+            this->allocate(mSize);
+            rhs.mPages->decompress(reinterpret_cast<char*>(mData), &decodePage);
+            mFlags &= ~PAGED;
+            mCompressedBytes = 0;
+        }
+        // pages are immutable so they can be shared with the source array
+        else                mPages = rhs.mPages;
     } else if (this->isCompressed()) {
         char* buffer = 0;
         if (uncompress) {
@@ -742,6 +1312,7 @@ TypedAttributeArray<ValueType_, Codec_>::TypedAttributeArray(const TypedAttribut
         }
         assert(buffer);
         mData = reinterpret_cast<StorageType*>(buffer);
+        if (!this->isCompressed())  CodecBufferTransform<Codec_>::decode(mData, mSize);
     } else {
         this->allocate(mSize);
         memcpy(mData, rhs.mData, mSize * sizeof(StorageType));
@@ -770,6 +1341,8 @@ TypedAttributeArray<ValueType_, Codec_>::operator=(const TypedAttributeArray& rh
         } else if (rhs.isOutOfCore()) {
             mFileInfo = rhs.mFileInfo;
 #endif
+        } else if (this->isPaged()) {
+            mPages = rhs.mPages;
         } else if (this->isCompressed()) {
             char* buffer = new char[mCompressedBytes];
             memcpy(buffer, rhs.mData, mCompressedBytes);
@@ -779,6 +1352,8 @@ TypedAttributeArray<ValueType_, Codec_>::operator=(const TypedAttributeArray& rh
             memcpy(mData, rhs.mData, mSize * sizeof(StorageType));
         }
     }
+
+    return *this;
 }
 
 
@@ -900,6 +1475,12 @@ TypedAttributeArray<ValueType_, Codec_>::deallocate()
         delete[] mData;
         mData = NULL;
     }
+    // release pages if paged
+    if (this->isPaged()) {
+        mFlags &= ~PAGED;
+        mCompressedBytes = 0;
+    }
+    mPages.reset();
 }
 
 
@@ -907,7 +1488,7 @@ template<typename ValueType_, typename Codec_>
 size_t
 TypedAttributeArray<ValueType_, Codec_>::memUsage() const
 {
-    return sizeof(*this) + (mData != NULL ? this->arrayMemUsage() : 0);
+    return sizeof(*this) + (mData != NULL || this->isPaged() ? this->arrayMemUsage() : 0);
 }
 
 
@@ -929,6 +1510,8 @@ template<typename ValueType_, typename Codec_>
 typename TypedAttributeArray<ValueType_, Codec_>::ValueType
 TypedAttributeArray<ValueType_, Codec_>::get(Index n) const
 {
+    if (this->isPaged())                return this->getPaged(n);
+
     if (this->isCompressed())           const_cast<TypedAttributeArray*>(this)->decompress();
     else if (this->isOutOfCore())       this->doLoad();
     else if (n >= this->size())         OPENVDB_THROW(IndexError, "Out-of-range access.");
@@ -957,6 +1540,11 @@ template<typename T>
 void
 TypedAttributeArray<ValueType_, Codec_>::get(Index n, T& val) const
 {
+    if (this->isPaged()) {
+        val = static_cast<T>(this->getPaged(n));
+        return;
+    }
+
     if (this->isCompressed())           const_cast<TypedAttributeArray*>(this)->decompress();
     else if (this->isOutOfCore())       this->doLoad();
     else if (n >= this->size())         OPENVDB_THROW(IndexError, "Out-of-range access.");
@@ -973,6 +1561,32 @@ TypedAttributeArray<ValueType_, Codec_>::getUnsafe(const AttributeArray* array,
 }
 
 
+template<typename ValueType_, typename Codec_>
+typename TypedAttributeArray<ValueType_, Codec_>::ValueType
+TypedAttributeArray<ValueType_, Codec_>::get(const AttributeArray* array, const Index n)
+{
+    return static_cast<const TypedAttributeArray<ValueType, Codec>*>(array)->get(n);
+}
+
+
+template<typename ValueType_, typename Codec_>
+typename TypedAttributeArray<ValueType_, Codec_>::ValueType
+TypedAttributeArray<ValueType_, Codec_>::getPaged(Index n) const
+{
+    assert(this->isPaged());
+
+    if (n >= this->size())              OPENVDB_THROW(IndexError, "Out-of-range access.");
+
+    const size_t pageSize = mPages->pageBytes() / sizeof(StorageType);
+    const StorageType* page = reinterpret_cast<const StorageType*>(
+        mPages->page(n / pageSize, &decodePage));
+
+    ValueType val;
+    Codec::decode(/*in=*/page[n % pageSize], /*out=*/val);
+    return val;
+}
+
+
 template<typename ValueType_, typename Codec_>
 void
 TypedAttributeArray<ValueType_, Codec_>::setUnsafe(Index n, const ValueType& val)
@@ -1049,10 +1663,49 @@ TypedAttributeArray<ValueType_, Codec_>::set(Index n, const AttributeArray& sour
 }
 
 
+template<typename ValueType_, typename Codec_>
+void
+TypedAttributeArray<ValueType_, Codec_>::copyValuesUnsafe(const Index n, const AttributeArray& sourceArray,
+                                                          const Index sourceIndex, const Index count)
+{
+    if (count == 0)     return;
+
+    if (sourceArray.type() != this->type()) {
+        OPENVDB_THROW(TypeError, "Cannot copy values from an attribute of a different type.");
+    }
+
+    const TypedAttributeArray& source = static_cast<const TypedAttributeArray&>(sourceArray);
+
+    assert(!this->isCompressed() && !source.isCompressed());
+    assert(!this->isOutOfCore() && !source.isOutOfCore());
+    assert(n + count <= this->size());
+
+    if (source.mIsUniform) {
+        const StorageType value = source.mData[0];
+        if (mIsUniform) {
+            // remain uniform if the value matches or the entire array is replaced
+            if (count == mSize)     mData[0] = value;
+            if (mData[0] == value)  return;
+            this->expand();
+        }
+        std::fill(mData + n, mData + n + count, value);
+        return;
+    }
+
+    assert(sourceIndex + count <= source.size());
+
+    if (mIsUniform)     this->expand();
+
+    memcpy(mData + n, source.mData + sourceIndex, count * sizeof(StorageType));
+}
+
+
 template<typename ValueType_, typename Codec_>
 void
 TypedAttributeArray<ValueType_, Codec_>::expand(bool fill)
 {
+    instrumentation::increment(instrumentation::EXPAND_CALLS);
+
     if (!mIsUniform)    return;
 
     const StorageType val = mData[0];
@@ -1101,6 +1754,8 @@ template<typename ValueType_, typename Codec_>
 void
 TypedAttributeArray<ValueType_, Codec_>::collapse(const ValueType& uniformValue)
 {
+    instrumentation::increment(instrumentation::COLLAPSE_CALLS);
+
     if (!mIsUniform) {
         tbb::spin_mutex::scoped_lock lock(mMutex);
         this->deallocate();
@@ -1123,10 +1778,11 @@ template<typename ValueType_, typename Codec_>
 void
 TypedAttributeArray<ValueType_, Codec_>::fill(const ValueType& value)
 {
-    if (this->isOutOfCore()) {
+    if (this->isOutOfCore() || this->isCompressed()) {
         tbb::spin_mutex::scoped_lock lock(mMutex);
         this->deallocate();
-        this->allocate(mSize);
+        this->allocate(mIsUniform ? 1 : mSize);
+        mCompressedBytes = 0;
     }
 
     const size_t size = mIsUniform ? 1 : mSize;
@@ -1163,6 +1819,7 @@ TypedAttributeArray<ValueType_, Codec_>::compress()
         const size_t inBytes = mSize * sizeof(StorageType);
         size_t outBytes;
         char* charBuffer = reinterpret_cast<char*>(mData);
+        CodecBufferTransform<Codec_>::encode(mData, mSize);
         char* buffer = compress(charBuffer, typeSize, inBytes, outBytes, /*cleanup=*/true);
 
         if (buffer) {
@@ -1170,6 +1827,9 @@ TypedAttributeArray<ValueType_, Codec_>::compress()
             mCompressedBytes = outBytes;
             return true;
         }
+
+        // compression failed so revert the buffer transform
+        CodecBufferTransform<Codec_>::decode(mData, mSize);
     }
 
     return false;
@@ -1185,13 +1845,24 @@ TypedAttributeArray<ValueType_, Codec_>::decompress()
 
     tbb::spin_mutex::scoped_lock lock(mMutex);
 
+    if (this->isPaged()) {
+        // the data buffer is unused while paged so decompress the pages directly into it
+        this->allocate(mSize);
+        mPages->decompress(reinterpret_cast<char*>(mData), &decodePage);
+        mPages.reset();
+        mFlags &= ~PAGED;
+        mCompressedBytes = 0;
+        return true;
+    }
+
     if (this->isCompressed()) {
         this->doLoadUnsafe();
         char* charBuffer = reinterpret_cast<char*>(this->mData);
-        char* buffer = decompress(charBuffer, uncompressedSize(charBuffer));
+        char* buffer = decompress(charBuffer, uncompressedSize(charBuffer), /*cleanup=*/true);
         if (buffer) {
             mData = reinterpret_cast<StorageType*>(buffer);
             mCompressedBytes = 0;
+            CodecBufferTransform<Codec_>::decode(mData, mSize);
             return true;
         }
     }
@@ -1200,6 +1871,66 @@ TypedAttributeArray<ValueType_, Codec_>::decompress()
 }
 
 
+template<typename ValueType_, typename Codec_>
+inline bool
+TypedAttributeArray<ValueType_, Codec_>::compressPaged(const Index pageSize)
+{
+    using attribute_compression::canCompress;
+    using attribute_compression::PagedBuffer;
+
+    if (pageSize == 0)      OPENVDB_THROW(ValueError, "Cannot compress using a page size of zero.");
+
+    if (!canCompress() || mIsUniform)   return false;
+
+    // re-compress arrays that are already compressed as a whole or with a different page size
+
+    if (this->isCompressed()) {
+        if (this->isPaged() && mPages->pageBytes() == pageSize * sizeof(StorageType)) {
+            return false;
+        }
+        this->decompress();
+        if (this->isCompressed())   return false;
+    }
+
+    tbb::spin_mutex::scoped_lock lock(mMutex);
+
+    this->doLoadUnsafe();
+
+    const size_t typeSize = sizeof(typename Codec_::StorageType);
+    const size_t inBytes = mSize * sizeof(StorageType);
+    const size_t pageBytes = pageSize * sizeof(StorageType);
+
+    PagedBuffer::Ptr pages = PagedBuffer::create(reinterpret_cast<const char*>(mData),
+        typeSize, inBytes, pageBytes, CodecBufferTransform<Codec_>::Enabled ? &encodePage : NULL);
+
+    if (!pages)     return false;
+
+    this->deallocate();
+
+    mPages = pages;
+    mFlags |= PAGED;
+    mCompressedBytes = mPages->memUsage();
+
+    return true;
+}
+
+
+template<typename ValueType_, typename Codec_>
+void
+TypedAttributeArray<ValueType_, Codec_>::encodePage(char* buffer, const size_t bytes)
+{
+    CodecBufferTransform<Codec_>::encode(reinterpret_cast<StorageType*>(buffer), bytes / sizeof(StorageType));
+}
+
+
+template<typename ValueType_, typename Codec_>
+void
+TypedAttributeArray<ValueType_, Codec_>::decodePage(char* buffer, const size_t bytes)
+{
+    CodecBufferTransform<Codec_>::decode(reinterpret_cast<StorageType*>(buffer), bytes / sizeof(StorageType));
+}
+
+
 template<typename ValueType_, typename Codec_>
 bool
 TypedAttributeArray<ValueType_, Codec_>::isOutOfCore() const
@@ -1254,9 +1985,9 @@ template<typename ValueType_, typename Codec_>
 void
 TypedAttributeArray<ValueType_, Codec_>::read(std::istream& is)
 {
-    using attribute_compression::decompress;
+    instrumentation::ScopedTimer timer(instrumentation::READ_TIMER);
 
-    // read data
+    // read header
 
     Index64 bytes = Index64(0);
     is.read(reinterpret_cast<char*>(&bytes), sizeof(Index64));
@@ -1264,12 +1995,26 @@ TypedAttributeArray<ValueType_, Codec_>::read(std::istream& is)
 
     Int16 flags = Int16(0);
     is.read(reinterpret_cast<char*>(&flags), sizeof(Int16));
-    mFlags = flags;
 
     Index64 size = Index64(0);
     is.read(reinterpret_cast<char*>(&size), sizeof(Index64));
+
+    this->readBuffer(is, bytes, flags, size);
+}
+
+
+template<typename ValueType_, typename Codec_>
+void
+TypedAttributeArray<ValueType_, Codec_>::readBuffer(std::istream& is, const Index64 bytes,
+                                                    const Int16 flags, const Index64 size)
+{
+    using attribute_compression::decompress;
+
+    mFlags = flags;
     mSize = size;
 
+    // read data
+
     char* buffer = new char[bytes];
 
     // read uniform and compressed state
@@ -1316,7 +2061,10 @@ TypedAttributeArray<ValueType_, Codec_>::read(std::istream& is)
 
         const size_t inBytes = mSize * sizeof(StorageType);
         char* newBuffer = decompress(buffer, inBytes, /*cleanup=*/true);
-        if (newBuffer)  buffer = newBuffer;
+        if (newBuffer) {
+            buffer = newBuffer;
+            CodecBufferTransform<Codec_>::decode(reinterpret_cast<StorageType*>(buffer), mSize);
+        }
     }
 
     // set data to buffer
@@ -1337,7 +2085,9 @@ TypedAttributeArray<ValueType_, Codec_>::write(std::ostream& os) const
 
     if (this->isTransient())    return;
 
-    Int16 flags(mFlags);
+    instrumentation::ScopedTimer timer(instrumentation::WRITE_TIMER);
+
+    Int16 flags(mFlags & ~PAGED);
     Index64 size(mSize);
 
     boost::scoped_array<char> compressedBuffer;
@@ -1345,26 +2095,50 @@ TypedAttributeArray<ValueType_, Codec_>::write(std::ostream& os) const
 
     this->doLoad();
 
+    // paging is not serialized so decompress the pages into a temporary buffer
+
+    const StorageType* data = mData;
+    size_t dataBytes = this->arrayMemUsage();
+
+    boost::scoped_array<StorageType> pagedData;
+    if (this->isPaged()) {
+        pagedData.reset(new StorageType[mSize]);
+        mPages->decompress(reinterpret_cast<char*>(pagedData.get()), &decodePage);
+        data = pagedData.get();
+        dataBytes = mSize * sizeof(StorageType);
+    }
+
     if (mIsUniform)
     {
         flags |= WRITEUNIFORM;
     }
-    else if (this->isCompressed())
+    else if (this->isCompressed() && !this->isPaged())
     {
         flags |= WRITEMEMCOMPRESS;
     }
     else if (io::getDataCompression(os) & io::COMPRESS_BLOSC)
     {
-        const char* charBuffer = reinterpret_cast<const char*>(mData);
+        const char* charBuffer = reinterpret_cast<const char*>(data);
         const size_t typeSize = sizeof(typename Codec_::StorageType);
         const size_t inBytes = mSize * sizeof(StorageType);
+
+        // apply the buffer transform to a copy as the array is not modified on write
+
+        boost::scoped_array<StorageType> transformed;
+        if (CodecBufferTransform<Codec_>::Enabled) {
+            transformed.reset(new StorageType[mSize]);
+            memcpy(transformed.get(), data, inBytes);
+            CodecBufferTransform<Codec_>::encode(transformed.get(), mSize);
+            charBuffer = reinterpret_cast<const char*>(transformed.get());
+        }
+
         compressedBuffer.reset(compress(charBuffer, typeSize, inBytes, compressedBytes));
         if (compressedBuffer)   flags |= WRITEDISKCOMPRESS;
     }
 
     Index64 bytes = /*flags*/ sizeof(Int16) + /*size*/ sizeof(Index64);
 
-    bytes += compressedBuffer ? compressedBytes : this->arrayMemUsage();
+    bytes += compressedBuffer ? compressedBytes : dataBytes;
 
     // write data
 
@@ -1373,7 +2147,7 @@ TypedAttributeArray<ValueType_, Codec_>::write(std::ostream& os) const
     os.write(reinterpret_cast<const char*>(&size), sizeof(Index64));
 
     if (compressedBuffer)   os.write(reinterpret_cast<const char*>(compressedBuffer.get()), compressedBytes);
-    else                    os.write(reinterpret_cast<const char*>(mData), this->arrayMemUsage());
+    else                    os.write(reinterpret_cast<const char*>(data), dataBytes);
 }
 
 
@@ -1400,6 +2174,9 @@ TypedAttributeArray<ValueType_, Codec_>::doLoadUnsafe() const
 
     const Index64 bytes = info.bytes;
 
+    instrumentation::increment(instrumentation::ARRAYS_LOADED);
+    instrumentation::increment(instrumentation::BYTES_LOADED, bytes);
+
     is.seekg(info.bufpos);
 
     char* buffer = new char[bytes];
@@ -1413,7 +2190,10 @@ TypedAttributeArray<ValueType_, Codec_>::doLoadUnsafe() const
 
         const size_t inBytes = mSize * sizeof(StorageType);
         char* newBuffer = decompress(buffer, inBytes, /*cleanup=*/true);
-        if (newBuffer)  buffer = newBuffer;
+        if (newBuffer) {
+            buffer = newBuffer;
+            CodecBufferTransform<Codec_>::decode(reinterpret_cast<StorageType*>(buffer), mSize);
+        }
     }
 
     // set data to buffer
@@ -1432,10 +2212,17 @@ AttributeArray::AccessorBasePtr
 TypedAttributeArray<ValueType_, Codec_>::getAccessor() const
 {
     // use the faster 'unsafe' get and set methods as attribute handles
-    // ensure data is uncompressed and in-core when constructed
+    // ensure data is uncompressed and in-core when constructed, with the
+    // exception of paged arrays which are read a page at a time
+
+    typedef typename AttributeArray::Accessor<ValueType_>::GetterPtr GetterPtr;
+
+    const GetterPtr getter = this->isPaged() ?
+        GetterPtr(&TypedAttributeArray<ValueType_, Codec_>::get) :
+        GetterPtr(&TypedAttributeArray<ValueType_, Codec_>::getUnsafe);
 
     return AccessorBasePtr(new AttributeArray::Accessor<ValueType_>(
-        &TypedAttributeArray<ValueType_, Codec_>::getUnsafe,
+        getter,
         &TypedAttributeArray<ValueType_, Codec_>::setUnsafe,
         &TypedAttributeArray<ValueType_, Codec_>::collapse,
         &TypedAttributeArray<ValueType_, Codec_>::fill));
@@ -1452,6 +2239,14 @@ TypedAttributeArray<ValueType_, Codec_>::isEqual(const AttributeArray& other) co
        this->mIsUniform != otherT->mIsUniform ||
        *this->sTypeName != *otherT->sTypeName) return false;
 
+    // compare the uncompressed values of paged arrays
+
+    if (this->isPaged() || otherT->isPaged()) {
+        const TypedAttributeArray<ValueType_, Codec_> uncompressed(*this, /*uncompress=*/true);
+        const TypedAttributeArray<ValueType_, Codec_> otherUncompressed(*otherT, /*uncompress=*/true);
+        return uncompressed.isEqual(otherUncompressed);
+    }
+
     this->doLoad();
 
     const StorageType *target = this->mData, *source = otherT->mData;
@@ -1483,8 +2278,9 @@ AttributeHandle<T>::AttributeHandle(const AttributeArray& array, const bool pres
 
     // if array is compressed and preserve compression is true, copy and decompress
     // into a local copy that is destroyed with handle to maintain thread-safety
+    // (paged arrays are read a page at a time and so remain compressed)
 
-    if (array.isCompressed())
+    if (array.isCompressed() && !(preserveCompression && array.isPaged()))
     {
         if (preserveCompression) {
             mLocalArray = array.copyUncompressed();
@@ -35,6 +35,8 @@
 
 #include <openvdb_points/tools/AttributeGroup.h>
 
+#include <algorithm> // std::lower_bound
+
 
 namespace openvdb {
 OPENVDB_USE_VERSION_NAMESPACE
@@ -47,20 +49,116 @@ namespace tools {
 // GroupAttributeArray implementation
 
 
+tbb::atomic<const NamePair*> GroupAttributeArray::sTypeName;
+
+
 GroupAttributeArray::GroupAttributeArray(size_t n, const ValueType& uniformValue)
-    : TypedAttributeArray<GroupType, NullAttributeCodec<GroupType> >(n, uniformValue)
+    : BaseT(n, uniformValue)
+    , mSparseIndices()
+    , mSparseValues()
+    , mSparseThreshold(0)
 {
     this->setGroup(true);
 }
 
 
 GroupAttributeArray::GroupAttributeArray(const GroupAttributeArray& array, const bool decompress)
-        : TypedAttributeArray<GroupType, NullAttributeCodec<GroupType> >(array, decompress)
+    : BaseT(array, decompress)
+    , mSparseIndices(array.mSparseIndices)
+    , mSparseValues(array.mSparseValues)
+    , mSparseThreshold(array.mSparseThreshold)
 {
     this->setGroup(true);
 }
 
 
+GroupAttributeArray::GroupAttributeArray(const BaseT& array)
+    : BaseT(array)
+    , mSparseIndices()
+    , mSparseValues()
+    , mSparseThreshold(0)
+{
+}
+
+
+AttributeArray::Ptr
+GroupAttributeArray::copy() const
+{
+    return AttributeArray::Ptr(new GroupAttributeArray(*this));
+}
+
+
+AttributeArray::Ptr
+GroupAttributeArray::copyUncompressed() const
+{
+    return AttributeArray::Ptr(new GroupAttributeArray(*this, /*decompress = */true));
+}
+
+
+GroupAttributeArray::Ptr
+GroupAttributeArray::create(size_t n)
+{
+    return Ptr(new GroupAttributeArray(n));
+}
+
+
+GroupAttributeArray::Ptr
+GroupAttributeArray::convertLegacy(const BaseT& array)
+{
+    return Ptr(new GroupAttributeArray(array));
+}
+
+
+AttributeArray::Ptr
+GroupAttributeArray::factory(size_t n)
+{
+    // arrays created through the registry are only groups once explicitly flagged
+
+    GroupAttributeArray::Ptr array = GroupAttributeArray::create(n);
+    array->setGroup(false);
+    return array;
+}
+
+
+const NamePair&
+GroupAttributeArray::legacyAttributeType()
+{
+    return BaseT::attributeType();
+}
+
+
+const NamePair&
+GroupAttributeArray::attributeType()
+{
+    if (sTypeName == NULL) {
+        NamePair* s = new NamePair("group", BaseT::attributeType().second);
+        if (sTypeName.compare_and_swap(s, NULL) != NULL) delete s;
+    }
+    return *sTypeName;
+}
+
+
+bool
+GroupAttributeArray::isRegistered()
+{
+    return AttributeArray::isRegistered(GroupAttributeArray::attributeType());
+}
+
+
+void
+GroupAttributeArray::registerType()
+{
+    AttributeArray::registerType(GroupAttributeArray::attributeType(), GroupAttributeArray::factory);
+}
+
+
+void
+GroupAttributeArray::unregisterType()
+{
+    AttributeArray::unregisterType(GroupAttributeArray::attributeType());
+}
+
+
 void GroupAttributeArray::setGroup(bool state)
 {
     if (state) mFlags |= Int16(GROUP);
@@ -68,6 +166,387 @@ void GroupAttributeArray::setGroup(bool state)
 }
 
 
+size_t
+GroupAttributeArray::memUsage() const
+{
+    return BaseT::memUsage() + sizeof(mSparseThreshold) +
+        mSparseIndices.capacity() * sizeof(Index) +
+        mSparseValues.capacity() * sizeof(ValueType);
+}
+
+
+void
+GroupAttributeArray::set(const Index n, const AttributeArray& sourceArray, const Index sourceIndex)
+{
+    const GroupAttributeArray* sourceGroupArray = dynamic_cast<const GroupAttributeArray*>(&sourceArray);
+
+    if (sourceGroupArray)   this->set(n, sourceGroupArray->get(sourceIndex));
+    else                    this->set(n, static_cast<const BaseT&>(sourceArray).get(sourceIndex));
+}
+
+
+void
+GroupAttributeArray::copyValuesUnsafe(const Index n, const AttributeArray& sourceArray,
+                                      const Index sourceIndex, const Index count)
+{
+    const GroupAttributeArray& source = GroupAttributeArray::cast(sourceArray);
+
+    if (this->isSparse())   this->expand();
+
+    BaseT::copyValuesUnsafe(n, source, sourceIndex, count);
+
+    if (!source.isSparse())     return;
+
+    for (size_t i = source.sparseOffset(sourceIndex); i < source.mSparseIndices.size() &&
+                                source.mSparseIndices[i] < sourceIndex + count; i++) {
+        this->setUnsafe(n + (source.mSparseIndices[i] - sourceIndex), source.mSparseValues[i]);
+    }
+}
+
+
+void
+GroupAttributeArray::expand(bool fill)
+{
+    if (!this->isSparse()) {
+        BaseT::expand(fill);
+        return;
+    }
+
+    BaseT::expand(/*fill=*/true);
+
+    if (fill) {
+        for (size_t i = 0; i < mSparseIndices.size(); i++) {
+            BaseT::setUnsafe(mSparseIndices[i], mSparseValues[i]);
+        }
+    }
+
+    std::vector<Index>().swap(mSparseIndices);
+    std::vector<ValueType>().swap(mSparseValues);
+}
+
+
+void
+GroupAttributeArray::collapse()
+{
+    this->collapse(zeroVal<ValueType>());
+}
+
+
+void
+GroupAttributeArray::collapse(const ValueType& uniformValue)
+{
+    std::vector<Index>().swap(mSparseIndices);
+    std::vector<ValueType>().swap(mSparseValues);
+
+    BaseT::collapse(uniformValue);
+}
+
+
+void
+GroupAttributeArray::fill(const ValueType& value)
+{
+    if (this->isSparse())   this->collapse(value);
+    else                    BaseT::fill(value);
+}
+
+
+bool
+GroupAttributeArray::compact()
+{
+    if (this->isSparse())   return false;
+
+    if (BaseT::compact())   return true;
+
+    this->sparsify();
+
+    return false;
+}
+
+
+void
+GroupAttributeArray::setSparseThreshold(Index threshold)
+{
+    mSparseThreshold = threshold;
+
+    if (this->isSparse() && mSparseIndices.size() > mSparseThreshold) {
+        this->expand();
+    }
+
+    this->compact();
+}
+
+
+size_t
+GroupAttributeArray::sparseOffset(Index n) const
+{
+    return std::lower_bound(mSparseIndices.begin(), mSparseIndices.end(), n) - mSparseIndices.begin();
+}
+
+
+void
+GroupAttributeArray::setSparse(Index n, const ValueType& value)
+{
+    assert(BaseT::isUniform());
+
+    // the background value is read directly, so a delay-loaded array must be loaded first
+
+    this->loadData();
+
+    const ValueType background = BaseT::getUnsafe(0);
+
+    const size_t offset = this->sparseOffset(n);
+    const bool exists = offset < mSparseIndices.size() && mSparseIndices[offset] == n;
+
+    if (exists) {
+        if (value == background) {
+            mSparseIndices.erase(mSparseIndices.begin() + offset);
+            mSparseValues.erase(mSparseValues.begin() + offset);
+        }
+        else {
+            mSparseValues[offset] = value;
+        }
+        return;
+    }
+
+    if (value == background)    return;
+
+    // promote to dense storage if the threshold is exceeded
+
+    if (mSparseIndices.size() >= mSparseThreshold) {
+        this->expand();
+        BaseT::setUnsafe(n, value);
+        return;
+    }
+
+    mSparseIndices.insert(mSparseIndices.begin() + offset, n);
+    mSparseValues.insert(mSparseValues.begin() + offset, value);
+}
+
+
+bool
+GroupAttributeArray::sparsify()
+{
+    if (mSparseThreshold == 0 || BaseT::isUniform())     return false;
+
+    this->loadData();
+    this->decompress();
+
+    // try a background value of the first element and then zero
+
+    const Index size = Index(this->size());
+
+    ValueType background = BaseT::getUnsafe(0);
+
+    for (int attempt = 0; attempt < 2; attempt++) {
+
+        Index count = 0;
+        for (Index i = 0; i < size && count <= mSparseThreshold; i++) {
+            if (BaseT::getUnsafe(i) != background)      count++;
+        }
+
+        if (count <= mSparseThreshold) {
+            std::vector<Index> indices;
+            std::vector<ValueType> values;
+            indices.reserve(count);
+            values.reserve(count);
+
+            for (Index i = 0; i < size; i++) {
+                const ValueType value = BaseT::getUnsafe(i);
+                if (value == background)    continue;
+                indices.push_back(i);
+                values.push_back(value);
+            }
+
+            BaseT::collapse(background);
+
+            mSparseIndices.swap(indices);
+            mSparseValues.swap(values);
+
+            return true;
+        }
+
+        if (background == zeroVal<ValueType>())     break;
+        background = zeroVal<ValueType>();
+    }
+
+    return false;
+}
+
+
+void
+GroupAttributeArray::pruneSparse()
+{
+    this->loadData();
+
+    const ValueType background = BaseT::getUnsafe(0);
+
+    size_t offset = 0;
+    for (size_t i = 0; i < mSparseIndices.size(); i++) {
+        if (mSparseValues[i] == background)     continue;
+        mSparseIndices[offset] = mSparseIndices[i];
+        mSparseValues[offset] = mSparseValues[i];
+        offset++;
+    }
+
+    mSparseIndices.resize(offset);
+    mSparseValues.resize(offset);
+}
+
+
+void
+GroupAttributeArray::write(std::ostream& os) const
+{
+    if (this->isTransient())    return;
+
+    // the sparse threshold precedes the array data to persist it for dense arrays too
+
+    os.write(reinterpret_cast<const char*>(&mSparseThreshold), sizeof(Index));
+
+    if (!this->isSparse()) {
+        BaseT::write(os);
+        return;
+    }
+
+    // a sparse array is written as a uniform background value followed by
+    // the number of sparse values, the sparse indices and the sparse values
+
+    this->loadData();
+
+    const Int16 flags(mFlags | WRITEUNIFORM | WRITESPARSE);
+    const Index64 size(this->size());
+    const Index64 count(mSparseIndices.size());
+    const ValueType background = BaseT::getUnsafe(0);
+
+    const Index64 bytes = /*flags*/ sizeof(Int16) + /*size*/ sizeof(Index64) +
+        /*background*/ sizeof(ValueType) + /*count*/ sizeof(Index64) +
+        count * (sizeof(Index) + sizeof(ValueType));
+
+    os.write(reinterpret_cast<const char*>(&bytes), sizeof(Index64));
+    os.write(reinterpret_cast<const char*>(&flags), sizeof(Int16));
+    os.write(reinterpret_cast<const char*>(&size), sizeof(Index64));
+    os.write(reinterpret_cast<const char*>(&background), sizeof(ValueType));
+    os.write(reinterpret_cast<const char*>(&count), sizeof(Index64));
+    os.write(reinterpret_cast<const char*>(&mSparseIndices[0]), count * sizeof(Index));
+    os.write(reinterpret_cast<const char*>(&mSparseValues[0]), count * sizeof(ValueType));
+}
+
+
+void
+GroupAttributeArray::read(std::istream& is)
+{
+    std::vector<Index>().swap(mSparseIndices);
+    std::vector<ValueType>().swap(mSparseValues);
+
+    // arrays written before groups had their own type have no sparse threshold or sparse values
+
+    if (getPointsFormatVersion(is) < OPENVDB_POINTS_FILE_VERSION_GROUP_TYPE) {
+        mSparseThreshold = Index(0);
+        BaseT::read(is);
+        return;
+    }
+
+    Index threshold = Index(0);
+    is.read(reinterpret_cast<char*>(&threshold), sizeof(Index));
+
+    // read header
+
+    Index64 bytes = Index64(0);
+    is.read(reinterpret_cast<char*>(&bytes), sizeof(Index64));
+    bytes = bytes - /*flags*/sizeof(Int16) - /*size*/sizeof(Index64);
+
+    Int16 flags = Int16(0);
+    is.read(reinterpret_cast<char*>(&flags), sizeof(Int16));
+
+    Index64 size = Index64(0);
+    is.read(reinterpret_cast<char*>(&size), sizeof(Index64));
+
+    mSparseThreshold = threshold;
+
+    if (!(flags & WRITESPARSE)) {
+        this->readBuffer(is, bytes, flags, size);
+        return;
+    }
+
+    // read the background value as a uniform array
+
+    this->readBuffer(is, sizeof(ValueType), Int16(flags & ~WRITESPARSE), size);
+
+    // sparse values are always read immediately
+
+    this->loadData();
+
+    Index64 count = Index64(0);
+    is.read(reinterpret_cast<char*>(&count), sizeof(Index64));
+
+    mSparseIndices.resize(count);
+    mSparseValues.resize(count);
+
+    if (count > 0) {
+        is.read(reinterpret_cast<char*>(&mSparseIndices[0]), count * sizeof(Index));
+        is.read(reinterpret_cast<char*>(&mSparseValues[0]), count * sizeof(ValueType));
+    }
+}
+
+
+AttributeArray::AccessorBasePtr
+GroupAttributeArray::getAccessor() const
+{
+    return AccessorBasePtr(new AttributeArray::Accessor<ValueType>(
+        &GroupAttributeArray::getUnsafe,
+        &GroupAttributeArray::setUnsafe,
+        &GroupAttributeArray::collapse,
+        &GroupAttributeArray::fill));
+}
+
+
+bool
+GroupAttributeArray::isEqual(const AttributeArray& other) const
+{
+    const GroupAttributeArray* const otherT = dynamic_cast<const GroupAttributeArray*>(&other);
+
+    if (!otherT)    return BaseT::isEqual(other);
+
+    if (!this->isSparse() && !otherT->isSparse())   return BaseT::isEqual(other);
+
+    if (this->size() != otherT->size())             return false;
+    if (this->isUniform() != otherT->isUniform())   return false;
+
+    for (Index i = 0, size = Index(this->size()); i < size; i++) {
+        if (this->get(i) != otherT->get(i))         return false;
+    }
+
+    return true;
+}
+
+
+GroupAttributeArray::ValueType
+GroupAttributeArray::getUnsafe(const AttributeArray* array, const Index n)
+{
+    return static_cast<const GroupAttributeArray*>(array)->getUnsafe(n);
+}
+
+
+void
+GroupAttributeArray::setUnsafe(AttributeArray* array, const Index n, const ValueType& value)
+{
+    static_cast<GroupAttributeArray*>(array)->setUnsafe(n, value);
+}
+
+
+void
+GroupAttributeArray::collapse(AttributeArray* array, const ValueType& value)
+{
+    static_cast<GroupAttributeArray*>(array)->collapse(value);
+}
+
+
+void
+GroupAttributeArray::fill(AttributeArray* array, const ValueType& value)
+{
+    static_cast<GroupAttributeArray*>(array)->fill(value);
+}
+
+
 ////////////////////////////////////////
 
 // GroupHandle implementation
@@ -122,6 +601,20 @@ bool GroupWriteHandle::collapse(bool on)
 {
     GroupAttributeArray& array(const_cast<GroupAttributeArray&>(mArray));
 
+    // apply to the background and sparse values directly
+
+    if (array.isSparse()) {
+        array.loadData();
+        const GroupType background = array.BaseT::getUnsafe(0);
+        array.BaseT::collapse(on ? GroupType(background | mBitMask) : GroupType(background & ~mBitMask));
+        for (size_t i = 0; i < array.mSparseValues.size(); i++) {
+            GroupType& value = array.mSparseValues[i];
+            value = on ? GroupType(value | mBitMask) : GroupType(value & ~mBitMask);
+        }
+        array.pruneSparse();
+        return !array.isSparse();
+    }
+
     array.compact();
 
     if (this->isUniform()) {
@@ -41,6 +41,8 @@
 
 #include <openvdb_points/tools/AttributeArray.h>
 
+#include <vector>
+
 
 namespace openvdb {
 OPENVDB_USE_VERSION_NAMESPACE
@@ -54,9 +56,20 @@ typedef uint8_t GroupType;
 ////////////////////////////////////////
 
 
+/// @brief Group attribute array that stores eight groups per element.
+///
+/// @details With a non-zero sparse threshold, an array with only a few elements that
+/// differ from a background value is stored as a uniform background value along with
+/// a sorted list of indices and values, avoiding the cost of expanding the array for
+/// groups with very few members. The array is promoted to dense storage once the number
+/// of differing elements exceeds the threshold and demoted again when compacted.
 class GroupAttributeArray : public TypedAttributeArray<GroupType, NullAttributeCodec<GroupType> >
 {
 public:
+    typedef TypedAttributeArray<GroupType, NullAttributeCodec<GroupType> > BaseT;
+    typedef boost::shared_ptr<GroupAttributeArray>          Ptr;
+    typedef boost::shared_ptr<const GroupAttributeArray>    ConstPtr;
+
     /// Default constructor, always constructs a uniform attribute.
     explicit GroupAttributeArray(   size_t n = 1,
                                     const ValueType& uniformValue = zeroVal<ValueType>());
@@ -64,6 +77,15 @@ public:
     GroupAttributeArray(const GroupAttributeArray& array,
                         const bool decompress = false);
 
+    /// Return a copy of this attribute.
+    virtual AttributeArray::Ptr copy() const;
+
+    /// Return an uncompressed copy of this attribute (will just return a copy if not compressed).
+    virtual AttributeArray::Ptr copyUncompressed() const;
+
+    /// Return a new group attribute array of the given length @a n with uniform value zero.
+    static Ptr create(size_t n);
+
     /// Cast an AttributeArray to GroupAttributeArray
     static GroupAttributeArray& cast(AttributeArray& attributeArray);
 
@@ -73,15 +95,184 @@ public:
     /// Return @c true if the AttributeArray provided is a group
     static bool isGroup(const AttributeArray& attributeArray);
 
+    /// @brief Return the name of this attribute's type ("group", includes codec)
+    /// @note Groups have a type distinct from uint8 attributes so that readers
+    /// without support for sparse group storage refuse to load them.
+    static const NamePair& attributeType();
+    /// @brief Return the name of the type groups were stored with before they had their own
+    /// type, which is shared with uint8 attributes and so is resolved from the file format
+    /// version and the group flag on read rather than through the registry.
+    static const NamePair& legacyAttributeType();
+    /// Return the name of this attribute's type.
+    virtual const NamePair& type() const { return attributeType(); }
+
+    /// Return @c true if this attribute type is registered.
+    static bool isRegistered();
+    /// Register this attribute type along with a factory function.
+    static void registerType();
+    /// Remove this attribute type from the registry.
+    static void unregisterType();
+
+    /// @brief Return a group attribute array holding a copy of a uint8 array flagged as
+    /// a group, which is how groups were stored before they were given their own type.
+    static Ptr convertLegacy(const BaseT& array);
+
     /// @brief Specify whether this attribute is for tracking group membership
     /// @note  Attributes are not group attributes by default.
     void setGroup(bool state);
     /// Return @c true if this attribute is for tracking groups
     bool isGroup() const { return bool(mFlags & GROUP); }
 
+    /// Return the number of bytes of memory used by this attribute.
+    virtual size_t memUsage() const;
+
+    /// Return the value at index @a n (assumes uncompressed and in-core)
+    ValueType getUnsafe(Index n) const;
+    /// Return the value at index @a n
+    ValueType get(Index n) const;
+
+    /// Set @a value at the given index @a n (assumes uncompressed and in-core)
+    void setUnsafe(Index n, const ValueType& value);
+    /// Set @a value at the given index @a n
+    void set(Index n, const ValueType& value);
+
+    /// Set value at given index @a n from @a sourceIndex of another @a sourceArray
+    virtual void set(const Index n, const AttributeArray& sourceArray, const Index sourceIndex);
+
+    /// @brief Copy @a count values from @a sourceIndex of another group @a sourceArray into
+    /// this array starting at index @a n (assumes uncompressed and in-core).
+    /// @note The dense or background values are copied in bulk followed by any sparse values.
+    virtual void copyValuesUnsafe(const Index n, const AttributeArray& sourceArray,
+                                  const Index sourceIndex, const Index count);
+
+    /// Return @c true if this array is stored as a single uniform value.
+    virtual bool isUniform() const { return !this->isSparse() && BaseT::isUniform(); }
+    /// @brief  Replace the single value or sparse storage with an array of length size().
+    /// @param  fill toggle to initialize the array elements with the pre-expanded values.
+    virtual void expand(bool fill = true);
+    /// Replace the existing array with a uniform zero value.
+    virtual void collapse();
+    /// @brief Compact the existing array to become uniform if all values are identical,
+    /// or sparse if the number of values differing from a background value is within
+    /// the sparse threshold.
+    virtual bool compact();
+
+    /// Replace the existing array with the given uniform value.
+    void collapse(const ValueType& uniformValue);
+    /// @brief Fill the existing array with the given value.
+    /// @note Identical to collapse() except a non-uniform array will not become uniform.
+    void fill(const ValueType& value);
+
+    /// Write attribute data to a stream.
+    virtual void write(std::ostream& os) const;
+    /// Read attribute data from a stream.
+    virtual void read(std::istream& is);
+
+    /// @brief Set the maximum number of elements that can differ from the background
+    /// value for the array to be stored sparsely, zero disables sparse storage.
+    /// @note The array is compacted to match the new threshold. The threshold is
+    /// serialized with the array, whether the array is stored sparse or dense.
+    /// @note Setting a value in sparse storage inserts into sorted arrays, so it is
+    /// linear in the number of sparse values (amortized constant when setting in
+    /// ascending index order), which the threshold is intended to keep small.
+    void setSparseThreshold(Index threshold);
+    /// Return the maximum number of elements stored sparsely.
+    Index sparseThreshold() const { return mSparseThreshold; }
+    /// Return @c true if this array is stored as a background value and a list of values.
+    bool isSparse() const { return !mSparseIndices.empty(); }
+    /// Return the number of elements that differ from the background value when sparse.
+    Index sparseCount() const { return Index(mSparseIndices.size()); }
+
+    /// @brief Return the values of a dense array for operating on many elements at once
+    /// (assumes not uniform, not sparse, uncompressed and in-core).
+    const ValueType* dataUnsafe() const { assert(!this->isUniform() && !this->isSparse()); return mData; }
+    ValueType* dataUnsafe() { assert(!this->isUniform() && !this->isSparse()); return mData; }
+
+protected:
+    virtual AccessorBasePtr getAccessor() const;
+
+    virtual bool isEqual(const AttributeArray& other) const;
+
+private:
+    friend class GroupWriteHandle;
+
+    /// Construct from a copy of a uint8 array, retaining its flags.
+    explicit GroupAttributeArray(const BaseT& array);
+
+    /// Return the position of index @a n in the sparse indices
+    size_t sparseOffset(Index n) const;
+    /// @brief Set a value in sparse storage, promoting to dense storage if exceeding the threshold
+    /// @note Linear in the number of sparse values due to the sorted insertion.
+    void setSparse(Index n, const ValueType& value);
+    /// Attempt to demote dense storage to sparse storage
+    bool sparsify();
+    /// Remove any sparse values that match the background value
+    void pruneSparse();
+
+    static ValueType getUnsafe(const AttributeArray* array, const Index n);
+    static void setUnsafe(AttributeArray* array, const Index n, const ValueType& value);
+    static void collapse(AttributeArray* array, const ValueType& value);
+    static void fill(AttributeArray* array, const ValueType& value);
+
+    /// Helper function for use with registerType()
+    static AttributeArray::Ptr factory(size_t n);
+
+    static tbb::atomic<const NamePair*> sTypeName;
+
+    std::vector<Index>      mSparseIndices;
+    std::vector<ValueType>  mSparseValues;
+    Index                   mSparseThreshold;
 }; // class GroupAttributeArray
 
 
+////////////////////////////////////////
+
+
+inline GroupAttributeArray::ValueType
+GroupAttributeArray::getUnsafe(Index n) const
+{
+    if (this->isSparse()) {
+        const size_t offset = this->sparseOffset(n);
+        if (offset < mSparseIndices.size() && mSparseIndices[offset] == n) {
+            return mSparseValues[offset];
+        }
+    }
+    return BaseT::getUnsafe(n);
+}
+
+
+inline GroupAttributeArray::ValueType
+GroupAttributeArray::get(Index n) const
+{
+    if (this->isSparse()) {
+        if (n >= this->size())      OPENVDB_THROW(IndexError, "Out-of-range access.");
+        return this->getUnsafe(n);
+    }
+    return BaseT::get(n);
+}
+
+
+inline void
+GroupAttributeArray::setUnsafe(Index n, const ValueType& value)
+{
+    if (mSparseThreshold > 0 && BaseT::isUniform())     this->setSparse(n, value);
+    else                                                BaseT::setUnsafe(n, value);
+}
+
+
+inline void
+GroupAttributeArray::set(Index n, const ValueType& value)
+{
+    if (mSparseThreshold > 0 && BaseT::isUniform()) {
+        if (n >= this->size())      OPENVDB_THROW(IndexError, "Out-of-range access.");
+        this->setSparse(n, value);
+    }
+    else {
+        BaseT::set(n, value);
+    }
+}
+
+
 inline GroupAttributeArray&
 GroupAttributeArray::cast(AttributeArray& attributeArray)
 {
@@ -107,7 +298,7 @@ GroupAttributeArray::isGroup(const AttributeArray& attributeArray)
 {
     if (!attributeArray.isType<GroupAttributeArray>())  return false;
 
-    return GroupAttributeArray::cast(attributeArray).isGroup();
+    return bool(attributeArray.flags() & GROUP);
 }
 
 
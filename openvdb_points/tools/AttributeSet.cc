@@ -164,6 +164,28 @@ AttributeSet::replace(size_t pos, const AttributeArray::Ptr& attr)
 }
 
 
+size_t
+AttributeSet::replace(size_t pos, const AttributeArray::Ptr& attr,
+                      const Descriptor& expected, const DescriptorPtr& replacement)
+{
+    assert(pos != INVALID_POS);
+    assert(pos < mAttrs.size());
+
+    // ensure the descriptor is as expected
+    if (*mDescr != expected) {
+        OPENVDB_THROW(LookupError, "Cannot replace attribute as descriptors do not match.")
+    }
+
+    if (attr->type() != replacement->type(pos)) {
+        return INVALID_POS;
+    }
+
+    mDescr = replacement;
+    mAttrs[pos] = attr;
+    return pos;
+}
+
+
 const AttributeArray*
 AttributeSet::getConst(const std::string& name) const
 {
@@ -501,6 +523,16 @@ AttributeSet::readAttributes(std::istream& is)
     for (size_t n = 0, N = mAttrs.size(); n < N; ++n) {
         mAttrs[n] = AttributeArray::create(mDescr->type(n), 1);
         mAttrs[n]->read(is);
+
+        // convert groups stored as uint8 arrays before groups were given their own type
+
+        if (getPointsFormatVersion(is) < OPENVDB_POINTS_FILE_VERSION_GROUP_TYPE &&
+            mDescr->type(n) == GroupAttributeArray::legacyAttributeType() &&
+            (mAttrs[n]->flags() & AttributeArray::GROUP)) {
+            mAttrs[n] = GroupAttributeArray::convertLegacy(
+                static_cast<const GroupAttributeArray::BaseT&>(*mAttrs[n]));
+            mDescr = mDescr->duplicateRetype(n, GroupAttributeArray::attributeType());
+        }
     }
 }
 
@@ -861,6 +893,19 @@ AttributeSet::Descriptor::duplicateDrop(const std::vector<size_t>& pos) const
     return descriptor;
 }
 
+AttributeSet::Descriptor::Ptr
+AttributeSet::Descriptor::duplicateRetype(const size_t pos, const NamePair& type) const
+{
+    NameAndTypeVec vec;
+    this->appendTo(vec);
+
+    assert(pos < vec.size());
+
+    vec[pos].type = type;
+
+    return Descriptor::create(vec, mGroupMap, mMetadata);
+}
+
 void
 AttributeSet::Descriptor::appendTo(NameAndTypeVec& attrs) const
 {
@@ -991,7 +1036,11 @@ AttributeSet::Descriptor::write(std::ostream& os) const
         os.write(reinterpret_cast<const char*>(&groupIt->second), sizeof(Index64));
     }
 
-    mMetadata.writeMeta(os);
+    // the file format version is written with the metadata and removed from it on read
+
+    MetaMap metadata(mMetadata);
+    metadata.insertMeta(META_FILE_VERSION, Int32Metadata(OPENVDB_POINTS_FILE_VERSION));
+    metadata.writeMeta(os);
 }
 
 
@@ -1030,6 +1079,17 @@ AttributeSet::Descriptor::read(std::istream& is)
     }
 
     mMetadata.readMeta(is);
+
+    // descriptors written before the file format version was stored are the initial version
+
+    uint32_t version = OPENVDB_POINTS_FILE_VERSION_INITIAL;
+
+    if (Int32Metadata::Ptr versionMeta = mMetadata.getMetadata<Int32Metadata>(META_FILE_VERSION)) {
+        version = uint32_t(versionMeta->value());
+        mMetadata.removeMeta(META_FILE_VERSION);
+    }
+
+    setPointsFormatVersion(is, version);
 }
 
 
@@ -137,6 +137,16 @@ public:
     ///         the descriptor.
     size_t replace(size_t pos, const AttributeArray::Ptr&);
 
+    /// @brief  Replace the attribute array stored at position @a pos with an array
+    ///         of a different type (descriptor-sharing method).
+    ///         Requires current descriptor to match @a expected
+    ///         On replace, current descriptor is replaced with @a replacement
+    /// @return The position of the updated attribute array or @c INVALID_POS
+    ///         if replacement failed because the new array type does not comply with
+    ///         the replacement descriptor.
+    size_t replace(size_t pos, const AttributeArray::Ptr&,
+                   const Descriptor& expected, const DescriptorPtr& replacement);
+
     //@{
     /// @brief  Return a pointer to the attribute array whose name is @a name or
     ///         a null pointer if no match is found.
@@ -297,6 +307,8 @@ public:
     Ptr duplicateAppend(const NameAndType& attribute) const;
     Ptr duplicateAppend(const NameAndTypeVec& vec) const;
     Ptr duplicateDrop(const std::vector<size_t>& pos) const;
+    /// Duplicate the descriptor with the attribute at @a pos changed to @a type.
+    Ptr duplicateRetype(const size_t pos, const NamePair& type) const;
 
     /// Return the number of attributes in this descriptor.
     size_t size() const { return mTypes.size(); }
@@ -0,0 +1,397 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2015-2016 Double Negative Visual Effects
+//
+// All rights reserved. This software is distributed under the
+// Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
+//
+// Redistributions of source code must retain the above copyright
+// and license notice and the following restrictions and disclaimer.
+//
+// *     Neither the name of Double Negative Visual Effects nor the names
+// of its contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// IN NO EVENT SHALL THE COPYRIGHT HOLDERS' AND CONTRIBUTORS' AGGREGATE
+// LIABILITY FOR ALL CLAIMS REGARDLESS OF THEIR BASIS EXCEED US$250.00.
+//
+///////////////////////////////////////////////////////////////////////////
+//
+/// @file AttributeString.cc
+
+
+#include <openvdb_points/tools/AttributeString.h>
+
+#include <boost/algorithm/string/predicate.hpp> // boost::starts_with
+
+#include <cstdlib> // std::strtoul
+#include <sstream>
+
+
+namespace openvdb {
+OPENVDB_USE_VERSION_NAMESPACE
+namespace OPENVDB_VERSION_NAME {
+namespace tools {
+
+
+namespace {
+
+/// Return the string table index of a descriptor metadata key or zero if not a string key
+Index
+stringIndex(const Name& key)
+{
+    if (!boost::starts_with(key, "string:"))    return 0;
+
+    const Name digits = key.substr(7);
+
+    if (digits.empty() || digits.find_first_not_of("0123456789") != Name::npos)    return 0;
+
+    return Index(std::strtoul(digits.c_str(), NULL, 10)) + 1;
+}
+
+
+/// Return the remapped string table index
+inline Index
+remapIndex(const std::vector<Index>& indices, const Index index)
+{
+    if (index >= indices.size()) {
+        OPENVDB_THROW(LookupError, "Cannot remap string index " << index << ".");
+    }
+    return indices[index];
+}
+
+} // namespace
+
+
+Name
+stringMetaKey(const Index index)
+{
+    assert(index > 0);
+
+    std::ostringstream ostr;
+    ostr << "string:" << (index - 1);
+    return ostr.str();
+}
+
+
+////////////////////////////////////////
+
+// StringMetaCache implementation
+
+
+StringMetaCache::StringMetaCache(const MetaMap& metadata)
+{
+    this->reset(metadata);
+}
+
+
+void
+StringMetaCache::reset(const MetaMap& metadata)
+{
+    mStrings.assign(1, Name());
+    mValid.assign(1, true);
+    mIndices.clear();
+
+    for (MetaMap::ConstMetaIterator it = metadata.beginMeta(),
+                                    itEnd = metadata.endMeta(); it != itEnd; ++it) {
+
+        const Index index = stringIndex(it->first);
+        if (index == 0)     continue;
+
+        const StringMetadata* meta = dynamic_cast<const StringMetadata*>(it->second.get());
+        if (!meta)          continue;
+
+        if (index >= mStrings.size()) {
+            mStrings.resize(index + 1);
+            mValid.resize(index + 1, false);
+        }
+
+        mStrings[index] = meta->value();
+        mValid[index] = true;
+
+        // a string stored more than once is found at the lowest index
+
+        IndexMap::iterator found = mIndices.find(meta->value());
+        if (found == mIndices.end() || index < found->second) {
+            mIndices[meta->value()] = index;
+        }
+    }
+}
+
+
+const Name&
+StringMetaCache::get(const Index index) const
+{
+    if (!this->isValid(index)) {
+        OPENVDB_THROW(LookupError, "Cannot find string with index " << index << ".");
+    }
+    return mStrings[index];
+}
+
+
+Index
+StringMetaCache::find(const Name& name) const
+{
+    if (name.empty())   return 0;
+
+    IndexMap::const_iterator it = mIndices.find(name);
+    if (it == mIndices.end()) {
+        OPENVDB_THROW(LookupError, "Cannot find string - " << name << ".");
+    }
+    return it->second;
+}
+
+
+////////////////////////////////////////
+
+// StringMetaInserter implementation
+
+
+StringMetaInserter::StringMetaInserter(MetaMap& metadata)
+    : mMetadata(metadata)
+    , mIndices()
+    , mNextIndex(1)
+{
+    this->resetCache();
+}
+
+
+Index
+StringMetaInserter::insert(const Name& name)
+{
+    if (name.empty())   return 0;
+
+    std::map<Name, Index>::const_iterator it = mIndices.find(name);
+    if (it != mIndices.end())   return it->second;
+
+    // new strings are appended to the end of the string table
+
+    const Index index = mNextIndex++;
+
+    mMetadata.insertMeta(stringMetaKey(index), StringMetadata(name));
+    mIndices[name] = index;
+
+    return index;
+}
+
+
+void
+StringMetaInserter::insert(const MetaMap& source, std::vector<Index>& indices)
+{
+    const StringMetaCache cache(source);
+
+    indices.assign(cache.size(), Index(0));
+
+    for (Index index = 1; index < Index(cache.size()); index++) {
+        if (cache.isValid(index))   indices[index] = this->insert(cache.get(index));
+    }
+}
+
+
+void
+StringMetaInserter::resetCache()
+{
+    const StringMetaCache cache(mMetadata);
+
+    mIndices = cache.map();
+    mNextIndex = Index(cache.size());
+}
+
+
+////////////////////////////////////////
+
+
+void
+remapStrings(AttributeArray& array, const std::vector<Index>& indices)
+{
+    remapStrings(array, indices, Index(0), Index(array.size()));
+}
+
+
+void
+remapStrings(AttributeArray& array, const std::vector<Index>& indices,
+             const Index start, const Index count)
+{
+    StringAttributeArray& stringArray = StringAttributeArray::cast(array);
+
+    if (count == 0)     return;
+
+    if (size_t(start) + size_t(count) > stringArray.size()) {
+        OPENVDB_THROW(IndexError, "Cannot remap strings beyond the end of the array.");
+    }
+
+    if (stringArray.isUniform()) {
+        const Index index = stringArray.get(0);
+        const Index remapped = remapIndex(indices, index);
+        if (count == stringArray.size()) {
+            stringArray.collapse(remapped);
+            return;
+        }
+        if (remapped == index)  return;
+        stringArray.expand();
+    }
+
+    // remap the uncompressed indices and restore any compression
+
+    const bool compressed = stringArray.isCompressed();
+
+    stringArray.loadData();
+    stringArray.decompress();
+
+    for (Index n = start, N = start + count; n < N; n++) {
+        stringArray.setUnsafe(n, remapIndex(indices, stringArray.getUnsafe(n)));
+    }
+
+    if (compressed)     stringArray.compress();
+}
+
+
+bool
+isIdentityRemap(const std::vector<Index>& indices)
+{
+    for (size_t i = 0; i < indices.size(); i++) {
+        if (indices[i] != Index(i))     return false;
+    }
+    return true;
+}
+
+
+////////////////////////////////////////
+
+// StringAttributeHandle implementation
+
+
+StringAttributeHandle::Ptr
+StringAttributeHandle::create(const AttributeArray& array, const MetaMap& metadata,
+                              const bool preserveCompression)
+{
+    return Ptr(new StringAttributeHandle(array, metadata, preserveCompression));
+}
+
+
+StringAttributeHandle::StringAttributeHandle(const AttributeArray& array,
+                                             const MetaMap& metadata,
+                                             const bool preserveCompression)
+    : mHandle(StringAttributeArray::cast(array), preserveCompression)
+    , mLocalCache(new StringMetaCache(metadata))
+    , mCache(mLocalCache.get())
+{
+}
+
+
+StringAttributeHandle::StringAttributeHandle(const AttributeArray& array,
+                                             const StringMetaCache& cache,
+                                             const bool preserveCompression)
+    : mHandle(StringAttributeArray::cast(array), preserveCompression)
+    , mLocalCache()
+    , mCache(&cache)
+{
+}
+
+
+const Name&
+StringAttributeHandle::get(Index n) const
+{
+    return mCache->get(mHandle.get(n));
+}
+
+
+void
+StringAttributeHandle::get(Name& name, Index n) const
+{
+    name = this->get(n);
+}
+
+
+////////////////////////////////////////
+
+// StringAttributeWriteHandle implementation
+
+
+StringAttributeWriteHandle::Ptr
+StringAttributeWriteHandle::create(AttributeArray& array, const MetaMap& metadata)
+{
+    return Ptr(new StringAttributeWriteHandle(array, metadata));
+}
+
+
+StringAttributeWriteHandle::StringAttributeWriteHandle(AttributeArray& array,
+                                                       const MetaMap& metadata)
+    : StringAttributeHandle(array, metadata, /*preserveCompression=*/false)
+    , mWriteHandle(array)
+{
+}
+
+
+StringAttributeWriteHandle::StringAttributeWriteHandle(AttributeArray& array,
+                                                       const StringMetaCache& cache)
+    : StringAttributeHandle(array, cache, /*preserveCompression=*/false)
+    , mWriteHandle(array)
+{
+}
+
+
+void
+StringAttributeWriteHandle::expand(bool fill)
+{
+    mWriteHandle.expand(fill);
+}
+
+
+void
+StringAttributeWriteHandle::collapse()
+{
+    mWriteHandle.collapse(Index(0));
+}
+
+
+void
+StringAttributeWriteHandle::collapse(const Name& name)
+{
+    mWriteHandle.collapse(mCache->find(name));
+}
+
+
+bool
+StringAttributeWriteHandle::compact()
+{
+    return mWriteHandle.compact();
+}
+
+
+void
+StringAttributeWriteHandle::fill(const Name& name)
+{
+    mWriteHandle.fill(mCache->find(name));
+}
+
+
+void
+StringAttributeWriteHandle::set(Index n, const Name& name)
+{
+    mWriteHandle.set(n, mCache->find(name));
+}
+
+
+////////////////////////////////////////
+
+
+} // namespace tools
+} // namespace OPENVDB_VERSION_NAME
+} // namespace openvdb
+
+
+// Copyright (c) 2015-2016 Double Negative Visual Effects
+// All rights reserved. This software is distributed under the
+// Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
@@ -0,0 +1,321 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2015-2016 Double Negative Visual Effects
+//
+// All rights reserved. This software is distributed under the
+// Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
+//
+// Redistributions of source code must retain the above copyright
+// and license notice and the following restrictions and disclaimer.
+//
+// *     Neither the name of Double Negative Visual Effects nor the names
+// of its contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// IN NO EVENT SHALL THE COPYRIGHT HOLDERS' AND CONTRIBUTORS' AGGREGATE
+// LIABILITY FOR ALL CLAIMS REGARDLESS OF THEIR BASIS EXCEED US$250.00.
+//
+///////////////////////////////////////////////////////////////////////////
+//
+/// @file AttributeString.h
+///
+/// @brief  String attributes stored as indices into a string table held in the
+///         metadata of the attribute set descriptor.
+///
+
+
+#ifndef OPENVDB_TOOLS_ATTRIBUTE_STRING_HAS_BEEN_INCLUDED
+#define OPENVDB_TOOLS_ATTRIBUTE_STRING_HAS_BEEN_INCLUDED
+
+#include <openvdb_points/tools/AttributeArray.h>
+
+#include <openvdb/metadata/MetaMap.h>
+
+#include <map>
+#include <vector>
+
+
+namespace openvdb {
+OPENVDB_USE_VERSION_NAMESPACE
+namespace OPENVDB_VERSION_NAME {
+namespace tools {
+
+
+////////////////////////////////////////
+
+
+/// @brief Codec for a string attribute that stores the index of each string in the
+/// string table of the attribute set descriptor, where index zero is the empty string.
+/// @note A string attribute with identical strings for all elements remains uniform
+/// and the indices of a non-uniform array compress well with Blosc.
+struct StringAttributeCodec
+{
+    typedef Index32 StorageType;
+    template<typename ValueType> static void decode(const StorageType&, ValueType&);
+    template<typename ValueType> static void encode(const ValueType&, StorageType&);
+    static const char* name() { return "str"; }
+};
+
+
+typedef TypedAttributeArray<Index, StringAttributeCodec> StringAttributeArray;
+
+
+/// Return @c true if the AttributeArray provided is a string attribute
+inline bool isString(const AttributeArray& array)
+{
+    return array.isType<StringAttributeArray>();
+}
+
+
+/// @brief Return the descriptor metadata key of the string table entry with the
+/// given non-zero @a index.
+Name stringMetaKey(const Index index);
+
+
+////////////////////////////////////////
+
+
+/// @brief Cache of the string table held in the metadata of an attribute set descriptor.
+///
+/// @details The string table is stored as one string metadata entry per string, a cache
+/// provides constant time lookup by index and logarithmic lookup by string. The cache
+/// can be built once and shared between the string handles of all leaves that share
+/// a descriptor, rather than each handle building its own cache.
+class StringMetaCache
+{
+public:
+    typedef std::map<Name, Index> IndexMap;
+
+    explicit StringMetaCache(const MetaMap& metadata);
+
+    /// Rebuild the cache from the given @a metadata.
+    void reset(const MetaMap& metadata);
+
+    /// Return the number of indices in the string table (including the empty string).
+    size_t size() const { return mStrings.size(); }
+
+    /// Return @c true if the given @a index is in the string table.
+    bool isValid(const Index index) const { return index < mStrings.size() && mValid[index]; }
+
+    /// @brief Return the string with the given @a index.
+    /// @throw LookupError if the index is not in the string table.
+    const Name& get(const Index index) const;
+
+    /// @brief Return the index of the given string @a name.
+    /// @throw LookupError if the string is not in the string table.
+    Index find(const Name& name) const;
+
+    /// Return @c true if the string table contains the given string @a name.
+    bool has(const Name& name) const { return name.empty() || mIndices.count(name) > 0; }
+
+    /// Return a reference to the string-to-index map.
+    const IndexMap& map() const { return mIndices; }
+
+private:
+    std::vector<Name>   mStrings;
+    std::vector<bool>   mValid;
+    IndexMap            mIndices;
+}; // class StringMetaCache
+
+
+////////////////////////////////////////
+
+
+/// @brief Insert strings into the string table held in the metadata of an attribute
+/// set descriptor.
+/// @note The descriptor is typically shared by all leaves of a tree, so strings should
+/// be inserted serially before any string attributes are written.
+class StringMetaInserter
+{
+public:
+    explicit StringMetaInserter(MetaMap& metadata);
+
+    /// @brief Insert the string @a name into the string table if not already present
+    /// and return its index.
+    Index insert(const Name& name);
+
+    /// @brief Insert all strings of the @a source string table and return in @a indices
+    /// the index in this string table of each source string, indexed by source index.
+    /// @details Use remapStrings() with these indices to bulk remap string attributes
+    /// between string tables, for example when merging grids.
+    void insert(const MetaMap& source, std::vector<Index>& indices);
+
+    /// Rebuild the cache from the metadata, required if the metadata is modified externally.
+    void resetCache();
+
+private:
+    MetaMap&                mMetadata;
+    std::map<Name, Index>   mIndices;
+    Index                   mNextIndex;
+}; // class StringMetaInserter
+
+
+////////////////////////////////////////
+
+
+/// @brief Replace each string index of a string attribute @a array with the value
+/// at that position in @a indices, such as those returned by StringMetaInserter::insert().
+/// @throw TypeError if the array is not a string attribute.
+/// @throw LookupError if an index in the array is beyond the end of @a indices.
+void remapStrings(AttributeArray& array, const std::vector<Index>& indices);
+
+/// @brief Replace the string indices of @a count elements of a string attribute @a array
+/// starting at @a start with the values at those positions in @a indices.
+/// @note A uniform array is only expanded if the remapped range does not cover it.
+/// @throw TypeError if the array is not a string attribute.
+/// @throw IndexError if the range extends beyond the end of the array.
+/// @throw LookupError if an index in the range is beyond the end of @a indices.
+void remapStrings(AttributeArray& array, const std::vector<Index>& indices,
+                  const Index start, const Index count);
+
+/// Return @c true if remapping with the given @a indices leaves all strings unchanged.
+bool isIdentityRemap(const std::vector<Index>& indices);
+
+
+////////////////////////////////////////
+
+
+/// Read access to a string attribute.
+class StringAttributeHandle
+{
+public:
+    typedef boost::shared_ptr<StringAttributeHandle> Ptr;
+
+    static Ptr create(const AttributeArray& array, const MetaMap& metadata,
+                      const bool preserveCompression = true);
+
+    /// @brief Bind to a string attribute, building a local string table cache.
+    /// @throw TypeError if the array is not a string attribute.
+    StringAttributeHandle(  const AttributeArray& array,
+                            const MetaMap& metadata,
+                            const bool preserveCompression = true);
+
+    /// @brief Bind to a string attribute using a shared string table @a cache that
+    /// must outlive this handle.
+    /// @throw TypeError if the array is not a string attribute.
+    StringAttributeHandle(  const AttributeArray& array,
+                            const StringMetaCache& cache,
+                            const bool preserveCompression = true);
+
+    virtual ~StringAttributeHandle() { }
+
+    size_t size() const { return mHandle.size(); }
+    bool isUniform() const { return mHandle.isUniform(); }
+
+    /// Return the string at index @a n.
+    const Name& get(Index n) const;
+    void get(Name& name, Index n) const;
+
+    /// Return the string table index at index @a n.
+    Index index(Index n) const { return mHandle.get(n); }
+
+    /// Return a reference to the string table cache.
+    const StringMetaCache& cache() const { return *mCache; }
+
+protected:
+    AttributeHandle<Index>              mHandle;
+    boost::shared_ptr<StringMetaCache>  mLocalCache;
+    const StringMetaCache*              mCache;
+}; // class StringAttributeHandle
+
+
+////////////////////////////////////////
+
+
+/// Write access to a string attribute.
+class StringAttributeWriteHandle : public StringAttributeHandle
+{
+public:
+    typedef boost::shared_ptr<StringAttributeWriteHandle> Ptr;
+
+    static Ptr create(AttributeArray& array, const MetaMap& metadata);
+
+    /// @brief Bind to a string attribute, building a local string table cache.
+    /// @throw TypeError if the array is not a string attribute.
+    StringAttributeWriteHandle(AttributeArray& array, const MetaMap& metadata);
+
+    /// @brief Bind to a string attribute using a shared string table @a cache that
+    /// must outlive this handle.
+    /// @throw TypeError if the array is not a string attribute.
+    StringAttributeWriteHandle(AttributeArray& array, const StringMetaCache& cache);
+
+    virtual ~StringAttributeWriteHandle() { }
+
+    /// @brief  If this array is uniform, replace it with an array of length size().
+    /// @param  fill if true, assign the uniform value to each element of the array.
+    void expand(bool fill = true);
+
+    /// Replace the existing array with the empty string.
+    void collapse();
+    /// @brief Replace the existing array with the given string.
+    /// @throw LookupError if the string is not in the string table.
+    void collapse(const Name& name);
+
+    /// Compact the existing array to become uniform if all values are identical
+    bool compact();
+
+    /// @brief Fill the existing array with the given string.
+    /// @note Identical to collapse() except a non-uniform array will not become uniform.
+    /// @throw LookupError if the string is not in the string table.
+    void fill(const Name& name);
+
+    /// @brief Set the string at index @a n.
+    /// @throw LookupError if the string is not in the string table, strings must be
+    /// inserted with a StringMetaInserter before they are set.
+    void set(Index n, const Name& name);
+
+    /// Set the string table index at index @a n.
+    void setIndex(Index n, const Index index) { mWriteHandle.set(n, index); }
+
+private:
+    AttributeWriteHandle<Index> mWriteHandle;
+}; // class StringAttributeWriteHandle
+
+
+////////////////////////////////////////
+
+
+// StringAttributeCodec implementation
+
+
+template<typename ValueType>
+inline void
+StringAttributeCodec::decode(const StorageType& data, ValueType& val)
+{
+    val = static_cast<ValueType>(data);
+}
+
+
+template<typename ValueType>
+inline void
+StringAttributeCodec::encode(const ValueType& val, StorageType& data)
+{
+    data = static_cast<StorageType>(val);
+}
+
+
+////////////////////////////////////////
+
+
+} // namespace tools
+} // namespace OPENVDB_VERSION_NAME
+} // namespace openvdb
+
+
+#endif // OPENVDB_TOOLS_ATTRIBUTE_STRING_HAS_BEEN_INCLUDED
+
+
+// Copyright (c) 2015-2016 Double Negative Visual Effects
+// All rights reserved. This software is distributed under the
+// Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
@@ -0,0 +1,958 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2015-2016 Double Negative Visual Effects
+//
+// All rights reserved. This software is distributed under the
+// Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
+//
+// Redistributions of source code must retain the above copyright
+// and license notice and the following restrictions and disclaimer.
+//
+// *     Neither the name of Double Negative Visual Effects nor the names
+// of its contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// IN NO EVENT SHALL THE COPYRIGHT HOLDERS' AND CONTRIBUTORS' AGGREGATE
+// LIABILITY FOR ALL CLAIMS REGARDLESS OF THEIR BASIS EXCEED US$250.00.
+//
+///////////////////////////////////////////////////////////////////////////
+//
+/// @file AttributeVariable.h
+///
+/// @brief  Attribute array storing a variable-length list of values per element.
+///
+
+
+#ifndef OPENVDB_TOOLS_ATTRIBUTE_VARIABLE_HAS_BEEN_INCLUDED
+#define OPENVDB_TOOLS_ATTRIBUTE_VARIABLE_HAS_BEEN_INCLUDED
+
+#include <openvdb_points/tools/AttributeArray.h>
+
+#include <tbb/spin_mutex.h>
+
+#include <algorithm>
+#include <vector>
+
+
+namespace openvdb {
+OPENVDB_USE_VERSION_NAMESPACE
+namespace OPENVDB_VERSION_NAME {
+namespace tools {
+
+
+////////////////////////////////////////
+
+
+/// @brief Attribute array that stores a variable-length list of values per element
+/// (an array-of-arrays), such as neighbour lists, curve vertices or sample histories.
+///
+/// @details The values of all elements are stored contiguously in a flat value buffer
+/// (a TypedAttributeArray, so any codec may be used) along with a table of the end
+/// offset of each list in this buffer, in the same way that a PointDataLeafNode stores
+/// the end offset of the points in each voxel. Both arrays are compressed, serialized
+/// and delay-loaded with the existing TypedAttributeArray machinery.
+///
+/// @note Changing the length of a list moves the offsets of all following elements and,
+/// unless the following lists are empty, their values. Populating an array in element
+/// order appends to the value buffer which grows geometrically and defers updating the
+/// offsets of the trailing empty lists, so it is linear in the total length. Alternatively
+/// use setLengths() followed by set(n, i, value) or copyValuesUnsafe() to populate an
+/// array in bulk.
+template<typename ValueType_, typename Codec_ = NullAttributeCodec<ValueType_> >
+class VariableAttributeArray : public AttributeArray
+{
+public:
+    typedef boost::shared_ptr<VariableAttributeArray>          Ptr;
+    typedef boost::shared_ptr<const VariableAttributeArray>    ConstPtr;
+
+    typedef ValueType_                              ValueType;
+    typedef Codec_                                  Codec;
+    typedef typename Codec::StorageType             StorageType;
+    typedef TypedAttributeArray<Index32>            OffsetArray;
+    typedef TypedAttributeArray<ValueType, Codec>   ValueArray;
+
+    //////////
+
+    /// Default constructor, constructs an array of @a n empty lists.
+    explicit VariableAttributeArray(size_t n = 1);
+    /// Deep copy constructor (optionally decompress during copy).
+    VariableAttributeArray(const VariableAttributeArray&, bool uncompress = false);
+    /// Deep copy assignment operator.
+    VariableAttributeArray& operator=(const VariableAttributeArray&);
+
+    virtual ~VariableAttributeArray() { }
+
+    /// Return a copy of this attribute.
+    virtual AttributeArray::Ptr copy() const;
+
+    /// Return an uncompressed copy of this attribute (will just return a copy if not compressed).
+    virtual AttributeArray::Ptr copyUncompressed() const;
+
+    /// Return a new attribute array of the given length @a n with empty lists.
+    static Ptr create(size_t n);
+
+    /// Cast an AttributeArray to VariableAttributeArray<T>
+    static VariableAttributeArray& cast(AttributeArray& attributeArray);
+
+    /// Cast an AttributeArray to VariableAttributeArray<T>
+    static const VariableAttributeArray& cast(const AttributeArray& attributeArray);
+
+    /// Return the name of this attribute's type (value type suffixed with "[]", includes codec)
+    static const NamePair& attributeType();
+    /// Return the name of this attribute's type.
+    virtual const NamePair& type() const { return attributeType(); }
+
+    /// Return @c true if this attribute type is registered.
+    static bool isRegistered();
+    /// Register this attribute type along with a factory function.
+    static void registerType();
+    /// Remove this attribute type from the registry.
+    static void unregisterType();
+
+    /// Return the number of elements (lists) in this array.
+    virtual size_t size() const { return mOffsets->size(); }
+
+    /// Return the number of bytes of memory used by this attribute.
+    virtual size_t memUsage() const;
+
+    /// Return the number of bytes used to store a single value in the value buffer.
+    virtual Index storageTypeSize() const { return mValues->storageTypeSize(); }
+
+    /// Return the number of values in the list of element @a n.
+    Index length(Index n) const;
+    /// Return the position in the value buffer of the first value of element @a n.
+    Index offset(Index n) const;
+    /// Return the total number of values in all lists.
+    Index totalLength() const;
+
+    /// Return the value at position @a i in the list of element @a n.
+    ValueType get(Index n, Index i) const;
+    /// Return the list of @a values of element @a n.
+    void get(Index n, std::vector<ValueType>& values) const;
+
+    /// Set the value at position @a i in the list of element @a n.
+    void set(Index n, Index i, const ValueType& value);
+    /// Replace the list of element @a n with @a values.
+    void set(Index n, const std::vector<ValueType>& values);
+
+    /// Set the list of element @a n from element @a sourceIndex of another @a sourceArray
+    virtual void set(const Index n, const AttributeArray& sourceArray, const Index sourceIndex);
+
+    /// @brief Copy the lists of @a count elements from @a sourceIndex of another @a sourceArray
+    /// of the same type into this array starting at element @a n (assumes uncompressed and in-core).
+    /// @note The value buffer is resized once and the values are copied in a single block.
+    virtual void copyValuesUnsafe(const Index n, const AttributeArray& sourceArray,
+                                  const Index sourceIndex, const Index count);
+
+    /// @brief Change the length of the list of element @a n, values beyond the existing
+    /// length are zero.
+    void resize(Index n, Index length);
+
+    /// @brief Replace all lists with lists of the given @a lengths filled with zero values.
+    /// @throw ValueError if the number of lengths does not match the size of the array.
+    void setLengths(const std::vector<Index>& lengths);
+
+    /// @brief Return the table of end offsets of each list in the value buffer.
+    /// @note Intended for bulk iteration of an uncompressed, in-core array. Any end offsets
+    /// deferred while appending in element order are written first.
+    const OffsetArray& offsets() { this->flushTail(); return *mOffsets; }
+    /// @brief Return the flat value buffer, the list of element @a n occupies the
+    /// positions offset(n) to offset(n) + length(n) - 1.
+    /// @note Intended for bulk iteration of an uncompressed, in-core array. The buffer
+    /// may be longer than totalLength() while values are being appended.
+    const ValueArray& values() const { return *mValues; }
+    ValueArray& values() { return *mValues; }
+
+    /// Return @c true if this array is stored as uniform empty lists.
+    virtual bool isUniform() const;
+    /// @brief  Replace uniform empty lists with an explicit offset table.
+    /// @note   The lists are unchanged, so the offset table is always filled.
+    virtual void expand(bool fill = true);
+    /// Replace the existing lists with empty lists.
+    virtual void collapse();
+    /// @brief Release any unused value buffer capacity, collapse the array if all lists
+    /// are empty and compact the offset table and value buffer where possible.
+    virtual bool compact();
+
+    /// Compress the offset table and value buffer.
+    virtual bool compress();
+    /// Uncompress the offset table and value buffer.
+    virtual bool decompress();
+
+    /// Read attribute data from a stream.
+    virtual void read(std::istream& is);
+    /// Write attribute data to a stream.
+    virtual void write(std::ostream& os) const;
+
+    /// Return @c true if the offsets or values have not yet been read from disk.
+    bool isOutOfCore() const;
+
+    /// Ensures all data is in-core
+    virtual void loadData() const;
+
+protected:
+    /// @throw TypeError as a variable-length array cannot be bound to an AttributeHandle.
+    virtual AccessorBasePtr getAccessor() const;
+
+    /// Compare the this data to another attribute array. Used by the base class comparison operator
+    virtual bool isEqual(const AttributeArray& other) const;
+
+private:
+    /// Load and uncompress both the offsets and the values.
+    void doLoad() const;
+
+    /// Return the end position of the list of element @a n (assumes uncompressed and in-core)
+    Index endUnsafe(Index n) const
+    {
+        // the lists from the tail onwards are empty and end with the list before the tail
+        if (n < mTail)  return mOffsets->getUnsafe(n);
+        return mTail == 0 ? Index(0) : mOffsets->getUnsafe(mTail - 1);
+    }
+    /// Return the position of the first value of element @a n (assumes uncompressed and in-core)
+    Index offsetUnsafe(Index n) const { return n == 0 ? Index(0) : this->endUnsafe(n - 1); }
+    /// Return the total number of values (assumes uncompressed and in-core)
+    Index totalLengthUnsafe() const { return this->endUnsafe(Index(mOffsets->size() - 1)); }
+
+    /// @brief Change the total length of the lists of elements [@a n, @a n + @a count) to
+    /// @a length, values beyond the existing lengths are zero. The end offset of the last of
+    /// these lists is updated, the end offsets of the others are left to the caller.
+    void resizeUnsafe(Index n, Index count, Index length);
+    /// Write the end offsets of the trailing empty lists deferred while appending.
+    void flushTail();
+
+    /// Reallocate the value buffer to @a capacity values, preserving the values in the
+    /// range [0, @a keep) and moving those in [@a end, @a total) to start at @a newEnd.
+    void reallocate(Index capacity, Index keep, Index end, Index total, Index newEnd);
+    /// Release any value buffer capacity beyond the total length.
+    void shrink();
+
+    /// Track the compressed state of the offsets and values in the base class.
+    void updateCompressedBytes();
+
+    /// Helper function for use with registerType()
+    static AttributeArray::Ptr factory(size_t n) { return VariableAttributeArray::create(n); }
+
+    static tbb::atomic<const NamePair*> sTypeName;
+    typename OffsetArray::Ptr   mOffsets;
+    typename ValueArray::Ptr    mValues;
+    // first element from which the stored end offsets are out-of-date
+    Index                       mTail;
+    tbb::spin_mutex             mMutex;
+}; // class VariableAttributeArray
+
+
+////////////////////////////////////////
+
+// VariableAttributeArray implementation
+
+template<typename ValueType_, typename Codec_>
+tbb::atomic<const NamePair*> VariableAttributeArray<ValueType_, Codec_>::sTypeName;
+
+
+template<typename ValueType_, typename Codec_>
+VariableAttributeArray<ValueType_, Codec_>::VariableAttributeArray(size_t n)
+    : AttributeArray()
+    , mOffsets(new OffsetArray(n))
+    , mValues(new ValueArray(1))
+    , mTail(Index(n))
+    , mMutex()
+{
+}
+
+
+template<typename ValueType_, typename Codec_>
+VariableAttributeArray<ValueType_, Codec_>::VariableAttributeArray(
+    const VariableAttributeArray& rhs, bool uncompress)
+    : AttributeArray(rhs)
+    , mOffsets(new OffsetArray(*rhs.mOffsets, uncompress))
+    , mValues(new ValueArray(*rhs.mValues, uncompress))
+    , mTail(rhs.mTail)
+    , mMutex()
+{
+    this->updateCompressedBytes();
+}
+
+
+template<typename ValueType_, typename Codec_>
+VariableAttributeArray<ValueType_, Codec_>&
+VariableAttributeArray<ValueType_, Codec_>::operator=(const VariableAttributeArray& rhs)
+{
+    if (&rhs != this) {
+        mFlags = rhs.mFlags;
+        mOffsets.reset(new OffsetArray(*rhs.mOffsets));
+        mValues.reset(new ValueArray(*rhs.mValues));
+        mTail = rhs.mTail;
+        this->updateCompressedBytes();
+    }
+    return *this;
+}
+
+
+template<typename ValueType_, typename Codec_>
+inline const NamePair&
+VariableAttributeArray<ValueType_, Codec_>::attributeType()
+{
+    if (sTypeName == NULL) {
+        std::ostringstream ostr;
+        ostr << typeNameAsString<ValueType>() << "[]";
+        NamePair* s = new NamePair(ostr.str(), ValueArray::attributeType().second);
+        if (sTypeName.compare_and_swap(s, NULL) != NULL) delete s;
+    }
+    return *sTypeName;
+}
+
+
+template<typename ValueType_, typename Codec_>
+inline bool
+VariableAttributeArray<ValueType_, Codec_>::isRegistered()
+{
+    return AttributeArray::isRegistered(VariableAttributeArray::attributeType());
+}
+
+
+template<typename ValueType_, typename Codec_>
+inline void
+VariableAttributeArray<ValueType_, Codec_>::registerType()
+{
+    AttributeArray::registerType(VariableAttributeArray::attributeType(), VariableAttributeArray::factory);
+}
+
+
+template<typename ValueType_, typename Codec_>
+inline void
+VariableAttributeArray<ValueType_, Codec_>::unregisterType()
+{
+    AttributeArray::unregisterType(VariableAttributeArray::attributeType());
+}
+
+
+template<typename ValueType_, typename Codec_>
+inline typename VariableAttributeArray<ValueType_, Codec_>::Ptr
+VariableAttributeArray<ValueType_, Codec_>::create(size_t n)
+{
+    return Ptr(new VariableAttributeArray(n));
+}
+
+
+template<typename ValueType_, typename Codec_>
+inline VariableAttributeArray<ValueType_, Codec_>&
+VariableAttributeArray<ValueType_, Codec_>::cast(AttributeArray& attributeArray)
+{
+    if (!attributeArray.isType<VariableAttributeArray>()) {
+        OPENVDB_THROW(TypeError, "Invalid Attribute Type");
+    }
+    return static_cast<VariableAttributeArray&>(attributeArray);
+}
+
+
+template<typename ValueType_, typename Codec_>
+inline const VariableAttributeArray<ValueType_, Codec_>&
+VariableAttributeArray<ValueType_, Codec_>::cast(const AttributeArray& attributeArray)
+{
+    if (!attributeArray.isType<VariableAttributeArray>()) {
+        OPENVDB_THROW(TypeError, "Invalid Attribute Type");
+    }
+    return static_cast<const VariableAttributeArray&>(attributeArray);
+}
+
+
+template<typename ValueType_, typename Codec_>
+AttributeArray::Ptr
+VariableAttributeArray<ValueType_, Codec_>::copy() const
+{
+    return AttributeArray::Ptr(new VariableAttributeArray<ValueType, Codec>(*this));
+}
+
+
+template<typename ValueType_, typename Codec_>
+AttributeArray::Ptr
+VariableAttributeArray<ValueType_, Codec_>::copyUncompressed() const
+{
+    return AttributeArray::Ptr(new VariableAttributeArray<ValueType, Codec>(*this, /*decompress = */true));
+}
+
+
+template<typename ValueType_, typename Codec_>
+size_t
+VariableAttributeArray<ValueType_, Codec_>::memUsage() const
+{
+    return sizeof(*this) + mOffsets->memUsage() + mValues->memUsage();
+}
+
+
+template<typename ValueType_, typename Codec_>
+Index
+VariableAttributeArray<ValueType_, Codec_>::length(Index n) const
+{
+    this->doLoad();
+
+    if (n >= this->size())  OPENVDB_THROW(IndexError, "Out-of-range access.");
+
+    return this->endUnsafe(n) - this->offsetUnsafe(n);
+}
+
+
+template<typename ValueType_, typename Codec_>
+Index
+VariableAttributeArray<ValueType_, Codec_>::offset(Index n) const
+{
+    this->doLoad();
+
+    if (n >= this->size())  OPENVDB_THROW(IndexError, "Out-of-range access.");
+
+    return this->offsetUnsafe(n);
+}
+
+
+template<typename ValueType_, typename Codec_>
+Index
+VariableAttributeArray<ValueType_, Codec_>::totalLength() const
+{
+    this->doLoad();
+
+    return this->totalLengthUnsafe();
+}
+
+
+template<typename ValueType_, typename Codec_>
+typename VariableAttributeArray<ValueType_, Codec_>::ValueType
+VariableAttributeArray<ValueType_, Codec_>::get(Index n, Index i) const
+{
+    if (i >= this->length(n))   OPENVDB_THROW(IndexError, "Out-of-range access.");
+
+    return mValues->getUnsafe(this->offsetUnsafe(n) + i);
+}
+
+
+template<typename ValueType_, typename Codec_>
+void
+VariableAttributeArray<ValueType_, Codec_>::get(Index n, std::vector<ValueType>& values) const
+{
+    const Index length = this->length(n);
+    const Index start = this->offsetUnsafe(n);
+
+    values.resize(length);
+
+    for (Index i = 0; i < length; i++) {
+        values[i] = mValues->getUnsafe(start + i);
+    }
+}
+
+
+template<typename ValueType_, typename Codec_>
+void
+VariableAttributeArray<ValueType_, Codec_>::set(Index n, Index i, const ValueType& value)
+{
+    if (i >= this->length(n))   OPENVDB_THROW(IndexError, "Out-of-range access.");
+
+    mValues->setUnsafe(this->offsetUnsafe(n) + i, value);
+}
+
+
+template<typename ValueType_, typename Codec_>
+void
+VariableAttributeArray<ValueType_, Codec_>::set(Index n, const std::vector<ValueType>& values)
+{
+    this->resize(n, Index(values.size()));
+
+    const Index start = this->offsetUnsafe(n);
+
+    for (Index i = 0; i < Index(values.size()); i++) {
+        mValues->setUnsafe(start + i, values[i]);
+    }
+}
+
+
+template<typename ValueType_, typename Codec_>
+void
+VariableAttributeArray<ValueType_, Codec_>::set(Index n, const AttributeArray& sourceArray, const Index sourceIndex)
+{
+    if (sourceArray.type() != this->type()) {
+        OPENVDB_THROW(TypeError, "Cannot copy values from an attribute of a different type.");
+    }
+
+    const VariableAttributeArray& sourceTypedArray = static_cast<const VariableAttributeArray&>(sourceArray);
+
+    const Index length = sourceTypedArray.length(sourceIndex);
+    const Index sourceStart = sourceTypedArray.offsetUnsafe(sourceIndex);
+
+    this->resize(n, length);
+
+    const Index start = this->offsetUnsafe(n);
+
+    for (Index i = 0; i < length; i++) {
+        mValues->setUnsafe(start + i, sourceTypedArray.mValues->getUnsafe(sourceStart + i));
+    }
+}
+
+
+template<typename ValueType_, typename Codec_>
+void
+VariableAttributeArray<ValueType_, Codec_>::copyValuesUnsafe(const Index n, const AttributeArray& sourceArray,
+                                                             const Index sourceIndex, const Index count)
+{
+    if (count == 0)     return;
+
+    if (sourceArray.type() != this->type()) {
+        OPENVDB_THROW(TypeError, "Cannot copy values from an attribute of a different type.");
+    }
+
+    const VariableAttributeArray& source = static_cast<const VariableAttributeArray&>(sourceArray);
+
+    assert(!this->isCompressed() && !source.isCompressed());
+    assert(!this->isOutOfCore() && !source.isOutOfCore());
+    assert(n + count <= this->size());
+
+    // a uniform source provides an empty list for all elements
+
+    const bool uniform = source.isUniform();
+
+    const Index sourceStart = source.offsetUnsafe(sourceIndex);
+    const Index sourceEnd = uniform ? sourceStart : source.endUnsafe(sourceIndex + count - 1);
+    const Index length = sourceEnd - sourceStart;
+
+    // resize all lists at once, then set the end offsets of all but the last list
+
+    const Index start = this->offsetUnsafe(n);
+
+    this->resizeUnsafe(n, count, length);
+
+    if (!uniform) {
+        for (Index i = 0; i < count - 1; i++) {
+            mOffsets->setUnsafe(n + i, Index32(start + source.endUnsafe(sourceIndex + i) - sourceStart));
+        }
+    }
+    else {
+        for (Index i = 0; i < count - 1; i++) {
+            mOffsets->setUnsafe(n + i, Index32(start));
+        }
+    }
+
+    if (length == 0)    return;
+
+    mValues->expand(/*fill=*/true);
+
+    if (source.mValues->isUniform()) {
+        std::fill(mValues->mData + start, mValues->mData + start + length, source.mValues->mData[0]);
+    }
+    else {
+        memcpy(mValues->mData + start, source.mValues->mData + sourceStart, length * sizeof(StorageType));
+    }
+}
+
+
+template<typename ValueType_, typename Codec_>
+void
+VariableAttributeArray<ValueType_, Codec_>::resize(Index n, Index length)
+{
+    this->doLoad();
+
+    if (n >= this->size())  OPENVDB_THROW(IndexError, "Out-of-range access.");
+
+    this->resizeUnsafe(n, 1, length);
+}
+
+
+template<typename ValueType_, typename Codec_>
+void
+VariableAttributeArray<ValueType_, Codec_>::setLengths(const std::vector<Index>& lengths)
+{
+    if (lengths.size() != this->size()) {
+        OPENVDB_THROW(ValueError, "Number of lengths (" << lengths.size() <<
+            ") does not match the size of the array (" << this->size() << ").");
+    }
+
+    typename OffsetArray::Ptr offsets(new OffsetArray(this->size()));
+
+    Index total = 0;
+    for (size_t n = 0; n < lengths.size(); n++) {
+        total += lengths[n];
+        offsets->setUnsafe(Index(n), Index32(total));
+    }
+
+    mOffsets = offsets;
+    mValues.reset(new ValueArray(std::max(Index(1), total)));
+    mTail = Index(this->size());
+
+    mCompressedBytes = 0;
+}
+
+
+template<typename ValueType_, typename Codec_>
+bool
+VariableAttributeArray<ValueType_, Codec_>::isUniform() const
+{
+    return mOffsets->isUniform() && mOffsets->get(0) == Index32(0);
+}
+
+
+template<typename ValueType_, typename Codec_>
+void
+VariableAttributeArray<ValueType_, Codec_>::expand(bool /*fill*/)
+{
+    this->doLoad();
+
+    mOffsets->expand(/*fill=*/true);
+}
+
+
+template<typename ValueType_, typename Codec_>
+void
+VariableAttributeArray<ValueType_, Codec_>::collapse()
+{
+    mOffsets.reset(new OffsetArray(this->size()));
+    mValues.reset(new ValueArray(1));
+    mTail = Index(this->size());
+
+    mCompressedBytes = 0;
+}
+
+
+template<typename ValueType_, typename Codec_>
+bool
+VariableAttributeArray<ValueType_, Codec_>::compact()
+{
+    if (this->isUniform())  return true;
+
+    this->doLoad();
+
+    if (this->totalLengthUnsafe() == 0) {
+        this->collapse();
+        return true;
+    }
+
+    this->shrink();
+    this->flushTail();
+
+    mOffsets->compact();
+    mValues->compact();
+
+    return false;
+}
+
+
+template<typename ValueType_, typename Codec_>
+bool
+VariableAttributeArray<ValueType_, Codec_>::compress()
+{
+    if (!this->isCompressed() && !this->isOutOfCore()) {
+        this->shrink();
+        this->flushTail();
+    }
+
+    mOffsets->compress();
+    mValues->compress();
+
+    this->updateCompressedBytes();
+
+    return this->isCompressed();
+}
+
+
+template<typename ValueType_, typename Codec_>
+bool
+VariableAttributeArray<ValueType_, Codec_>::decompress()
+{
+    const bool compressed = this->isCompressed();
+
+    mOffsets->decompress();
+    mValues->decompress();
+
+    this->updateCompressedBytes();
+
+    return compressed && !this->isCompressed();
+}
+
+
+template<typename ValueType_, typename Codec_>
+bool
+VariableAttributeArray<ValueType_, Codec_>::isOutOfCore() const
+{
+    return mOffsets->isOutOfCore() || mValues->isOutOfCore();
+}
+
+
+template<typename ValueType_, typename Codec_>
+void
+VariableAttributeArray<ValueType_, Codec_>::loadData() const
+{
+    mOffsets->loadData();
+    mValues->loadData();
+}
+
+
+template<typename ValueType_, typename Codec_>
+void
+VariableAttributeArray<ValueType_, Codec_>::read(std::istream& is)
+{
+    // read header
+
+    Int16 flags = Int16(0);
+    is.read(reinterpret_cast<char*>(&flags), sizeof(Int16));
+
+    mFlags = flags;
+
+    // read offsets and values
+
+    mOffsets->read(is);
+    mValues->read(is);
+
+    mTail = Index(this->size());
+
+    this->updateCompressedBytes();
+}
+
+
+template<typename ValueType_, typename Codec_>
+void
+VariableAttributeArray<ValueType_, Codec_>::write(std::ostream& os) const
+{
+    if (this->isTransient())    return;
+
+    // write header
+
+    const Int16 flags(mFlags);
+    os.write(reinterpret_cast<const char*>(&flags), sizeof(Int16));
+
+    // write offsets and values, any deferred end offsets are written to a copy of the
+    // offset table as the array is not modified on write
+
+    if (mTail < Index(this->size())) {
+        OffsetArray offsets(*mOffsets);
+        const Index end = this->endUnsafe(mTail);
+        for (Index m = mTail; m < Index(this->size()); m++) {
+            offsets.setUnsafe(m, Index32(end));
+        }
+        offsets.write(os);
+    }
+    else {
+        mOffsets->write(os);
+    }
+
+    // an uncompressed value buffer may have unused capacity from appending values,
+    // which is written as a trimmed copy as the array is not modified on write
+
+    if (!this->isCompressed() && !this->isOutOfCore() && !mValues->isUniform()) {
+        const Index total = std::max(Index(1), this->totalLengthUnsafe());
+        if (Index(mValues->size()) > total) {
+            ValueArray values(total);
+            values.expand(/*fill=*/false);
+            memcpy(values.mData, mValues->mData, total * sizeof(StorageType));
+            values.write(os);
+            return;
+        }
+    }
+
+    mValues->write(os);
+}
+
+
+template<typename ValueType_, typename Codec_>
+AttributeArray::AccessorBasePtr
+VariableAttributeArray<ValueType_, Codec_>::getAccessor() const
+{
+    // an AttributeHandle requires a single value per element
+
+    OPENVDB_THROW(TypeError, "Cannot bind an AttributeHandle to a variable-length attribute array.");
+}
+
+
+template<typename ValueType_, typename Codec_>
+bool
+VariableAttributeArray<ValueType_, Codec_>::isEqual(const AttributeArray& other) const
+{
+    const VariableAttributeArray* const otherT = dynamic_cast<const VariableAttributeArray*>(&other);
+    if (!otherT) return false;
+
+    if (this->mTail == Index(this->size()) && otherT->mTail == Index(otherT->size())) {
+        if (*this->mOffsets != *otherT->mOffsets) return false;
+    }
+    else {
+        // compare the end offsets of each list while any are deferred
+
+        if (this->size() != otherT->size()) return false;
+
+        this->doLoad();
+        otherT->doLoad();
+
+        for (Index n = 0; n < Index(this->size()); n++) {
+            if (this->endUnsafe(n) != otherT->endUnsafe(n))  return false;
+        }
+    }
+
+    // unused value buffer capacity is always zero so buffers of equal size can be compared directly
+
+    if (this->mValues->size() == otherT->mValues->size()) {
+        return *this->mValues == *otherT->mValues;
+    }
+
+    this->doLoad();
+    otherT->doLoad();
+
+    const Index total = this->totalLengthUnsafe();
+    for (Index i = 0; i < total; i++) {
+        if (!math::isExactlyEqual(this->mValues->getUnsafe(i), otherT->mValues->getUnsafe(i))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+template<typename ValueType_, typename Codec_>
+void
+VariableAttributeArray<ValueType_, Codec_>::doLoad() const
+{
+    if (!this->isCompressed() && !this->isOutOfCore())  return;
+
+    VariableAttributeArray* self = const_cast<VariableAttributeArray*>(this);
+
+    // decompress the offsets and values together to keep the compressed state consistent,
+    // this lock will be contended at most once, after which both arrays are in-core and
+    // uncompressed
+    tbb::spin_mutex::scoped_lock lock(self->mMutex);
+
+    if (this->isCompressed())   self->decompress();
+    else                        this->loadData();
+}
+
+
+template<typename ValueType_, typename Codec_>
+void
+VariableAttributeArray<ValueType_, Codec_>::resizeUnsafe(Index n, Index count, Index length)
+{
+    const Index last = n + count - 1;
+
+    const Index start = this->offsetUnsafe(n);
+    const Index end = this->endUnsafe(last);
+    const Index total = this->totalLengthUnsafe();
+
+    if (end - start == length)  return;
+
+    const Index newEnd = start + length;
+    const Index newTotal = total - (end - start) + length;
+
+    // the capacity of the value buffer is its size, one value is always allocated
+
+    const Index capacity = Index(mValues->size());
+
+    if (end == total && newTotal <= capacity) {
+        // the following lists are empty and the value buffer is large enough, so only
+        // reset the values that are added or removed to keep the unused capacity zero
+        for (Index i = std::min(end, newEnd); i < std::max(end, newEnd); i++) {
+            mValues->setUnsafe(i, zeroVal<ValueType>());
+        }
+    }
+    else {
+        // grow the value buffer geometrically when appending to the last non-empty list
+        const Index newCapacity = end == total ? std::max(newTotal, Index(2) * total) : newTotal;
+        this->reallocate(newCapacity, std::min(end, newEnd), end, total, newEnd);
+    }
+
+    if (end == total) {
+        // the following lists are empty, so their end offsets are deferred by moving the
+        // tail rather than shifted, which keeps appending in element order linear
+        for (Index m = mTail; m < n; m++) {
+            mOffsets->setUnsafe(m, Index32(start));
+        }
+        mOffsets->setUnsafe(last, Index32(newEnd));
+        mTail = last + 1;
+    }
+    else {
+        // shift the end offsets of the last and all following lists up to the tail
+        for (Index m = last; m < mTail; m++) {
+            mOffsets->setUnsafe(m, Index32(mOffsets->getUnsafe(m) - end + newEnd));
+        }
+    }
+}
+
+
+template<typename ValueType_, typename Codec_>
+void
+VariableAttributeArray<ValueType_, Codec_>::flushTail()
+{
+    if (mTail >= Index(this->size()))   return;
+
+    const Index end = this->endUnsafe(mTail);
+
+    for (Index m = mTail; m < Index(this->size()); m++) {
+        mOffsets->setUnsafe(m, Index32(end));
+    }
+    mTail = Index(this->size());
+}
+
+
+template<typename ValueType_, typename Codec_>
+void
+VariableAttributeArray<ValueType_, Codec_>::reallocate(Index capacity, Index keep,
+    Index end, Index total, Index newEnd)
+{
+    // a new value buffer is filled with zero values
+
+    typename ValueArray::Ptr values(new ValueArray(std::max(Index(1), capacity)));
+    values->expand(/*fill=*/true);
+
+    mValues->expand(/*fill=*/true);
+
+    if (keep > 0) {
+        memcpy(values->mData, mValues->mData, keep * sizeof(StorageType));
+    }
+    if (total > end) {
+        memcpy(values->mData + newEnd, mValues->mData + end, (total - end) * sizeof(StorageType));
+    }
+
+    mValues = values;
+}
+
+
+template<typename ValueType_, typename Codec_>
+void
+VariableAttributeArray<ValueType_, Codec_>::shrink()
+{
+    const Index total = std::max(Index(1), this->totalLengthUnsafe());
+
+    if (mValues->isUniform() || Index(mValues->size()) <= total)  return;
+
+    this->reallocate(total, total, total, total, total);
+}
+
+
+template<typename ValueType_, typename Codec_>
+void
+VariableAttributeArray<ValueType_, Codec_>::updateCompressedBytes()
+{
+    // the base class reports the combined memory usage while either array is compressed
+
+    mCompressedBytes = 0;
+
+    if (mOffsets->isCompressed() || mValues->isCompressed()) {
+        mCompressedBytes = mOffsets->memUsage() + mValues->memUsage();
+    }
+}
+
+
+////////////////////////////////////////
+
+
+} // namespace tools
+} // namespace OPENVDB_VERSION_NAME
+} // namespace openvdb
+
+
+#endif // OPENVDB_TOOLS_ATTRIBUTE_VARIABLE_HAS_BEEN_INCLUDED
+
+
+// Copyright (c) 2015-2016 Double Negative Visual Effects
+// All rights reserved. This software is distributed under the
+// Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
@@ -44,6 +44,7 @@
 
 #include <openvdb/math/Transform.h>
 #include <openvdb/tools/Interpolation.h>
+#include <openvdb/tree/LeafManager.h>
 
 #include <openvdb_points/tools/IndexIterator.h>
 #include <openvdb_points/tools/AttributeArray.h>
@@ -51,6 +52,12 @@
 
 #include <boost/random/uniform_real_distribution.hpp>
 #include <boost/ptr_container/ptr_vector.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/functional/hash.hpp>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_scan.h>
 
 namespace openvdb {
 OPENVDB_USE_VERSION_NAMESPACE
@@ -104,6 +111,111 @@ void generateRandomSubset(std::vector<IntType>& values, const unsigned int seed,
 }
 
 
+struct CoordHash
+{
+    size_t operator()(const Coord& ijk) const {
+        size_t seed = 0;
+        boost::hash_combine(seed, ijk[0]);
+        boost::hash_combine(seed, ijk[1]);
+        boost::hash_combine(seed, ijk[2]);
+        return seed;
+    }
+};
+
+
+template <typename PointDataTreeT>
+struct LeafPointCountOp
+{
+    typedef typename tree::LeafManager<const PointDataTreeT> LeafManagerT;
+
+    LeafPointCountOp(std::vector<Coord>& origins, std::vector<Index64>& counts)
+        : mOrigins(origins)
+        , mCounts(counts) { }
+
+    void operator()(const typename LeafManagerT::LeafRange& range) const {
+        for (typename LeafManagerT::LeafRange::Iterator leaf = range.begin(); leaf; ++leaf) {
+            mOrigins[leaf.pos()] = leaf->origin();
+            mCounts[leaf.pos()] = leaf->pointCount();
+        }
+    }
+
+    std::vector<Coord>& mOrigins;
+    std::vector<Index64>& mCounts;
+}; // struct LeafPointCountOp
+
+
+// in-place inclusive prefix sum
+struct PrefixSumOp
+{
+    typedef tbb::blocked_range<size_t> RangeT;
+
+    PrefixSumOp(std::vector<Index64>& values)
+        : mValues(values)
+        , mSum(0) { }
+
+    PrefixSumOp(PrefixSumOp& other, tbb::split)
+        : mValues(other.mValues)
+        , mSum(0) { }
+
+    template <typename TagT>
+    void operator()(const RangeT& range, TagT) {
+        Index64 sum = mSum;
+        for (size_t n = range.begin(), N = range.end(); n < N; ++n) {
+            sum += mValues[n];
+            if (TagT::is_final_scan())  mValues[n] = sum;
+        }
+        mSum = sum;
+    }
+
+    void reverse_join(PrefixSumOp& other) { mSum = other.mSum + mSum; }
+    void assign(PrefixSumOp& other) { mSum = other.mSum; }
+
+    std::vector<Index64>& mValues;
+    Index64 mSum;
+}; // struct PrefixSumOp
+
+
+// distribute the target points across the leaves in proportion to the cumulative
+// point counts, each leaf receives floor(factor * C[i]) - floor(factor * C[i-1])
+// points so that allocation is independent per leaf
+template <typename SeedCountPairT>
+struct AllocateLeafPointsOp
+{
+    typedef tbb::blocked_range<size_t> RangeT;
+
+    AllocateLeafPointsOp(   std::vector<SeedCountPairT>& leafSeeds,
+                            const std::vector<Index64>& cumulativeCounts,
+                            const std::vector<unsigned int>& seeds,
+                            const double factor,
+                            const Index64 targetPoints)
+        : mLeafSeeds(leafSeeds)
+        , mCumulativeCounts(cumulativeCounts)
+        , mSeeds(seeds)
+        , mFactor(factor)
+        , mTargetPoints(targetPoints) { }
+
+    Index64 allocated(const size_t n) const {
+        return Index64(std::floor(mFactor * double(mCumulativeCounts[n])));
+    }
+
+    void operator()(const RangeT& range) const {
+        const size_t last = mCumulativeCounts.size() - 1;
+        for (size_t n = range.begin(), N = range.end(); n < N; ++n) {
+            const Index64 previous = n == 0 ? 0 : this->allocated(n-1);
+            // for the last leaf - use the remaining points to reach the target points
+            const Index64 current = n == last ? std::max(mTargetPoints, previous) : this->allocated(n);
+            mLeafSeeds[n] = SeedCountPairT(mSeeds[n], Index(current - previous));
+        }
+    }
+
+    std::vector<SeedCountPairT>& mLeafSeeds;
+    const std::vector<Index64>& mCumulativeCounts;
+    const std::vector<unsigned int>& mSeeds;
+    const double mFactor;
+    const Index64 mTargetPoints;
+}; // struct AllocateLeafPointsOp
+
+
 } // namespace index_filter_internal
 
 
@@ -181,7 +293,9 @@ public:
     struct Data
     {
         typedef std::pair<Index, Index> SeedCountPair;
-        typedef std::map<openvdb::Coord, SeedCountPair> LeafMap;
+        typedef boost::unordered_map<openvdb::Coord, SeedCountPair,
+                                     index_filter_internal::CoordHash> LeafMap;
+        typedef std::vector<std::pair<openvdb::Coord, SeedCountPair> > LeafArray;
 
         Data() { }
 
@@ -190,30 +304,10 @@ public:
                                     const Index64 targetPoints,
                                     const unsigned int seed = 0)
         {
-            const Index64 currentPoints = pointCount(tree);
-            const float factor = targetPoints > currentPoints ? 1.0f : float(targetPoints) / float(currentPoints);
-
-            math::RandInt<unsigned int, boost::mt19937> randGen(seed, 0, std::numeric_limits<unsigned int>::max()-1);
-
-            Index32 leafCounter = 0;
-            float totalPointsFloat = 0.0f;
-            int totalPoints = 0;
-            for (typename PointDataTreeT::LeafCIter iter = tree.cbeginLeaf(); iter; ++iter) {
-                // for the last leaf - use the remaining points to reach the target points
-                if (leafCounter + 1 == tree.leafCount()) {
-                    const int leafPoints = targetPoints - totalPoints;
-                    leafMap[iter->origin()] = SeedCountPair(randGen(), leafPoints);
-                    break;
-                }
-                totalPointsFloat += factor * iter->pointCount();
-                const int leafPoints = math::Floor(totalPointsFloat);
-                totalPointsFloat -= leafPoints;
-                totalPoints += leafPoints;
-
-                leafMap[iter->origin()] = SeedCountPair(randGen(), leafPoints);
-
-                leafCounter++;
-            }
+            std::vector<Coord> origins;
+            std::vector<Index64> counts;
+            this->cumulativeLeafPointCounts(tree, origins, counts);
+            this->allocate(origins, counts, targetPoints, seed);
         }
 
         template <typename PointDataTreeT>
@@ -221,13 +315,85 @@ public:
                                         const float percentage = 10.0f,
                                         const unsigned int seed = 0)
         {
-            const int currentPoints = pointCount(tree);
-            const int targetPoints = int(math::Round((percentage * currentPoints)/100.0f));
+            std::vector<Coord> origins;
+            std::vector<Index64> counts;
+            this->cumulativeLeafPointCounts(tree, origins, counts);
+
+            const Index64 currentPoints = counts.empty() ? 0 : counts.back();
+            const Index64 targetPoints = Index64(math::Round((percentage * double(currentPoints))/100.0));
 
-            populateByTargetPoints(tree, targetPoints, seed);
+            this->allocate(origins, counts, targetPoints, seed);
+        }
+
+        /// @brief Return the seed and count for the leaf at position @a leafIndex in a
+        /// LeafManager of the tree used to populate this data, or @c NULL if the index
+        /// does not refer to a leaf with the given @a origin.
+        const SeedCountPair* seedCount(const Index leafIndex, const openvdb::Coord& origin) const
+        {
+            if (leafIndex < leafArray.size() && leafArray[leafIndex].first == origin) {
+                return &leafArray[leafIndex].second;
+            }
+            return NULL;
         }
 
         LeafMap leafMap;
+        LeafArray leafArray;
+
+    private:
+        template <typename PointDataTreeT>
+        void cumulativeLeafPointCounts( const PointDataTreeT& tree,
+                                        std::vector<Coord>& origins,
+                                        std::vector<Index64>& counts) const
+        {
+            typedef index_filter_internal::LeafPointCountOp<PointDataTreeT> LeafPointCountOp;
+
+            typename LeafPointCountOp::LeafManagerT leafManager(tree);
+
+            origins.resize(leafManager.leafCount());
+            counts.resize(leafManager.leafCount());
+
+            LeafPointCountOp countOp(origins, counts);
+            tbb::parallel_for(leafManager.leafRange(), countOp);
+
+            index_filter_internal::PrefixSumOp scanOp(counts);
+            tbb::parallel_scan(tbb::blocked_range<size_t>(0, counts.size()), scanOp);
+        }
+
+        void allocate(  const std::vector<Coord>& origins,
+                        const std::vector<Index64>& counts,
+                        const Index64 targetPoints,
+                        const unsigned int seed)
+        {
+            leafMap.clear();
+            leafArray.clear();
+
+            if (counts.empty())     return;
+
+            const Index64 currentPoints = counts.back();
+            const double factor = (targetPoints > currentPoints || currentPoints == 0) ?
+                                    1.0 : double(targetPoints) / double(currentPoints);
+
+            // seeds are drawn serially to remain deterministic for a given tree
+
+            math::RandInt<unsigned int, boost::mt19937> randGen(seed, 0, std::numeric_limits<unsigned int>::max()-1);
+
+            std::vector<unsigned int> seeds(counts.size());
+            for (size_t n = 0; n < seeds.size(); n++)    seeds[n] = randGen();
+
+            std::vector<SeedCountPair> leafSeeds(counts.size());
+
+            index_filter_internal::AllocateLeafPointsOp<SeedCountPair> allocateOp(
+                leafSeeds, counts, seeds, factor, targetPoints);
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, counts.size()), allocateOp);
+
+            leafArray.resize(counts.size());
+            leafMap.rehash(counts.size());
+
+            for (size_t n = 0; n < counts.size(); n++) {
+                leafArray[n] = std::make_pair(origins[n], leafSeeds[n]);
+                leafMap[origins[n]] = leafSeeds[n];
+            }
+        }
     }; // struct Data
 
     RandomLeafFilter(const unsigned int seed, const Index count, const Index total)
@@ -246,13 +412,28 @@ public:
         if (it == data.leafMap.end()) {
             OPENVDB_THROW(openvdb::KeyError, "Cannot find leaf origin in map for random filter - " << leaf.origin());
         }
-        const typename Data::SeedCountPair& value = it->second;
+        return create(leaf, it->second);
+    }
+
+    /// @brief Create the filter using the position of the leaf in a LeafManager
+    /// for a constant-time lookup, falling back to a search by leaf origin.
+    template <typename LeafT>
+    static RandomLeafFilter create(const LeafT& leaf, const Data& data, const Index leafIndex) {
+        const typename Data::SeedCountPair* value = data.seedCount(leafIndex, leaf.origin());
+        if (!value)     return create(leaf, data);
+        return create(leaf, *value);
+    }
+
+private:
+    template <typename LeafT>
+    static RandomLeafFilter create(const LeafT& leaf, const typename Data::SeedCountPair& value) {
         const unsigned int seed = (unsigned int) value.first;
         const Index total = leaf.pointCount();
         const Index count = std::min(value.second, total);
         return RandomLeafFilter(seed, count, total);
     }
 
+public:
     inline void next() const {
         mSubsetOffset++;
         mNextIndex =    mSubsetOffset >= mCount ?
@@ -491,6 +672,42 @@ struct FilterTraits<BinaryFilter<T0, T1, And> > {
 ////////////////////////////////////////
 
 
+/// @brief Create a filter for a leaf at a known position within a LeafManager,
+/// enabling filters that pre-compute per-leaf data to index it directly.
+template <typename FilterT>
+struct FilterFactory
+{
+    template <typename LeafT>
+    static FilterT create(const LeafT& leaf, const typename FilterT::Data& data, const Index /*leafIndex*/) {
+        return FilterT::create(leaf, data);
+    }
+};
+template <typename RandGenT>
+struct FilterFactory<RandomLeafFilter<RandGenT> >
+{
+    typedef RandomLeafFilter<RandGenT> FilterT;
+
+    template <typename LeafT>
+    static FilterT create(const LeafT& leaf, const typename FilterT::Data& data, const Index leafIndex) {
+        return FilterT::create(leaf, data, leafIndex);
+    }
+};
+template <typename T1, typename T2, bool And>
+struct FilterFactory<BinaryFilter<T1, T2, And> >
+{
+    typedef BinaryFilter<T1, T2, And> FilterT;
+
+    template <typename LeafT>
+    static FilterT create(const LeafT& leaf, const typename FilterT::Data& data, const Index leafIndex) {
+        return FilterT( FilterFactory<T1>::create(leaf, data.filterData1, leafIndex),
+                        FilterFactory<T2>::create(leaf, data.filterData2, leafIndex));
+    }
+};
+
+
+////////////////////////////////////////
+
+
 } // namespace tools
 } // namespace OPENVDB_VERSION_NAME
 } // namespace openvdb
@@ -0,0 +1,217 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2015-2016 Double Negative Visual Effects
+//
+// All rights reserved. This software is distributed under the
+// Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
+//
+// Redistributions of source code must retain the above copyright
+// and license notice and the following restrictions and disclaimer.
+//
+// *     Neither the name of Double Negative Visual Effects nor the names
+// of its contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// IN NO EVENT SHALL THE COPYRIGHT HOLDERS' AND CONTRIBUTORS' AGGREGATE
+// LIABILITY FOR ALL CLAIMS REGARDLESS OF THEIR BASIS EXCEED US$250.00.
+//
+///////////////////////////////////////////////////////////////////////////
+//
+/// @file Instrumentation.cc
+
+#include <openvdb_points/tools/Instrumentation.h>
+
+#include <tbb/atomic.h>
+#include <tbb/enumerable_thread_specific.h>
+
+#include <iomanip> // std::setw
+
+namespace openvdb {
+OPENVDB_USE_VERSION_NAMESPACE
+namespace OPENVDB_VERSION_NAME {
+namespace tools {
+namespace instrumentation {
+
+
+namespace instrumentation_internal {
+
+// Declare this at file scope, atomics are zero-initialized prior to any dynamic initialization.
+tbb::atomic<Int32> sEnabled;
+
+} // namespace instrumentation_internal
+
+
+namespace {
+
+using instrumentation_internal::sEnabled;
+
+// Counters and timers of a single thread, these are only modified by their own thread so
+// updates are uncontended loads and stores rather than read-modify-writes of a shared value
+struct LocalTotals
+{
+    LocalTotals() { this->clear(); }
+
+    void clear()
+    {
+        for (int i = 0; i < NUM_COUNTERS; i++)  counters[i] = 0;
+        for (int i = 0; i < NUM_TIMERS; i++) {
+            timerCalls[i] = 0;
+            timerNanoseconds[i] = 0;
+        }
+    }
+
+    tbb::atomic<Index64> counters[NUM_COUNTERS];
+    tbb::atomic<Index64> timerCalls[NUM_TIMERS];
+    tbb::atomic<Index64> timerNanoseconds[NUM_TIMERS];
+};
+
+typedef tbb::enumerable_thread_specific<LocalTotals> LocalTotalsT;
+
+// Declare this at file scope to ensure thread-safe initialization.
+LocalTotalsT sLocalTotals;
+
+const char* sCounterNames[NUM_COUNTERS] = {
+    "bytes compressed",
+    "bytes decompressed",
+    "pages decompressed",
+    "page cache hits",
+    "arrays loaded",
+    "bytes loaded",
+    "expand calls",
+    "collapse calls",
+    "registry lookups"
+};
+
+const char* sTimerNames[NUM_TIMERS] = {
+    "read",
+    "write",
+    "compress",
+    "decompress"
+};
+
+} // unnamed namespace
+
+
+////////////////////////////////////////
+
+
+void
+setEnabled(const bool enabled)
+{
+    sEnabled = enabled ? 1 : 0;
+}
+
+
+void
+reset()
+{
+    for (LocalTotalsT::iterator it = sLocalTotals.begin(); it != sLocalTotals.end(); ++it) {
+        it->clear();
+    }
+}
+
+
+Index64
+count(const Counter counter)
+{
+    Index64 total = 0;
+    for (LocalTotalsT::const_iterator it = sLocalTotals.begin(); it != sLocalTotals.end(); ++it) {
+        total += it->counters[counter];
+    }
+    return total;
+}
+
+
+Index64
+calls(const Timer timer)
+{
+    Index64 total = 0;
+    for (LocalTotalsT::const_iterator it = sLocalTotals.begin(); it != sLocalTotals.end(); ++it) {
+        total += it->timerCalls[timer];
+    }
+    return total;
+}
+
+
+double
+seconds(const Timer timer)
+{
+    Index64 total = 0;
+    for (LocalTotalsT::const_iterator it = sLocalTotals.begin(); it != sLocalTotals.end(); ++it) {
+        total += it->timerNanoseconds[timer];
+    }
+    return double(total) * 1e-9;
+}
+
+
+const char*
+name(const Counter counter)
+{
+    return sCounterNames[counter];
+}
+
+
+const char*
+name(const Timer timer)
+{
+    return sTimerNames[timer];
+}
+
+
+void
+print(std::ostream& os, const std::string& indent)
+{
+    os << indent << "Counters:" << std::endl;
+    for (int i = 0; i < NUM_COUNTERS; i++) {
+        os << indent << "  " << std::left << std::setw(20) << sCounterNames[i]
+           << std::right << count(Counter(i)) << std::endl;
+    }
+
+    os << indent << "Timers:" << std::endl;
+    for (int i = 0; i < NUM_TIMERS; i++) {
+        const Timer timer = Timer(i);
+        os << indent << "  " << std::left << std::setw(20) << sTimerNames[i]
+           << std::right << seconds(timer) << "s (" << calls(timer) << " call"
+           << (calls(timer) == 1 ? "" : "s") << ")" << std::endl;
+    }
+}
+
+
+void
+instrumentation_internal::incrementCounter(const Counter counter, const Index64 n)
+{
+    LocalTotals& local = sLocalTotals.local();
+    local.counters[counter] = local.counters[counter] + n;
+}
+
+
+void
+accumulate(const Timer timer, const double time)
+{
+    if (sEnabled == 0)  return;
+    LocalTotals& local = sLocalTotals.local();
+    local.timerCalls[timer] = local.timerCalls[timer] + 1;
+    local.timerNanoseconds[timer] = local.timerNanoseconds[timer] + Index64(time * 1e9);
+}
+
+
+} // namespace instrumentation
+} // namespace tools
+} // namespace OPENVDB_VERSION_NAME
+} // namespace openvdb
+
+
+// Copyright (c) 2015-2016 Double Negative Visual Effects
+// All rights reserved. This software is distributed under the
+// Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
@@ -0,0 +1,173 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2015-2016 Double Negative Visual Effects
+//
+// All rights reserved. This software is distributed under the
+// Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
+//
+// Redistributions of source code must retain the above copyright
+// and license notice and the following restrictions and disclaimer.
+//
+// *     Neither the name of Double Negative Visual Effects nor the names
+// of its contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// IN NO EVENT SHALL THE COPYRIGHT HOLDERS' AND CONTRIBUTORS' AGGREGATE
+// LIABILITY FOR ALL CLAIMS REGARDLESS OF THEIR BASIS EXCEED US$250.00.
+//
+///////////////////////////////////////////////////////////////////////////
+//
+/// @file Instrumentation.h
+///
+/// @brief  Runtime-switchable counters and timers for the attribute storage hot paths.
+///
+/// Instrumentation is disabled by default, in which case each instrumented call costs a
+/// single check of a global flag. It can be enabled with setEnabled() or by setting the
+/// OPENVDB_POINTS_INSTRUMENTATION environment variable before calling
+/// openvdb::points::initialize().
+///
+/// @code
+///    instrumentation::setEnabled(true);
+///    // read, modify and write points
+///    instrumentation::print(std::cout);
+/// @endcode
+///
+
+
+#ifndef OPENVDB_TOOLS_INSTRUMENTATION_HAS_BEEN_INCLUDED
+#define OPENVDB_TOOLS_INSTRUMENTATION_HAS_BEEN_INCLUDED
+
+#include <openvdb/Types.h>
+
+#include <tbb/atomic.h>
+#include <tbb/tick_count.h>
+
+#include <iostream>
+
+namespace openvdb {
+OPENVDB_USE_VERSION_NAMESPACE
+namespace OPENVDB_VERSION_NAME {
+namespace tools {
+namespace instrumentation {
+
+
+enum Counter {
+    BYTES_COMPRESSED = 0,       // uncompressed bytes passed to a successful compression
+    BYTES_DECOMPRESSED,         // uncompressed bytes produced by decompression
+    PAGES_DECOMPRESSED,         // pages of paged arrays decompressed into the page cache
+    PAGE_CACHE_HITS,            // pages of paged arrays found in the page cache
+    ARRAYS_LOADED,              // attribute arrays loaded from out-of-core storage
+    BYTES_LOADED,               // bytes read from disk when loading out-of-core arrays
+    EXPAND_CALLS,               // calls to AttributeArray::expand()
+    COLLAPSE_CALLS,             // calls to AttributeArray::collapse()
+    REGISTRY_LOOKUPS,           // lookups in the attribute type registry
+    NUM_COUNTERS
+};
+
+enum Timer {
+    READ_TIMER = 0,             // reading attribute arrays from a stream
+    WRITE_TIMER,                // writing attribute arrays to a stream (includes compression)
+    COMPRESS_TIMER,             // compressing buffers
+    DECOMPRESS_TIMER,           // decompressing buffers
+    NUM_TIMERS
+};
+
+
+namespace instrumentation_internal {
+
+/// Global enabled flag, exposed so that the disabled path is inlined at each call site
+extern tbb::atomic<Int32> sEnabled;
+
+/// Add @a n to a counter regardless of whether instrumentation is enabled.
+void incrementCounter(const Counter counter, const Index64 n);
+
+} // namespace instrumentation_internal
+
+
+/// @brief Enable or disable the collection of counters and timers.
+void setEnabled(const bool enabled);
+
+/// @brief Return @c true if counters and timers are being collected.
+inline bool isEnabled() { return instrumentation_internal::sEnabled != 0; }
+
+/// @brief Reset all counters and timers to zero.
+void reset();
+
+/// @brief Return the current value of a counter.
+/// @note Counters and timers are accumulated per thread and combined when read, so they
+/// should be read or reset once the instrumented work has completed.
+Index64 count(const Counter counter);
+
+/// @brief Return the number of times a timer has been started.
+Index64 calls(const Timer timer);
+
+/// @brief Return the total time in seconds accumulated by a timer.
+double seconds(const Timer timer);
+
+/// @brief Return the name of a counter.
+const char* name(const Counter counter);
+
+/// @brief Return the name of a timer.
+const char* name(const Timer timer);
+
+/// @brief Print all counters and timers to a stream.
+void print(std::ostream& os = std::cout, const std::string& indent = "");
+
+/// @brief Add @a n to a counter if instrumentation is enabled.
+inline void increment(const Counter counter, const Index64 n = 1)
+{
+    if (!isEnabled())   return;
+    instrumentation_internal::incrementCounter(counter, n);
+}
+
+/// @brief Add a time interval to a timer if instrumentation is enabled.
+void accumulate(const Timer timer, const double time);
+
+
+/// @brief Accumulate the time from construction to destruction into a timer.
+/// @note The timer is inactive if instrumentation is disabled on construction.
+class ScopedTimer
+{
+public:
+    explicit ScopedTimer(const Timer timer)
+        : mTimer(timer)
+        , mEnabled(isEnabled())
+    {
+        if (mEnabled)   mStart = tbb::tick_count::now();
+    }
+
+    ~ScopedTimer()
+    {
+        if (mEnabled)   accumulate(mTimer, (tbb::tick_count::now() - mStart).seconds());
+    }
+
+private:
+    const Timer mTimer;
+    const bool mEnabled;
+    tbb::tick_count mStart;
+}; // class ScopedTimer
+
+
+} // namespace instrumentation
+} // namespace tools
+} // namespace OPENVDB_VERSION_NAME
+} // namespace openvdb
+
+
+#endif // OPENVDB_TOOLS_INSTRUMENTATION_HAS_BEEN_INCLUDED
+
+
+// Copyright (c) 2015-2016 Double Negative Visual Effects
+// All rights reserved. This software is distributed under the
+// Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
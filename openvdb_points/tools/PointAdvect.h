@@ -0,0 +1,167 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2015-2016 Double Negative Visual Effects
+//
+// All rights reserved. This software is distributed under the
+// Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
+//
+// Redistributions of source code must retain the above copyright
+// and license notice and the following restrictions and disclaimer.
+//
+// *     Neither the name of Double Negative Visual Effects nor the names
+// of its contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// IN NO EVENT SHALL THE COPYRIGHT HOLDERS' AND CONTRIBUTORS' AGGREGATE
+// LIABILITY FOR ALL CLAIMS REGARDLESS OF THEIR BASIS EXCEED US$250.00.
+//
+///////////////////////////////////////////////////////////////////////////
+//
+/// @file PointAdvect.h
+///
+/// @brief  Advect the points of a VDB Point Grid through a velocity grid.
+///
+
+
+#ifndef OPENVDB_TOOLS_POINT_ADVECT_HAS_BEEN_INCLUDED
+#define OPENVDB_TOOLS_POINT_ADVECT_HAS_BEEN_INCLUDED
+
+#include <openvdb/openvdb.h>
+#include <openvdb/tools/VelocityFields.h>
+
+#include <openvdb_points/tools/PointDataGrid.h>
+#include <openvdb_points/tools/PointMove.h>
+
+#include <boost/shared_ptr.hpp>
+
+namespace openvdb {
+OPENVDB_USE_VERSION_NAMESPACE
+namespace OPENVDB_VERSION_NAME {
+namespace tools {
+
+
+/// @brief Advect the points of a PointDataGrid through a velocity grid.
+///
+/// @param points               the PointDataGrid.
+/// @param velocity             the velocity grid, sampled as a staggered grid if the
+///                             grid class is GRID_STAGGERED.
+/// @param dt                   the time step.
+/// @param integrationOrder     the order of the Runge-Kutta integration, 1 for forward
+///                             Euler, 2 for RK2, 3 for RK3 and 4 for RK4.
+///
+/// @note Points that move into a different voxel or leaf are re-bucketed along with
+/// all of their attributes and group membership using movePoints().
+template <typename PointDataGridT, typename VelGridT>
+inline void advectPoints(   PointDataGridT& points,
+                            const VelGridT& velocity,
+                            const double dt,
+                            const int integrationOrder = 1);
+
+
+////////////////////////////////////////
+
+
+namespace point_advect_internal {
+
+
+/// @brief Deformer that integrates world-space positions through a velocity grid
+template <typename VelGridT, bool Staggered, size_t Order>
+class AdvectionDeformer
+{
+public:
+    typedef VelocityIntegrator<VelGridT, Staggered>             IntegratorT;
+    typedef typename IntegratorT::ElementType                   ElementType;
+
+    AdvectionDeformer(const VelGridT& velocity, const double dt)
+        : mVelocity(velocity)
+        , mDt(dt) { }
+
+    template <typename LeafT>
+    void reset(const LeafT&, size_t)
+    {
+        // the integrator (and hence the velocity accessor) is created lazily so
+        // that every copy of the deformer owns its own
+
+        if (!mIntegrator)   mIntegrator.reset(new IntegratorT(mVelocity));
+    }
+
+    template <typename IterT>
+    void apply(Vec3d& position, const IterT&) const
+    {
+        mIntegrator->template rungeKutta<Order>(ElementType(mDt), position);
+    }
+
+private:
+    const VelGridT&                     mVelocity;
+    const double                        mDt;
+    boost::shared_ptr<IntegratorT>      mIntegrator;
+}; // class AdvectionDeformer
+
+
+template <typename PointDataGridT, typename VelGridT, bool Staggered>
+inline void
+advectPoints(PointDataGridT& points, const VelGridT& velocity, const double dt,
+             const int integrationOrder)
+{
+    switch (integrationOrder) {
+        case 1: movePoints(points, AdvectionDeformer<VelGridT, Staggered, 1>(velocity, dt)); break;
+        case 2: movePoints(points, AdvectionDeformer<VelGridT, Staggered, 2>(velocity, dt)); break;
+        case 3: movePoints(points, AdvectionDeformer<VelGridT, Staggered, 3>(velocity, dt)); break;
+        case 4: movePoints(points, AdvectionDeformer<VelGridT, Staggered, 4>(velocity, dt)); break;
+        default: OPENVDB_THROW(ValueError, "Unsupported integration order - " << integrationOrder << ".");
+    }
+}
+
+
+} // namespace point_advect_internal
+
+
+////////////////////////////////////////
+
+
+template <typename PointDataGridT, typename VelGridT>
+inline void advectPoints(   PointDataGridT& points,
+                            const VelGridT& velocity,
+                            const double dt,
+                            const int integrationOrder)
+{
+    if (integrationOrder < 1 || integrationOrder > 4) {
+        OPENVDB_THROW(ValueError, "Unsupported integration order - " << integrationOrder << ".");
+    }
+
+    if (velocity.getGridClass() == GRID_STAGGERED) {
+        point_advect_internal::advectPoints<PointDataGridT, VelGridT, true>(
+            points, velocity, dt, integrationOrder);
+    }
+    else {
+        point_advect_internal::advectPoints<PointDataGridT, VelGridT, false>(
+            points, velocity, dt, integrationOrder);
+    }
+}
+
+
+////////////////////////////////////////
+
+
+} // namespace tools
+} // namespace OPENVDB_VERSION_NAME
+} // namespace openvdb
+
+
+#endif // OPENVDB_TOOLS_POINT_ADVECT_HAS_BEEN_INCLUDED
+
+
+// Copyright (c) 2015-2016 Double Negative Visual Effects
+// All rights reserved. This software is distributed under the
+// Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
@@ -139,6 +139,17 @@ template <typename PointDataTree>
 inline void bloscCompressAttribute( PointDataTree& tree,
                                     const Name& name);
 
+/// @brief Apply paged Blosc compression to one attribute in the VDB tree, so that
+/// values can be read without decompressing the entire attribute array.
+///
+/// @param tree          the PointDataTree.
+/// @param name          name of the attribute to compress.
+/// @param pageSize      number of elements in each independently compressed page.
+template <typename PointDataTree>
+inline void pagedCompressAttribute( PointDataTree& tree,
+                                    const Name& name,
+                                    const Index pageSize = AttributeArray::DEFAULT_PAGE_SIZE);
+
 ////////////////////////////////////////
 
 
@@ -257,9 +268,11 @@ struct BloscCompressAttributesOp {
     typedef std::vector<size_t>                                 Indices;
 
     BloscCompressAttributesOp(  PointDataTreeType& tree,
-                                const Indices& indices)
+                                const Indices& indices,
+                                const Index pageSize = 0)
         : mTree(tree)
-        , mIndices(indices) { }
+        , mIndices(indices)
+        , mPageSize(pageSize) { }
 
     void operator()(const LeafRangeT& range) const {
 
@@ -269,7 +282,8 @@ struct BloscCompressAttributesOp {
                                             itEnd = mIndices.end(); it != itEnd; ++it) {
 
                 AttributeArray& array = leaf->attributeArray(*it);
-                array.compress();
+                if (mPageSize > 0)  array.compressPaged(mPageSize);
+                else                array.compress();
             }
         }
     }
@@ -278,6 +292,7 @@ struct BloscCompressAttributesOp {
 
     PointDataTreeType&              mTree;
     const Indices&                  mIndices;
+    const Index                     mPageSize;
 }; // class BloscCompressAttributesOp
 
 
@@ -529,6 +544,43 @@ inline void bloscCompressAttribute( PointDataTree& tree,
     tbb::parallel_for(LeafManagerT(tree).leafRange(), BloscCompressAttributesOp<PointDataTree>(tree, indices));
 }
 
+
+template <typename PointDataTree>
+inline void pagedCompressAttribute( PointDataTree& tree,
+                                    const Name& name,
+                                    const Index pageSize)
+{
+    using point_attribute_internal::BloscCompressAttributesOp;
+
+    typedef typename tree::LeafManager<PointDataTree>       LeafManagerT;
+    typedef AttributeSet::Descriptor                        Descriptor;
+
+    if (pageSize == 0) {
+        OPENVDB_THROW(ValueError, "Cannot compress using a page size of zero.");
+    }
+
+    typename PointDataTree::LeafCIter iter = tree.cbeginLeaf();
+
+    if (!iter)  return;
+
+    const Descriptor& descriptor = iter->attributeSet().descriptor();
+
+    // throw if index cannot be found in descriptor
+
+    const size_t index = descriptor.find(name);
+    if (index == AttributeSet::INVALID_POS) {
+        OPENVDB_THROW(KeyError, "Cannot find requested attribute - " << name << ".");
+    }
+
+    // paged blosc compress attributes
+
+    std::vector<size_t> indices;
+    indices.push_back(index);
+
+    tbb::parallel_for(LeafManagerT(tree).leafRange(),
+        BloscCompressAttributesOp<PointDataTree>(tree, indices, pageSize));
+}
+
 ////////////////////////////////////////
 
 
@@ -0,0 +1,444 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2015-2016 Double Negative Visual Effects
+//
+// All rights reserved. This software is distributed under the
+// Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
+//
+// Redistributions of source code must retain the above copyright
+// and license notice and the following restrictions and disclaimer.
+//
+// *     Neither the name of Double Negative Visual Effects nor the names
+// of its contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// IN NO EVENT SHALL THE COPYRIGHT HOLDERS' AND CONTRIBUTORS' AGGREGATE
+// LIABILITY FOR ALL CLAIMS REGARDLESS OF THEIR BASIS EXCEED US$250.00.
+//
+///////////////////////////////////////////////////////////////////////////
+//
+/// @file PointCompression.h
+///
+/// @brief  Automatic selection of lossy attribute codecs under an error tolerance.
+///
+/// Candidate codecs are truncation to half-precision, fixed-point (8-bit and 16-bit)
+/// and unit vector (quantized and octahedral) compression. The quantization error of each candidate is measured
+/// by encoding and decoding the actual values and the smallest registered codec with
+/// a maximum absolute error (per component) within the tolerance is selected.
+///
+
+
+#ifndef OPENVDB_TOOLS_POINT_COMPRESSION_HAS_BEEN_INCLUDED
+#define OPENVDB_TOOLS_POINT_COMPRESSION_HAS_BEEN_INCLUDED
+
+#include <openvdb/openvdb.h>
+
+#include <openvdb_points/tools/AttributeArray.h>
+#include <openvdb_points/tools/AttributeSet.h>
+#include <openvdb_points/tools/PointDataGrid.h>
+
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_reduce.h>
+
+#include <algorithm> // std::max
+#include <cmath> // std::abs
+#include <limits>
+#include <map>
+#include <vector>
+
+namespace openvdb {
+OPENVDB_USE_VERSION_NAMESPACE
+namespace OPENVDB_VERSION_NAME {
+namespace tools {
+
+
+/// @brief Return the type of the smallest registered codec that represents all of the
+/// @a values with a maximum absolute error (per component) of @a tolerance.
+///
+/// @param values       the values to be stored.
+/// @param tolerance    the maximum absolute error permitted.
+///
+/// @note Codecs are available for float and Vec3f values, for all other value types
+/// the type of an uncompressed attribute array is returned.
+template <typename ValueType>
+inline NamePair chooseCodec(const std::vector<ValueType>& values, const double tolerance);
+
+/// @brief Convert each requested attribute to the smallest registered codec that
+/// represents the existing values to within its tolerance.
+///
+/// @param tree         the PointDataTree.
+/// @param tolerances   maximum absolute error permitted keyed by attribute name.
+///
+/// @note The quantization error is measured in parallel against the values currently
+/// stored in the tree and attributes are only converted to codecs with strictly smaller
+/// storage than their existing codec. Only float and Vec3f attributes can be optimized.
+/// @note Positions are stored relative to the center of each voxel, so the tolerance of "P"
+/// is measured in voxel units in the index space of the grid, the tolerances of all other
+/// attributes are measured in the units of their values.
+template <typename PointDataTree>
+inline void optimizeAttributeCodecs(PointDataTree& tree,
+                                    const std::map<Name, double>& tolerances);
+
+
+////////////////////////////////////////
+
+
+namespace point_compression_internal {
+
+
+template <typename T> inline double maxComponentError(const T& a, const T& b)
+{
+    return std::abs(double(a) - double(b));
+}
+
+template <typename T> inline double maxComponentError(const math::Vec3<T>& a, const math::Vec3<T>& b)
+{
+    return std::max(std::abs(double(a.x()) - double(b.x())),
+           std::max(std::abs(double(a.y()) - double(b.y())),
+                    std::abs(double(a.z()) - double(b.z()))));
+}
+
+
+/// Encode and decode a value with the given codec to measure the quantization error
+template <typename ValueType, typename CodecType>
+inline double quantizationError(const ValueType& value)
+{
+    typename CodecType::StorageType data;
+    CodecType::encode(value, data);
+    ValueType result;
+    CodecType::decode(data, result);
+
+    const double error = maxComponentError(value, result);
+
+    // infinite error for values that overflow the storage type
+    return error == error ? error : std::numeric_limits<double>::max();
+}
+
+
+template <typename ValueType>
+struct CodecCandidate
+{
+    typedef double (*ErrorFn)(const ValueType&);
+
+    CodecCandidate(const NamePair& _type, const size_t _bytes, const ErrorFn _error)
+        : type(_type), bytes(_bytes), error(_error) { }
+
+    NamePair type;
+    size_t bytes;
+    ErrorFn error;
+};
+
+
+template <typename ValueType, typename CodecType>
+inline CodecCandidate<ValueType> makeCandidate()
+{
+    return CodecCandidate<ValueType>(
+        TypedAttributeArray<ValueType, CodecType>::attributeType(),
+        sizeof(typename CodecType::StorageType),
+        &quantizationError<ValueType, CodecType>);
+}
+
+
+/// Registered codec candidates for a value type in order of increasing storage size,
+/// the last candidate is always the uncompressed type
+template <typename ValueType>
+struct CodecCandidates
+{
+    static void get(std::vector<CodecCandidate<ValueType> >& candidates)
+    {
+        candidates.push_back(makeCandidate<ValueType, NullAttributeCodec<ValueType> >());
+    }
+};
+
+template <>
+struct CodecCandidates<float>
+{
+    static void get(std::vector<CodecCandidate<float> >& candidates)
+    {
+        candidates.push_back(makeCandidate<float, NullAttributeCodec<half> >());
+        candidates.push_back(makeCandidate<float, NullAttributeCodec<float> >());
+    }
+};
+
+template <>
+struct CodecCandidates<Vec3f>
+{
+    static void get(std::vector<CodecCandidate<Vec3f> >& candidates)
+    {
+        candidates.push_back(makeCandidate<Vec3f, UnitVecAttributeCodec>());
+        candidates.push_back(makeCandidate<Vec3f, OctahedralAttributeCodec<uint16_t> >());
+        candidates.push_back(makeCandidate<Vec3f, FixedPointAttributeCodec<math::Vec3<uint8_t> > >());
+        candidates.push_back(makeCandidate<Vec3f, OctahedralAttributeCodec<uint32_t> >());
+        candidates.push_back(makeCandidate<Vec3f, FixedPointAttributeCodec<math::Vec3<uint16_t> > >());
+        candidates.push_back(makeCandidate<Vec3f, NullAttributeCodec<math::Vec3<half> > >());
+        candidates.push_back(makeCandidate<Vec3f, NullAttributeCodec<Vec3f> >());
+    }
+};
+
+
+/// Accumulate the maximum error of each candidate codec for a single value
+template <typename ValueType>
+inline void accumulateErrors(const ValueType& value,
+                             const std::vector<CodecCandidate<ValueType> >& candidates,
+                             std::vector<double>& errors)
+{
+    for (size_t i = 0; i < candidates.size(); i++) {
+        errors[i] = std::max(errors[i], candidates[i].error(value));
+    }
+}
+
+
+/// Return the index of the first registered candidate within tolerance
+template <typename ValueType>
+inline size_t selectCandidate(const std::vector<CodecCandidate<ValueType> >& candidates,
+                              const std::vector<double>& errors, const double tolerance)
+{
+    for (size_t i = 0; i < candidates.size(); i++) {
+        if (errors[i] > tolerance)                                  continue;
+        if (!AttributeArray::isRegistered(candidates[i].type))     continue;
+        return i;
+    }
+    return candidates.size() - 1;
+}
+
+
+template <typename PointDataTreeType, typename ValueType>
+struct CodecErrorOp
+{
+    typedef typename tree::LeafManager<const PointDataTreeType> LeafManagerT;
+    typedef typename LeafManagerT::LeafRange                    LeafRangeT;
+    typedef CodecCandidate<ValueType>                           CandidateT;
+
+    CodecErrorOp(const size_t pos, const std::vector<CandidateT>& candidates)
+        : mPos(pos)
+        , mCandidates(candidates)
+        , mErrors(candidates.size(), 0.0) { }
+
+    CodecErrorOp(const CodecErrorOp& other, tbb::split)
+        : mPos(other.mPos)
+        , mCandidates(other.mCandidates)
+        , mErrors(other.mCandidates.size(), 0.0) { }
+
+    void operator()(const LeafRangeT& range) {
+
+        for (typename LeafRangeT::Iterator leaf=range.begin(); leaf; ++leaf) {
+
+            AttributeHandle<ValueType> handle(leaf->constAttributeArray(mPos));
+
+            // a uniform array only needs to evaluate the first value
+
+            const Index size = handle.isUniform() ? Index(1) : Index(handle.size());
+
+            for (Index n = 0; n < size; n++) {
+                accumulateErrors(handle.get(n), mCandidates, mErrors);
+            }
+        }
+    }
+
+    void join(const CodecErrorOp& other) {
+        for (size_t i = 0; i < mErrors.size(); i++) {
+            mErrors[i] = std::max(mErrors[i], other.mErrors[i]);
+        }
+    }
+
+    //////////
+
+    const size_t                        mPos;
+    const std::vector<CandidateT>&      mCandidates;
+    std::vector<double>                 mErrors;
+}; // struct CodecErrorOp
+
+
+template <typename PointDataTreeType, typename ValueType>
+struct ConvertCodecOp
+{
+    typedef typename tree::LeafManager<PointDataTreeType>       LeafManagerT;
+    typedef typename LeafManagerT::LeafRange                    LeafRangeT;
+    typedef AttributeSet::Descriptor                            Descriptor;
+
+    ConvertCodecOp( const size_t pos,
+                    const Descriptor& expected,
+                    const Descriptor::Ptr& replacement)
+        : mPos(pos)
+        , mExpected(expected)
+        , mReplacement(replacement) { }
+
+    void operator()(const LeafRangeT& range) const {
+
+        const NamePair& type = mReplacement->type(mPos);
+
+        for (typename LeafRangeT::Iterator leaf=range.begin(); leaf; ++leaf) {
+
+            const AttributeArray& array = leaf->constAttributeArray(mPos);
+
+            AttributeHandle<ValueType> sourceHandle(array);
+
+            AttributeArray::Ptr newArray = AttributeArray::create(type, array.size());
+            newArray->setHidden(array.isHidden());
+            newArray->setTransient(array.isTransient());
+
+            AttributeWriteHandle<ValueType> targetHandle(*newArray);
+
+            if (sourceHandle.isUniform()) {
+                targetHandle.collapse(sourceHandle.get(0));
+            }
+            else {
+                targetHandle.expand(/*fill=*/false);
+                for (Index n = 0, N = Index(sourceHandle.size()); n < N; n++) {
+                    targetHandle.set(n, sourceHandle.get(n));
+                }
+            }
+
+            if (array.isCompressed())   newArray->compress();
+
+            leaf->replaceAttribute(mPos, newArray, mExpected, mReplacement);
+        }
+    }
+
+    //////////
+
+    const size_t                    mPos;
+    const Descriptor&               mExpected;
+    const Descriptor::Ptr&          mReplacement;
+}; // struct ConvertCodecOp
+
+
+/// Convert the attribute at position @a pos to the smallest codec within tolerance
+template <typename PointDataTreeType, typename ValueType>
+inline void optimizeAttributeCodec(PointDataTreeType& tree, const size_t pos, const double tolerance)
+{
+    typedef CodecCandidate<ValueType>                                   CandidateT;
+    typedef AttributeSet::Descriptor                                    Descriptor;
+    typedef CodecErrorOp<PointDataTreeType, ValueType>                  ErrorOp;
+    typedef ConvertCodecOp<PointDataTreeType, ValueType>                ConvertOp;
+
+    std::vector<CandidateT> candidates;
+    CodecCandidates<ValueType>::get(candidates);
+
+    // measure the maximum quantization error of each candidate in parallel
+
+    typename ErrorOp::LeafManagerT errorLeafManager(tree);
+    ErrorOp errorOp(pos, candidates);
+    tbb::parallel_reduce(errorLeafManager.leafRange(), errorOp);
+
+    const CandidateT& candidate = candidates[selectCandidate(candidates, errorOp.mErrors, tolerance)];
+
+    // only convert to a codec with strictly smaller storage than the existing codec,
+    // which need not be one of the candidates
+
+    typename PointDataTreeType::LeafIter iter = tree.beginLeaf();
+    assert(iter);
+
+    if (candidate.bytes >= size_t(iter->constAttributeArray(pos).storageTypeSize()))   return;
+
+    const Descriptor& descriptor = iter->attributeSet().descriptor();
+
+    Descriptor::Ptr replacement = descriptor.duplicateRetype(pos, candidate.type);
+
+    // hold a reference to the existing descriptor while leaves are updated
+
+    const Descriptor::Ptr expected = iter->attributeSet().descriptorPtr();
+
+    typename ConvertOp::LeafManagerT leafManager(tree);
+    tbb::parallel_for(leafManager.leafRange(), ConvertOp(pos, *expected, replacement));
+}
+
+
+} // namespace point_compression_internal
+
+
+////////////////////////////////////////
+
+
+template <typename ValueType>
+inline NamePair chooseCodec(const std::vector<ValueType>& values, const double tolerance)
+{
+    using namespace point_compression_internal;
+
+    std::vector<CodecCandidate<ValueType> > candidates;
+    CodecCandidates<ValueType>::get(candidates);
+
+    std::vector<double> errors(candidates.size(), 0.0);
+
+    for (typename std::vector<ValueType>::const_iterator    it = values.begin(),
+                                                            itEnd = values.end(); it != itEnd; ++it) {
+        accumulateErrors(*it, candidates, errors);
+    }
+
+    return candidates[selectCandidate(candidates, errors, tolerance)].type;
+}
+
+
+////////////////////////////////////////
+
+
+template <typename PointDataTree>
+inline void optimizeAttributeCodecs(PointDataTree& tree,
+                                    const std::map<Name, double>& tolerances)
+{
+    using point_compression_internal::optimizeAttributeCodec;
+
+    typedef AttributeSet::Descriptor Descriptor;
+
+    typename PointDataTree::LeafCIter iter = tree.cbeginLeaf();
+
+    if (!iter)  return;
+
+    for (std::map<Name, double>::const_iterator it = tolerances.begin(),
+                                                itEnd = tolerances.end(); it != itEnd; ++it) {
+
+        // re-acquire the descriptor as it is replaced by each conversion
+
+        const Descriptor& descriptor = tree.cbeginLeaf()->attributeSet().descriptor();
+
+        const size_t pos = descriptor.find(it->first);
+
+        if (pos == AttributeSet::INVALID_POS) {
+            OPENVDB_THROW(KeyError, "Cannot find requested attribute - " << it->first << ".");
+        }
+
+        if (it->second < 0.0) {
+            OPENVDB_THROW(ValueError, "Tolerance for attribute " << it->first << " must not be negative.");
+        }
+
+        const Name& valueType = descriptor.valueType(pos);
+
+        if (valueType == typeNameAsString<float>()) {
+            optimizeAttributeCodec<PointDataTree, float>(tree, pos, it->second);
+        }
+        else if (valueType == typeNameAsString<Vec3f>()) {
+            optimizeAttributeCodec<PointDataTree, Vec3f>(tree, pos, it->second);
+        }
+        else {
+            OPENVDB_THROW(TypeError, "Cannot optimize codec of attribute " << it->first
+                << " with value type " << valueType << ".");
+        }
+    }
+}
+
+
+////////////////////////////////////////
+
+
+} // namespace tools
+} // namespace OPENVDB_VERSION_NAME
+} // namespace openvdb
+
+
+#endif // OPENVDB_TOOLS_POINT_COMPRESSION_HAS_BEEN_INCLUDED
+
+
+// Copyright (c) 2015-2016 Double Negative Visual Effects
+// All rights reserved. This software is distributed under the
+// Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
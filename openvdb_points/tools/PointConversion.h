@@ -39,6 +39,7 @@
 #ifndef OPENVDB_TOOLS_POINT_CONVERSION_HAS_BEEN_INCLUDED
 #define OPENVDB_TOOLS_POINT_CONVERSION_HAS_BEEN_INCLUDED
 
+#include <openvdb/math/BBox.h>
 #include <openvdb/math/Transform.h>
 
 #include <openvdb/tools/PointIndexGrid.h>
@@ -48,6 +49,13 @@
 #include <openvdb_points/tools/PointDataGrid.h>
 #include <openvdb_points/tools/PointGroup.h>
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_sort.h>
+
+#include <algorithm>
+#include <cmath>
+
 namespace openvdb {
 OPENVDB_USE_VERSION_NAMESPACE
 namespace OPENVDB_VERSION_NAME {
@@ -183,6 +191,39 @@ convertPointDataGridGroup(  Group& group,
                             const bool inCoreOnly = true);
 
 
+/// @brief  Estimate the voxel size that gives a target average number of points per
+///         active voxel.
+///
+/// @param  positions       list of world space point positions.
+/// @param  pointsPerVoxel  the target average number of points per active voxel.
+///
+/// @note   The position data must be supplied in a Point-Partitioner compatible
+///         data structure. A convenience PointAttributeVector class is offered.
+///
+/// @note   The voxel size is refined iteratively from a histogram of a fixed strided
+///         subset of at most 2^17 positions, so the cost does not grow with the number
+///         of points.
+///
+/// @return the voxel size or zero if there are fewer than two distinct positions.
+
+template <typename PositionWrapper>
+inline float
+computeVoxelSize(const PositionWrapper& positions, const float pointsPerVoxel);
+
+
+/// @brief  Estimate the voxel size that gives a target average number of points per
+///         leaf node of a PointDataTree.
+///
+/// @param  positions       list of world space point positions.
+/// @param  pointsPerLeaf   the target average number of points per leaf node.
+///
+/// @return the voxel size or zero if there are fewer than two distinct positions.
+
+template <typename PointDataTreeT, typename PositionWrapper>
+inline float
+computeLeafVoxelSize(const PositionWrapper& positions, const float pointsPerLeaf);
+
+
 ////////////////////////////////////////
 
 
@@ -359,7 +400,7 @@ struct PopulateAttributeOp {
             for (typename IndexArray::const_iterator it = indices.begin(), it_end = indices.end(); it != it_end; ++it)
             {
                 ValueType value;
-                mData.template get<ValueType>(*it, value);
+                mData.get(*it, value);
 
                 attributeWriteHandle->set(index, value);
 
@@ -512,7 +553,7 @@ struct ConvertPointDataGridAttributeOp {
                     AttributeHandle<ValueType>::create(leaf->template constAttributeArray(mIndex));
 
             const bool uniform = handle->isUniform();
-            ValueType uniformValue = uniform ? ValueType(handle->get(0)) : ValueType(0);
+            ValueType uniformValue = uniform ? ValueType(handle->get(0)) : zeroVal<ValueType>();
 
             IndexOnIter iter = leaf->beginIndexOn();
 
@@ -664,6 +705,151 @@ struct ConvertPointDataGridGroupOp {
 }; // ConvertPointDataGridGroupOp
 
 
+
+/// @brief Compute the cell coordinates of a list of sample positions
+struct SampleCellsOp {
+
+    SampleCellsOp(const std::vector<Vec3d>& samples, const double cellSize, std::vector<Coord>& cells)
+        : mSamples(samples)
+        , mInvCellSize(1.0 / cellSize)
+        , mCells(cells) { }
+
+    void operator()(const tbb::blocked_range<size_t>& range) const {
+        for (size_t n = range.begin(); n < range.end(); n++) {
+            mCells[n] = Coord::round(mSamples[n] * mInvCellSize);
+        }
+    }
+
+    //////////
+
+    const std::vector<Vec3d>&               mSamples;
+    const double                            mInvCellSize;
+    std::vector<Coord>&                     mCells;
+}; // SampleCellsOp
+
+
+/// @brief Estimate the average number of points per occupied cell of the given size from
+/// a subset of the positions that holds the fraction @a sampled of all the points
+///
+/// @details Treating the subset as a random sample, the samples in a cell of @c N points
+/// are Poisson distributed with mean @c lambda = @a sampled * @c N and the average number of
+/// samples per occupied cell is @c lambda / (1 - exp(-lambda)), which is inverted to give @c N.
+inline double
+estimatePointsPerCell(const std::vector<Vec3d>& samples, const double cellSize, const double sampled)
+{
+    std::vector<Coord> cells(samples.size());
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, samples.size()),
+        SampleCellsOp(samples, cellSize, cells));
+
+    tbb::parallel_sort(cells.begin(), cells.end());
+
+    const size_t uniqueCells = std::unique(cells.begin(), cells.end()) - cells.begin();
+
+    if (uniqueCells == 0)   return 0.0;
+
+    const double samplesPerCell = double(samples.size()) / double(uniqueCells);
+
+    if (sampled >= 1.0)     return samplesPerCell;
+
+    // bisect for the Poisson mean, which is at most the number of samples per cell
+
+    double lower = 0.0, upper = samplesPerCell;
+
+    for (int i = 0; i < 64; i++) {
+        const double lambda = 0.5 * (lower + upper);
+        if (lambda / (1.0 - std::exp(-lambda)) < samplesPerCell)    lower = lambda;
+        else                                                        upper = lambda;
+    }
+
+    return 0.5 * (lower + upper) / sampled;
+}
+
+
+/// @brief Estimate the size of a cell that gives a target average number of points per
+/// occupied cell
+///
+/// @details The bounds and the histogram of points per cell are computed from a fixed
+/// strided subset of the positions.
+template <typename PositionWrapper>
+inline double
+computeCellSize(const PositionWrapper& positions, const double pointsPerCell)
+{
+    typedef typename PositionWrapper::PosType PosType;
+
+    const size_t SampleSize = 1 << 17;
+    const int MaxIterations = 8;
+    const double Tolerance = 0.05;
+
+    if (pointsPerCell < 1.0) {
+        OPENVDB_THROW(ValueError, "Target number of points must be at least one - " << pointsPerCell << ".");
+    }
+
+    const size_t count = positions.size();
+
+    if (count < 2)  return 0.0;
+
+    // gather the subset of positions and their bounds
+
+    const size_t stride = std::max(size_t(1), count / SampleSize);
+
+    std::vector<Vec3d> samples;
+    samples.reserve(count / stride + 1);
+
+    BBoxd bounds;
+    PosType xyz;
+
+    for (size_t n = 0; n < count; n += stride) {
+        positions.getPos(n, xyz);
+        samples.push_back(Vec3d(xyz));
+        bounds.expand(samples.back());
+    }
+
+    const Vec3d extents = bounds.extents();
+    const double maxExtent = extents[bounds.maxExtent()];
+
+    if (maxExtent <= 0.0)   return 0.0;
+
+    // initial estimate assuming the points evenly fill their bounds, ignoring flat axes
+
+    double volume = 1.0;
+    double dimensions = 0.0;
+
+    for (int i = 0; i < 3; i++) {
+        if (extents[i] <= maxExtent * 1e-3)     continue;
+        volume *= extents[i];
+        dimensions += 1.0;
+    }
+
+    const double sampled = double(samples.size()) / double(count);
+
+    double cellSize = std::pow(volume * pointsPerCell / double(count), 1.0 / dimensions);
+
+    double density = estimatePointsPerCell(samples, cellSize, sampled);
+
+    for (int i = 0; i < MaxIterations; i++) {
+
+        if (density <= 0.0)                                         break;
+        if (std::abs(density / pointsPerCell - 1.0) < Tolerance)   break;
+
+        const double nextCellSize = cellSize * std::pow(pointsPerCell / density, 1.0 / dimensions);
+        const double nextDensity = estimatePointsPerCell(samples, nextCellSize, sampled);
+
+        // refine the dimensionality of the points from the change in density
+
+        if (nextDensity > 0.0 && nextDensity != density && nextCellSize != cellSize) {
+            const double slope = std::log(nextDensity / density) / std::log(nextCellSize / cellSize);
+            dimensions = std::min(3.0, std::max(1.0, slope));
+        }
+
+        cellSize = nextCellSize;
+        density = nextDensity;
+    }
+
+    return cellSize;
+}
+
+
 } // namespace point_conversion_internal
 
 
@@ -893,6 +1079,33 @@ convertPointDataGridGroup(  Group& group,
 }
 
 
+////////////////////////////////////////
+
+
+template <typename PositionWrapper>
+inline float
+computeVoxelSize(const PositionWrapper& positions, const float pointsPerVoxel)
+{
+    return float(point_conversion_internal::computeCellSize(positions, pointsPerVoxel));
+}
+
+
+////////////////////////////////////////
+
+
+template <typename PointDataTreeT, typename PositionWrapper>
+inline float
+computeLeafVoxelSize(const PositionWrapper& positions, const float pointsPerLeaf)
+{
+    typedef typename PointDataTreeT::LeafNodeType LeafT;
+
+    return float(point_conversion_internal::computeCellSize(positions, pointsPerLeaf) / double(LeafT::DIM));
+}
+
+
+////////////////////////////////////////
+
+
 } // namespace tools
 } // namespace OPENVDB_VERSION_NAME
 } // namespace openvdb
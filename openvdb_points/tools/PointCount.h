@@ -143,7 +143,7 @@ struct PointCountOp
             if (mInCoreOnly && leaf->buffer().isOutOfCore())     continue;
 #endif
             IndexIterator indexIterator(IndexIteratorFromLeafT::begin(*leaf));
-            FilterT filter(FilterT::create(*leaf, mFilterData));
+            FilterT filter(FilterFactory<FilterT>::create(*leaf, mFilterData, Index(leaf.pos())));
             Iterator iter(indexIterator, filter);
             size += iterCount(iter);
         }
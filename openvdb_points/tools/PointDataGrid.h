@@ -226,6 +226,13 @@ public:
     /// @param expected Existing descriptor is expected to match this parameter.
     /// @param replacement New descriptor to replace the existing one.
     void renameAttributes(const Descriptor& expected, Descriptor::Ptr& replacement);
+    /// @brief Replace an attribute with an array of a different type.
+    /// @param pos Index of the attribute to replace.
+    /// @param attribute New attribute array, must match the type in @a replacement.
+    /// @param expected Existing descriptor is expected to match this parameter.
+    /// @param replacement New descriptor to replace the existing one.
+    void replaceAttribute(const size_t pos, const AttributeArray::Ptr& attribute,
+                          const Descriptor& expected, const Descriptor::Ptr& replacement);
     /// @brief Compact all attributes in attribute set.
     void compactAttributes();
 
@@ -610,6 +617,24 @@ PointDataLeafNode<T, Log2Dim>::renameAttributes(const Descriptor& expected, Desc
     mAttributeSet->renameAttributes(expected, replacement);
 }
 
+template<typename T, Index Log2Dim>
+inline void
+PointDataLeafNode<T, Log2Dim>::replaceAttribute(const size_t pos, const AttributeArray::Ptr& attribute,
+                    const Descriptor& expected, const Descriptor::Ptr& replacement)
+{
+    if (pos >= mAttributeSet->size()) {
+        OPENVDB_THROW(IndexError, "Cannot replace attribute, index out of range - " << pos << ".");
+    }
+
+    if (attribute->size() != mAttributeSet->get(pos)->size()) {
+        OPENVDB_THROW(ValueError, "Cannot replace attribute with an array of a different length.");
+    }
+
+    if (mAttributeSet->replace(pos, attribute, expected, replacement) == AttributeSet::INVALID_POS) {
+        OPENVDB_THROW(TypeError, "Cannot replace attribute, array type does not match descriptor.");
+    }
+}
+
 template<typename T, Index Log2Dim>
 inline void
 PointDataLeafNode<T, Log2Dim>::compactAttributes()
@@ -48,6 +48,8 @@
 
 #include <boost/ptr_container/ptr_vector.hpp>
 
+#include <cstring> // std::memcpy
+
 namespace openvdb {
 OPENVDB_USE_VERSION_NAMESPACE
 namespace OPENVDB_VERSION_NAME {
@@ -123,6 +125,23 @@ inline void setGroup(   PointDataTree& tree,
                         const Name& group,
                         const bool remove = false);
 
+/// @brief Sets membership of multiple groups from a PointIndexTree-ordered packed bitset.
+///
+/// @param tree          the PointDataTree.
+/// @param indexTree     the PointIndexTree.
+/// @param membership    packed group membership with (groups.size() + 7) / 8 bytes per point,
+///                      bit @c g%8 of byte @c g/8 of a point denotes membership of group @c g.
+/// @param groups        the names of the groups.
+/// @param remove        if @c true also perform removal of points from the groups.
+///
+/// @note All groups of a leaf are set in a single traversal of the tree.
+template <typename PointDataTree, typename PointIndexTree>
+inline void setGroups(  PointDataTree& tree,
+                        const PointIndexTree& indexTree,
+                        const std::vector<GroupType>& membership,
+                        const std::vector<Name>& groups,
+                        const bool remove = false);
+
 /// @brief Sets membership for the specified group for all points (on/off).
 ///
 /// @param tree         the PointDataTree.
@@ -143,6 +162,73 @@ inline void setGroupByFilter(   PointDataTree& tree,
                                 const Name& group,
                                 const typename FilterT::Data& filterData);
 
+/// @brief Sets the sparse storage threshold of all group attribute arrays.
+///
+/// @param tree          the PointDataTree.
+/// @param threshold     the maximum number of points per leaf that can differ from a
+///                      background value for group data to be stored sparsely, zero
+///                      disables sparse storage.
+///
+/// @note The threshold is shared by all groups stored in the same attribute array and
+/// is not applied to group attribute arrays that are subsequently appended.
+template <typename PointDataTree>
+inline void setGroupSparseThreshold(PointDataTree& tree,
+                                    const Index threshold);
+
+/// @brief Copies membership of one group into another.
+///
+/// @param tree          the PointDataTree.
+/// @param source        the name of the group to copy from.
+/// @param target        the name of the group to copy to.
+template <typename PointDataTree>
+inline void copyGroup(  PointDataTree& tree,
+                        const Name& source,
+                        const Name& target);
+
+/// @brief Sets membership of the target group to points in either of two groups.
+///
+/// @param tree          the PointDataTree.
+/// @param groupA        the name of the first group.
+/// @param groupB        the name of the second group.
+/// @param target        the name of the group to store the result (may be one of the inputs).
+template <typename PointDataTree>
+inline void unionGroups(PointDataTree& tree,
+                        const Name& groupA,
+                        const Name& groupB,
+                        const Name& target);
+
+/// @brief Sets membership of the target group to points in both of two groups.
+///
+/// @param tree          the PointDataTree.
+/// @param groupA        the name of the first group.
+/// @param groupB        the name of the second group.
+/// @param target        the name of the group to store the result (may be one of the inputs).
+template <typename PointDataTree>
+inline void intersectGroups(PointDataTree& tree,
+                            const Name& groupA,
+                            const Name& groupB,
+                            const Name& target);
+
+/// @brief Sets membership of the target group to points in the first group but not the second.
+///
+/// @param tree          the PointDataTree.
+/// @param groupA        the name of the group to subtract from.
+/// @param groupB        the name of the group to subtract.
+/// @param target        the name of the group to store the result (may be one of the inputs).
+template <typename PointDataTree>
+inline void subtractGroups( PointDataTree& tree,
+                            const Name& groupA,
+                            const Name& groupB,
+                            const Name& target);
+
+/// @brief Inverts membership of the specified group for all points.
+///
+/// @param tree          the PointDataTree.
+/// @param group         the name of the group.
+template <typename PointDataTree>
+inline void invertGroup(PointDataTree& tree,
+                        const Name& group);
+
 
 ////////////////////////////////////////
 
@@ -150,42 +236,161 @@ inline void setGroupByFilter(   PointDataTree& tree,
 namespace point_group_internal {
 
 
-/// Copy a group attribute value from one group offset to another
+/// Set the sparse threshold on the group attribute arrays
 template<typename PointDataTreeType>
-struct CopyGroupOp {
+struct SetSparseThresholdOp {
+
+    typedef typename tree::LeafManager<PointDataTreeType>       LeafManagerT;
+
+    SetSparseThresholdOp(const std::vector<size_t>& indices, const Index threshold)
+        : mIndices(indices)
+        , mThreshold(threshold) { }
+
+    void operator()(const typename LeafManagerT::LeafRange& range) const {
+
+        for (typename LeafManagerT::LeafRange::Iterator leaf=range.begin(); leaf; ++leaf) {
+            for (std::vector<size_t>::const_iterator    it = mIndices.begin(),
+                                                        itEnd = mIndices.end(); it != itEnd; ++it) {
+                GroupAttributeArray::cast(leaf->attributeArray(*it)).setSparseThreshold(mThreshold);
+            }
+        }
+    }
+
+    //////////
+
+    const std::vector<size_t>&  mIndices;
+    const Index                 mThreshold;
+}; // struct SetSparseThresholdOp
+
+
+/// Bitwise operations used to combine group membership, applied to whole group bytes
+/// or words of group bytes with the source bits already aligned to the target bit
+struct GroupCopy        { template <typename T> static T apply(const T a, const T)   { return a; } };
+struct GroupUnion       { template <typename T> static T apply(const T a, const T b) { return T(a | b); } };
+struct GroupIntersect   { template <typename T> static T apply(const T a, const T b) { return T(a & b); } };
+struct GroupSubtract    { template <typename T> static T apply(const T a, const T b) { return T(a & ~b); } };
+struct GroupInvert      { template <typename T> static T apply(const T a, const T)   { return T(~a); } };
+
+
+/// @brief Shift a group byte, or a word of group bytes, so that the bit at offset @a from
+/// lands on offset @a to
+/// @note In a word, bits shifted across a byte boundary never land on offset @a to, so
+/// they are discarded when the result is masked to the target bit of each byte.
+template <typename T>
+inline T alignGroupBits(const T value, const Index from, const Index to)
+{
+    return from >= to ? T(value >> (from - to)) : T(value << (to - from));
+}
+
+
+/// Ensure a group array is in-core and uncompressed to allow unsafe access
+inline void prepareGroupArray(const GroupAttributeArray& array)
+{
+    array.loadData();
+    if (array.isCompressed())   const_cast<GroupAttributeArray&>(array).decompress();
+}
+
+
+/// Combine two source groups into a target group operating directly on the
+/// group attribute values, uniform source arrays produce a uniform result
+template<typename PointDataTreeType, typename GroupOpT>
+struct GroupBitwiseOp {
 
     typedef typename tree::LeafManager<PointDataTreeType>       LeafManagerT;
     typedef typename LeafManagerT::LeafRange                    LeafRangeT;
-    typedef AttributeSet::Descriptor::NameAndType               NameAndType;
     typedef AttributeSet::Descriptor::GroupIndex                GroupIndex;
 
-    CopyGroupOp(PointDataTreeType& tree,
-                const GroupIndex& targetIndex,
-                const GroupIndex& sourceIndex)
-        : mTree(tree)
-        , mTargetIndex(targetIndex)
-        , mSourceIndex(sourceIndex) { }
+    GroupBitwiseOp( const GroupIndex& targetIndex,
+                    const GroupIndex& sourceIndexA,
+                    const GroupIndex& sourceIndexB)
+        : mTargetIndex(targetIndex)
+        , mSourceIndexA(sourceIndexA)
+        , mSourceIndexB(sourceIndexB) { }
 
     void operator()(const typename LeafManagerT::LeafRange& range) const {
 
+        const Index targetOffset = mTargetIndex.second;
+        const Index sourceOffsetA = mSourceIndexA.second;
+        const Index sourceOffsetB = mSourceIndexB.second;
+
+        const GroupType targetMask = GroupType(1) << targetOffset;
+
         for (typename LeafManagerT::LeafRange::Iterator leaf=range.begin(); leaf; ++leaf) {
 
-            GroupHandle sourceGroup = leaf->groupHandle(mSourceIndex);
-            GroupWriteHandle targetGroup = leaf->groupWriteHandle(mTargetIndex);
+            // retrieve the target first as the non-const lookup may replace a shared array
+
+            GroupAttributeArray& target = GroupAttributeArray::cast(leaf->attributeArray(mTargetIndex.first));
+            const GroupAttributeArray& sourceA = GroupAttributeArray::cast(leaf->constAttributeArray(mSourceIndexA.first));
+            const GroupAttributeArray& sourceB = GroupAttributeArray::cast(leaf->constAttributeArray(mSourceIndexB.first));
+
+            assert(target.size() == sourceA.size() && target.size() == sourceB.size());
 
-            for (IndexIter iter = leaf->beginIndex(); iter; ++iter) {
-                const bool groupOn = sourceGroup.get(*iter);
-                targetGroup.set(*iter, groupOn);
+            // evaluate once and collapse if both sources are uniform
+
+            if (sourceA.isUniform() && sourceB.isUniform()) {
+                const GroupType result = GroupOpT::apply(
+                    alignGroupBits(sourceA.get(0), sourceOffsetA, targetOffset),
+                    alignGroupBits(sourceB.get(0), sourceOffsetB, targetOffset));
+                GroupWriteHandle(target, mTargetIndex.second).collapse((result & targetMask) != 0);
+                continue;
+            }
+
+            prepareGroupArray(target);
+            prepareGroupArray(sourceA);
+            prepareGroupArray(sourceB);
+
+            // expanding retains the membership of the other groups in the array
+
+            target.expand();
+
+            const Index size = Index(target.size());
+            Index start = 0;
+
+            // dense sources are combined a word of group bytes at a time with the target
+            // mask repeated in each byte, the remaining elements are combined one by one
+
+            if (!sourceA.isUniform() && !sourceA.isSparse() &&
+                !sourceB.isUniform() && !sourceB.isSparse()) {
+
+                typedef Index64 WordType;
+
+                const WordType wordMask = WordType(targetMask) * (~WordType(0) / WordType(0xFF));
+
+                GroupType* targetData = target.dataUnsafe();
+                const GroupType* dataA = sourceA.dataUnsafe();
+                const GroupType* dataB = sourceB.dataUnsafe();
+
+                for (; start + sizeof(WordType) <= size; start += Index(sizeof(WordType))) {
+                    WordType a, b, value;
+                    std::memcpy(&a, dataA + start, sizeof(WordType));
+                    std::memcpy(&b, dataB + start, sizeof(WordType));
+                    std::memcpy(&value, targetData + start, sizeof(WordType));
+                    const WordType result = GroupOpT::apply(
+                        alignGroupBits(a, sourceOffsetA, targetOffset),
+                        alignGroupBits(b, sourceOffsetB, targetOffset));
+                    value = (value & ~wordMask) | (result & wordMask);
+                    std::memcpy(targetData + start, &value, sizeof(WordType));
+                }
+            }
+
+            for (Index n = start; n < size; ++n) {
+                const GroupType result = GroupOpT::apply(
+                    alignGroupBits(sourceA.getUnsafe(n), sourceOffsetA, targetOffset),
+                    alignGroupBits(sourceB.getUnsafe(n), sourceOffsetB, targetOffset));
+                const GroupType value = target.getUnsafe(n);
+                target.setUnsafe(n, GroupType((value & ~targetMask) | (result & targetMask)));
             }
+
+            target.compact();
         }
     }
 
     //////////
 
-    PointDataTreeType&      mTree;
     const GroupIndex        mTargetIndex;
-    const GroupIndex        mSourceIndex;
-};
+    const GroupIndex        mSourceIndexA;
+    const GroupIndex        mSourceIndexB;
+}; // struct GroupBitwiseOp
 
 
 /// Set membership on or off for the specified group
@@ -278,6 +483,94 @@ struct SetGroupFromIndexOp
 }; // struct SetGroupFromIndexOp
 
 
+template <typename PointDataTree, typename PointIndexTree, bool Remove>
+struct SetGroupsFromIndexOp
+{
+    typedef typename tree::LeafManager<PointDataTree>   LeafManagerT;
+    typedef typename PointIndexTree::LeafNodeType       PointIndexLeafNode;
+    typedef typename PointIndexLeafNode::IndexArray     IndexArray;
+    typedef std::vector<GroupType>                      MembershipArray;
+
+    /// The bit offsets within the packed membership that map to a group attribute array
+    struct GroupArray
+    {
+        GroupArray(const size_t _index) : index(_index) { }
+        size_t index;
+        std::vector<size_t> membershipBits;
+        std::vector<GroupType> bitMasks;
+    };
+
+    typedef std::vector<GroupArray>                     GroupArrays;
+
+    SetGroupsFromIndexOp(   const PointIndexTree& indexTree,
+                            const MembershipArray& membership,
+                            const size_t bytesPerPoint,
+                            const GroupArrays& groupArrays)
+        : mIndexTree(indexTree)
+        , mMembership(membership)
+        , mBytesPerPoint(bytesPerPoint)
+        , mGroupArrays(groupArrays) { }
+
+    void operator()(const typename LeafManagerT::LeafRange& range) const
+    {
+        for (typename LeafManagerT::LeafRange::Iterator leaf=range.begin(); leaf; ++leaf) {
+
+            // obtain the PointIndexLeafNode (using the origin of the current leaf)
+
+            const PointIndexLeafNode* pointIndexLeaf = mIndexTree.probeConstLeaf(leaf->origin());
+
+            if (!pointIndexLeaf)    continue;
+
+            const IndexArray& indices = pointIndexLeaf->indices();
+
+            for (typename GroupArrays::const_iterator   it = mGroupArrays.begin(),
+                                                        itEnd = mGroupArrays.end(); it != itEnd; ++it) {
+
+                GroupAttributeArray& array = GroupAttributeArray::cast(leaf->attributeArray(it->index));
+
+                prepareGroupArray(array);
+
+                array.expand();
+
+                const size_t groups = it->membershipBits.size();
+
+                Index index = 0;
+
+                for (typename IndexArray::const_iterator    indexIt = indices.begin(),
+                                                            indexItEnd = indices.end(); indexIt != indexItEnd; ++indexIt) {
+
+                    const GroupType* bits = &mMembership[size_t(*indexIt) * mBytesPerPoint];
+
+                    GroupType value = array.getUnsafe(index);
+
+                    for (size_t i = 0; i < groups; i++) {
+                        const size_t bit = it->membershipBits[i];
+                        const bool on = (bits[bit >> 3] & (GroupType(1) << (bit & 7))) != 0;
+                        if (on)             value |= it->bitMasks[i];
+                        else if (Remove)    value &= GroupType(~it->bitMasks[i]);
+                    }
+
+                    array.setUnsafe(index, value);
+
+                    index++;
+                }
+
+                // attempt to compact the array
+
+                array.compact();
+            }
+        }
+    }
+
+    //////////
+
+    const PointIndexTree& mIndexTree;
+    const MembershipArray& mMembership;
+    const size_t mBytesPerPoint;
+    const GroupArrays& mGroupArrays;
+}; // struct SetGroupsFromIndexOp
+
+
 template <typename PointDataTree, typename FilterT, typename IterT = typename PointDataTree::LeafNodeType::ValueAllCIter>
 struct SetGroupByFilterOp
 {
@@ -302,7 +595,7 @@ struct SetGroupByFilterOp
 
             // create the filter
 
-            FilterT filter(FilterT::create(*leaf, mFilterData));
+            FilterT filter(FilterFactory<FilterT>::create(*leaf, mFilterData, Index(leaf.pos())));
 
             // if the voxel coord is not required and we're using a dense All iterator
             // iterate over the attribute arrays directly for faster performance
@@ -452,6 +745,42 @@ private:
 }; // class GroupInfo
 
 
+/// Apply a bitwise group operation to all points in the tree
+template <typename PointDataTree, typename GroupOpT>
+inline void applyGroupOp(   PointDataTree& tree,
+                            const Name& groupA,
+                            const Name& groupB,
+                            const Name& target)
+{
+    typedef AttributeSet::Descriptor Descriptor;
+    typedef typename tree::template LeafManager<PointDataTree> LeafManagerT;
+
+    typename PointDataTree::LeafCIter iter = tree.cbeginLeaf();
+
+    if (!iter)  return;
+
+    const AttributeSet& attributeSet = iter->attributeSet();
+    const Descriptor& descriptor = attributeSet.descriptor();
+
+    if (!descriptor.hasGroup(target)) {
+        OPENVDB_THROW(LookupError, "Group must exist on Tree before defining membership.");
+    }
+    if (!descriptor.hasGroup(groupA)) {
+        OPENVDB_THROW(LookupError, "Cannot find group - " << groupA);
+    }
+    if (!descriptor.hasGroup(groupB)) {
+        OPENVDB_THROW(LookupError, "Cannot find group - " << groupB);
+    }
+
+    const Descriptor::GroupIndex targetIndex = attributeSet.groupIndex(target);
+    const Descriptor::GroupIndex indexA = attributeSet.groupIndex(groupA);
+    const Descriptor::GroupIndex indexB = attributeSet.groupIndex(groupB);
+
+    GroupBitwiseOp<PointDataTree, GroupOpT> op(targetIndex, indexA, indexB);
+    tbb::parallel_for(LeafManagerT(tree).leafRange(), op);
+}
+
+
 } // namespace point_group_internal
 
 
@@ -646,7 +975,8 @@ inline void compactGroups(PointDataTree& tree)
     typedef AttributeSet::Descriptor                              Descriptor;
     typedef Descriptor::GroupIndex                                GroupIndex;
 
-    using point_group_internal::CopyGroupOp;
+    using point_group_internal::GroupBitwiseOp;
+    using point_group_internal::GroupCopy;
     using point_group_internal::GroupInfo;
 
     typename PointDataTree::LeafCIter iter = tree.cbeginLeaf();
@@ -677,7 +1007,7 @@ inline void compactGroups(PointDataTree& tree)
         const GroupIndex sourceIndex = attributeSet.groupIndex(sourceOffset);
         const GroupIndex targetIndex = attributeSet.groupIndex(targetOffset);
 
-        CopyGroupOp<PointDataTree> copy(tree, targetIndex, sourceIndex);
+        GroupBitwiseOp<PointDataTree, GroupCopy> copy(targetIndex, sourceIndex, sourceIndex);
         tbb::parallel_for(typename tree::template LeafManager<PointDataTree>(tree).leafRange(), copy);
 
         descriptor->setGroup(sourceName, targetOffset);
@@ -748,6 +1078,79 @@ inline void setGroup(   PointDataTree& tree,
 ////////////////////////////////////////
 
 
+template <typename PointDataTree, typename PointIndexTree>
+inline void setGroups(  PointDataTree& tree,
+                        const PointIndexTree& indexTree,
+                        const std::vector<GroupType>& membership,
+                        const std::vector<Name>& groups,
+                        const bool remove)
+{
+    typedef AttributeSet::Descriptor Descriptor;
+    typedef typename tree::template LeafManager<PointDataTree> LeafManagerT;
+
+    using point_group_internal::SetGroupsFromIndexOp;
+
+    if (groups.empty())     return;
+
+    const size_t bytesPerPoint = (groups.size() + 7) / 8;
+
+    if (membership.size() != pointCount(tree) * bytesPerPoint) {
+        OPENVDB_THROW(LookupError, "Membership vector size must match number of points and groups.");
+    }
+
+    typename PointDataTree::LeafCIter iter = tree.cbeginLeaf();
+
+    if (!iter)  return;
+
+    const AttributeSet& attributeSet = iter->attributeSet();
+    const Descriptor& descriptor = attributeSet.descriptor();
+
+    // gather the membership bits and bitmasks for each group attribute array
+
+    typedef typename SetGroupsFromIndexOp<PointDataTree, PointIndexTree, true>::GroupArray GroupArray;
+    typedef typename SetGroupsFromIndexOp<PointDataTree, PointIndexTree, true>::GroupArrays GroupArrays;
+
+    GroupArrays groupArrays;
+
+    for (size_t i = 0; i < groups.size(); i++) {
+
+        if (!descriptor.hasGroup(groups[i])) {
+            OPENVDB_THROW(LookupError, "Group must exist on Tree before defining membership.");
+        }
+
+        const Descriptor::GroupIndex index = attributeSet.groupIndex(groups[i]);
+
+        typename GroupArrays::iterator it = groupArrays.begin();
+        for (; it != groupArrays.end(); ++it) {
+            if (it->index == index.first)   break;
+        }
+        if (it == groupArrays.end()) {
+            groupArrays.push_back(GroupArray(index.first));
+            it = groupArrays.end() - 1;
+        }
+
+        it->membershipBits.push_back(i);
+        it->bitMasks.push_back(GroupType(1) << index.second);
+    }
+
+    // set membership
+
+    if (remove) {
+        SetGroupsFromIndexOp<PointDataTree, PointIndexTree, true>
+            set(indexTree, membership, bytesPerPoint, groupArrays);
+        tbb::parallel_for(LeafManagerT(tree).leafRange(), set);
+    }
+    else {
+        SetGroupsFromIndexOp<PointDataTree, PointIndexTree, false>
+            set(indexTree, membership, bytesPerPoint, groupArrays);
+        tbb::parallel_for(LeafManagerT(tree).leafRange(), set);
+    }
+}
+
+
+////////////////////////////////////////
+
+
 template <typename PointDataTree>
 inline void setGroup(   PointDataTree& tree,
                         const Name& group,
@@ -814,6 +1217,111 @@ inline void setGroupByFilter(   PointDataTree& tree,
 ////////////////////////////////////////
 
 
+template <typename PointDataTree>
+inline void setGroupSparseThreshold(PointDataTree& tree,
+                                    const Index threshold)
+{
+    typedef typename tree::template LeafManager<PointDataTree> LeafManagerT;
+
+    using point_group_internal::GroupInfo;
+    using point_group_internal::SetSparseThresholdOp;
+
+    typename PointDataTree::LeafCIter iter = tree.cbeginLeaf();
+
+    if (!iter)  return;
+
+    std::vector<size_t> indices;
+    GroupInfo(iter->attributeSet()).populateGroupIndices(indices);
+
+    if (indices.empty())    return;
+
+    SetSparseThresholdOp<PointDataTree> op(indices, threshold);
+    tbb::parallel_for(LeafManagerT(tree).leafRange(), op);
+}
+
+
+////////////////////////////////////////
+
+
+template <typename PointDataTree>
+inline void copyGroup(  PointDataTree& tree,
+                        const Name& source,
+                        const Name& target)
+{
+    using point_group_internal::applyGroupOp;
+    using point_group_internal::GroupCopy;
+
+    if (source == target)   return;
+
+    applyGroupOp<PointDataTree, GroupCopy>(tree, source, source, target);
+}
+
+
+////////////////////////////////////////
+
+
+template <typename PointDataTree>
+inline void unionGroups(PointDataTree& tree,
+                        const Name& groupA,
+                        const Name& groupB,
+                        const Name& target)
+{
+    using point_group_internal::applyGroupOp;
+    using point_group_internal::GroupUnion;
+
+    applyGroupOp<PointDataTree, GroupUnion>(tree, groupA, groupB, target);
+}
+
+
+////////////////////////////////////////
+
+
+template <typename PointDataTree>
+inline void intersectGroups(PointDataTree& tree,
+                            const Name& groupA,
+                            const Name& groupB,
+                            const Name& target)
+{
+    using point_group_internal::applyGroupOp;
+    using point_group_internal::GroupIntersect;
+
+    applyGroupOp<PointDataTree, GroupIntersect>(tree, groupA, groupB, target);
+}
+
+
+////////////////////////////////////////
+
+
+template <typename PointDataTree>
+inline void subtractGroups( PointDataTree& tree,
+                            const Name& groupA,
+                            const Name& groupB,
+                            const Name& target)
+{
+    using point_group_internal::applyGroupOp;
+    using point_group_internal::GroupSubtract;
+
+    applyGroupOp<PointDataTree, GroupSubtract>(tree, groupA, groupB, target);
+}
+
+
+////////////////////////////////////////
+
+
+template <typename PointDataTree>
+inline void invertGroup(PointDataTree& tree,
+                        const Name& group)
+{
+    using point_group_internal::applyGroupOp;
+    using point_group_internal::GroupInvert;
+
+    applyGroupOp<PointDataTree, GroupInvert>(tree, group, group, group);
+}
+
+
+////////////////////////////////////////
+
+
 template <typename PointDataTree>
 inline void setGroupByRandomTarget( PointDataTree& tree,
                                     const Name& group,
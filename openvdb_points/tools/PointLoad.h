@@ -44,6 +44,14 @@
 #include <openvdb_points/tools/AttributeSet.h>
 #include <openvdb_points/tools/PointDataGrid.h>
 
+#include <tbb/atomic.h>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_scheduler_init.h>
+
+#include <algorithm>
+#include <vector>
+
 namespace openvdb {
 OPENVDB_USE_VERSION_NAMESPACE
 namespace OPENVDB_VERSION_NAME {
@@ -58,25 +66,134 @@ template <typename PointDataGridT>
 void loadPoints(PointDataGridT& grid);
 
 
-/// @brief Loads all leaf node voxel data in the given grid that
+/// @brief Loads all leaf node voxel and attribute data in the given grid that
 /// overlap with mask grid leaf nodes.
 ///
-/// @param grid  the Grid to be loaded.
-/// @param mask  the mask to denote region of points to load
+/// @param grid         the Grid to be loaded.
+/// @param mask         the mask to denote region of points to load
+/// @param concurrency  the maximum number of leaf nodes to load at once, zero uses the
+///                     number of available threads. Low-latency local storage saturates
+///                     with few concurrent loads so a lower value avoids contention.
+///
+/// @note Loads run on the TBB thread pool, so @a concurrency is an upper bound that is
+/// capped by the number of scheduler threads and cannot keep more loads in flight.
+///
+/// @return the number of bytes loaded into memory.
 template <typename PointDataGridT, typename MaskGridT>
-void loadPoints(PointDataGridT& grid, const MaskGridT& mask);
+Index64 loadPoints(PointDataGridT& grid, const MaskGridT& mask, const size_t concurrency = 0);
 
 
-/// @brief Load the leaf node voxel data in the given grid that
+/// @brief Load the leaf node voxel and attribute data in the given grid that
 /// overlap with a world-space bounding box.
 ///
-/// @param grid  the Grid to be loaded.
-/// @param bbox  the bbox to denote region of points to load
+/// @param grid         the Grid to be loaded.
+/// @param bbox         the bbox to denote region of points to load
+/// @param concurrency  the maximum number of leaf nodes to load at once, zero uses the
+///                     number of available threads.
+///
+/// @return the number of bytes loaded into memory.
 ///
 /// @note Does not clip to the bounding box, leaf nodes with any
 /// overlap will be loaded.
+/// @note @a concurrency is an upper bound capped by the number of TBB scheduler threads.
 template <typename PointDataGridT>
-void loadPoints(PointDataGridT& grid, const BBoxd& bbox);
+Index64 loadPoints(PointDataGridT& grid, const BBoxd& bbox, const size_t concurrency = 0);
+
+
+////////////////////////////////////////
+
+
+namespace point_load_internal {
+
+
+/// @brief Load the voxel and attribute data of a leaf, returning the number of bytes loaded
+template <typename LeafT>
+inline Index64 loadLeaf(const LeafT& leaf)
+{
+    const Index64 bytes = leaf.memUsage();
+
+#ifndef OPENVDB_2_ABI_COMPATIBLE
+    if (leaf.buffer().isOutOfCore())    leaf.buffer().data();
+#endif
+
+    const AttributeSet& attributeSet = leaf.attributeSet();
+
+    for (size_t i = 0; i < attributeSet.size(); i++) {
+        attributeSet.getConst(i)->loadData();
+    }
+
+    const Index64 loadedBytes = leaf.memUsage();
+
+    return loadedBytes > bytes ? loadedBytes - bytes : Index64(0);
+}
+
+
+/// @brief Loads leaf nodes with a bounded number of concurrent workers that
+/// each claim the next unloaded leaf from a shared counter
+template <typename LeafT>
+struct LoadLeafOp
+{
+    typedef std::vector<const LeafT*> LeafArray;
+
+    LoadLeafOp( const LeafArray& leaves,
+                tbb::atomic<size_t>& nextLeaf,
+                tbb::atomic<Index64>& bytes)
+        : mLeaves(leaves)
+        , mNextLeaf(nextLeaf)
+        , mBytes(bytes) { }
+
+    void operator()(const tbb::blocked_range<size_t>& range) const
+    {
+        for (size_t worker = range.begin(); worker < range.end(); worker++) {
+
+            Index64 bytes = 0;
+
+            for (size_t i = mNextLeaf++; i < mLeaves.size(); i = mNextLeaf++) {
+                bytes += loadLeaf(*mLeaves[i]);
+            }
+
+            mBytes += bytes;
+        }
+    }
+
+    //////////
+
+    const LeafArray& mLeaves;
+    tbb::atomic<size_t>& mNextLeaf;
+    tbb::atomic<Index64>& mBytes;
+}; // struct LoadLeafOp
+
+
+template <typename LeafT>
+inline Index64 loadLeaves(std::vector<const LeafT*>& leaves, const size_t concurrency)
+{
+    if (leaves.empty())     return 0;
+
+    // remove duplicates so that no two workers load the same leaf
+
+    std::sort(leaves.begin(), leaves.end());
+    leaves.erase(std::unique(leaves.begin(), leaves.end()), leaves.end());
+
+    size_t workers = concurrency > 0 ? concurrency :
+        size_t(tbb::task_scheduler_init::default_num_threads());
+
+    workers = std::max(size_t(1), std::min(workers, leaves.size()));
+
+    tbb::atomic<size_t> nextLeaf;
+    tbb::atomic<Index64> bytes;
+    nextLeaf = 0;
+    bytes = 0;
+
+    LoadLeafOp<LeafT> op(leaves, nextLeaf, bytes);
+
+    if (workers == 1)   op(tbb::blocked_range<size_t>(0, 1));
+    else                tbb::parallel_for(tbb::blocked_range<size_t>(0, workers, 1), op);
+
+    return bytes;
+}
+
+
+} // namespace point_load_internal
 
 
 ////////////////////////////////////////
@@ -98,50 +215,54 @@ void loadPoints(PointDataGridT&)
 
 
 template <typename PointDataGridT, typename MaskGridT>
-void loadPoints(PointDataGridT& grid, const MaskGridT& mask)
+Index64 loadPoints(PointDataGridT& grid, const MaskGridT& mask, const size_t concurrency)
 {
     typedef typename PointDataGridT::TreeType PointDataTreeT;
+    typedef typename PointDataTreeT::LeafNodeType LeafT;
 
     tree::ValueAccessor<const PointDataTreeT> pointsAcc(grid.constTree());
 
-    typename MaskGridT::TreeType::LeafCIter leafIter = mask.constTree().cbeginLeaf();
+    // collect the leaf nodes overlapping the mask leaf nodes
 
-    for (; leafIter; ++leafIter) {
-        const Coord& ijk = leafIter->origin();
-        const typename PointDataTreeT::LeafNodeType* leaf = pointsAcc.probeConstLeaf(ijk);
+    std::vector<const LeafT*> leaves;
+    leaves.reserve(grid.constTree().leafCount());
 
-        if (!leaf)  continue;
+    typename MaskGridT::TreeType::LeafCIter leafIter = mask.constTree().cbeginLeaf();
 
-        // load out of core leaf nodes
-        if (leaf->buffer().isOutOfCore())    leaf->buffer().data();
+    for (; leafIter; ++leafIter) {
+        const LeafT* leaf = pointsAcc.probeConstLeaf(leafIter->origin());
+        if (leaf)   leaves.push_back(leaf);
     }
+
+    return point_load_internal::loadLeaves(leaves, concurrency);
 }
 
 
 template <typename PointDataGridT>
-void loadPoints(PointDataGridT& grid, const BBoxd& bbox)
+Index64 loadPoints(PointDataGridT& grid, const BBoxd& bbox, const size_t concurrency)
 {
-    typedef typename PointDataGridT::template ValueConverter<bool>::Type BoolGridT;
+    typedef typename PointDataGridT::TreeType PointDataTreeT;
+    typedef typename PointDataTreeT::LeafNodeType LeafT;
 
     // Transform the world-space bounding box into the source grid's index space.
     Vec3d idxMin, idxMax;
     math::calculateBounds(grid.constTransform(), bbox.min(), bbox.max(), idxMin, idxMax);
-    CoordBBox region(Coord::floor(idxMin), Coord::floor(idxMax));
+    const CoordBBox region(Coord::floor(idxMin), Coord::floor(idxMax));
 
-    // Construct a boolean mask grid that is true inside the index-space bounding box
-    // and false everywhere else.
-    BoolGridT clipMask(/*background=*/false);
-    clipMask.fill(region, /*value=*/true, /*active=*/true);
+    // collect the leaf nodes with bounding boxes that overlap the region
 
-    // MaskGrid introduced in OpenVDB 3.2
-    typedef BoolGrid MaskType;
+    std::vector<const LeafT*> leaves;
+    leaves.reserve(grid.constTree().leafCount());
 
-    // Convert the input grid to a mask grid (with the same tree configuration).
-    MaskType::Ptr pointsMask = MaskType::create(/*background=*/false);
-    pointsMask->topologyUnion(grid);
-    pointsMask->topologyIntersection(clipMask);
+    typename PointDataTreeT::LeafCIter leafIter = grid.constTree().cbeginLeaf();
+
+    for (; leafIter; ++leafIter) {
+        if (region.hasOverlap(leafIter->getNodeBoundingBox())) {
+            leaves.push_back(leafIter.getLeaf());
+        }
+    }
 
-    loadPoints(grid, *pointsMask);
+    return point_load_internal::loadLeaves(leaves, concurrency);
 }
 
 
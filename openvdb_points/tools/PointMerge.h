@@ -0,0 +1,683 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2015-2016 Double Negative Visual Effects
+//
+// All rights reserved. This software is distributed under the
+// Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
+//
+// Redistributions of source code must retain the above copyright
+// and license notice and the following restrictions and disclaimer.
+//
+// *     Neither the name of Double Negative Visual Effects nor the names
+// of its contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// IN NO EVENT SHALL THE COPYRIGHT HOLDERS' AND CONTRIBUTORS' AGGREGATE
+// LIABILITY FOR ALL CLAIMS REGARDLESS OF THEIR BASIS EXCEED US$250.00.
+//
+///////////////////////////////////////////////////////////////////////////
+//
+/// @file PointMerge.h
+///
+/// @brief  Merge the points of multiple VDB Point Grids into a single grid.
+///
+
+
+#ifndef OPENVDB_TOOLS_POINT_MERGE_HAS_BEEN_INCLUDED
+#define OPENVDB_TOOLS_POINT_MERGE_HAS_BEEN_INCLUDED
+
+#include <openvdb/openvdb.h>
+#include <openvdb/tree/LeafManager.h>
+
+#include <openvdb_points/tools/AttributeArray.h>
+#include <openvdb_points/tools/AttributeGroup.h>
+#include <openvdb_points/tools/AttributeSet.h>
+#include <openvdb_points/tools/AttributeString.h>
+#include <openvdb_points/tools/PointAttribute.h>
+#include <openvdb_points/tools/PointDataGrid.h>
+#include <openvdb_points/tools/PointGroup.h>
+#include <openvdb_points/tools/PointMove.h>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace openvdb {
+OPENVDB_USE_VERSION_NAMESPACE
+namespace OPENVDB_VERSION_NAME {
+namespace tools {
+
+
+/// @brief Merge the points of the source grids into a PointDataGrid.
+///
+/// @param points       the PointDataGrid to merge into.
+/// @param sources      the PointDataGrids to merge from, null grids are ignored.
+///
+/// @note Attributes missing from the target are appended with their default value
+/// metadata and any missing groups are appended, points that have no value for an
+/// attribute use the zero value. Points of grids with a different transform are
+/// re-bucketed into the voxels of the target transform. Within each voxel, points
+/// of the target precede points of the sources in the order they are supplied.
+/// @note The strings of the source grids are inserted into the string table of the
+/// target and string attributes are remapped onto the merged string table.
+/// @note Attributes with the same name that only differ in codec are converted to the
+/// codec of the target.
+/// @note The attribute arrays of the source grids are loaded and uncompressed.
+/// @throw TypeError if attributes with the same name have different value types.
+template <typename PointDataGridT>
+inline void mergePoints(PointDataGridT& points,
+                        const std::vector<typename PointDataGridT::Ptr>& sources);
+
+
+/// @brief Merge the points of a source grid into a PointDataGrid.
+///
+/// @param points       the PointDataGrid to merge into.
+/// @param source       the PointDataGrid to merge from.
+template <typename PointDataGridT>
+inline void mergePoints(PointDataGridT& points,
+                        PointDataGridT& source);
+
+
+////////////////////////////////////////
+
+
+namespace point_merge_internal {
+
+
+using point_move_internal::LeafPositionArrays;
+using point_move_internal::PointRuns;
+using point_move_internal::OriginAndIndexArray;
+using point_move_internal::LeafAndIndex;
+using point_move_internal::LeafAndIndexArray;
+using point_move_internal::TransformPositionsOp;
+
+typedef AttributeSet::Descriptor::GroupIndex            GroupIndex;
+typedef std::vector<Index>                              StringIndices;
+
+
+/// @brief A lookup from each value of a source group attribute array to the bits it sets in
+/// a target group attribute array, for grids with groups at different offsets
+struct GroupByteMap
+{
+    GroupByteMap(const size_t _sourceIndex, const size_t _targetIndex)
+        : sourceIndex(_sourceIndex), targetIndex(_targetIndex)
+    {
+        std::fill(bits, bits + Size, GroupType(0));
+    }
+
+    static const size_t Size = size_t(1) << (sizeof(GroupType) * 8);
+
+    size_t sourceIndex;
+    size_t targetIndex;
+    GroupType bits[Size];
+};
+
+typedef std::vector<GroupByteMap>                       GroupByteMaps;
+
+
+/// @brief Copy the values of an attribute from the sorted source points through attribute
+/// handles, converting the values of source arrays that use a different codec
+template <typename ValueType, typename LeafT>
+inline void
+convertSourceValues(AttributeArray& array,
+                    const size_t attributeIndex,
+                    const LeafAndIndexArray& sources,
+                    const std::vector<const LeafT*>& sourceLeaves,
+                    const std::vector<size_t>& sourceGrids,
+                    const std::vector<std::vector<size_t> >& attributeMaps)
+{
+    AttributeWriteHandle<ValueType> handle(array);
+
+    // re-use the source handle for consecutive points of the same source leaf
+
+    typename AttributeHandle<ValueType>::Ptr sourceHandle;
+    size_t sourceLeaf = 0;
+
+    for (size_t i = 0; i < sources.size(); i++) {
+        const size_t sourceIndex = attributeMaps[sourceGrids[sources[i].first]][attributeIndex];
+        if (sourceIndex == AttributeSet::INVALID_POS)   continue;
+
+        if (!sourceHandle || sources[i].first != sourceLeaf) {
+            sourceLeaf = sources[i].first;
+            sourceHandle = AttributeHandle<ValueType>::create(
+                sourceLeaves[sourceLeaf]->constAttributeArray(sourceIndex));
+        }
+
+        handle.set(Index(i), sourceHandle->get(sources[i].second));
+    }
+}
+
+
+/// @brief Populate each destination leaf from the runs of points of the source leaves,
+/// mapping the attributes and groups of each source grid onto the merged descriptor
+template <typename PointDataTreeT>
+struct MergeLeafOp
+{
+    typedef typename PointDataTreeT::LeafNodeType       LeafT;
+    typedef typename LeafT::ValueType                   ValueType;
+    typedef AttributeSet::Descriptor                    Descriptor;
+
+    MergeLeafOp(const std::vector<LeafT*>& targetLeaves,
+                const std::vector<PointRuns>& targetRuns,
+                const std::vector<const LeafT*>& sourceLeaves,
+                const std::vector<size_t>& sourceGrids,
+                const std::vector<OriginAndIndexArray>& destinations,
+                const LeafPositionArrays& positions,
+                const LeafT& prototype,
+                const std::vector<std::vector<size_t> >& attributeMaps,
+                const std::vector<GroupByteMaps>& groupMaps,
+                const std::vector<StringIndices>& stringMaps,
+                const std::vector<bool>& compressed,
+                const std::vector<bool>& converted,
+                const size_t positionIndex)
+        : mTargetLeaves(targetLeaves)
+        , mTargetRuns(targetRuns)
+        , mSourceLeaves(sourceLeaves)
+        , mSourceGrids(sourceGrids)
+        , mDestinations(destinations)
+        , mPositions(positions)
+        , mPrototype(prototype)
+        , mAttributeMaps(attributeMaps)
+        , mGroupMaps(groupMaps)
+        , mStringMaps(stringMaps)
+        , mCompressed(compressed)
+        , mConverted(converted)
+        , mPositionIndex(positionIndex) { }
+
+    void operator()(const tbb::blocked_range<size_t>& range) const
+    {
+        using point_move_internal::sortPointsByVoxel;
+        using point_move_internal::copyAttributeFlags;
+        using point_move_internal::setVoxelPositions;
+
+        const Descriptor::Ptr& descriptor = mPrototype.attributeSet().descriptorPtr();
+
+        std::vector<ValueType> offsets;
+        LeafAndIndexArray sources;
+
+        for (size_t n = range.begin(); n < range.end(); n++) {
+
+            LeafT& leaf = *mTargetLeaves[n];
+
+            sortPointsByVoxel<LeafT>(sources, offsets, mTargetRuns[n], mDestinations, mPositions);
+
+            const size_t count = sources.size();
+
+            leaf.setOffsets(offsets);
+            leaf.initializeAttributes(descriptor, count);
+
+            // copy the attributes present in each source grid, others remain zero
+
+            for (size_t attributeIndex = 0; attributeIndex < descriptor->size(); attributeIndex++) {
+
+                AttributeArray& array = leaf.attributeArray(attributeIndex);
+
+                copyAttributeFlags(array, mPrototype.constAttributeArray(attributeIndex));
+
+                if (attributeIndex == mPositionIndex) {
+                    setVoxelPositions(array, sources, mPositions);
+                    continue;
+                }
+
+                // attributes with a different codec in any source grid are converted
+
+                if (mConverted[attributeIndex]) {
+                    const Name& valueType = descriptor->valueType(attributeIndex);
+                    if (valueType == typeNameAsString<float>()) {
+                        convertSourceValues<float>(array, attributeIndex, sources,
+                            mSourceLeaves, mSourceGrids, mAttributeMaps);
+                    }
+                    else if (valueType == typeNameAsString<Vec3f>()) {
+                        convertSourceValues<Vec3f>(array, attributeIndex, sources,
+                            mSourceLeaves, mSourceGrids, mAttributeMaps);
+                    }
+                    else if (valueType == typeNameAsString<math::Quat<float> >()) {
+                        convertSourceValues<math::Quat<float> >(array, attributeIndex, sources,
+                            mSourceLeaves, mSourceGrids, mAttributeMaps);
+                    }
+                    else if (valueType == typeNameAsString<int32_t>()) {
+                        convertSourceValues<int32_t>(array, attributeIndex, sources,
+                            mSourceLeaves, mSourceGrids, mAttributeMaps);
+                    }
+                    else if (valueType == typeNameAsString<int64_t>()) {
+                        convertSourceValues<int64_t>(array, attributeIndex, sources,
+                            mSourceLeaves, mSourceGrids, mAttributeMaps);
+                    }
+                    else {
+                        OPENVDB_THROW(TypeError, "Cannot convert codec of attribute with value type "
+                            << valueType << ".");
+                    }
+                    continue;
+                }
+
+                const bool stringAttribute = isString(array);
+
+                // copy each run of consecutive points of the same source leaf at once
+
+                for (size_t begin = 0, end = 0; begin < count; begin = end) {
+
+                    const LeafAndIndex& source = sources[begin];
+
+                    for (end = begin + 1; end < count && sources[end].first == source.first &&
+                                          sources[end].second == source.second + Index(end - begin); end++) { }
+
+                    const size_t grid = mSourceGrids[source.first];
+                    const size_t sourceIndex = mAttributeMaps[grid][attributeIndex];
+                    if (sourceIndex == AttributeSet::INVALID_POS)   continue;
+
+                    const AttributeArray& sourceArray =
+                        mSourceLeaves[source.first]->constAttributeArray(sourceIndex);
+
+                    array.copyValuesUnsafe(Index(begin), sourceArray, source.second, Index(end - begin));
+
+                    // remap the string indices of grids with a different string table
+
+                    if (stringAttribute && !mStringMaps[grid].empty()) {
+                        remapStrings(array, mStringMaps[grid], Index(begin), Index(end - begin));
+                    }
+                }
+            }
+
+            // map group membership a byte at a time for grids with a different group layout
+
+            for (size_t begin = 0, end = 0; begin < count; begin = end) {
+
+                const Index sourceLeaf = sources[begin].first;
+
+                for (end = begin + 1; end < count && sources[end].first == sourceLeaf; end++) { }
+
+                const GroupByteMaps& groupMaps = mGroupMaps[mSourceGrids[sourceLeaf]];
+
+                for (GroupByteMaps::const_iterator it = groupMaps.begin(), itEnd = groupMaps.end();
+                    it != itEnd; ++it) {
+
+                    const GroupAttributeArray& sourceArray = GroupAttributeArray::cast(
+                        mSourceLeaves[sourceLeaf]->constAttributeArray(it->sourceIndex));
+
+                    GroupAttributeArray& groupArray =
+                        GroupAttributeArray::cast(leaf.attributeArray(it->targetIndex));
+
+                    for (size_t i = begin; i < end; i++) {
+                        const GroupType bits = it->bits[sourceArray.get(sources[i].second)];
+                        if (bits)   groupArray.set(Index(i), GroupType(groupArray.get(Index(i)) | bits));
+                    }
+                }
+            }
+
+            for (size_t attributeIndex = 0; attributeIndex < descriptor->size(); attributeIndex++) {
+
+                AttributeArray& array = leaf.attributeArray(attributeIndex);
+
+                array.compact();
+
+                if (mCompressed[attributeIndex])    array.compress();
+            }
+        }
+    }
+
+    //////////
+
+    const std::vector<LeafT*>&                  mTargetLeaves;
+    const std::vector<PointRuns>&               mTargetRuns;
+    const std::vector<const LeafT*>&            mSourceLeaves;
+    const std::vector<size_t>&                  mSourceGrids;
+    const std::vector<OriginAndIndexArray>&     mDestinations;
+    const LeafPositionArrays&                   mPositions;
+    const LeafT&                                mPrototype;
+    const std::vector<std::vector<size_t> >&    mAttributeMaps;
+    const std::vector<GroupByteMaps>&           mGroupMaps;
+    const std::vector<StringIndices>&           mStringMaps;
+    const std::vector<bool>&                    mCompressed;
+    const std::vector<bool>&                    mConverted;
+    const size_t                                mPositionIndex;
+}; // struct MergeLeafOp
+
+
+/// @brief Append the attributes and groups of an attribute set that are missing from a tree
+template <typename PointDataTreeT>
+inline void
+appendMissingAttributes(PointDataTreeT& tree, const AttributeSet& attributeSet)
+{
+    typedef AttributeSet::Descriptor                            Descriptor;
+    typedef Descriptor::NameAndType                             NameAndType;
+
+    const Descriptor& sourceDescriptor = attributeSet.descriptor();
+
+    // extract the attribute names in order
+
+    std::vector<Name> names(sourceDescriptor.size());
+
+    for (Descriptor::ConstIterator it = sourceDescriptor.map().begin(),
+        itEnd = sourceDescriptor.map().end(); it != itEnd; ++it) {
+        names[it->second] = it->first;
+    }
+
+    for (size_t i = 0; i < names.size(); i++) {
+
+        const AttributeArray& array = *attributeSet.getConst(i);
+
+        // group attributes are appended along with the groups
+
+        if (GroupAttributeArray::isGroup(array))    continue;
+
+        const Descriptor& descriptor = tree.cbeginLeaf()->attributeSet().descriptor();
+        const size_t index = descriptor.find(names[i]);
+
+        // attributes that only differ in codec keep the codec of the tree
+
+        if (index != AttributeSet::INVALID_POS) {
+            if (descriptor.valueType(index) != sourceDescriptor.valueType(i)) {
+                OPENVDB_THROW(TypeError, "Cannot merge attributes of different types - " << names[i] << ".");
+            }
+            continue;
+        }
+
+        Metadata::Ptr defaultValue;
+
+        if (sourceDescriptor.hasDefaultValue(names[i])) {
+            defaultValue = sourceDescriptor.getMetadata()["default:" + names[i]]->copy();
+        }
+
+        appendAttribute(tree, NameAndType(names[i], sourceDescriptor.type(i)), defaultValue,
+            array.isHidden(), array.isTransient());
+    }
+
+    std::vector<Name> groups;
+
+    const Descriptor& descriptor = tree.cbeginLeaf()->attributeSet().descriptor();
+
+    for (Descriptor::ConstIterator it = sourceDescriptor.groupMap().begin(),
+        itEnd = sourceDescriptor.groupMap().end(); it != itEnd; ++it) {
+        if (!descriptor.hasGroup(it->first))    groups.push_back(it->first);
+    }
+
+    appendGroups(tree, groups);
+}
+
+
+/// @brief Map the attributes and groups of an attribute set onto a merged attribute set
+inline void
+mapAttributes(  std::vector<size_t>& attributeMap,
+                GroupByteMaps& groupMaps,
+                const AttributeSet& attributeSet,
+                const AttributeSet& mergedSet)
+{
+    typedef AttributeSet::Descriptor                            Descriptor;
+
+    const Descriptor& descriptor = attributeSet.descriptor();
+    const Descriptor& mergedDescriptor = mergedSet.descriptor();
+
+    attributeMap.assign(mergedSet.size(), AttributeSet::INVALID_POS);
+
+    // group attributes can be copied as a whole if the groups are at the same offsets
+
+    bool sameGroups = descriptor.groupMap() == mergedDescriptor.groupMap();
+
+    for (size_t i = 0; i < mergedSet.size() && sameGroups; i++) {
+        if (!GroupAttributeArray::isGroup(*mergedSet.getConst(i)))  continue;
+        sameGroups = i < attributeSet.size() && GroupAttributeArray::isGroup(*attributeSet.getConst(i));
+    }
+
+    for (Descriptor::ConstIterator it = mergedDescriptor.map().begin(),
+        itEnd = mergedDescriptor.map().end(); it != itEnd; ++it) {
+
+        const size_t mergedIndex = it->second;
+
+        if (GroupAttributeArray::isGroup(*mergedSet.getConst(mergedIndex))) {
+            if (sameGroups)     attributeMap[mergedIndex] = mergedIndex;
+        }
+        else {
+            attributeMap[mergedIndex] = descriptor.find(it->first);
+        }
+    }
+
+    groupMaps.clear();
+
+    if (sameGroups)     return;
+
+    // otherwise build a lookup for each pair of source and merged group attributes
+
+    for (Descriptor::ConstIterator it = descriptor.groupMap().begin(),
+        itEnd = descriptor.groupMap().end(); it != itEnd; ++it) {
+
+        const GroupIndex sourceIndex = attributeSet.groupIndex(it->first);
+        const GroupIndex mergedIndex = mergedSet.groupIndex(it->first);
+
+        size_t n = 0;
+        for (; n < groupMaps.size(); n++) {
+            if (groupMaps[n].sourceIndex == sourceIndex.first &&
+                groupMaps[n].targetIndex == mergedIndex.first)     break;
+        }
+
+        if (n == groupMaps.size())  groupMaps.push_back(GroupByteMap(sourceIndex.first, mergedIndex.first));
+
+        const GroupType sourceBit = GroupType(GroupType(1) << sourceIndex.second);
+        const GroupType mergedBit = GroupType(GroupType(1) << mergedIndex.second);
+
+        for (size_t value = 0; value < GroupByteMap::Size; value++) {
+            if (value & sourceBit)  groupMaps[n].bits[value] |= mergedBit;
+        }
+    }
+}
+
+
+template <typename PointDataGridT>
+inline void
+mergePoints(PointDataGridT& points, const std::vector<PointDataGridT*>& sources)
+{
+    typedef typename PointDataGridT::TreeType                   PointDataTreeT;
+    typedef typename PointDataTreeT::LeafNodeType               LeafT;
+    typedef typename tree::LeafManager<PointDataTreeT>          LeafManagerT;
+
+    using point_move_internal::PrepareSourceOp;
+    using point_move_internal::createTargetLeaves;
+
+    // gather the grids that contain points with the target first
+
+    std::vector<PointDataGridT*> grids;
+    grids.push_back(&points);
+
+    for (size_t i = 0; i < sources.size(); i++) {
+        if (sources[i] == &points) {
+            OPENVDB_THROW(ValueError, "Cannot merge a PointDataGrid into itself.");
+        }
+        if (sources[i])     grids.push_back(sources[i]);
+    }
+
+    std::vector<const LeafT*> firstLeaves;
+    std::vector<PointDataGridT*> nonEmptyGrids;
+
+    for (size_t i = 0; i < grids.size(); i++) {
+
+        typename PointDataTreeT::LeafCIter iter = grids[i]->constTree().cbeginLeaf();
+
+        if (!iter)  continue;
+
+        if (iter->attributeSet().descriptor().find("P") == AttributeSet::INVALID_POS) {
+            OPENVDB_THROW(KeyError, "Cannot find position attribute - P.");
+        }
+
+        firstLeaves.push_back(iter.getLeaf());
+        nonEmptyGrids.push_back(grids[i]);
+    }
+
+    if (nonEmptyGrids.empty() || (nonEmptyGrids.size() == 1 && nonEmptyGrids[0] == &points))    return;
+
+    grids.swap(nonEmptyGrids);
+
+    // reconcile the descriptors on a single-leaf prototype tree, the attribute arrays
+    // are shared with the first leaf but appending attributes and groups leaves them intact
+
+    PointDataTreeT prototypeTree;
+    prototypeTree.addLeaf(new LeafT(*firstLeaves.front()));
+
+    for (size_t i = 1; i < grids.size(); i++) {
+        appendMissingAttributes(prototypeTree, firstLeaves[i]->attributeSet());
+    }
+
+    const LeafT& prototype = *prototypeTree.cbeginLeaf();
+    const AttributeSet& mergedSet = prototype.attributeSet();
+    const size_t positionIndex = mergedSet.find("P");
+
+    std::vector<std::vector<size_t> > attributeMaps(grids.size());
+    std::vector<GroupByteMaps> groupMaps(grids.size());
+
+    for (size_t i = 0; i < grids.size(); i++) {
+        mapAttributes(attributeMaps[i], groupMaps[i], firstLeaves[i]->attributeSet(), mergedSet);
+    }
+
+    // flag the attributes that use a different codec in any grid to convert their values,
+    // positions are always written through an attribute handle
+
+    std::vector<bool> converted(mergedSet.size(), false);
+
+    for (size_t i = 0; i < grids.size(); i++) {
+        for (size_t j = 0; j < converted.size(); j++) {
+            const size_t sourceIndex = attributeMaps[i][j];
+            if (j == positionIndex || sourceIndex == AttributeSet::INVALID_POS)   continue;
+            const AttributeArray& sourceArray = *firstLeaves[i]->attributeSet().getConst(sourceIndex);
+            if (sourceArray.type() != mergedSet.getConst(j)->type())    converted[j] = true;
+        }
+    }
+
+    // merge the string tables of all grids if there are string attributes, the string
+    // indices of each grid are only remapped if its string table differs from the target
+
+    std::vector<StringIndices> stringMaps(grids.size());
+
+    bool hasStrings = false;
+
+    for (size_t i = 0; i < mergedSet.size() && !hasStrings; i++) {
+        hasStrings = isString(*mergedSet.getConst(i));
+    }
+
+    if (hasStrings) {
+        makeDescriptorUnique(prototypeTree);
+
+        StringMetaInserter inserter(mergedSet.descriptorPtr()->getMetadata());
+
+        for (size_t i = 0; i < grids.size(); i++) {
+            inserter.insert(firstLeaves[i]->attributeSet().descriptor().getMetadata(), stringMaps[i]);
+            if (isIdentityRemap(stringMaps[i]))     stringMaps[i].clear();
+        }
+    }
+
+    // collect the source leaves of all grids and the voxel positions and destinations of
+    // their points in the target index space, sorted by destination leaf
+
+    size_t leafCount = 0;
+
+    for (size_t i = 0; i < grids.size(); i++)  leafCount += grids[i]->constTree().leafCount();
+
+    std::vector<const LeafT*> sourceLeaves;
+    std::vector<size_t> sourceGrids;
+    std::vector<OriginAndIndexArray> destinations(leafCount);
+    LeafPositionArrays positions(leafCount);
+
+    sourceLeaves.reserve(leafCount);
+    sourceGrids.reserve(leafCount);
+
+    // record which attributes are compressed to re-compress them once merged
+
+    std::vector<bool> compressed(mergedSet.size(), false);
+
+    for (size_t i = 0; i < grids.size(); i++) {
+
+        LeafManagerT leafManager(grids[i]->tree());
+
+        const size_t leafOffset = sourceLeaves.size();
+        const size_t gridPositionIndex = firstLeaves[i]->attributeSet().find("P");
+
+        for (size_t n = 0; n < leafManager.leafCount(); n++) {
+            const LeafT& leaf = leafManager.leaf(n);
+            sourceLeaves.push_back(&leaf);
+            sourceGrids.push_back(i);
+            for (size_t j = 0; j < compressed.size(); j++) {
+                const size_t sourceIndex = attributeMaps[i][j];
+                if (sourceIndex == AttributeSet::INVALID_POS)   continue;
+                if (leaf.constAttributeArray(sourceIndex).isCompressed())     compressed[j] = true;
+            }
+        }
+
+        tbb::parallel_for(leafManager.leafRange(), PrepareSourceOp<PointDataTreeT>());
+
+        TransformPositionsOp<PointDataTreeT> transformPositions(destinations, positions,
+            leafOffset, grids[i]->constTransform(), points.constTransform(), gridPositionIndex);
+        tbb::parallel_for(leafManager.leafRange(), transformPositions);
+    }
+
+    // create the destination leaves and populate them in parallel
+
+    typename PointDataTreeT::Ptr newTree(new PointDataTreeT(points.tree().background()));
+
+    std::vector<LeafT*> targetLeaves;
+    std::vector<PointRuns> targetRuns;
+
+    createTargetLeaves(*newTree, targetLeaves, targetRuns, destinations);
+
+    MergeLeafOp<PointDataTreeT> merge(targetLeaves, targetRuns, sourceLeaves, sourceGrids,
+        destinations, positions, prototype, attributeMaps, groupMaps, stringMaps, compressed,
+        converted, positionIndex);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, targetLeaves.size()), merge);
+
+    points.setTree(newTree);
+}
+
+
+} // namespace point_merge_internal
+
+
+////////////////////////////////////////
+
+
+template <typename PointDataGridT>
+inline void mergePoints(PointDataGridT& points,
+                        const std::vector<typename PointDataGridT::Ptr>& sources)
+{
+    std::vector<PointDataGridT*> grids;
+    grids.reserve(sources.size());
+
+    for (size_t i = 0; i < sources.size(); i++)     grids.push_back(sources[i].get());
+
+    point_merge_internal::mergePoints(points, grids);
+}
+
+
+template <typename PointDataGridT>
+inline void mergePoints(PointDataGridT& points,
+                        PointDataGridT& source)
+{
+    std::vector<PointDataGridT*> grids;
+    grids.push_back(&source);
+
+    point_merge_internal::mergePoints(points, grids);
+}
+
+
+////////////////////////////////////////
+
+
+} // namespace tools
+} // namespace OPENVDB_VERSION_NAME
+} // namespace openvdb
+
+
+#endif // OPENVDB_TOOLS_POINT_MERGE_HAS_BEEN_INCLUDED
+
+
+// Copyright (c) 2015-2016 Double Negative Visual Effects
+// All rights reserved. This software is distributed under the
+// Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
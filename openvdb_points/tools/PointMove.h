@@ -0,0 +1,886 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2015-2016 Double Negative Visual Effects
+//
+// All rights reserved. This software is distributed under the
+// Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
+//
+// Redistributions of source code must retain the above copyright
+// and license notice and the following restrictions and disclaimer.
+//
+// *     Neither the name of Double Negative Visual Effects nor the names
+// of its contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// IN NO EVENT SHALL THE COPYRIGHT HOLDERS' AND CONTRIBUTORS' AGGREGATE
+// LIABILITY FOR ALL CLAIMS REGARDLESS OF THEIR BASIS EXCEED US$250.00.
+//
+///////////////////////////////////////////////////////////////////////////
+//
+/// @file PointMove.h
+///
+/// @brief  Move points of a VDB Point Grid between voxels and leaf nodes.
+///
+
+
+#ifndef OPENVDB_TOOLS_POINT_MOVE_HAS_BEEN_INCLUDED
+#define OPENVDB_TOOLS_POINT_MOVE_HAS_BEEN_INCLUDED
+
+#include <openvdb/openvdb.h>
+#include <openvdb/tree/LeafManager.h>
+
+#include <openvdb_points/tools/AttributeArray.h>
+#include <openvdb_points/tools/AttributeGroup.h>
+#include <openvdb_points/tools/AttributeSet.h>
+#include <openvdb_points/tools/PointConversion.h>
+#include <openvdb_points/tools/PointDataGrid.h>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+namespace openvdb {
+OPENVDB_USE_VERSION_NAMESPACE
+namespace OPENVDB_VERSION_NAME {
+namespace tools {
+
+
+/// @brief Move the points of a PointDataGrid using a deformer of world-space positions.
+///
+/// @param points       the PointDataGrid.
+/// @param deformer     the deformer, which is copied for each thread of execution and
+///                     must provide @c reset(leaf, leafIndex), called before the points
+///                     of each leaf are deformed, and @c apply(position, indexIter) to
+///                     modify the world-space position of a point.
+///
+/// @note If any point changes voxel, all points are re-bucketed into new voxels and
+/// leaves in parallel, with all attributes and group membership. Within each voxel,
+/// points are ordered by source leaf and then by source index so the result is
+/// deterministic, and voxels containing points are active. Otherwise positions are
+/// updated in place and the topology is unchanged.
+template <typename PointDataGridT, typename DeformerT>
+inline void movePoints( PointDataGridT& points,
+                        const DeformerT& deformer);
+
+
+/// @brief Re-bucket points with voxel-space positions that lie outside of their voxel,
+/// such as after the position attribute has been modified in place.
+///
+/// @param points       the PointDataGrid.
+template <typename PointDataGridT>
+inline void reorderPoints(PointDataGridT& points);
+
+
+/// @brief Rebuild a PointDataGrid with a new transform.
+///
+/// @param points       the PointDataGrid.
+/// @param transform    the new transform.
+///
+/// @note The positions of the points are computed directly in the index space of the
+/// new transform and all points are re-bucketed along with all of their attributes and
+/// group membership in a single parallel pass.
+template <typename PointDataGridT>
+inline void resamplePoints( PointDataGridT& points,
+                            const math::Transform& transform);
+
+
+/// @brief Rebuild a PointDataGrid with a voxel size chosen to give the target
+/// average number of points per active voxel.
+///
+/// @param points           the PointDataGrid.
+/// @param pointsPerVoxel   the target average number of points per active voxel.
+///
+/// @note The voxel size is estimated with computeVoxelSize() from the world-space
+/// positions, which are read in place rather than copied. The grid is unchanged if
+/// there are fewer than two distinct positions.
+template <typename PointDataGridT>
+inline void resamplePoints( PointDataGridT& points,
+                            const float pointsPerVoxel);
+
+
+/// @brief A deformer that leaves the position of every point unchanged.
+struct NullDeformer
+{
+    template <typename LeafT>
+    void reset(const LeafT&, size_t) { }
+
+    template <typename IterT>
+    void apply(Vec3d&, const IterT&) const { }
+}; // struct NullDeformer
+
+
+////////////////////////////////////////
+
+
+namespace point_move_internal {
+
+
+/// @brief The new voxel-space position of a point and the offset of its voxel in its
+/// destination leaf, the index-space position itself is not retained
+struct VoxelPosition
+{
+    VoxelPosition() : position(), offset(0) { }
+    Vec3f position;
+    Index offset;
+};
+
+typedef std::vector<VoxelPosition>      PositionArray;
+typedef std::vector<PositionArray>      LeafPositionArrays;
+
+
+/// @brief A contiguous run of points in a source leaf that share a destination leaf
+struct PointRun
+{
+    PointRun(const size_t _sourceLeaf, const size_t _begin, const size_t _end)
+        : sourceLeaf(_sourceLeaf), begin(_begin), end(_end) { }
+    size_t sourceLeaf;
+    size_t begin;
+    size_t end;
+};
+
+typedef std::vector<PointRun>                   PointRuns;
+typedef std::pair<Coord, Index>                 OriginAndIndex;
+typedef std::vector<OriginAndIndex>             OriginAndIndexArray;
+typedef std::pair<Index, Index>                 LeafAndIndex;
+typedef std::vector<LeafAndIndex>               LeafAndIndexArray;
+
+
+/// @brief Record the destination leaf origin and the voxel position of a point from its
+/// new index-space position
+template <typename LeafT>
+inline void
+setDestination( OriginAndIndexArray& destinations,
+                PositionArray& positions,
+                const Index index,
+                const Vec3d& xyz)
+{
+    const Coord ijk = Coord::round(xyz);
+
+    destinations[index] = OriginAndIndex(ijk & ~(Int32(LeafT::DIM) - 1), index);
+
+    positions[index].position = Vec3f(xyz - ijk.asVec3d());
+    positions[index].offset = LeafT::coordToOffset(ijk);
+}
+
+
+/// @brief Gather the source leaf and point index of every point in the runs of a
+/// destination leaf and sort them by voxel, computing the voxel offsets of the leaf
+///
+/// @note The sort is stable so the order of points within each voxel is the run order.
+template <typename LeafT>
+inline void
+sortPointsByVoxel(  LeafAndIndexArray& sources,
+                    std::vector<typename LeafT::ValueType>& offsets,
+                    const PointRuns& runs,
+                    const std::vector<OriginAndIndexArray>& destinations,
+                    const LeafPositionArrays& positions)
+{
+    typedef typename LeafT::ValueType ValueType;
+
+    LeafAndIndexArray unsorted;
+
+    for (PointRuns::const_iterator it = runs.begin(), itEnd = runs.end(); it != itEnd; ++it) {
+        const OriginAndIndexArray& leafDestinations = destinations[it->sourceLeaf];
+        for (size_t i = it->begin; i < it->end; i++) {
+            unsorted.push_back(LeafAndIndex(Index(it->sourceLeaf), leafDestinations[i].second));
+        }
+    }
+
+    const size_t count = unsorted.size();
+
+    // counting sort by voxel
+
+    std::vector<Index> voxelOffsets(count);
+    std::vector<Index> counts(LeafT::SIZE, Index(0));
+
+    for (size_t i = 0; i < count; i++) {
+        voxelOffsets[i] = positions[unsorted[i].first][unsorted[i].second].offset;
+        counts[voxelOffsets[i]]++;
+    }
+
+    // convert the counts into the start offset of each voxel
+
+    offsets.resize(LeafT::SIZE);
+
+    Index total = 0;
+
+    for (size_t i = 0; i < counts.size(); i++) {
+        const Index start = total;
+        total += counts[i];
+        counts[i] = start;
+        offsets[i] = ValueType(total);
+    }
+
+    sources.resize(count);
+
+    for (size_t i = 0; i < count; i++) {
+        sources[counts[voxelOffsets[i]]++] = unsorted[i];
+    }
+}
+
+
+/// @brief Match the hidden, transient and group flags of a source attribute array
+inline void
+copyAttributeFlags(AttributeArray& array, const AttributeArray& sourceArray)
+{
+    array.setHidden(sourceArray.isHidden());
+    array.setTransient(sourceArray.isTransient());
+
+    if (GroupAttributeArray::isGroup(sourceArray)) {
+        GroupAttributeArray& groupArray = GroupAttributeArray::cast(array);
+        groupArray.setGroup(true);
+        groupArray.setSparseThreshold(GroupAttributeArray::cast(sourceArray).sparseThreshold());
+    }
+}
+
+
+/// @brief Store the new voxel-space positions of the sorted source points
+inline void
+setVoxelPositions(  AttributeArray& array,
+                    const LeafAndIndexArray& sources,
+                    const LeafPositionArrays& positions)
+{
+    AttributeWriteHandle<Vec3f> handle(array);
+
+    for (size_t i = 0; i < sources.size(); i++) {
+        handle.set(Index(i), positions[sources[i].first][sources[i].second].position);
+    }
+}
+
+
+/// @brief Copy the values of an attribute from the sorted source points, consecutive points
+/// of the same source leaf are copied as a single run
+///
+/// @note If the first source array is uniform, the target is first set to its value so that
+/// it remains uniform when every source array shares the same uniform value.
+template <typename LeafT>
+inline void
+copySourceValues(   AttributeArray& array,
+                    const size_t attributeIndex,
+                    const LeafAndIndexArray& sources,
+                    const std::vector<const LeafT*>& sourceLeaves)
+{
+    const size_t count = sources.size();
+
+    const AttributeArray& firstArray =
+        sourceLeaves[sources.front().first]->constAttributeArray(attributeIndex);
+
+    if (firstArray.isUniform()) {
+        array.copyValuesUnsafe(0, firstArray, sources.front().second, Index(count));
+    }
+
+    for (size_t begin = 0, end = 0; begin < count; begin = end) {
+
+        const LeafAndIndex& source = sources[begin];
+
+        for (end = begin + 1; end < count && sources[end].first == source.first &&
+                              sources[end].second == source.second + Index(end - begin); end++) { }
+
+        array.copyValuesUnsafe(Index(begin), sourceLeaves[source.first]->constAttributeArray(attributeIndex),
+            source.second, Index(end - begin));
+    }
+}
+
+
+/// @brief Populate each destination leaf from the runs of points of the source leaves
+template <typename PointDataTreeT>
+struct PopulateLeafOp
+{
+    typedef typename PointDataTreeT::LeafNodeType       LeafT;
+    typedef typename LeafT::ValueType                   ValueType;
+    typedef AttributeSet::Descriptor                    Descriptor;
+
+    PopulateLeafOp( const std::vector<LeafT*>& targetLeaves,
+                    const std::vector<PointRuns>& targetRuns,
+                    const std::vector<const LeafT*>& sourceLeaves,
+                    const std::vector<OriginAndIndexArray>& destinations,
+                    const LeafPositionArrays& positions,
+                    const Descriptor::Ptr& descriptor,
+                    const std::vector<bool>& compressed,
+                    const size_t positionIndex)
+        : mTargetLeaves(targetLeaves)
+        , mTargetRuns(targetRuns)
+        , mSourceLeaves(sourceLeaves)
+        , mDestinations(destinations)
+        , mPositions(positions)
+        , mDescriptor(descriptor)
+        , mCompressed(compressed)
+        , mPositionIndex(positionIndex) { }
+
+    void operator()(const tbb::blocked_range<size_t>& range) const
+    {
+        std::vector<ValueType> offsets;
+        LeafAndIndexArray sources;
+
+        for (size_t n = range.begin(); n < range.end(); n++) {
+
+            LeafT& leaf = *mTargetLeaves[n];
+
+            sortPointsByVoxel<LeafT>(sources, offsets, mTargetRuns[n], mDestinations, mPositions);
+
+            const size_t count = sources.size();
+
+            leaf.setOffsets(offsets);
+            leaf.initializeAttributes(mDescriptor, count);
+
+            // copy every attribute (including groups) from the source points
+
+            for (size_t attributeIndex = 0; attributeIndex < mDescriptor->size(); attributeIndex++) {
+
+                AttributeArray& array = leaf.attributeArray(attributeIndex);
+
+                copyAttributeFlags(array,
+                    mSourceLeaves[sources.front().first]->constAttributeArray(attributeIndex));
+
+                if (attributeIndex == mPositionIndex) {
+                    setVoxelPositions(array, sources, mPositions);
+                }
+                else {
+                    copySourceValues(array, attributeIndex, sources, mSourceLeaves);
+                }
+
+                array.compact();
+
+                if (mCompressed[attributeIndex])    array.compress();
+            }
+        }
+    }
+
+    //////////
+
+    const std::vector<LeafT*>&                  mTargetLeaves;
+    const std::vector<PointRuns>&               mTargetRuns;
+    const std::vector<const LeafT*>&            mSourceLeaves;
+    const std::vector<OriginAndIndexArray>&     mDestinations;
+    const LeafPositionArrays&                   mPositions;
+    const Descriptor::Ptr&                      mDescriptor;
+    const std::vector<bool>&                    mCompressed;
+    const size_t                                mPositionIndex;
+}; // struct PopulateLeafOp
+
+
+/// @brief Load and decompress all attribute arrays of the source leaves so that they
+/// can be read concurrently without modification
+template <typename PointDataTreeT>
+struct PrepareSourceOp
+{
+    typedef typename tree::LeafManager<PointDataTreeT> LeafManagerT;
+
+    void operator()(const typename LeafManagerT::LeafRange& range) const
+    {
+        for (typename LeafManagerT::LeafRange::Iterator leaf=range.begin(); leaf; ++leaf) {
+            for (size_t i = 0; i < leaf->attributeSet().size(); i++) {
+                AttributeArray& array = leaf->attributeArray(i);
+                array.loadData();
+                array.decompress();
+            }
+        }
+    }
+}; // struct PrepareSourceOp
+
+
+/// @brief Create the destination leaves of a tree in source leaf order and collect the
+/// runs of points that contribute to each of them
+template <typename PointDataTreeT>
+inline void
+createTargetLeaves( PointDataTreeT& tree,
+                    std::vector<typename PointDataTreeT::LeafNodeType*>& targetLeaves,
+                    std::vector<PointRuns>& targetRuns,
+                    const std::vector<OriginAndIndexArray>& destinations)
+{
+    std::map<Coord, size_t> targetIndices;
+
+    for (size_t n = 0; n < destinations.size(); n++) {
+
+        const OriginAndIndexArray& leafDestinations = destinations[n];
+
+        for (size_t begin = 0, end = 0; begin < leafDestinations.size(); begin = end) {
+
+            const Coord& origin = leafDestinations[begin].first;
+
+            for (end = begin + 1; end < leafDestinations.size() &&
+                                  leafDestinations[end].first == origin; end++) { }
+
+            std::map<Coord, size_t>::iterator it = targetIndices.find(origin);
+
+            if (it == targetIndices.end()) {
+                it = targetIndices.insert(std::make_pair(origin, targetLeaves.size())).first;
+                targetLeaves.push_back(tree.touchLeaf(origin));
+                targetRuns.push_back(PointRuns());
+            }
+
+            targetRuns[it->second].push_back(PointRun(n, begin, end));
+        }
+    }
+}
+
+
+/// @brief Re-bucket the points of a tree into new voxels and leaves from their
+/// destinations sorted by leaf origin and their new voxel positions (indexed by leaf
+/// and then by point index)
+template <typename PointDataGridT>
+inline void
+rebucketPoints( PointDataGridT& points,
+                const std::vector<OriginAndIndexArray>& destinations,
+                const LeafPositionArrays& positions,
+                const size_t positionIndex)
+{
+    typedef typename PointDataGridT::TreeType                   PointDataTreeT;
+    typedef typename PointDataTreeT::LeafNodeType               LeafT;
+    typedef typename tree::LeafManager<PointDataTreeT>          LeafManagerT;
+    typedef AttributeSet::Descriptor                            Descriptor;
+
+    PointDataTreeT& tree = points.tree();
+
+    LeafManagerT leafManager(tree);
+
+    const size_t leafCount = leafManager.leafCount();
+
+    if (leafCount == 0)     return;
+
+    const Descriptor::Ptr descriptor = leafManager.leaf(0).attributeSet().descriptorPtr();
+
+    // record which attributes are compressed to re-compress them once moved
+
+    std::vector<bool> compressed(descriptor->size(), false);
+
+    std::vector<const LeafT*> sourceLeaves(leafCount);
+
+    for (size_t n = 0; n < leafCount; n++) {
+        const LeafT& leaf = leafManager.leaf(n);
+        sourceLeaves[n] = &leaf;
+        for (size_t i = 0; i < compressed.size(); i++) {
+            if (leaf.constAttributeArray(i).isCompressed())     compressed[i] = true;
+        }
+    }
+
+    tbb::parallel_for(leafManager.leafRange(), PrepareSourceOp<PointDataTreeT>());
+
+    // create the destination leaves and collect the runs of points that contribute
+    // to each of them in source leaf order
+
+    typename PointDataTreeT::Ptr newTree(new PointDataTreeT(tree.background()));
+
+    std::vector<LeafT*> targetLeaves;
+    std::vector<PointRuns> targetRuns;
+
+    createTargetLeaves(*newTree, targetLeaves, targetRuns, destinations);
+
+    // populate the destination leaves in parallel
+
+    PopulateLeafOp<PointDataTreeT> populate(targetLeaves, targetRuns, sourceLeaves,
+        destinations, positions, descriptor, compressed, positionIndex);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, targetLeaves.size()), populate);
+
+    points.setTree(newTree);
+}
+
+
+/// @brief Deform the world-space position of every point of every leaf and store the
+/// resulting voxel positions and destinations sorted by destination leaf origin
+template <typename PointDataTreeT, typename DeformerT>
+struct DeformPositionsOp
+{
+    typedef typename tree::LeafManager<PointDataTreeT>          LeafManagerT;
+    typedef typename PointDataTreeT::LeafNodeType               LeafT;
+    typedef typename LeafT::IndexAllIter                        IndexAllIter;
+
+    DeformPositionsOp(  std::vector<OriginAndIndexArray>& destinations,
+                        LeafPositionArrays& positions,
+                        std::vector<char>& moved,
+                        const math::Transform& transform,
+                        const DeformerT& deformer,
+                        const size_t positionIndex)
+        : mDestinations(destinations)
+        , mPositions(positions)
+        , mMoved(moved)
+        , mTransform(transform)
+        , mDeformer(deformer)
+        , mPositionIndex(positionIndex) { }
+
+    void operator()(const typename LeafManagerT::LeafRange& range) const
+    {
+        DeformerT deformer(mDeformer);
+
+        for (typename LeafManagerT::LeafRange::Iterator leaf=range.begin(); leaf; ++leaf) {
+
+            deformer.reset(*leaf, leaf.pos());
+
+            OriginAndIndexArray& destinations = mDestinations[leaf.pos()];
+            PositionArray& positions = mPositions[leaf.pos()];
+            destinations.resize(leaf->pointCount());
+            positions.resize(leaf->pointCount());
+
+            AttributeHandle<Vec3f>::Ptr positionHandle =
+                AttributeHandle<Vec3f>::create(leaf->constAttributeArray(mPositionIndex));
+
+            bool moved = false;
+
+            for (IndexAllIter iter = leaf->beginIndexAll(); iter; ++iter) {
+                const Index index = Index(*iter);
+                const Coord& ijk = iter.getCoord();
+                Vec3d position = mTransform.indexToWorld(ijk.asVec3d() + Vec3d(positionHandle->get(index)));
+                deformer.apply(position, iter);
+                const Vec3d xyz = mTransform.worldToIndex(position);
+                setDestination<LeafT>(destinations, positions, index, xyz);
+                if (Coord::round(xyz) != ijk)   moved = true;
+            }
+
+            // sorting by origin then index keeps the order of points deterministic
+
+            std::sort(destinations.begin(), destinations.end());
+
+            mMoved[leaf.pos()] = moved ? 1 : 0;
+        }
+    }
+
+    //////////
+
+    std::vector<OriginAndIndexArray>&   mDestinations;
+    LeafPositionArrays&                 mPositions;
+    std::vector<char>&                  mMoved;
+    const math::Transform&              mTransform;
+    const DeformerT&                    mDeformer;
+    const size_t                        mPositionIndex;
+}; // struct DeformPositionsOp
+
+
+/// @brief Compute the voxel positions of every point of every leaf in the index space
+/// of the target transform along with their destinations sorted by destination leaf origin
+template <typename PointDataTreeT>
+struct TransformPositionsOp
+{
+    typedef typename tree::LeafManager<PointDataTreeT>          LeafManagerT;
+    typedef typename PointDataTreeT::LeafNodeType               LeafT;
+    typedef typename LeafT::IndexAllIter                        IndexAllIter;
+
+    TransformPositionsOp(   std::vector<OriginAndIndexArray>& destinations,
+                            LeafPositionArrays& positions,
+                            const size_t leafOffset,
+                            const math::Transform& sourceTransform,
+                            const math::Transform& targetTransform,
+                            const size_t positionIndex)
+        : mDestinations(destinations)
+        , mPositions(positions)
+        , mLeafOffset(leafOffset)
+        , mSourceTransform(sourceTransform)
+        , mTargetTransform(targetTransform)
+        , mSameTransform(sourceTransform == targetTransform)
+        , mPositionIndex(positionIndex) { }
+
+    void operator()(const typename LeafManagerT::LeafRange& range) const
+    {
+        for (typename LeafManagerT::LeafRange::Iterator leaf=range.begin(); leaf; ++leaf) {
+
+            OriginAndIndexArray& destinations = mDestinations[mLeafOffset + leaf.pos()];
+            PositionArray& positions = mPositions[mLeafOffset + leaf.pos()];
+            destinations.resize(leaf->pointCount());
+            positions.resize(leaf->pointCount());
+
+            AttributeHandle<Vec3f>::Ptr positionHandle =
+                AttributeHandle<Vec3f>::create(leaf->constAttributeArray(mPositionIndex));
+
+            for (IndexAllIter iter = leaf->beginIndexAll(); iter; ++iter) {
+                const Index index = Index(*iter);
+                const Vec3d xyz = iter.getCoord().asVec3d() + Vec3d(positionHandle->get(index));
+                setDestination<LeafT>(destinations, positions, index, mSameTransform ? xyz :
+                    mTargetTransform.worldToIndex(mSourceTransform.indexToWorld(xyz)));
+            }
+
+            // sorting by origin then index keeps the order of points deterministic
+
+            std::sort(destinations.begin(), destinations.end());
+        }
+    }
+
+    //////////
+
+    std::vector<OriginAndIndexArray>&   mDestinations;
+    LeafPositionArrays&                 mPositions;
+    const size_t                        mLeafOffset;
+    const math::Transform&              mSourceTransform;
+    const math::Transform&              mTargetTransform;
+    const bool                          mSameTransform;
+    const size_t                        mPositionIndex;
+}; // struct TransformPositionsOp
+
+
+/// @brief Update the voxel-space positions of points that remain in their voxels
+template <typename PointDataTreeT>
+struct UpdatePositionsOp
+{
+    typedef typename tree::LeafManager<PointDataTreeT>          LeafManagerT;
+    typedef typename PointDataTreeT::LeafNodeType               LeafT;
+    typedef typename LeafT::IndexAllIter                        IndexAllIter;
+
+    UpdatePositionsOp(  const LeafPositionArrays& positions,
+                        const size_t positionIndex)
+        : mPositions(positions)
+        , mPositionIndex(positionIndex) { }
+
+    void operator()(const typename LeafManagerT::LeafRange& range) const
+    {
+        for (typename LeafManagerT::LeafRange::Iterator leaf=range.begin(); leaf; ++leaf) {
+
+            const PositionArray& positions = mPositions[leaf.pos()];
+
+            AttributeArray& array = leaf->attributeArray(mPositionIndex);
+
+            const bool compressed = array.isCompressed();
+
+            {
+                AttributeWriteHandle<Vec3f> handle(array);
+
+                for (IndexAllIter iter = leaf->beginIndexAll(); iter; ++iter) {
+                    const Index index = Index(*iter);
+                    handle.set(index, positions[index].position);
+                }
+            }
+
+            array.compact();
+
+            if (compressed)     array.compress();
+        }
+    }
+
+    //////////
+
+    const LeafPositionArrays&   mPositions;
+    const size_t                mPositionIndex;
+}; // struct UpdatePositionsOp
+
+
+/// @brief Point-partitioner compatible wrapper of the world-space positions of the points
+/// of a PointDataTree, read in place from the position attribute of each leaf
+template <typename PointDataTreeT>
+class WorldPositionWrapper
+{
+public:
+    typedef Vec3d                                               PosType;
+    typedef typename PointDataTreeT::LeafNodeType               LeafT;
+
+    WorldPositionWrapper(   const PointDataTreeT& tree,
+                            const math::Transform& transform,
+                            const size_t positionIndex)
+        : mTransform(transform)
+        , mCount(0)
+    {
+        for (typename PointDataTreeT::LeafCIter iter = tree.cbeginLeaf(); iter; ++iter) {
+            if (iter->pointCount() == 0)    continue;
+            mCount += iter->pointCount();
+            mLeaves.push_back(iter.getLeaf());
+            mHandles.push_back(AttributeHandle<Vec3f>::create(iter->constAttributeArray(positionIndex)));
+            mOffsets.push_back(mCount);
+        }
+    }
+
+    size_t size() const { return size_t(mCount); }
+
+    void getPos(size_t n, PosType& xyz) const
+    {
+        // find the leaf from the cumulative point offsets
+
+        const size_t leaf = std::upper_bound(mOffsets.begin(), mOffsets.end(), Index64(n)) - mOffsets.begin();
+        const Index index = Index(Index64(n) - (leaf == 0 ? 0 : mOffsets[leaf - 1]));
+
+        // find the voxel from the cumulative voxel offsets of the leaf
+
+        const LeafT& node = *mLeaves[leaf];
+
+        Index begin = 0, end = LeafT::SIZE;
+
+        while (begin < end) {
+            const Index middle = (begin + end) / 2;
+            if (index < Index(node.getValue(middle)))   end = middle;
+            else                                        begin = middle + 1;
+        }
+
+        xyz = mTransform.indexToWorld(node.offsetToGlobalCoord(begin).asVec3d() +
+            Vec3d(mHandles[leaf]->get(index)));
+    }
+
+private:
+    const math::Transform&                          mTransform;
+    Index64                                         mCount;
+    std::vector<const LeafT*>                       mLeaves;
+    std::vector<AttributeHandle<Vec3f>::Ptr>        mHandles;
+    std::vector<Index64>                            mOffsets;
+}; // class WorldPositionWrapper
+
+
+} // namespace point_move_internal
+
+
+////////////////////////////////////////
+
+
+template <typename PointDataGridT, typename DeformerT>
+inline void movePoints( PointDataGridT& points,
+                        const DeformerT& deformer)
+{
+    typedef typename PointDataGridT::TreeType                   PointDataTreeT;
+    typedef typename tree::LeafManager<PointDataTreeT>          LeafManagerT;
+
+    using point_move_internal::OriginAndIndexArray;
+    using point_move_internal::LeafPositionArrays;
+    using point_move_internal::DeformPositionsOp;
+    using point_move_internal::UpdatePositionsOp;
+    using point_move_internal::rebucketPoints;
+
+    typename PointDataTreeT::LeafCIter iter = points.constTree().cbeginLeaf();
+
+    if (!iter)  return;
+
+    const size_t positionIndex = iter->attributeSet().descriptor().find("P");
+
+    if (positionIndex == AttributeSet::INVALID_POS) {
+        OPENVDB_THROW(KeyError, "Cannot find position attribute - P.");
+    }
+
+    // compute the new voxel positions and destinations of all points
+
+    const size_t leafCount = points.constTree().leafCount();
+
+    std::vector<OriginAndIndexArray> destinations(leafCount);
+    LeafPositionArrays positions(leafCount);
+    std::vector<char> moved(leafCount, 0);
+
+    DeformPositionsOp<PointDataTreeT, DeformerT> deform(destinations, positions, moved,
+        points.constTransform(), deformer, positionIndex);
+    tbb::parallel_for(LeafManagerT(points.tree()).leafRange(), deform);
+
+    // move the points into their new voxels and leaves only if required
+
+    if (std::find(moved.begin(), moved.end(), 1) != moved.end()) {
+        rebucketPoints(points, destinations, positions, positionIndex);
+    }
+    else {
+        UpdatePositionsOp<PointDataTreeT> update(positions, positionIndex);
+        tbb::parallel_for(LeafManagerT(points.tree()).leafRange(), update);
+    }
+}
+
+
+template <typename PointDataGridT>
+inline void reorderPoints(PointDataGridT& points)
+{
+    movePoints(points, NullDeformer());
+}
+
+
+template <typename PointDataGridT>
+inline void resamplePoints( PointDataGridT& points,
+                            const math::Transform& transform)
+{
+    typedef typename PointDataGridT::TreeType                   PointDataTreeT;
+    typedef typename tree::LeafManager<PointDataTreeT>          LeafManagerT;
+
+    using point_move_internal::OriginAndIndexArray;
+    using point_move_internal::LeafPositionArrays;
+    using point_move_internal::TransformPositionsOp;
+    using point_move_internal::rebucketPoints;
+
+    if (points.constTransform() == transform)   return;
+
+    typename PointDataTreeT::LeafCIter iter = points.constTree().cbeginLeaf();
+
+    if (iter) {
+
+        const size_t positionIndex = iter->attributeSet().descriptor().find("P");
+
+        if (positionIndex == AttributeSet::INVALID_POS) {
+            OPENVDB_THROW(KeyError, "Cannot find position attribute - P.");
+        }
+
+        // compute the voxel positions and destinations of all points in the new transform
+
+        const size_t leafCount = points.constTree().leafCount();
+
+        std::vector<OriginAndIndexArray> destinations(leafCount);
+        LeafPositionArrays positions(leafCount);
+
+        LeafManagerT leafManager(points.tree());
+
+        TransformPositionsOp<PointDataTreeT> transformPositions(destinations, positions,
+            /*leafOffset=*/0, points.constTransform(), transform, positionIndex);
+        tbb::parallel_for(leafManager.leafRange(), transformPositions);
+
+        rebucketPoints(points, destinations, positions, positionIndex);
+    }
+
+    points.setTransform(transform.copy());
+}
+
+
+template <typename PointDataGridT>
+inline void resamplePoints( PointDataGridT& points,
+                            const float pointsPerVoxel)
+{
+    typedef typename PointDataGridT::TreeType                   PointDataTreeT;
+
+    using point_move_internal::WorldPositionWrapper;
+
+    if (pointsPerVoxel <= 0.0f) {
+        OPENVDB_THROW(ValueError, "Points per voxel must be positive - " << pointsPerVoxel << ".");
+    }
+
+    typename PointDataTreeT::LeafCIter iter = points.constTree().cbeginLeaf();
+
+    if (!iter)  return;
+
+    const size_t positionIndex = iter->attributeSet().descriptor().find("P");
+
+    if (positionIndex == AttributeSet::INVALID_POS) {
+        OPENVDB_THROW(KeyError, "Cannot find position attribute - P.");
+    }
+
+    // estimate the voxel size from the world-space positions, which are read in place
+
+    float voxelSize = 0.0f;
+
+    {
+        const WorldPositionWrapper<PointDataTreeT> positions(points.constTree(),
+            points.constTransform(), positionIndex);
+
+        voxelSize = computeVoxelSize(positions, pointsPerVoxel);
+    }
+
+    if (voxelSize <= 0.0f)  return;
+
+    // scale the current transform so that any rotation is retained
+
+    math::Transform::Ptr transform = points.constTransform().copy();
+    transform->preScale(double(voxelSize) / points.constTransform().voxelSize()[0]);
+
+    resamplePoints(points, *transform);
+}
+
+
+////////////////////////////////////////
+
+
+} // namespace tools
+} // namespace OPENVDB_VERSION_NAME
+} // namespace openvdb
+
+
+#endif // OPENVDB_TOOLS_POINT_MOVE_HAS_BEEN_INCLUDED
+
+
+// Copyright (c) 2015-2016 Double Negative Visual Effects
+// All rights reserved. This software is distributed under the
+// Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
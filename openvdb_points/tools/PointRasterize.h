@@ -0,0 +1,809 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2015-2016 Double Negative Visual Effects
+//
+// All rights reserved. This software is distributed under the
+// Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
+//
+// Redistributions of source code must retain the above copyright
+// and license notice and the following restrictions and disclaimer.
+//
+// *     Neither the name of Double Negative Visual Effects nor the names
+// of its contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// IN NO EVENT SHALL THE COPYRIGHT HOLDERS' AND CONTRIBUTORS' AGGREGATE
+// LIABILITY FOR ALL CLAIMS REGARDLESS OF THEIR BASIS EXCEED US$250.00.
+//
+///////////////////////////////////////////////////////////////////////////
+//
+/// @file PointRasterize.h
+///
+/// @brief  Rasterize points from a VDB Point Grid into density grids and level sets.
+///
+
+
+#ifndef OPENVDB_TOOLS_POINT_RASTERIZE_HAS_BEEN_INCLUDED
+#define OPENVDB_TOOLS_POINT_RASTERIZE_HAS_BEEN_INCLUDED
+
+#include <openvdb/openvdb.h>
+#include <openvdb/tree/LeafManager.h>
+#include <openvdb/tools/Prune.h>
+#include <openvdb/tools/SignedFloodFill.h>
+
+#include <openvdb_points/tools/AttributeArray.h>
+#include <openvdb_points/tools/AttributeSet.h>
+#include <openvdb_points/tools/PointDataGrid.h>
+
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_reduce.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace openvdb {
+OPENVDB_USE_VERSION_NAMESPACE
+namespace OPENVDB_VERSION_NAME {
+namespace tools {
+
+
+/// @brief Kernels used to distribute the weight of each point into density voxels.
+enum DensityKernel
+{
+    DENSITY_NEAREST = 0,    ///< accumulate into the nearest voxel
+    DENSITY_TRILINEAR,      ///< distribute between the eight surrounding voxels
+    DENSITY_SMOOTH          ///< distribute with a smooth falloff over a radius
+};
+
+
+/// @brief Rasterize the points of a PointDataGrid into a density grid.
+///
+/// @param points           the PointDataGrid.
+/// @param transform        the transform of the density grid.
+/// @param kernel           the kernel used to distribute the weight of each point.
+/// @param weightAttribute  the name of a float attribute to weight each point by,
+///                         if empty each point has a weight of one.
+/// @param radius           the support radius of the smooth kernel in voxels.
+///
+/// @throw ValueError if the smooth kernel is used with a radius that is not positive.
+///
+/// @note The contribution of every point is normalized so that the sum of all density
+/// values equals the sum of the point weights regardless of the kernel.
+/// @note When @a transform matches that of @a points, the nearest kernel re-uses the
+/// topology of the point grid and accumulates each leaf independently.
+template <typename PointDataGridT>
+inline FloatGrid::Ptr
+rasterizeDensity(   const PointDataGridT& points,
+                    const math::Transform& transform,
+                    const DensityKernel kernel = DENSITY_NEAREST,
+                    const Name& weightAttribute = "",
+                    const float radius = 1.0f);
+
+
+/// @brief Rasterize the points of a PointDataGrid as spheres into a narrow-band level set.
+///
+/// @param points           the PointDataGrid.
+/// @param transform        the transform of the level set, which must have uniform scale.
+/// @param radius           the world-space radius of each sphere, or the scale applied to
+///                         the radius attribute if one is provided.
+/// @param radiusAttribute  the name of a float attribute (such as "pscale") to provide
+///                         the radius of each point, if empty all points share a uniform radius.
+/// @param halfWidth        the half-width of the narrow band in voxel units.
+///
+/// @note Points are processed leaf by leaf directly from the PointDataGrid with each thread
+/// writing the union of its spheres into a separate tree prior to merging. Only the narrow
+/// band of each sphere is written and the interior is classified by a sign flood fill.
+template <typename PointDataGridT>
+inline FloatGrid::Ptr
+rasterizeSpheres(   const PointDataGridT& points,
+                    const math::Transform& transform,
+                    const float radius,
+                    const Name& radiusAttribute = "",
+                    const float halfWidth = float(LEVEL_SET_HALF_WIDTH));
+
+
+////////////////////////////////////////
+
+
+namespace point_rasterize_internal {
+
+
+/// @brief Return the index of an optional float attribute or INVALID_POS if no name is given
+template <typename LeafT>
+inline size_t floatAttributeIndex(const LeafT& leaf, const Name& name)
+{
+    if (name.empty())   return AttributeSet::INVALID_POS;
+
+    const size_t index = leaf.attributeSet().descriptor().find(name);
+
+    if (index == AttributeSet::INVALID_POS) {
+        OPENVDB_THROW(KeyError, "Cannot find requested attribute - " << name << ".");
+    }
+
+    if (!leaf.constAttributeArray(index).template hasValueType<float>()) {
+        OPENVDB_THROW(TypeError, "Attribute must be of float type - " << name << ".");
+    }
+
+    return index;
+}
+
+
+/// @brief Accumulate point weights into thread-local density trees that are merged on join
+template <typename PointDataTreeT>
+struct RasterizeDensityOp
+{
+    typedef typename tree::LeafManager<const PointDataTreeT>    LeafManagerT;
+    typedef typename PointDataTreeT::LeafNodeType               PointDataLeafT;
+    typedef typename PointDataLeafT::IndexOnIter                IndexOnIter;
+    typedef tree::ValueAccessor<FloatTree>                      AccessorT;
+    typedef FloatTree::LeafNodeType                             FloatLeafT;
+
+    RasterizeDensityOp( const math::Transform& sourceTransform,
+                        const math::Transform& targetTransform,
+                        const size_t positionIndex,
+                        const size_t weightIndex,
+                        const DensityKernel kernel,
+                        const float radius)
+        : mSourceTransform(sourceTransform)
+        , mTargetTransform(targetTransform)
+        , mPositionIndex(positionIndex)
+        , mWeightIndex(weightIndex)
+        , mKernel(kernel)
+        , mRadius(radius)
+        , mTree(new FloatTree(0.0f)) { }
+
+    RasterizeDensityOp(RasterizeDensityOp& other, tbb::split)
+        : mSourceTransform(other.mSourceTransform)
+        , mTargetTransform(other.mTargetTransform)
+        , mPositionIndex(other.mPositionIndex)
+        , mWeightIndex(other.mWeightIndex)
+        , mKernel(other.mKernel)
+        , mRadius(other.mRadius)
+        , mTree(new FloatTree(0.0f)) { }
+
+    void operator()(const typename LeafManagerT::LeafRange& range)
+    {
+        AccessorT accessor(*mTree);
+
+        for (typename LeafManagerT::LeafRange::Iterator leaf=range.begin(); leaf; ++leaf) {
+
+            AttributeHandle<Vec3f>::Ptr positionHandle =
+                AttributeHandle<Vec3f>::create(leaf->constAttributeArray(mPositionIndex));
+
+            AttributeHandle<float>::Ptr weightHandle;
+
+            if (mWeightIndex != AttributeSet::INVALID_POS) {
+                weightHandle = AttributeHandle<float>::create(leaf->constAttributeArray(mWeightIndex));
+            }
+
+            for (IndexOnIter iter = leaf->beginIndexOn(); iter; ++iter) {
+
+                const Vec3d xyz = iter.getCoord().asVec3d() + Vec3d(positionHandle->get(Index(*iter)));
+                const Vec3d position = mTargetTransform.worldToIndex(mSourceTransform.indexToWorld(xyz));
+                const float weight = weightHandle ? weightHandle->get(Index(*iter)) : 1.0f;
+
+                if (mKernel == DENSITY_TRILINEAR)       this->splatTrilinear(accessor, position, weight);
+                else if (mKernel == DENSITY_SMOOTH)     this->splatSmooth(accessor, position, weight);
+                else                                    this->splatNearest(accessor, Coord::round(position), weight);
+            }
+        }
+    }
+
+    void join(RasterizeDensityOp& other)
+    {
+        AccessorT accessor(*mTree);
+
+        for (FloatTree::LeafCIter leafIter = other.mTree->cbeginLeaf(); leafIter; ++leafIter) {
+
+            FloatLeafT* leaf = accessor.probeLeaf(leafIter->origin());
+
+            if (!leaf) {
+                accessor.addLeaf(new FloatLeafT(*leafIter));
+                continue;
+            }
+
+            for (FloatLeafT::ValueOnCIter iter = leafIter->cbeginValueOn(); iter; ++iter) {
+                const Index offset = iter.pos();
+                leaf->setValueOn(offset, leaf->getValue(offset) + *iter);
+            }
+        }
+    }
+
+    //////////
+
+    static void splatNearest(AccessorT& accessor, const Coord& ijk, const float weight)
+    {
+        accessor.setValueOn(ijk, accessor.getValue(ijk) + weight);
+    }
+
+    static void splatTrilinear(AccessorT& accessor, const Vec3d& position, const float weight)
+    {
+        const Coord base = Coord::floor(position);
+        const Vec3d t = position - base.asVec3d();
+
+        for (int i = 0; i < 2; i++) {
+            const double wx = i ? t.x() : 1.0 - t.x();
+            for (int j = 0; j < 2; j++) {
+                const double wy = j ? t.y() : 1.0 - t.y();
+                for (int k = 0; k < 2; k++) {
+                    const double wz = k ? t.z() : 1.0 - t.z();
+                    const float w = float(wx * wy * wz);
+                    if (w > 0.0f)   splatNearest(accessor, base.offsetBy(i, j, k), weight * w);
+                }
+            }
+        }
+    }
+
+    void splatSmooth(AccessorT& accessor, const Vec3d& position, const float weight) const
+    {
+        const double radius = double(mRadius);
+        const double invRadiusSqr = 1.0 / (radius * radius);
+
+        const CoordBBox bbox(Coord::floor(position - Vec3d(radius)), Coord::ceil(position + Vec3d(radius)));
+
+        // compute the sum of the kernel weights to normalize the contribution
+
+        double sum = 0.0;
+
+        for (Coord ijk = bbox.min(); ijk.x() <= bbox.max().x(); ijk.x() += 1) {
+            for (ijk.y() = bbox.min().y(); ijk.y() <= bbox.max().y(); ijk.y() += 1) {
+                for (ijk.z() = bbox.min().z(); ijk.z() <= bbox.max().z(); ijk.z() += 1) {
+                    sum += falloff((ijk.asVec3d() - position).lengthSqr() * invRadiusSqr);
+                }
+            }
+        }
+
+        // fall back to the nearest voxel if the radius does not reach any voxel center
+
+        if (sum <= 0.0) {
+            splatNearest(accessor, Coord::round(position), weight);
+            return;
+        }
+
+        const double scale = double(weight) / sum;
+
+        for (Coord ijk = bbox.min(); ijk.x() <= bbox.max().x(); ijk.x() += 1) {
+            for (ijk.y() = bbox.min().y(); ijk.y() <= bbox.max().y(); ijk.y() += 1) {
+                for (ijk.z() = bbox.min().z(); ijk.z() <= bbox.max().z(); ijk.z() += 1) {
+                    const double w = falloff((ijk.asVec3d() - position).lengthSqr() * invRadiusSqr);
+                    if (w > 0.0)    splatNearest(accessor, ijk, float(w * scale));
+                }
+            }
+        }
+    }
+
+    /// Smooth polynomial falloff of the squared normalized distance
+    static double falloff(const double distanceSqr)
+    {
+        if (distanceSqr >= 1.0)     return 0.0;
+        const double x = 1.0 - distanceSqr;
+        return x * x * x;
+    }
+
+    //////////
+
+    const math::Transform&  mSourceTransform;
+    const math::Transform&  mTargetTransform;
+    const size_t            mPositionIndex;
+    const size_t            mWeightIndex;
+    const DensityKernel     mKernel;
+    const float             mRadius;
+    FloatTree::Ptr          mTree;
+}; // struct RasterizeDensityOp
+
+
+/// @brief Accumulate point weights into the co-located leaf of a density tree
+/// that shares the topology of the point tree
+template <typename PointDataTreeT>
+struct NearestDensityOp
+{
+    typedef tree::LeafManager<FloatTree>                LeafManagerT;
+    typedef typename PointDataTreeT::LeafNodeType       PointDataLeafT;
+    typedef typename PointDataLeafT::IndexOnIter        IndexOnIter;
+
+    NearestDensityOp(   const PointDataTreeT& tree,
+                        const size_t weightIndex)
+        : mTree(tree)
+        , mWeightIndex(weightIndex) { }
+
+    void operator()(const LeafManagerT::LeafRange& range) const
+    {
+        for (LeafManagerT::LeafRange::Iterator leaf=range.begin(); leaf; ++leaf) {
+
+            const PointDataLeafT* pointLeaf = mTree.probeConstLeaf(leaf->origin());
+
+            if (!pointLeaf)     continue;
+
+            AttributeHandle<float>::Ptr weightHandle;
+
+            if (mWeightIndex != AttributeSet::INVALID_POS) {
+                weightHandle = AttributeHandle<float>::create(pointLeaf->constAttributeArray(mWeightIndex));
+            }
+
+            for (IndexOnIter iter = pointLeaf->beginIndexOn(); iter; ++iter) {
+                const Index offset = FloatTree::LeafNodeType::coordToOffset(iter.getCoord());
+                const float weight = weightHandle ? weightHandle->get(Index(*iter)) : 1.0f;
+                leaf->setValueOnly(offset, leaf->getValue(offset) + weight);
+            }
+        }
+    }
+
+    //////////
+
+    const PointDataTreeT&   mTree;
+    const size_t            mWeightIndex;
+}; // struct NearestDensityOp
+
+
+/// @brief Write the signed distance of the spheres of each point into thread-local level
+/// set trees that are merged with a union on join
+template <typename PointDataTreeT>
+struct RasterizeSpheresOp
+{
+    typedef typename tree::LeafManager<const PointDataTreeT>    LeafManagerT;
+    typedef typename PointDataTreeT::LeafNodeType               PointDataLeafT;
+    typedef typename PointDataLeafT::IndexOnIter                IndexOnIter;
+    typedef tree::ValueAccessor<FloatTree>                      AccessorT;
+    typedef FloatTree::LeafNodeType                             FloatLeafT;
+
+    RasterizeSpheresOp( const math::Transform& sourceTransform,
+                        const math::Transform& targetTransform,
+                        const size_t positionIndex,
+                        const size_t radiusIndex,
+                        const float radius,
+                        const float halfWidth)
+        : mSourceTransform(sourceTransform)
+        , mTargetTransform(targetTransform)
+        , mPositionIndex(positionIndex)
+        , mRadiusIndex(radiusIndex)
+        , mRadius(radius)
+        , mHalfWidth(halfWidth)
+        , mVoxelSize(float(targetTransform.voxelSize()[0]))
+        , mTree(new FloatTree(halfWidth * mVoxelSize)) { }
+
+    RasterizeSpheresOp(RasterizeSpheresOp& other, tbb::split)
+        : mSourceTransform(other.mSourceTransform)
+        , mTargetTransform(other.mTargetTransform)
+        , mPositionIndex(other.mPositionIndex)
+        , mRadiusIndex(other.mRadiusIndex)
+        , mRadius(other.mRadius)
+        , mHalfWidth(other.mHalfWidth)
+        , mVoxelSize(other.mVoxelSize)
+        , mTree(new FloatTree(other.mTree->background())) { }
+
+    void operator()(const typename LeafManagerT::LeafRange& range)
+    {
+        AccessorT accessor(*mTree);
+
+        for (typename LeafManagerT::LeafRange::Iterator leaf=range.begin(); leaf; ++leaf) {
+
+            AttributeHandle<Vec3f>::Ptr positionHandle =
+                AttributeHandle<Vec3f>::create(leaf->constAttributeArray(mPositionIndex));
+
+            AttributeHandle<float>::Ptr radiusHandle;
+
+            if (mRadiusIndex != AttributeSet::INVALID_POS) {
+                radiusHandle = AttributeHandle<float>::create(leaf->constAttributeArray(mRadiusIndex));
+            }
+
+            for (IndexOnIter iter = leaf->beginIndexOn(); iter; ++iter) {
+
+                const Vec3d xyz = iter.getCoord().asVec3d() + Vec3d(positionHandle->get(Index(*iter)));
+                const Vec3d position = mTargetTransform.worldToIndex(mSourceTransform.indexToWorld(xyz));
+                const float radius = radiusHandle ? mRadius * radiusHandle->get(Index(*iter)) : mRadius;
+
+                this->rasterizeSphere(accessor, position, double(radius / mVoxelSize));
+            }
+        }
+    }
+
+    void join(RasterizeSpheresOp& other)
+    {
+        AccessorT accessor(*mTree);
+
+        for (FloatTree::LeafCIter leafIter = other.mTree->cbeginLeaf(); leafIter; ++leafIter) {
+
+            FloatLeafT* leaf = accessor.probeLeaf(leafIter->origin());
+
+            if (!leaf) {
+                accessor.addLeaf(new FloatLeafT(*leafIter));
+                continue;
+            }
+
+            for (FloatLeafT::ValueOnCIter iter = leafIter->cbeginValueOn(); iter; ++iter) {
+                const Index offset = iter.pos();
+                leaf->setValueOn(offset, std::min(leaf->getValue(offset), *iter));
+            }
+        }
+    }
+
+    //////////
+
+    /// @brief Write the union of the narrow band of a sphere (in index space) and the existing
+    /// values, only the voxels of each column within the band are visited
+    /// @note The interior is classified by the sign flood fill, active voxels of other spheres
+    /// that lie inside this interior are corrected with MarkInteriorOp.
+    void rasterizeSphere(AccessorT& accessor, const Vec3d& center, const double radius) const
+    {
+        const double outer = radius + double(mHalfWidth);
+        const double inner = radius - double(mHalfWidth);
+
+        const double outerSqr = outer * outer;
+        const double innerSqr = inner > 0.0 ? inner * inner : -1.0;
+
+        const CoordBBox bbox(Coord::floor(center - Vec3d(outer)), Coord::ceil(center + Vec3d(outer)));
+
+        for (Coord ijk = bbox.min(); ijk.x() <= bbox.max().x(); ijk.x() += 1) {
+            const double dx = double(ijk.x()) - center.x();
+            for (ijk.y() = bbox.min().y(); ijk.y() <= bbox.max().y(); ijk.y() += 1) {
+                const double dy = double(ijk.y()) - center.y();
+                const double dxySqr = dx * dx + dy * dy;
+
+                if (dxySqr >= outerSqr)     continue;
+
+                const double outerZ = std::sqrt(outerSqr - dxySqr);
+                const Int32 zMin = Int32(std::ceil(center.z() - outerZ));
+                const Int32 zMax = Int32(std::floor(center.z() + outerZ));
+
+                if (dxySqr >= innerSqr) {
+                    this->rasterizeSpan(accessor, ijk, zMin, zMax, center, radius, outerSqr);
+                    continue;
+                }
+
+                // skip the span of the column inside the interior
+
+                const double innerZ = std::sqrt(innerSqr - dxySqr);
+
+                this->rasterizeSpan(accessor, ijk, zMin,
+                    Int32(std::ceil(center.z() - innerZ)) - 1, center, radius, outerSqr);
+                this->rasterizeSpan(accessor, ijk,
+                    Int32(std::floor(center.z() + innerZ)) + 1, zMax, center, radius, outerSqr);
+            }
+        }
+    }
+
+    /// Write the signed distance to the sphere for the voxels of a column between @a zMin and @a zMax
+    void rasterizeSpan( AccessorT& accessor, Coord ijk, const Int32 zMin, const Int32 zMax,
+                        const Vec3d& center, const double radius, const double outerSqr) const
+    {
+        for (ijk.z() = zMin; ijk.z() <= zMax; ijk.z() += 1) {
+
+            const double distSqr = (ijk.asVec3d() - center).lengthSqr();
+
+            if (distSqr >= outerSqr)    continue;
+
+            const float dist = float((std::sqrt(distSqr) - radius) * mVoxelSize);
+
+            if (dist < accessor.getValue(ijk))  accessor.setValue(ijk, dist);
+        }
+    }
+
+    //////////
+
+    const math::Transform&  mSourceTransform;
+    const math::Transform&  mTargetTransform;
+    const size_t            mPositionIndex;
+    const size_t            mRadiusIndex;
+    const float             mRadius;
+    const float             mHalfWidth;
+    const float             mVoxelSize;
+    FloatTree::Ptr          mTree;
+}; // struct RasterizeSpheresOp
+
+
+/// @brief Mark the active voxels of the rasterized narrow bands that lie inside the
+/// interior of any sphere, these are written by neighbouring overlapping spheres
+template <typename PointDataTreeT>
+struct MarkInteriorOp
+{
+    typedef typename tree::LeafManager<const PointDataTreeT>    LeafManagerT;
+    typedef typename PointDataTreeT::LeafNodeType               PointDataLeafT;
+    typedef typename PointDataLeafT::IndexOnIter                IndexOnIter;
+    typedef tree::ValueAccessor<const FloatTree>                ConstAccessorT;
+    typedef tree::ValueAccessor<BoolTree>                       MaskAccessorT;
+    typedef FloatTree::LeafNodeType                             FloatLeafT;
+
+    MarkInteriorOp( const math::Transform& sourceTransform,
+                    const math::Transform& targetTransform,
+                    const size_t positionIndex,
+                    const size_t radiusIndex,
+                    const float radius,
+                    const float halfWidth,
+                    const FloatTree& levelSet)
+        : mSourceTransform(sourceTransform)
+        , mTargetTransform(targetTransform)
+        , mPositionIndex(positionIndex)
+        , mRadiusIndex(radiusIndex)
+        , mRadius(radius)
+        , mHalfWidth(halfWidth)
+        , mVoxelSize(float(targetTransform.voxelSize()[0]))
+        , mLevelSet(levelSet)
+        , mMask(new BoolTree(false)) { }
+
+    MarkInteriorOp(MarkInteriorOp& other, tbb::split)
+        : mSourceTransform(other.mSourceTransform)
+        , mTargetTransform(other.mTargetTransform)
+        , mPositionIndex(other.mPositionIndex)
+        , mRadiusIndex(other.mRadiusIndex)
+        , mRadius(other.mRadius)
+        , mHalfWidth(other.mHalfWidth)
+        , mVoxelSize(other.mVoxelSize)
+        , mLevelSet(other.mLevelSet)
+        , mMask(new BoolTree(false)) { }
+
+    void operator()(const typename LeafManagerT::LeafRange& range)
+    {
+        ConstAccessorT levelSetAccessor(mLevelSet);
+        MaskAccessorT maskAccessor(*mMask);
+
+        for (typename LeafManagerT::LeafRange::Iterator leaf=range.begin(); leaf; ++leaf) {
+
+            AttributeHandle<Vec3f>::Ptr positionHandle =
+                AttributeHandle<Vec3f>::create(leaf->constAttributeArray(mPositionIndex));
+
+            AttributeHandle<float>::Ptr radiusHandle;
+
+            if (mRadiusIndex != AttributeSet::INVALID_POS) {
+                radiusHandle = AttributeHandle<float>::create(leaf->constAttributeArray(mRadiusIndex));
+            }
+
+            for (IndexOnIter iter = leaf->beginIndexOn(); iter; ++iter) {
+
+                const Vec3d xyz = iter.getCoord().asVec3d() + Vec3d(positionHandle->get(Index(*iter)));
+                const Vec3d position = mTargetTransform.worldToIndex(mSourceTransform.indexToWorld(xyz));
+                const float radius = radiusHandle ? mRadius * radiusHandle->get(Index(*iter)) : mRadius;
+
+                this->markSphere(levelSetAccessor, maskAccessor, position, double(radius / mVoxelSize));
+            }
+        }
+    }
+
+    void join(MarkInteriorOp& other)
+    {
+        mMask->topologyUnion(*other.mMask);
+    }
+
+    //////////
+
+    /// Mark the active voxels inside the interior of a sphere (in index space), each column
+    /// of the interior is traversed a leaf at a time to skip leaves that are not allocated
+    void markSphere(ConstAccessorT& levelSetAccessor, MaskAccessorT& maskAccessor,
+                    const Vec3d& center, const double radius) const
+    {
+        const double inner = radius - double(mHalfWidth);
+
+        if (inner <= 0.0)   return;
+
+        const double innerSqr = inner * inner;
+        const Int32 leafDim = Int32(FloatLeafT::DIM);
+
+        const CoordBBox bbox(Coord::floor(center - Vec3d(inner)), Coord::ceil(center + Vec3d(inner)));
+
+        for (Coord ijk = bbox.min(); ijk.x() <= bbox.max().x(); ijk.x() += 1) {
+            const double dx = double(ijk.x()) - center.x();
+            for (ijk.y() = bbox.min().y(); ijk.y() <= bbox.max().y(); ijk.y() += 1) {
+                const double dy = double(ijk.y()) - center.y();
+                const double dxySqr = dx * dx + dy * dy;
+
+                if (dxySqr > innerSqr)  continue;
+
+                const double innerZ = std::sqrt(innerSqr - dxySqr);
+                const Int32 zMin = Int32(std::ceil(center.z() - innerZ));
+                const Int32 zMax = Int32(std::floor(center.z() + innerZ));
+
+                for (ijk.z() = zMin; ijk.z() <= zMax; ) {
+                    const Int32 leafEnd = std::min(zMax, (ijk.z() & ~(leafDim - 1)) + leafDim - 1);
+                    const FloatLeafT* leaf = levelSetAccessor.probeConstLeaf(ijk);
+                    if (leaf) {
+                        for (; ijk.z() <= leafEnd; ijk.z() += 1) {
+                            if (leaf->isValueOn(ijk))   maskAccessor.setValueOn(ijk);
+                        }
+                    }
+                    ijk.z() = leafEnd + 1;
+                }
+            }
+        }
+    }
+
+    //////////
+
+    const math::Transform&  mSourceTransform;
+    const math::Transform&  mTargetTransform;
+    const size_t            mPositionIndex;
+    const size_t            mRadiusIndex;
+    const float             mRadius;
+    const float             mHalfWidth;
+    const float             mVoxelSize;
+    const FloatTree&        mLevelSet;
+    BoolTree::Ptr           mMask;
+}; // struct MarkInteriorOp
+
+
+/// @brief Deactivate the marked interior voxels, setting them to the negative background
+struct DeactivateInteriorOp
+{
+    typedef tree::LeafManager<FloatTree>    LeafManagerT;
+
+    DeactivateInteriorOp(const BoolTree& interior, const float background)
+        : mInterior(interior)
+        , mBackground(background) { }
+
+    void operator()(const LeafManagerT::LeafRange& range) const
+    {
+        for (LeafManagerT::LeafRange::Iterator leaf=range.begin(); leaf; ++leaf) {
+            const BoolTree::LeafNodeType* interiorLeaf = mInterior.probeConstLeaf(leaf->origin());
+            if (!interiorLeaf)  continue;
+            for (BoolTree::LeafNodeType::ValueOnCIter iter = interiorLeaf->cbeginValueOn(); iter; ++iter) {
+                leaf->setValueOff(iter.pos(), -mBackground);
+            }
+        }
+    }
+
+    //////////
+
+    const BoolTree& mInterior;
+    const float     mBackground;
+}; // struct DeactivateInteriorOp
+
+
+} // namespace point_rasterize_internal
+
+
+////////////////////////////////////////
+
+
+template <typename PointDataGridT>
+inline FloatGrid::Ptr
+rasterizeDensity(   const PointDataGridT& points,
+                    const math::Transform& transform,
+                    const DensityKernel kernel,
+                    const Name& weightAttribute,
+                    const float radius)
+{
+    typedef typename PointDataGridT::TreeType                       PointDataTreeT;
+    typedef typename tree::LeafManager<const PointDataTreeT>        LeafManagerT;
+
+    using point_rasterize_internal::RasterizeDensityOp;
+    using point_rasterize_internal::NearestDensityOp;
+
+    if (kernel == DENSITY_SMOOTH && radius <= 0.0f) {
+        OPENVDB_THROW(ValueError, "Smooth kernel radius must be positive.");
+    }
+
+    FloatGrid::Ptr density = FloatGrid::create(0.0f);
+    density->setTransform(transform.copy());
+    density->setGridClass(GRID_FOG_VOLUME);
+
+    const PointDataTreeT& tree = points.constTree();
+
+    typename PointDataTreeT::LeafCIter iter = tree.cbeginLeaf();
+
+    if (!iter)  return density;
+
+    const AttributeSet::Descriptor& descriptor = iter->attributeSet().descriptor();
+
+    const size_t positionIndex = descriptor.find("P");
+
+    if (positionIndex == AttributeSet::INVALID_POS) {
+        OPENVDB_THROW(KeyError, "Cannot find position attribute - P.");
+    }
+
+    const size_t weightIndex = point_rasterize_internal::floatAttributeIndex(*iter, weightAttribute);
+
+    if (kernel == DENSITY_NEAREST && transform == points.constTransform()) {
+
+        // voxel sizes match so every point is accumulated into its own voxel,
+        // re-use the point topology and process each leaf independently
+
+        density->tree().topologyUnion(tree);
+
+        NearestDensityOp<PointDataTreeT> op(tree, weightIndex);
+        tbb::parallel_for(tree::LeafManager<FloatTree>(density->tree()).leafRange(), op);
+
+        return density;
+    }
+
+    RasterizeDensityOp<PointDataTreeT> op(points.constTransform(), transform,
+                                          positionIndex, weightIndex, kernel, radius);
+    tbb::parallel_reduce(LeafManagerT(tree).leafRange(), op);
+
+    density->setTree(op.mTree);
+
+    return density;
+}
+
+
+////////////////////////////////////////
+
+
+template <typename PointDataGridT>
+inline FloatGrid::Ptr
+rasterizeSpheres(   const PointDataGridT& points,
+                    const math::Transform& transform,
+                    const float radius,
+                    const Name& radiusAttribute,
+                    const float halfWidth)
+{
+    typedef typename PointDataGridT::TreeType                       PointDataTreeT;
+    typedef typename tree::LeafManager<const PointDataTreeT>        LeafManagerT;
+
+    using point_rasterize_internal::RasterizeSpheresOp;
+    using point_rasterize_internal::MarkInteriorOp;
+    using point_rasterize_internal::DeactivateInteriorOp;
+
+    if (!transform.hasUniformScale()) {
+        OPENVDB_THROW(ValueError, "Level set transform must have uniform scale.");
+    }
+
+    if (halfWidth <= 0.0f) {
+        OPENVDB_THROW(ValueError, "Narrow band half-width must be positive.");
+    }
+
+    const float background = halfWidth * float(transform.voxelSize()[0]);
+
+    FloatGrid::Ptr levelSet = FloatGrid::create(background);
+    levelSet->setTransform(transform.copy());
+    levelSet->setGridClass(GRID_LEVEL_SET);
+
+    const PointDataTreeT& tree = points.constTree();
+
+    typename PointDataTreeT::LeafCIter iter = tree.cbeginLeaf();
+
+    if (!iter)  return levelSet;
+
+    const size_t positionIndex = iter->attributeSet().descriptor().find("P");
+
+    if (positionIndex == AttributeSet::INVALID_POS) {
+        OPENVDB_THROW(KeyError, "Cannot find position attribute - P.");
+    }
+
+    const size_t radiusIndex = point_rasterize_internal::floatAttributeIndex(*iter, radiusAttribute);
+
+    RasterizeSpheresOp<PointDataTreeT> op(points.constTransform(), transform,
+                                          positionIndex, radiusIndex, radius, halfWidth);
+    tbb::parallel_reduce(LeafManagerT(tree).leafRange(), op);
+
+    levelSet->setTree(op.mTree);
+
+    // only the narrow bands are written, so deactivate the voxels of any band that lie inside
+    // another sphere and propagate the sign to the interior
+
+    MarkInteriorOp<PointDataTreeT> mark(points.constTransform(), transform,
+                                        positionIndex, radiusIndex, radius, halfWidth, levelSet->tree());
+    tbb::parallel_reduce(LeafManagerT(tree).leafRange(), mark);
+
+    DeactivateInteriorOp deactivate(*mark.mMask, background);
+    tbb::parallel_for(tree::LeafManager<FloatTree>(levelSet->tree()).leafRange(), deactivate);
+
+    tools::pruneLevelSet(levelSet->tree());
+    tools::signedFloodFill(levelSet->tree());
+
+    return levelSet;
+}
+
+
+////////////////////////////////////////
+
+
+} // namespace tools
+} // namespace OPENVDB_VERSION_NAME
+} // namespace openvdb
+
+
+#endif // OPENVDB_TOOLS_POINT_RASTERIZE_HAS_BEEN_INCLUDED
+
+
+// Copyright (c) 2015-2016 Double Negative Visual Effects
+// All rights reserved. This software is distributed under the
+// Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
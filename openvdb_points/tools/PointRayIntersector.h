@@ -0,0 +1,1035 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2015-2016 Double Negative Visual Effects
+//
+// All rights reserved. This software is distributed under the
+// Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
+//
+// Redistributions of source code must retain the above copyright
+// and license notice and the following restrictions and disclaimer.
+//
+// *     Neither the name of Double Negative Visual Effects nor the names
+// of its contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// IN NO EVENT SHALL THE COPYRIGHT HOLDERS' AND CONTRIBUTORS' AGGREGATE
+// LIABILITY FOR ALL CLAIMS REGARDLESS OF THEIR BASIS EXCEED US$250.00.
+//
+///////////////////////////////////////////////////////////////////////////
+//
+/// @file PointRayIntersector.h
+///
+/// @brief  Ray intersection against the points of a VDB Point Grid rendered as spheres,
+///         with optional motion blur.
+///
+
+
+#ifndef OPENVDB_TOOLS_POINT_RAY_INTERSECTOR_HAS_BEEN_INCLUDED
+#define OPENVDB_TOOLS_POINT_RAY_INTERSECTOR_HAS_BEEN_INCLUDED
+
+#include <openvdb/openvdb.h>
+#include <openvdb/math/Maps.h>
+#include <openvdb/math/Ray.h>
+#include <openvdb/math/Transform.h>
+
+#include <openvdb_points/tools/AttributeArray.h>
+#include <openvdb_points/tools/AttributeSet.h>
+#include <openvdb_points/tools/PointDataGrid.h>
+
+#include <boost/static_assert.hpp>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace openvdb {
+OPENVDB_USE_VERSION_NAMESPACE
+namespace OPENVDB_VERSION_NAME {
+namespace tools {
+
+
+/// @brief Closest-hit ray intersection against the points of a PointDataGrid rendered as spheres.
+///
+/// The intersector decodes the points of each leaf into index-space spheres and builds a
+/// three-level bounding volume hierarchy per leaf (8x8x8, 4x4x4 and 2x2x2 voxels) beneath a
+/// binary hierarchy over the leaves. Rays are traversed in packets so that bounding box and
+/// sphere tests are evaluated for several rays at once in loops the compiler can vectorize.
+///
+/// The sphere radius is given in world-space and can optionally be scaled per-point by a float
+/// attribute. If a velocity attribute is provided, the points move linearly over the shutter
+/// interval and each bound stores a box at shutter open and shutter close which are
+/// interpolated using the time of the ray.
+///
+/// @note The grid must have a linear transform with uniform scale and must not be modified
+/// while the intersector is in use.
+template <typename PointDataGridT>
+class PointRayIntersector
+{
+public:
+    typedef typename PointDataGridT::TreeType           TreeType;
+    typedef typename TreeType::LeafNodeType             LeafType;
+    typedef math::Ray<double>                           RayT;
+
+    BOOST_STATIC_ASSERT(LeafType::DIM == 8);
+
+    /// @brief The closest intersection of a ray with the points
+    struct Hit
+    {
+        Hit() : leaf(NULL), index(0), t(0.0), normal(0.0) { }
+
+        /// @brief Return @c true if the ray intersected a point.
+        bool valid() const { return leaf != NULL; }
+
+        const LeafType* leaf;
+        Index index;
+        double t;
+        Vec3d normal;
+    }; // struct Hit
+
+    /// @param grid             the PointDataGrid to intersect.
+    /// @param radius           the world-space radius of each sphere.
+    /// @param radiusScale      name of a float attribute to scale the radius per-point (optional).
+    /// @param velocity         name of a Vec3f world-space velocity attribute (optional).
+    /// @param shutterOpen      the time of the start of the shutter interval.
+    /// @param shutterClose     the time of the end of the shutter interval.
+    PointRayIntersector(const PointDataGridT& grid,
+                        const double radius,
+                        const Name& radiusScale = "",
+                        const Name& velocity = "",
+                        const double shutterOpen = 0.0,
+                        const double shutterClose = 0.0);
+
+    /// @brief Return @c true if the world-space ray intersects a point at the given time and
+    /// populate the closest hit with a world-space normal.
+    /// @note The hit @c t is the parameter along the world-space ray.
+    bool intersectsWS(const RayT& ray, Hit& hit, const double time = 0.0) const;
+
+    /// @brief Intersect a packet of world-space rays, returning a mask of the rays that hit.
+    /// @param rays     an array of at least @a count rays.
+    /// @param hits     an array of at least @a count hits to populate.
+    /// @param times    an array of at least @a count ray times or @c NULL for a time of zero.
+    /// @param count    the number of rays in the packet (at most @a PacketSize).
+    template <Index PacketSize>
+    Index32 intersectsWS(   const RayT* rays,
+                            Hit* hits,
+                            const double* times = NULL,
+                            const Index count = PacketSize) const;
+
+    /// @brief Intersect world-space rays in parallel using packets of eight rays.
+    /// @param rays     the rays to intersect.
+    /// @param hits     populated with a hit per ray, invalid if the ray missed.
+    /// @param times    the ray times or empty for a time of zero.
+    void intersectsWS(  const std::vector<RayT>& rays,
+                        std::vector<Hit>& hits,
+                        const std::vector<double>& times = std::vector<double>()) const;
+
+    /// @brief Return the world-space bounding box of all spheres over the shutter interval.
+    BBoxd worldBBox() const;
+
+    /// @brief Return the number of leaves containing points.
+    size_t leafCount() const { return mLeafData.size(); }
+
+    ////////////////////////////////////////
+
+    /// Axis-aligned bounds at shutter open and shutter close
+    struct MotionBox
+    {
+        MotionBox() { this->reset(); }
+
+        void reset();
+        bool empty() const { return min[0][0] > max[0][0]; }
+        void expand(const Vec3d& center0, const Vec3d& center1, const double radius);
+        void expand(const MotionBox& box, const Vec3d& offset = Vec3d(0.0));
+        Vec3d centroid() const { return (min[0] + max[0] + min[1] + max[1]) * 0.25; }
+
+        Vec3d min[2];
+        Vec3d max[2];
+    }; // struct MotionBox
+
+    /// Hard-coded three-level hierarchy of leaf-local bounds
+    ///     level 1 is 8x8x8 (the leaf)
+    ///     level 2 is 4x4x4 (each node is 1/8 of a leaf)
+    ///     level 3 is 2x2x2 (each node is 1/64 of a leaf)
+    struct LeafBVH
+    {
+        LeafBVH() : occupied2(0), occupied3(0) { }
+
+        static Index index2(const Index i, const Index j, const Index k) {
+            return ((i >> 2) << 2) | ((j >> 2) << 1) | (k >> 2);
+        }
+        static Index index3(const Index i, const Index j, const Index k) {
+            return ((i >> 1) << 4) | ((j >> 1) << 2) | (k >> 1);
+        }
+
+        /// Expand the level 3 node containing the leaf-local voxel @a ijk
+        void expand(const Coord& ijk, const Vec3d& center0, const Vec3d& center1, const double radius);
+
+        /// Propagate the level 3 bounds up to levels 1 and 2
+        void propagate();
+
+        MotionBox node1;
+        MotionBox node2[8];
+        MotionBox node3[64];
+        Index32 occupied2;
+        Index64 occupied3;
+    }; // struct LeafBVH
+
+    /// Leaf-local sphere data and bounds for a single leaf
+    struct LeafData
+    {
+        LeafData() : leaf(NULL) { }
+
+        const LeafType*         leaf;
+        LeafBVH                 bvh;
+        std::vector<Vec3f>      centers0;
+        std::vector<Vec3f>      centers1;
+        std::vector<float>      radii;
+    }; // struct LeafData
+
+    /// Binary hierarchy node over the leaves, an inner node when @c count is zero
+    struct Node
+    {
+        Node() : left(0), begin(0), count(0), axis(0) { }
+
+        MotionBox box;
+        Index32 left;
+        Index32 begin;
+        Index32 count;
+        Index32 axis;
+    }; // struct Node
+
+private:
+    template <Index Size> struct RayPacket;
+
+    /// Traversal stack size, the hierarchy over at most 2^32 leaves is at most 32 levels deep
+    /// and each level adds at most one node to the stack
+    static const Index32 MaxStackSize = 64;
+
+    /// Recursively build the hierarchy over the leaves
+    void buildNodes(const Index32 nodeIndex, const Index32 begin, const Index32 end);
+
+    /// Intersect the points of a single leaf with the active rays of a packet
+    template <Index Size>
+    void intersectLeaf(RayPacket<Size>& packet, const Index32 leafIndex, const Index32 mask) const;
+
+    /// Return the interpolation weight for a ray time
+    double weight(const double time) const;
+
+    const PointDataGridT&                   mGrid;
+    math::MapBase::ConstPtr                 mMap;
+    double                                  mRadius;
+    double                                  mShutterOpen;
+    double                                  mShutterClose;
+    std::vector<LeafData>                   mLeafData;
+    std::vector<Index32>                    mLeafOrder;
+    std::vector<Node>                       mNodes;
+}; // class PointRayIntersector
+
+
+////////////////////////////////////////
+
+
+namespace point_ray_intersector_internal {
+
+
+template <typename LeafDataT, typename LeafT>
+struct BuildLeafOp
+{
+    typedef typename LeafT::IndexAllIter            IndexAllIter;
+
+    BuildLeafOp(std::vector<LeafDataT>& leafData,
+                const math::MapBase& map,
+                const size_t positionIndex,
+                const size_t radiusIndex,
+                const size_t velocityIndex,
+                const double radius,
+                const double shutterOpen,
+                const double shutterClose)
+        : mLeafData(leafData)
+        , mMap(map)
+        , mPositionIndex(positionIndex)
+        , mRadiusIndex(radiusIndex)
+        , mVelocityIndex(velocityIndex)
+        , mRadius(radius)
+        , mShutterOpen(shutterOpen)
+        , mShutterClose(shutterClose) { }
+
+    void operator()(const tbb::blocked_range<size_t>& range) const
+    {
+        for (size_t n = range.begin(); n < range.end(); n++) {
+
+            LeafDataT& data = mLeafData[n];
+            const LeafT& leaf = *data.leaf;
+
+            const size_t count = leaf.pointCount();
+
+            AttributeHandle<Vec3f>::Ptr positionHandle =
+                AttributeHandle<Vec3f>::create(leaf.constAttributeArray(mPositionIndex));
+
+            AttributeHandle<float>::Ptr radiusHandle;
+            AttributeHandle<Vec3f>::Ptr velocityHandle;
+
+            if (mRadiusIndex != AttributeSet::INVALID_POS) {
+                radiusHandle = AttributeHandle<float>::create(leaf.constAttributeArray(mRadiusIndex));
+                data.radii.resize(count);
+            }
+
+            if (mVelocityIndex != AttributeSet::INVALID_POS) {
+                velocityHandle = AttributeHandle<Vec3f>::create(leaf.constAttributeArray(mVelocityIndex));
+                data.centers1.resize(count);
+            }
+
+            data.centers0.resize(count);
+
+            const Coord origin = leaf.origin();
+
+            for (IndexAllIter iter = leaf.beginIndexAll(); iter; ++iter) {
+
+                const Index index = Index(*iter);
+                const Coord ijk = iter.getCoord() - origin;
+
+                const Vec3d position = ijk.asVec3d() + Vec3d(positionHandle->get(index));
+
+                double radius = mRadius;
+
+                if (radiusHandle) {
+                    radius *= radiusHandle->get(index);
+                    data.radii[index] = float(radius);
+                }
+
+                Vec3d center0(position), center1(position);
+
+                if (velocityHandle) {
+                    // velocities are world-space so are mapped into index-space
+                    const Vec3d velocity = mMap.applyInverseJacobian(Vec3d(velocityHandle->get(index)));
+                    center0 += velocity * mShutterOpen;
+                    center1 += velocity * mShutterClose;
+                    data.centers1[index] = Vec3f(center1);
+                }
+
+                data.centers0[index] = Vec3f(center0);
+
+                data.bvh.expand(ijk, center0, center1, radius);
+            }
+
+            data.bvh.propagate();
+        }
+    }
+
+    //////////
+
+    std::vector<LeafDataT>&         mLeafData;
+    const math::MapBase&            mMap;
+    const size_t                    mPositionIndex;
+    const size_t                    mRadiusIndex;
+    const size_t                    mVelocityIndex;
+    const double                    mRadius;
+    const double                    mShutterOpen;
+    const double                    mShutterClose;
+}; // struct BuildLeafOp
+
+
+template <typename IntersectorT>
+struct IntersectOp
+{
+    typedef typename IntersectorT::RayT     RayT;
+    typedef typename IntersectorT::Hit      Hit;
+
+    static const Index PacketSize = 8;
+
+    IntersectOp(const IntersectorT& intersector,
+                const std::vector<RayT>& rays,
+                const std::vector<double>& times,
+                std::vector<Hit>& hits)
+        : mIntersector(intersector)
+        , mRays(rays)
+        , mTimes(times)
+        , mHits(hits) { }
+
+    void operator()(const tbb::blocked_range<size_t>& range) const
+    {
+        for (size_t packet = range.begin(); packet < range.end(); packet++) {
+
+            const size_t offset = packet * PacketSize;
+            const Index count = Index(std::min(size_t(PacketSize), mRays.size() - offset));
+            const double* times = mTimes.empty() ? NULL : &mTimes[offset];
+
+            mIntersector.template intersectsWS<PacketSize>(&mRays[offset], &mHits[offset], times, count);
+        }
+    }
+
+    //////////
+
+    const IntersectorT&             mIntersector;
+    const std::vector<RayT>&        mRays;
+    const std::vector<double>&      mTimes;
+    std::vector<Hit>&               mHits;
+}; // struct IntersectOp
+
+
+/// Sort leaf indices by the centroid of the leaf bounds along an axis
+template <typename MotionBoxT>
+struct CompareCentroidOp
+{
+    CompareCentroidOp(const std::vector<MotionBoxT>& boxes, const int axis)
+        : mBoxes(boxes), mAxis(axis) { }
+
+    bool operator()(const Index32 lhs, const Index32 rhs) const {
+        return mBoxes[lhs].centroid()[mAxis] < mBoxes[rhs].centroid()[mAxis];
+    }
+
+    //////////
+
+    const std::vector<MotionBoxT>&  mBoxes;
+    const int                       mAxis;
+}; // struct CompareCentroidOp
+
+
+} // namespace point_ray_intersector_internal
+
+
+////////////////////////////////////////
+
+
+/// Structure-of-arrays storage for a packet of index-space rays
+template <typename PointDataGridT>
+template <Index Size>
+struct PointRayIntersector<PointDataGridT>::RayPacket
+{
+    BOOST_STATIC_ASSERT(Size > 0 && Size <= 32);
+
+    double eye[3][Size];
+    double dir[3][Size];
+    double invDir[3][Size];
+    double invDirLengthSqr[Size];
+    double weight[Size];
+    double tmin[Size];
+    double tmax[Size];
+
+    Index32 leafIndex[Size];
+    Index32 pointIndex[Size];
+    Index32 hitMask;
+    Index32 activeMask;
+}; // struct RayPacket
+
+
+////////////////////////////////////////
+
+
+namespace point_ray_intersector_internal {
+
+
+/// @brief Return a mask of the active rays of a packet that intersect a motion box, with the
+/// eye of each ray offset into the space of the box.
+template <typename PacketT, typename MotionBoxT, Index Size>
+inline Index32
+hitBox( const PacketT& packet,
+        const double (&eye)[3][Size],
+        const MotionBoxT& box,
+        const Index32 mask)
+{
+    Index32 result = 0;
+
+    for (Index r = 0; r < Size; r++) {
+
+        const double w = packet.weight[r];
+
+        double t0 = packet.tmin[r];
+        double t1 = packet.tmax[r];
+        bool inside = true;
+
+        for (int i = 0; i < 3; i++) {
+            const double lower = box.min[0][i] + (box.min[1][i] - box.min[0][i]) * w;
+            const double upper = box.max[0][i] + (box.max[1][i] - box.max[0][i]) * w;
+
+            // a ray parallel to the slab only hits the box if the eye lies within the slab,
+            // this avoids 0 * inf producing NaN when the eye lies on a slab plane
+
+            if (packet.dir[i][r] == 0.0) {
+                inside = inside && eye[i][r] >= lower && eye[i][r] <= upper;
+                continue;
+            }
+
+            const double a = (lower - eye[i][r]) * packet.invDir[i][r];
+            const double b = (upper - eye[i][r]) * packet.invDir[i][r];
+            t0 = std::max(t0, std::min(a, b));
+            t1 = std::min(t1, std::max(a, b));
+        }
+
+        result |= Index32(inside && t0 <= t1) << r;
+    }
+
+    return result & mask;
+}
+
+
+/// @brief Return a mask of the active rays of a packet that intersect a moving sphere within
+/// their current interval, populating @a t with the distance to the nearest intersection.
+template <typename PacketT, Index Size>
+inline Index32
+hitSphere(  const PacketT& packet,
+            const double (&eye)[3][Size],
+            const Vec3d& center0,
+            const Vec3d& center1,
+            const double radius,
+            const Index32 mask,
+            double (&t)[Size])
+{
+    const Vec3d delta = center1 - center0;
+    const double radiusSqr = radius * radius;
+
+    Index32 result = 0;
+
+    for (Index r = 0; r < Size; r++) {
+
+        const double w = packet.weight[r];
+
+        const double ox = eye[0][r] - (center0[0] + delta[0] * w);
+        const double oy = eye[1][r] - (center0[1] + delta[1] * w);
+        const double oz = eye[2][r] - (center0[2] + delta[2] * w);
+
+        const double b = ox * packet.dir[0][r] + oy * packet.dir[1][r] + oz * packet.dir[2][r];
+        const double c = ox * ox + oy * oy + oz * oz - radiusSqr;
+        const double discriminant = b * b - c / packet.invDirLengthSqr[r];
+
+        const double root = std::sqrt(std::max(discriminant, 0.0));
+        const double tNear = (-b - root) * packet.invDirLengthSqr[r];
+        const double tFar = (-b + root) * packet.invDirLengthSqr[r];
+
+        // use the far intersection if the eye lies inside the sphere
+
+        t[r] = tNear >= packet.tmin[r] ? tNear : tFar;
+
+        result |= Index32(discriminant >= 0.0 && t[r] >= packet.tmin[r] && t[r] <= packet.tmax[r]) << r;
+    }
+
+    return result & mask;
+}
+
+
+} // namespace point_ray_intersector_internal
+
+
+////////////////////////////////////////
+
+
+template <typename PointDataGridT>
+inline void
+PointRayIntersector<PointDataGridT>::MotionBox::reset()
+{
+    min[0] = min[1] = Vec3d(std::numeric_limits<double>::max());
+    max[0] = max[1] = Vec3d(-std::numeric_limits<double>::max());
+}
+
+
+template <typename PointDataGridT>
+inline void
+PointRayIntersector<PointDataGridT>::MotionBox::expand( const Vec3d& center0,
+                                                        const Vec3d& center1,
+                                                        const double radius)
+{
+    min[0] = math::minComponent(min[0], center0 - Vec3d(radius));
+    max[0] = math::maxComponent(max[0], center0 + Vec3d(radius));
+    min[1] = math::minComponent(min[1], center1 - Vec3d(radius));
+    max[1] = math::maxComponent(max[1], center1 + Vec3d(radius));
+}
+
+
+template <typename PointDataGridT>
+inline void
+PointRayIntersector<PointDataGridT>::MotionBox::expand(const MotionBox& box, const Vec3d& offset)
+{
+    if (box.empty())    return;
+
+    for (int i = 0; i < 2; i++) {
+        min[i] = math::minComponent(min[i], box.min[i] + offset);
+        max[i] = math::maxComponent(max[i], box.max[i] + offset);
+    }
+}
+
+
+////////////////////////////////////////
+
+
+template <typename PointDataGridT>
+inline void
+PointRayIntersector<PointDataGridT>::LeafBVH::expand(   const Coord& ijk,
+                                                        const Vec3d& center0,
+                                                        const Vec3d& center1,
+                                                        const double radius)
+{
+    const Index index = index3(ijk.x(), ijk.y(), ijk.z());
+
+    node3[index].expand(center0, center1, radius);
+    occupied3 |= Index64(1) << index;
+}
+
+
+template <typename PointDataGridT>
+inline void
+PointRayIntersector<PointDataGridT>::LeafBVH::propagate()
+{
+    for (Index index = 0; index < 64; index++) {
+
+        if (!(occupied3 & (Index64(1) << index)))   continue;
+
+        // level 3 indices are the level 2 indices of the leaf-local voxel divided by two
+
+        const Index parent = index2((index >> 4) << 1, ((index >> 2) & 3) << 1, (index & 3) << 1);
+
+        node2[parent].expand(node3[index]);
+        occupied2 |= Index32(1) << parent;
+
+        node1.expand(node3[index]);
+    }
+}
+
+
+////////////////////////////////////////
+
+
+template <typename PointDataGridT>
+PointRayIntersector<PointDataGridT>::PointRayIntersector(   const PointDataGridT& grid,
+                                                            const double radius,
+                                                            const Name& radiusScale,
+                                                            const Name& velocity,
+                                                            const double shutterOpen,
+                                                            const double shutterClose)
+    : mGrid(grid)
+    , mMap(grid.constTransform().baseMap())
+    , mRadius(0.0)
+    , mShutterOpen(shutterOpen)
+    , mShutterClose(shutterClose)
+    , mLeafData()
+    , mLeafOrder()
+    , mNodes()
+{
+    using point_ray_intersector_internal::BuildLeafOp;
+
+    const math::Transform& transform = grid.constTransform();
+
+    if (!transform.isLinear() || !transform.hasUniformScale()) {
+        OPENVDB_THROW(ValueError, "Point ray intersection requires a linear transform with uniform scale.");
+    }
+
+    if (radius <= 0.0) {
+        OPENVDB_THROW(ValueError, "Point ray intersection requires a positive radius.");
+    }
+
+    if (shutterClose < shutterOpen) {
+        OPENVDB_THROW(ValueError, "Shutter close must not be earlier than shutter open.");
+    }
+
+    const double voxelSize = transform.voxelSize()[0];
+
+    mRadius = radius / voxelSize;
+
+    const TreeType& tree = grid.constTree();
+
+    typename TreeType::LeafCIter iter = tree.cbeginLeaf();
+
+    if (!iter)  return;
+
+    const AttributeSet::Descriptor& descriptor = iter->attributeSet().descriptor();
+
+    const size_t positionIndex = descriptor.find("P");
+
+    if (positionIndex == AttributeSet::INVALID_POS) {
+        OPENVDB_THROW(KeyError, "Cannot find position attribute - P.");
+    }
+
+    size_t radiusIndex = AttributeSet::INVALID_POS;
+    size_t velocityIndex = AttributeSet::INVALID_POS;
+
+    if (!radiusScale.empty()) {
+        radiusIndex = descriptor.find(radiusScale);
+        if (radiusIndex == AttributeSet::INVALID_POS) {
+            OPENVDB_THROW(KeyError, "Cannot find radius scale attribute - " + radiusScale + ".");
+        }
+    }
+
+    if (!velocity.empty()) {
+        velocityIndex = descriptor.find(velocity);
+        if (velocityIndex == AttributeSet::INVALID_POS) {
+            OPENVDB_THROW(KeyError, "Cannot find velocity attribute - " + velocity + ".");
+        }
+    }
+
+    // decode the points and build the bounds of each leaf in parallel
+
+    for (; iter; ++iter) {
+        if (iter->pointCount() == 0)    continue;
+        mLeafData.push_back(LeafData());
+        mLeafData.back().leaf = iter.getLeaf();
+    }
+
+    BuildLeafOp<LeafData, LeafType> op(mLeafData, *mMap, positionIndex, radiusIndex, velocityIndex,
+                                       mRadius, shutterOpen, shutterClose);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, mLeafData.size()), op);
+
+    if (mLeafData.empty())  return;
+
+    // build the hierarchy over the leaves
+
+    mLeafOrder.resize(mLeafData.size());
+    for (Index32 n = 0; n < mLeafOrder.size(); n++)     mLeafOrder[n] = n;
+
+    mNodes.reserve(2 * mLeafData.size());
+    mNodes.push_back(Node());
+
+    this->buildNodes(0, 0, Index32(mLeafOrder.size()));
+}
+
+
+template <typename PointDataGridT>
+void
+PointRayIntersector<PointDataGridT>::buildNodes(const Index32 nodeIndex,
+                                                const Index32 begin,
+                                                const Index32 end)
+{
+    typedef point_ray_intersector_internal::CompareCentroidOp<MotionBox> CompareCentroidOp;
+
+    static const Index32 LeavesPerNode = 4;
+
+    std::vector<MotionBox> boxes(end - begin);
+
+    MotionBox bounds, centroids;
+
+    for (Index32 n = begin; n < end; n++) {
+        const LeafData& data = mLeafData[mLeafOrder[n]];
+        MotionBox& box = boxes[n - begin];
+        box.expand(data.bvh.node1, data.leaf->origin().asVec3d());
+        bounds.expand(box);
+        const Vec3d centroid = box.centroid();
+        centroids.expand(centroid, centroid, 0.0);
+    }
+
+    mNodes[nodeIndex].box = bounds;
+
+    if (end - begin <= LeavesPerNode) {
+        mNodes[nodeIndex].begin = begin;
+        mNodes[nodeIndex].count = end - begin;
+        return;
+    }
+
+    // split at the median centroid along the axis of largest centroid extent
+
+    const Vec3d extent = centroids.max[0] - centroids.min[0];
+    const int axis = int(math::MaxIndex(extent));
+
+    std::vector<Index32> order(end - begin);
+    for (Index32 n = 0; n < order.size(); n++)  order[n] = n;
+
+    const Index32 middle = (end - begin) / 2;
+
+    std::nth_element(order.begin(), order.begin() + middle, order.end(), CompareCentroidOp(boxes, axis));
+
+    std::vector<Index32> leafOrder(mLeafOrder.begin() + begin, mLeafOrder.begin() + end);
+    for (Index32 n = 0; n < order.size(); n++)  mLeafOrder[begin + n] = leafOrder[order[n]];
+
+    const Index32 left = Index32(mNodes.size());
+
+    mNodes.push_back(Node());
+    mNodes.push_back(Node());
+
+    mNodes[nodeIndex].left = left;
+    mNodes[nodeIndex].axis = Index32(axis);
+
+    this->buildNodes(left, begin, begin + middle);
+    this->buildNodes(left + 1, begin + middle, end);
+}
+
+
+template <typename PointDataGridT>
+inline double
+PointRayIntersector<PointDataGridT>::weight(const double time) const
+{
+    if (mShutterClose <= mShutterOpen)  return 0.0;
+
+    return math::Clamp01((time - mShutterOpen) / (mShutterClose - mShutterOpen));
+}
+
+
+template <typename PointDataGridT>
+template <Index Size>
+void
+PointRayIntersector<PointDataGridT>::intersectLeaf( RayPacket<Size>& packet,
+                                                    const Index32 leafIndex,
+                                                    const Index32 mask) const
+{
+    using point_ray_intersector_internal::hitBox;
+    using point_ray_intersector_internal::hitSphere;
+
+    const LeafData& data = mLeafData[leafIndex];
+    const LeafType& leaf = *data.leaf;
+    const LeafBVH& bvh = data.bvh;
+
+    const bool motion = !data.centers1.empty();
+    const bool uniform = data.radii.empty();
+
+    // offset the rays into leaf-local index-space
+
+    const Vec3d origin = leaf.origin().asVec3d();
+
+    double eye[3][Size];
+    for (int i = 0; i < 3; i++) {
+        for (Index r = 0; r < Size; r++)    eye[i][r] = packet.eye[i][r] - origin[i];
+    }
+
+    const Index32 mask1 = hitBox(packet, eye, bvh.node1, mask);
+
+    if (!mask1)     return;
+
+    double t[Size];
+
+    for (Index n2 = 0; n2 < 8; n2++) {
+
+        if (!(bvh.occupied2 & (Index32(1) << n2)))    continue;
+
+        const Index32 mask2 = hitBox(packet, eye, bvh.node2[n2], mask1);
+
+        if (!mask2)     continue;
+
+        for (Index child = 0; child < 8; child++) {
+
+            const Index i3 = ((n2 >> 2) << 1) | (child >> 2);
+            const Index j3 = (((n2 >> 1) & 1) << 1) | ((child >> 1) & 1);
+            const Index k3 = ((n2 & 1) << 1) | (child & 1);
+
+            const Index n3 = (i3 << 4) | (j3 << 2) | k3;
+
+            if (!(bvh.occupied3 & (Index64(1) << n3)))    continue;
+
+            Index32 mask3 = hitBox(packet, eye, bvh.node3[n3], mask2);
+
+            for (Index voxel = 0; mask3 && voxel < 8; voxel++) {
+
+                const Coord ijk((i3 << 1) | (voxel >> 2), (j3 << 1) | ((voxel >> 1) & 1), (k3 << 1) | (voxel & 1));
+
+                const Index offset = LeafType::coordToOffset(ijk);
+                const Index end = Index(leaf.getValue(offset));
+                const Index start = offset == 0 ? Index(0) : Index(leaf.getValue(offset - 1));
+
+                for (Index index = start; index < end; index++) {
+
+                    const Vec3d center0(data.centers0[index]);
+                    const Vec3d center1(motion ? data.centers1[index] : data.centers0[index]);
+                    const double radius = uniform ? mRadius : double(data.radii[index]);
+
+                    const Index32 hits = hitSphere(packet, eye, center0, center1, radius, mask3, t);
+
+                    if (!hits)  continue;
+
+                    for (Index r = 0; r < Size; r++) {
+                        if (!(hits & (Index32(1) << r)))    continue;
+                        packet.tmax[r] = t[r];
+                        packet.leafIndex[r] = leafIndex;
+                        packet.pointIndex[r] = Index32(index);
+                    }
+
+                    packet.hitMask |= hits;
+
+                    // the intervals have shrunk, so re-test the bounds of this level 3 node
+
+                    mask3 = hitBox(packet, eye, bvh.node3[n3], mask3);
+                }
+            }
+        }
+    }
+}
+
+
+template <typename PointDataGridT>
+template <Index PacketSize>
+Index32
+PointRayIntersector<PointDataGridT>::intersectsWS(  const RayT* rays,
+                                                    Hit* hits,
+                                                    const double* times,
+                                                    const Index count) const
+{
+    using point_ray_intersector_internal::hitBox;
+
+    assert(count <= PacketSize);
+
+    RayPacket<PacketSize> packet;
+
+    packet.hitMask = 0;
+    packet.activeMask = 0;
+
+    // initialise the packet in index-space, the parameter along each ray is unchanged
+    // as the transform is linear
+
+    for (Index r = 0; r < PacketSize; r++) {
+
+        // unused lanes duplicate the first ray and are masked out
+
+        const Index source = r < count ? r : 0;
+
+        const RayT& ray = rays[source];
+
+        const Vec3d eye = mGrid.constTransform().worldToIndex(ray.eye());
+        const Vec3d dir = mMap->applyInverseJacobian(ray.dir());
+
+        for (int i = 0; i < 3; i++) {
+            packet.eye[i][r] = eye[i];
+            packet.dir[i][r] = dir[i];
+            packet.invDir[i][r] = 1.0 / dir[i];
+        }
+
+        packet.invDirLengthSqr[r] = 1.0 / dir.lengthSqr();
+        packet.weight[r] = this->weight(times ? times[source] : 0.0);
+        packet.tmin[r] = ray.t0();
+        packet.tmax[r] = ray.t1();
+        packet.leafIndex[r] = 0;
+        packet.pointIndex[r] = 0;
+
+        if (r < count)  packet.activeMask |= Index32(1) << r;
+    }
+
+    for (Index r = 0; r < count; r++)   hits[r] = Hit();
+
+    if (mNodes.empty())     return 0;
+
+    // depth-first traversal of the leaf hierarchy, visiting the nearer child first
+    // based on the direction of the first active ray, the median split halves the
+    // leaves at each level so the depth and the stack size are bounded
+
+    Index32 stack[MaxStackSize];
+    Index32 stackSize = 0;
+
+    stack[stackSize++] = 0;
+
+    Index first = 0;
+    while (first < PacketSize - 1 && !(packet.activeMask & (Index32(1) << first)))   first++;
+
+    while (stackSize > 0) {
+
+        const Node& node = mNodes[stack[--stackSize]];
+
+        const Index32 mask = hitBox(packet, packet.eye, node.box, packet.activeMask);
+
+        if (!mask)  continue;
+
+        if (node.count > 0) {
+            for (Index32 n = node.begin; n < node.begin + node.count; n++) {
+                this->intersectLeaf(packet, mLeafOrder[n], mask);
+            }
+        }
+        else if (packet.dir[node.axis][first] < 0.0) {
+            assert(stackSize + 2 <= MaxStackSize);
+            stack[stackSize++] = node.left;
+            stack[stackSize++] = node.left + 1;
+        }
+        else {
+            assert(stackSize + 2 <= MaxStackSize);
+            stack[stackSize++] = node.left + 1;
+            stack[stackSize++] = node.left;
+        }
+    }
+
+    // populate the hits with world-space normals
+
+    for (Index r = 0; r < count; r++) {
+
+        if (!(packet.hitMask & (Index32(1) << r)))    continue;
+
+        const LeafData& data = mLeafData[packet.leafIndex[r]];
+        const Index index = packet.pointIndex[r];
+        const double t = packet.tmax[r];
+
+        const Vec3d center0(data.centers0[index]);
+        const Vec3d center1(data.centers1.empty() ? data.centers0[index] : data.centers1[index]);
+        const Vec3d center = data.leaf->origin().asVec3d() + center0 + (center1 - center0) * packet.weight[r];
+
+        const Vec3d position(   packet.eye[0][r] + packet.dir[0][r] * t,
+                                packet.eye[1][r] + packet.dir[1][r] * t,
+                                packet.eye[2][r] + packet.dir[2][r] * t);
+
+        Hit& hit = hits[r];
+        hit.leaf = data.leaf;
+        hit.index = index;
+        hit.t = t;
+        hit.normal = mMap->applyJacobian(position - center).unit();
+    }
+
+    return packet.hitMask & packet.activeMask;
+}
+
+
+template <typename PointDataGridT>
+bool
+PointRayIntersector<PointDataGridT>::intersectsWS(const RayT& ray, Hit& hit, const double time) const
+{
+    return this->template intersectsWS<1>(&ray, &hit, &time) != 0;
+}
+
+
+template <typename PointDataGridT>
+void
+PointRayIntersector<PointDataGridT>::intersectsWS(  const std::vector<RayT>& rays,
+                                                    std::vector<Hit>& hits,
+                                                    const std::vector<double>& times) const
+{
+    typedef point_ray_intersector_internal::IntersectOp<PointRayIntersector> IntersectOp;
+
+    if (!times.empty() && times.size() != rays.size()) {
+        OPENVDB_THROW(ValueError, "Ray times must be empty or match the number of rays.");
+    }
+
+    hits.resize(rays.size());
+
+    if (rays.empty())   return;
+
+    // parallelize over whole packets
+
+    const size_t packets = (rays.size() + IntersectOp::PacketSize - 1) / IntersectOp::PacketSize;
+
+    IntersectOp op(*this, rays, times, hits);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, packets), op);
+}
+
+
+template <typename PointDataGridT>
+BBoxd
+PointRayIntersector<PointDataGridT>::worldBBox() const
+{
+    if (mNodes.empty())     return BBoxd();
+
+    const MotionBox& box = mNodes.front().box;
+
+    BBoxd bbox(math::minComponent(box.min[0], box.min[1]), math::maxComponent(box.max[0], box.max[1]));
+
+    return bbox.applyMap(*mMap);
+}
+
+
+////////////////////////////////////////
+
+
+} // namespace tools
+} // namespace OPENVDB_VERSION_NAME
+} // namespace openvdb
+
+
+#endif // OPENVDB_TOOLS_POINT_RAY_INTERSECTOR_HAS_BEEN_INCLUDED
+
+
+// Copyright (c) 2015-2016 Double Negative Visual Effects
+// All rights reserved. This software is distributed under the
+// Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
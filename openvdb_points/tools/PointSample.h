@@ -0,0 +1,270 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2015-2016 Double Negative Visual Effects
+//
+// All rights reserved. This software is distributed under the
+// Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
+//
+// Redistributions of source code must retain the above copyright
+// and license notice and the following restrictions and disclaimer.
+//
+// *     Neither the name of Double Negative Visual Effects nor the names
+// of its contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// IN NO EVENT SHALL THE COPYRIGHT HOLDERS' AND CONTRIBUTORS' AGGREGATE
+// LIABILITY FOR ALL CLAIMS REGARDLESS OF THEIR BASIS EXCEED US$250.00.
+//
+///////////////////////////////////////////////////////////////////////////
+//
+/// @file PointSample.h
+///
+/// @brief  Sample VDB volumes onto the points of a VDB Point Grid.
+///
+
+
+#ifndef OPENVDB_TOOLS_POINT_SAMPLE_HAS_BEEN_INCLUDED
+#define OPENVDB_TOOLS_POINT_SAMPLE_HAS_BEEN_INCLUDED
+
+#include <openvdb/openvdb.h>
+#include <openvdb/tools/Interpolation.h>
+#include <openvdb/tree/LeafManager.h>
+
+#include <openvdb_points/tools/AttributeArray.h>
+#include <openvdb_points/tools/AttributeSet.h>
+#include <openvdb_points/tools/IndexFilter.h>
+#include <openvdb_points/tools/IndexIterator.h>
+#include <openvdb_points/tools/PointAttribute.h>
+#include <openvdb_points/tools/PointDataGrid.h>
+
+#include <tbb/parallel_for.h>
+
+namespace openvdb {
+OPENVDB_USE_VERSION_NAMESPACE
+namespace OPENVDB_VERSION_NAME {
+namespace tools {
+
+
+/// @brief Sample a VDB grid at the position of every point into a point attribute.
+///
+/// @param points           the PointDataGrid.
+/// @param grid             the scalar or vector grid to sample.
+/// @param attribute        the name of the attribute to store the samples, which is
+///                         appended if it does not already exist.
+/// @param includeGroups    the names of the groups of points to sample.
+/// @param excludeGroups    the names of the groups of points to not sample.
+///
+/// @note The sampler is provided as the first template argument, such as PointSampler,
+/// BoxSampler, QuadraticSampler or StaggeredBoxSampler.
+/// @note Points that are not sampled retain their existing attribute values.
+template <typename SamplerT, typename PointDataGridT, typename GridT>
+inline void sampleGrid( PointDataGridT& points,
+                        const GridT& grid,
+                        const Name& attribute,
+                        const std::vector<Name>& includeGroups = std::vector<Name>(),
+                        const std::vector<Name>& excludeGroups = std::vector<Name>());
+
+/// @brief Sample a VDB grid at the position of every point into a point attribute
+/// using trilinear interpolation.
+///
+/// @param points           the PointDataGrid.
+/// @param grid             the scalar or vector grid to sample.
+/// @param attribute        the name of the attribute to store the samples, which is
+///                         appended if it does not already exist.
+/// @param includeGroups    the names of the groups of points to sample.
+/// @param excludeGroups    the names of the groups of points to not sample.
+template <typename PointDataGridT, typename GridT>
+inline void sampleGrid( PointDataGridT& points,
+                        const GridT& grid,
+                        const Name& attribute,
+                        const std::vector<Name>& includeGroups = std::vector<Name>(),
+                        const std::vector<Name>& excludeGroups = std::vector<Name>());
+
+
+////////////////////////////////////////
+
+
+namespace point_sample_internal {
+
+
+template <typename PointDataTreeT, typename GridT, typename SamplerT>
+struct SampleGridOp
+{
+    typedef typename tree::LeafManager<PointDataTreeT>          LeafManagerT;
+    typedef typename PointDataTreeT::LeafNodeType               PointDataLeafT;
+    typedef typename PointDataLeafT::IndexOnIter                IndexOnIter;
+    typedef typename GridT::ValueType                           ValueType;
+    typedef typename GridT::ConstAccessor                       AccessorT;
+
+    SampleGridOp(   const math::Transform& pointTransform,
+                    const GridT& grid,
+                    const size_t positionIndex,
+                    const size_t attributeIndex,
+                    const std::vector<Name>& includeGroups,
+                    const std::vector<Name>& excludeGroups)
+        : mPointTransform(pointTransform)
+        , mGrid(grid)
+        , mPositionIndex(positionIndex)
+        , mAttributeIndex(attributeIndex)
+        , mIncludeGroups(includeGroups)
+        , mExcludeGroups(excludeGroups) { }
+
+    void operator()(const typename LeafManagerT::LeafRange& range) const
+    {
+        const bool useGroups = !mIncludeGroups.empty() || !mExcludeGroups.empty();
+
+        // one accessor per task, point leaves are visited in spatial order so that
+        // consecutive samples tend to hit the cached nodes of the accessor
+
+        AccessorT accessor = mGrid.getConstAccessor();
+
+        const math::Transform& gridTransform = mGrid.constTransform();
+
+        for (typename LeafManagerT::LeafRange::Iterator leaf=range.begin(); leaf; ++leaf) {
+
+            AttributeHandle<Vec3f>::Ptr positionHandle =
+                AttributeHandle<Vec3f>::create(leaf->constAttributeArray(mPositionIndex));
+
+            AttributeWriteHandle<ValueType> handle(leaf->attributeArray(mAttributeIndex));
+
+            IndexOnIter iter = leaf->beginIndexOn();
+
+            if (useGroups) {
+                MultiGroupFilter::Data data(mIncludeGroups, mExcludeGroups);
+                const MultiGroupFilter filter = MultiGroupFilter::create(*leaf, data);
+                FilterIndexIter<IndexOnIter, MultiGroupFilter> filterIndexIter(iter, filter);
+
+                for (; filterIndexIter; ++filterIndexIter) {
+                    const Vec3d xyz = filterIndexIter.indexIter().getCoord().asVec3d();
+                    this->sample(accessor, gridTransform, handle, *positionHandle,
+                                 xyz, Index(*filterIndexIter));
+                }
+            }
+            else {
+                for (; iter; ++iter) {
+                    const Vec3d xyz = iter.getCoord().asVec3d();
+                    this->sample(accessor, gridTransform, handle, *positionHandle,
+                                 xyz, Index(*iter));
+                }
+            }
+
+            // attempt to compact the array
+
+            handle.compact();
+        }
+    }
+
+    void sample(const AccessorT& accessor,
+                const math::Transform& gridTransform,
+                AttributeWriteHandle<ValueType>& handle,
+                const AttributeHandle<Vec3f>& positionHandle,
+                const Vec3d& xyz,
+                const Index index) const
+    {
+        const Vec3d position = gridTransform.worldToIndex(
+            mPointTransform.indexToWorld(xyz + Vec3d(positionHandle.get(index))));
+
+        ValueType value = zeroVal<ValueType>();
+        SamplerT::sample(accessor, position, value);
+        handle.set(index, value);
+    }
+
+    //////////
+
+    const math::Transform&          mPointTransform;
+    const GridT&                    mGrid;
+    const size_t                    mPositionIndex;
+    const size_t                    mAttributeIndex;
+    const std::vector<Name>&        mIncludeGroups;
+    const std::vector<Name>&        mExcludeGroups;
+}; // struct SampleGridOp
+
+
+} // namespace point_sample_internal
+
+
+////////////////////////////////////////
+
+
+template <typename SamplerT, typename PointDataGridT, typename GridT>
+inline void sampleGrid( PointDataGridT& points,
+                        const GridT& grid,
+                        const Name& attribute,
+                        const std::vector<Name>& includeGroups,
+                        const std::vector<Name>& excludeGroups)
+{
+    typedef typename PointDataGridT::TreeType                   PointDataTreeT;
+    typedef typename tree::LeafManager<PointDataTreeT>          LeafManagerT;
+    typedef typename GridT::ValueType                           ValueType;
+
+    using point_sample_internal::SampleGridOp;
+
+    PointDataTreeT& tree = points.tree();
+
+    typename PointDataTreeT::LeafCIter iter = tree.cbeginLeaf();
+
+    if (!iter)  return;
+
+    const size_t positionIndex = iter->attributeSet().descriptor().find("P");
+
+    if (positionIndex == AttributeSet::INVALID_POS) {
+        OPENVDB_THROW(KeyError, "Cannot find position attribute - P.");
+    }
+
+    size_t attributeIndex = iter->attributeSet().descriptor().find(attribute);
+
+    if (attributeIndex == AttributeSet::INVALID_POS) {
+
+        // append a new attribute matching the value type of the grid
+
+        appendAttribute(tree, AttributeSet::Util::NameAndType(
+            attribute, TypedAttributeArray<ValueType>::attributeType()));
+
+        attributeIndex = tree.cbeginLeaf()->attributeSet().descriptor().find(attribute);
+    }
+    else if (!iter->constAttributeArray(attributeIndex).template hasValueType<ValueType>()) {
+        OPENVDB_THROW(TypeError, "Attribute value type does not match grid value type - " << attribute << ".");
+    }
+
+    SampleGridOp<PointDataTreeT, GridT, SamplerT> sample(points.constTransform(), grid,
+        positionIndex, attributeIndex, includeGroups, excludeGroups);
+    tbb::parallel_for(LeafManagerT(tree).leafRange(), sample);
+}
+
+
+template <typename PointDataGridT, typename GridT>
+inline void sampleGrid( PointDataGridT& points,
+                        const GridT& grid,
+                        const Name& attribute,
+                        const std::vector<Name>& includeGroups,
+                        const std::vector<Name>& excludeGroups)
+{
+    sampleGrid<BoxSampler>(points, grid, attribute, includeGroups, excludeGroups);
+}
+
+
+////////////////////////////////////////
+
+
+} // namespace tools
+} // namespace OPENVDB_VERSION_NAME
+} // namespace openvdb
+
+
+#endif // OPENVDB_TOOLS_POINT_SAMPLE_HAS_BEEN_INCLUDED
+
+
+// Copyright (c) 2015-2016 Double Negative Visual Effects
+// All rights reserved. This software is distributed under the
+// Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
@@ -0,0 +1,513 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2015-2016 Double Negative Visual Effects
+//
+// All rights reserved. This software is distributed under the
+// Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
+//
+// Redistributions of source code must retain the above copyright
+// and license notice and the following restrictions and disclaimer.
+//
+// *     Neither the name of Double Negative Visual Effects nor the names
+// of its contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// IN NO EVENT SHALL THE COPYRIGHT HOLDERS' AND CONTRIBUTORS' AGGREGATE
+// LIABILITY FOR ALL CLAIMS REGARDLESS OF THEIR BASIS EXCEED US$250.00.
+//
+///////////////////////////////////////////////////////////////////////////
+//
+/// @file PointSearch.h
+///
+/// @brief  Radius and k-nearest-neighbour queries against the points of a VDB Point Grid.
+///
+
+
+#ifndef OPENVDB_TOOLS_POINT_SEARCH_HAS_BEEN_INCLUDED
+#define OPENVDB_TOOLS_POINT_SEARCH_HAS_BEEN_INCLUDED
+
+#include <openvdb/openvdb.h>
+#include <openvdb/math/Transform.h>
+
+#include <openvdb_points/tools/AttributeArray.h>
+#include <openvdb_points/tools/AttributeSet.h>
+#include <openvdb_points/tools/PointDataGrid.h>
+
+#include <tbb/blocked_range.h>
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/parallel_for.h>
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+namespace openvdb {
+OPENVDB_USE_VERSION_NAMESPACE
+namespace OPENVDB_VERSION_NAME {
+namespace tools {
+
+
+/// @brief Radius and k-nearest-neighbour queries against the points of a PointDataGrid.
+///
+/// Queries walk the leaf and voxel structure of the tree and test the decoded positions of
+/// the points in the voxels that overlap the query. Decoded positions are cached per leaf
+/// in a cache local to each thread so that queries can be issued concurrently.
+///
+/// Results are returned as handles to the leaf and the index of the point within the leaf
+/// so that attributes can be read directly.
+///
+/// @note The grid must have a linear transform with uniform scale and must not be modified
+/// while the search is in use.
+template <typename PointDataGridT>
+class PointSearch
+{
+public:
+    typedef typename PointDataGridT::TreeType           TreeType;
+    typedef typename TreeType::LeafNodeType             LeafType;
+
+    /// @brief A handle to a point found by a query along with its squared world-space
+    /// distance to the query position
+    struct Neighbour
+    {
+        Neighbour(const LeafType* _leaf, const Index _index, const double _distanceSqr)
+            : leaf(_leaf), index(_index), distanceSqr(_distanceSqr) { }
+
+        bool operator<(const Neighbour& rhs) const {
+            if (distanceSqr != rhs.distanceSqr)     return distanceSqr < rhs.distanceSqr;
+            if (leaf != rhs.leaf)                   return leaf->origin() < rhs.leaf->origin();
+            return index < rhs.index;
+        }
+
+        const LeafType* leaf;
+        Index index;
+        double distanceSqr;
+    }; // struct Neighbour
+
+    typedef std::vector<Neighbour>                      NeighbourList;
+
+    /// @param grid         the PointDataGrid to search.
+    /// @param cacheSize    the maximum number of leaves with decoded positions cached per thread.
+    explicit PointSearch(const PointDataGridT& grid, const size_t cacheSize = 256);
+
+    /// @brief Find all points within a radius of a world-space position, sorted by distance.
+    void searchRadius(  const Vec3d& position,
+                        const double radius,
+                        NeighbourList& neighbours) const;
+
+    /// @brief Find the @a k nearest points to a world-space position, sorted by distance.
+    /// @note Fewer points are returned if the grid contains fewer than @a k points.
+    void searchNearest( const Vec3d& position,
+                        const size_t k,
+                        NeighbourList& neighbours) const;
+
+    /// @brief Find all points within a radius of each of the world-space positions in parallel.
+    void searchRadius(  const std::vector<Vec3d>& positions,
+                        const double radius,
+                        std::vector<NeighbourList>& neighbours) const;
+
+    /// @brief Find the @a k nearest points to each of the world-space positions in parallel.
+    void searchNearest( const std::vector<Vec3d>& positions,
+                        const size_t k,
+                        std::vector<NeighbourList>& neighbours) const;
+
+    /// @brief Return the world-space position of a point found by a query.
+    Vec3d worldPosition(const Neighbour& neighbour) const;
+
+private:
+    typedef std::vector<Vec3d>                          PositionArray;
+    typedef typename TreeType::ConstAccessor            ConstAccessor;
+
+    /// Cache of decoded index-space positions and a tree accessor for a single thread
+    struct Cache
+    {
+        explicit Cache(const TreeType& tree)
+            : accessor(tree) { }
+
+        ConstAccessor accessor;
+        std::map<const LeafType*, PositionArray> positions;
+    }; // struct Cache
+
+    /// Return the cache of the calling thread
+    Cache& localCache() const;
+
+    /// Return the decoded index-space positions of a leaf, using the cache
+    const PositionArray& leafPositions(Cache& cache, const LeafType& leaf) const;
+
+    /// Append all points within an index-space radius of an index-space position
+    void searchIndexSpace(  Cache& cache,
+                            const Vec3d& center,
+                            const double radius,
+                            NeighbourList& neighbours) const;
+
+    const PointDataGridT&                               mGrid;
+    const size_t                                        mCacheSize;
+    size_t                                              mPositionIndex;
+    double                                              mVoxelSize;
+    CoordBBox                                           mBounds;
+    mutable tbb::enumerable_thread_specific<Cache>      mCaches;
+}; // class PointSearch
+
+
+////////////////////////////////////////
+
+
+namespace point_search_internal {
+
+
+template <typename SearchT>
+struct SearchRadiusOp
+{
+    typedef typename SearchT::NeighbourList NeighbourList;
+
+    SearchRadiusOp( const SearchT& search,
+                    const std::vector<Vec3d>& positions,
+                    const double radius,
+                    std::vector<NeighbourList>& neighbours)
+        : mSearch(search)
+        , mPositions(positions)
+        , mRadius(radius)
+        , mNeighbours(neighbours) { }
+
+    void operator()(const tbb::blocked_range<size_t>& range) const
+    {
+        for (size_t n = range.begin(); n < range.end(); n++) {
+            mSearch.searchRadius(mPositions[n], mRadius, mNeighbours[n]);
+        }
+    }
+
+    //////////
+
+    const SearchT&                  mSearch;
+    const std::vector<Vec3d>&       mPositions;
+    const double                    mRadius;
+    std::vector<NeighbourList>&     mNeighbours;
+}; // struct SearchRadiusOp
+
+
+template <typename SearchT>
+struct SearchNearestOp
+{
+    typedef typename SearchT::NeighbourList NeighbourList;
+
+    SearchNearestOp(const SearchT& search,
+                    const std::vector<Vec3d>& positions,
+                    const size_t k,
+                    std::vector<NeighbourList>& neighbours)
+        : mSearch(search)
+        , mPositions(positions)
+        , mK(k)
+        , mNeighbours(neighbours) { }
+
+    void operator()(const tbb::blocked_range<size_t>& range) const
+    {
+        for (size_t n = range.begin(); n < range.end(); n++) {
+            mSearch.searchNearest(mPositions[n], mK, mNeighbours[n]);
+        }
+    }
+
+    //////////
+
+    const SearchT&                  mSearch;
+    const std::vector<Vec3d>&       mPositions;
+    const size_t                    mK;
+    std::vector<NeighbourList>&     mNeighbours;
+}; // struct SearchNearestOp
+
+
+/// @brief Return the squared distance from a position to an axis-aligned box
+inline double
+distanceSqr(const Vec3d& position, const Vec3d& min, const Vec3d& max)
+{
+    double result = 0.0;
+
+    for (int i = 0; i < 3; i++) {
+        if (position[i] < min[i])           result += math::Pow2(min[i] - position[i]);
+        else if (position[i] > max[i])      result += math::Pow2(position[i] - max[i]);
+    }
+
+    return result;
+}
+
+
+} // namespace point_search_internal
+
+
+////////////////////////////////////////
+
+
+template <typename PointDataGridT>
+PointSearch<PointDataGridT>::PointSearch(const PointDataGridT& grid, const size_t cacheSize)
+    : mGrid(grid)
+    , mCacheSize(cacheSize)
+    , mPositionIndex(AttributeSet::INVALID_POS)
+    , mVoxelSize(grid.constTransform().voxelSize()[0])
+    , mBounds()
+    , mCaches(Cache(grid.constTree()))
+{
+    const math::Transform& transform = grid.constTransform();
+
+    if (!transform.isLinear() || !transform.hasUniformScale()) {
+        OPENVDB_THROW(ValueError, "Point search requires a linear transform with uniform scale.");
+    }
+
+    typename TreeType::LeafCIter iter = grid.constTree().cbeginLeaf();
+
+    if (!iter)  return;
+
+    mPositionIndex = iter->attributeSet().descriptor().find("P");
+
+    if (mPositionIndex == AttributeSet::INVALID_POS) {
+        OPENVDB_THROW(KeyError, "Cannot find position attribute - P.");
+    }
+
+    grid.constTree().evalLeafBoundingBox(mBounds);
+}
+
+
+template <typename PointDataGridT>
+typename PointSearch<PointDataGridT>::Cache&
+PointSearch<PointDataGridT>::localCache() const
+{
+    Cache& cache = mCaches.local();
+
+    // discard all cached positions once the cache is full
+
+    if (cache.positions.size() >= mCacheSize)   cache.positions.clear();
+
+    return cache;
+}
+
+
+template <typename PointDataGridT>
+const typename PointSearch<PointDataGridT>::PositionArray&
+PointSearch<PointDataGridT>::leafPositions(Cache& cache, const LeafType& leaf) const
+{
+    typedef typename LeafType::IndexAllIter IndexAllIter;
+
+    typename std::map<const LeafType*, PositionArray>::iterator it = cache.positions.find(&leaf);
+
+    if (it != cache.positions.end())    return it->second;
+
+    PositionArray& positions = cache.positions[&leaf];
+    positions.resize(leaf.pointCount());
+
+    AttributeHandle<Vec3f>::Ptr positionHandle =
+        AttributeHandle<Vec3f>::create(leaf.constAttributeArray(mPositionIndex));
+
+    for (IndexAllIter iter = leaf.beginIndexAll(); iter; ++iter) {
+        const Index index = Index(*iter);
+        positions[index] = iter.getCoord().asVec3d() + Vec3d(positionHandle->get(index));
+    }
+
+    return positions;
+}
+
+
+template <typename PointDataGridT>
+void
+PointSearch<PointDataGridT>::searchIndexSpace(  Cache& cache,
+                                                const Vec3d& center,
+                                                const double radius,
+                                                NeighbourList& neighbours) const
+{
+    using point_search_internal::distanceSqr;
+
+    const double radiusSqr = radius * radius;
+    const double voxelSizeSqr = mVoxelSize * mVoxelSize;
+
+    // points lie within half a voxel of the voxel center
+
+    CoordBBox bbox(Coord::round(center - Vec3d(radius)), Coord::round(center + Vec3d(radius)));
+    bbox.intersect(mBounds);
+
+    if (bbox.empty())   return;
+
+    const Int32 dim = Int32(LeafType::DIM);
+
+    const Coord leafMin = bbox.min() & ~(dim - 1);
+    const Coord leafMax = bbox.max() & ~(dim - 1);
+
+    Coord origin, ijk;
+
+    for (origin[0] = leafMin[0]; origin[0] <= leafMax[0]; origin[0] += dim) {
+        for (origin[1] = leafMin[1]; origin[1] <= leafMax[1]; origin[1] += dim) {
+            for (origin[2] = leafMin[2]; origin[2] <= leafMax[2]; origin[2] += dim) {
+
+                const LeafType* leaf = cache.accessor.probeConstLeaf(origin);
+
+                if (!leaf)  continue;
+
+                CoordBBox leafBBox = leaf->getNodeBoundingBox();
+
+                if (distanceSqr(center, leafBBox.min().asVec3d() - Vec3d(0.5),
+                                        leafBBox.max().asVec3d() + Vec3d(0.5)) > radiusSqr) continue;
+
+                leafBBox.intersect(bbox);
+
+                const PositionArray* positions = NULL;
+
+                for (ijk[0] = leafBBox.min()[0]; ijk[0] <= leafBBox.max()[0]; ijk[0]++) {
+                for (ijk[1] = leafBBox.min()[1]; ijk[1] <= leafBBox.max()[1]; ijk[1]++) {
+                for (ijk[2] = leafBBox.min()[2]; ijk[2] <= leafBBox.max()[2]; ijk[2]++) {
+
+                    const Vec3d xyz = ijk.asVec3d();
+
+                    if (distanceSqr(center, xyz - Vec3d(0.5), xyz + Vec3d(0.5)) > radiusSqr)  continue;
+
+                    const Index offset = LeafType::coordToOffset(ijk);
+                    const Index end = Index(leaf->getValue(offset));
+                    const Index start = offset == 0 ? Index(0) : Index(leaf->getValue(offset - 1));
+
+                    if (start == end)   continue;
+
+                    if (!positions)     positions = &this->leafPositions(cache, *leaf);
+
+                    for (Index index = start; index < end; index++) {
+                        const double pointDistanceSqr = ((*positions)[index] - center).lengthSqr();
+                        if (pointDistanceSqr <= radiusSqr) {
+                            neighbours.push_back(Neighbour(leaf, index, pointDistanceSqr * voxelSizeSqr));
+                        }
+                    }
+                }
+                }
+                }
+            }
+        }
+    }
+}
+
+
+template <typename PointDataGridT>
+void
+PointSearch<PointDataGridT>::searchRadius(  const Vec3d& position,
+                                            const double radius,
+                                            NeighbourList& neighbours) const
+{
+    neighbours.clear();
+
+    if (mPositionIndex == AttributeSet::INVALID_POS || radius < 0.0)   return;
+
+    const Vec3d center = mGrid.constTransform().worldToIndex(position);
+
+    this->searchIndexSpace(this->localCache(), center, radius / mVoxelSize, neighbours);
+
+    std::sort(neighbours.begin(), neighbours.end());
+}
+
+
+template <typename PointDataGridT>
+void
+PointSearch<PointDataGridT>::searchNearest( const Vec3d& position,
+                                            const size_t k,
+                                            NeighbourList& neighbours) const
+{
+    using point_search_internal::distanceSqr;
+
+    neighbours.clear();
+
+    if (mPositionIndex == AttributeSet::INVALID_POS || k == 0)     return;
+
+    const Vec3d center = mGrid.constTransform().worldToIndex(position);
+
+    Cache& cache = this->localCache();
+
+    // the radius at which every point in the grid is within range
+
+    const Vec3d min = mBounds.min().asVec3d() - Vec3d(0.5);
+    const Vec3d max = mBounds.max().asVec3d() + Vec3d(0.5);
+
+    double maxRadiusSqr = 0.0;
+    for (int i = 0; i < 8; i++) {
+        const Vec3d corner((i & 1) ? max[0] : min[0], (i & 2) ? max[1] : min[1], (i & 4) ? max[2] : min[2]);
+        maxRadiusSqr = std::max(maxRadiusSqr, (corner - center).lengthSqr());
+    }
+
+    const double maxRadius = std::sqrt(maxRadiusSqr);
+
+    // double the radius until at least k points are found, all points closer than the
+    // k-th nearest are then guaranteed to be within the radius
+
+    double radius = std::max(1.0, std::sqrt(distanceSqr(center, min, max)) + 1.0);
+
+    while (true) {
+
+        neighbours.clear();
+
+        this->searchIndexSpace(cache, center, radius, neighbours);
+
+        if (neighbours.size() >= k || radius >= maxRadius)  break;
+
+        radius = std::min(radius * 2.0, maxRadius);
+    }
+
+    if (neighbours.size() > k) {
+        std::partial_sort(neighbours.begin(), neighbours.begin() + k, neighbours.end());
+        neighbours.resize(k, neighbours.front());
+    }
+    else {
+        std::sort(neighbours.begin(), neighbours.end());
+    }
+}
+
+
+template <typename PointDataGridT>
+void
+PointSearch<PointDataGridT>::searchRadius(  const std::vector<Vec3d>& positions,
+                                            const double radius,
+                                            std::vector<NeighbourList>& neighbours) const
+{
+    neighbours.resize(positions.size());
+
+    point_search_internal::SearchRadiusOp<PointSearch> op(*this, positions, radius, neighbours);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, positions.size()), op);
+}
+
+
+template <typename PointDataGridT>
+void
+PointSearch<PointDataGridT>::searchNearest( const std::vector<Vec3d>& positions,
+                                            const size_t k,
+                                            std::vector<NeighbourList>& neighbours) const
+{
+    neighbours.resize(positions.size());
+
+    point_search_internal::SearchNearestOp<PointSearch> op(*this, positions, k, neighbours);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, positions.size()), op);
+}
+
+
+template <typename PointDataGridT>
+Vec3d
+PointSearch<PointDataGridT>::worldPosition(const Neighbour& neighbour) const
+{
+    const PositionArray& positions = this->leafPositions(this->localCache(), *neighbour.leaf);
+
+    return mGrid.constTransform().indexToWorld(positions[neighbour.index]);
+}
+
+
+////////////////////////////////////////
+
+
+} // namespace tools
+} // namespace OPENVDB_VERSION_NAME
+} // namespace openvdb
+
+
+#endif // OPENVDB_TOOLS_POINT_SEARCH_HAS_BEEN_INCLUDED
+
+
+// Copyright (c) 2015-2016 Double Negative Visual Effects
+// All rights reserved. This software is distributed under the
+// Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
@@ -113,7 +113,11 @@ public:
     CPPUNIT_TEST(testCompression);
     CPPUNIT_TEST(testRegistry);
     CPPUNIT_TEST(testAttributeArray);
+    CPPUNIT_TEST(testIntegerCodecs);
+    CPPUNIT_TEST(testOctahedralCodec);
+    CPPUNIT_TEST(testQuaternionAndMatrix);
     CPPUNIT_TEST(testAttributeHandle);
+    CPPUNIT_TEST(testPagedCompression);
     CPPUNIT_TEST(testDelayedLoad);
     CPPUNIT_TEST(testProfile);
 
@@ -123,7 +127,11 @@ public:
     void testCompression();
     void testRegistry();
     void testAttributeArray();
+    void testIntegerCodecs();
+    void testOctahedralCodec();
+    void testQuaternionAndMatrix();
     void testAttributeHandle();
+    void testPagedCompression();
     void testDelayedLoad();
     void testProfile();
 }; // class TestAttributeArray
@@ -785,6 +793,428 @@ TestAttributeArray::testAttributeArray()
         CPPUNIT_ASSERT_NO_THROW(TypedAttributeArray<float>::cast(*constArray));
         CPPUNIT_ASSERT_THROW(TypedAttributeArray<int>::cast(*constArray), TypeError);
     }
+
+    { // Bulk copy
+        using namespace openvdb;
+        using namespace openvdb::tools;
+
+        AttributeArrayF source(10);
+        for (Index i = 0; i < 10; i++)  source.set(i, float(i));
+
+        AttributeArrayF uniformSource(10, 5.0f);
+
+        AttributeArrayF target(6, 5.0f);
+
+        // copying matching uniform values leaves the array uniform
+
+        target.copyValuesUnsafe(0, uniformSource, 0, 3);
+        CPPUNIT_ASSERT(target.isUniform());
+
+        target.copyValuesUnsafe(2, source, 7, 3);
+        CPPUNIT_ASSERT(!target.isUniform());
+        CPPUNIT_ASSERT_EQUAL(target.get(1), 5.0f);
+        CPPUNIT_ASSERT_EQUAL(target.get(2), 7.0f);
+        CPPUNIT_ASSERT_EQUAL(target.get(4), 9.0f);
+        CPPUNIT_ASSERT_EQUAL(target.get(5), 5.0f);
+
+        // overwriting the entire array with a uniform value collapses it
+
+        AttributeArrayF uniformTarget(6);
+        uniformTarget.copyValuesUnsafe(0, uniformSource, 0, 6);
+        CPPUNIT_ASSERT(uniformTarget.isUniform());
+        CPPUNIT_ASSERT_EQUAL(uniformTarget.get(0), 5.0f);
+
+        CPPUNIT_ASSERT_THROW(target.copyValuesUnsafe(0, TypedAttributeArray<int>(10), 0, 1), TypeError);
+    }
+}
+
+
+namespace {
+
+template <typename AttributeT>
+void
+testIntegerCodec(const std::vector<typename AttributeT::ValueType>& values)
+{
+    using namespace openvdb;
+    using namespace openvdb::tools;
+
+    typedef typename AttributeT::ValueType ValueT;
+
+    const Index count = Index(values.size());
+
+    AttributeT attrA(count);
+    for (Index i = 0; i < count; ++i)   attrA.set(i, values[i]);
+
+    { // buffer transform round-trip
+        typedef typename AttributeT::Codec Codec;
+
+        std::vector<ValueT> buffer(values);
+        CodecBufferTransform<Codec>::encode(&buffer[0], buffer.size());
+        CodecBufferTransform<Codec>::decode(&buffer[0], buffer.size());
+
+        for (Index i = 0; i < count; ++i)   CPPUNIT_ASSERT_EQUAL(values[i], buffer[i]);
+    }
+
+#ifdef OPENVDB_USE_BLOSC
+    { // in-memory compression
+        AttributeT attrB(attrA);
+
+        CPPUNIT_ASSERT(attrB.compress());
+        CPPUNIT_ASSERT(attrB.isCompressed());
+
+        // a compressed copy is uncompressed on request
+
+        AttributeT attrC(attrB, /*uncompress=*/true);
+        CPPUNIT_ASSERT(!attrC.isCompressed());
+
+        for (Index i = 0; i < count; ++i) {
+            CPPUNIT_ASSERT_EQUAL(values[i], attrB.get(i));
+            CPPUNIT_ASSERT_EQUAL(values[i], attrC.get(i));
+        }
+    }
+#endif
+
+    { // write and read with on-disk compression
+        std::ostringstream ostr(std::ios_base::binary);
+        io::setDataCompression(ostr, io::COMPRESS_BLOSC);
+        attrA.write(ostr);
+
+        // the array being written is unchanged
+
+        for (Index i = 0; i < count; ++i)   CPPUNIT_ASSERT_EQUAL(values[i], attrA.get(i));
+
+        AttributeT attrB;
+        std::istringstream istr(ostr.str(), std::ios_base::binary);
+        attrB.read(istr);
+
+        CPPUNIT_ASSERT_EQUAL(attrA.size(), attrB.size());
+
+        for (Index i = 0; i < count; ++i)   CPPUNIT_ASSERT_EQUAL(values[i], attrB.get(i));
+    }
+}
+
+} // namespace
+
+
+void
+TestAttributeArray::testIntegerCodecs()
+{
+    using namespace openvdb;
+    using namespace openvdb::tools;
+
+    typedef TypedAttributeArray<int32_t, DeltaAttributeCodec<int32_t> >               AttributeDeltaI;
+    typedef TypedAttributeArray<int64_t, DeltaAttributeCodec<int64_t> >               AttributeDeltaL;
+    typedef TypedAttributeArray<int32_t, FrameOfReferenceAttributeCodec<int32_t> >    AttributeFORI;
+    typedef TypedAttributeArray<int64_t, FrameOfReferenceAttributeCodec<int64_t> >    AttributeFORL;
+
+    { // zig-zag encoding
+        CPPUNIT_ASSERT_EQUAL(uint32_t(0), zigZagEncode(uint32_t(0)));
+        CPPUNIT_ASSERT_EQUAL(uint32_t(1), zigZagEncode(uint32_t(-1)));
+        CPPUNIT_ASSERT_EQUAL(uint32_t(2), zigZagEncode(uint32_t(1)));
+        CPPUNIT_ASSERT_EQUAL(uint32_t(3), zigZagEncode(uint32_t(-2)));
+        CPPUNIT_ASSERT_EQUAL(uint32_t(0xFFFFFFFF), zigZagEncode(uint32_t(0x80000000)));
+
+        for (int i = -1000; i < 1000; i++) {
+            CPPUNIT_ASSERT_EQUAL(uint32_t(i), zigZagDecode(zigZagEncode(uint32_t(i))));
+            CPPUNIT_ASSERT_EQUAL(uint64_t(i), zigZagDecode(zigZagEncode(uint64_t(i))));
+        }
+    }
+
+    CPPUNIT_ASSERT(matchingNamePairs(AttributeDeltaI::attributeType(), NamePair("int32", "dlta_int32")));
+    CPPUNIT_ASSERT(matchingNamePairs(AttributeFORL::attributeType(), NamePair("int64", "for_int64")));
+
+    // near-sequential values with jumps and extremes to exercise wrapping
+
+    std::vector<int32_t> values32;
+    std::vector<int64_t> values64;
+
+    for (int i = 0; i < 1000; i++) {
+        const int32_t value = (i % 100 == 0) ? -i * 7 : 5000 + i;
+        values32.push_back(value);
+        values64.push_back(int64_t(value) * 1000000);
+    }
+
+    values32.push_back(std::numeric_limits<int32_t>::max());
+    values32.push_back(std::numeric_limits<int32_t>::min());
+    values64.push_back(std::numeric_limits<int64_t>::max());
+    values64.push_back(std::numeric_limits<int64_t>::min());
+
+    testIntegerCodec<AttributeDeltaI>(values32);
+    testIntegerCodec<AttributeFORI>(values32);
+    testIntegerCodec<AttributeDeltaL>(values64);
+    testIntegerCodec<AttributeFORL>(values64);
+
+    // single values
+
+    testIntegerCodec<AttributeDeltaI>(std::vector<int32_t>(1, -5));
+    testIntegerCodec<AttributeFORL>(std::vector<int64_t>(1, -5));
+
+#ifdef OPENVDB_USE_BLOSC
+    { // sequential ids compress better than the uncompressed codec
+        typedef TypedAttributeArray<int32_t> AttributeI;
+
+        const Index count(10000);
+
+        AttributeI attrA(count);
+        AttributeDeltaI attrB(count);
+
+        for (Index i = 0; i < count; ++i) {
+            attrA.set(i, int32_t(123456 + i * 3));
+            attrB.set(i, int32_t(123456 + i * 3));
+        }
+
+        CPPUNIT_ASSERT(attrA.compress());
+        CPPUNIT_ASSERT(attrB.compress());
+
+        CPPUNIT_ASSERT(attrB.memUsage() < attrA.memUsage());
+    }
+#endif
+}
+
+
+namespace {
+
+template <typename AttributeT>
+double
+maxOctahedralError(const std::vector<openvdb::Vec3f>& values)
+{
+    using namespace openvdb;
+
+    AttributeT attr(values.size());
+
+    double maxError = 0.0;
+
+    for (Index i = 0; i < Index(values.size()); i++) {
+        attr.set(i, values[i]);
+        const Vec3f value = attr.get(i);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, double(value.length()), 1e-5);
+        for (int j = 0; j < 3; j++) {
+            maxError = std::max(maxError, double(std::abs(value[j] - values[i][j])));
+        }
+    }
+
+    return maxError;
+}
+
+} // namespace
+
+
+void
+TestAttributeArray::testOctahedralCodec()
+{
+    using namespace openvdb;
+    using namespace openvdb::tools;
+
+    typedef TypedAttributeArray<Vec3f, OctahedralAttributeCodec<uint16_t> >             AttributeOct16;
+    typedef TypedAttributeArray<Vec3f, OctahedralAttributeCodec<uint32_t> >             AttributeOct32;
+    typedef TypedAttributeArray<Vec3f, OctahedralAttributeCodec<math::Vec2<half> > >    AttributeOctH;
+
+    CPPUNIT_ASSERT(matchingNamePairs(AttributeOct16::attributeType(), NamePair("vec3s", "oct_uint16")));
+    CPPUNIT_ASSERT(matchingNamePairs(AttributeOct32::attributeType(), NamePair("vec3s", "oct_uint32")));
+    CPPUNIT_ASSERT(matchingNamePairs(AttributeOctH::attributeType(), NamePair("vec3s", "oct_vec2h")));
+
+    { // signed normalized quantization
+        CPPUNIT_ASSERT_EQUAL(uint16_t(0), floatToSnorm<uint16_t, 8>(-1.0f));
+        CPPUNIT_ASSERT_EQUAL(uint16_t(127), floatToSnorm<uint16_t, 8>(0.0f));
+        CPPUNIT_ASSERT_EQUAL(uint16_t(254), floatToSnorm<uint16_t, 8>(1.0f));
+        CPPUNIT_ASSERT_EQUAL(uint16_t(254), floatToSnorm<uint16_t, 8>(2.0f));
+
+        CPPUNIT_ASSERT_EQUAL(-1.0f, snormToFloat<uint16_t, 8>(uint16_t(0)));
+        CPPUNIT_ASSERT_EQUAL(0.0f, snormToFloat<uint16_t, 8>(uint16_t(127)));
+        CPPUNIT_ASSERT_EQUAL(1.0f, snormToFloat<uint16_t, 8>(uint16_t(254)));
+        CPPUNIT_ASSERT_EQUAL(1.0f, snormToFloat<uint16_t, 8>(uint16_t(255)));
+
+        CPPUNIT_ASSERT_EQUAL(0.0f, snormToFloat<uint16_t, 16>(floatToSnorm<uint16_t, 16>(0.0f)));
+    }
+
+    { // axis directions are exact
+        std::vector<Vec3f> axes;
+        axes.push_back(Vec3f(1, 0, 0));
+        axes.push_back(Vec3f(-1, 0, 0));
+        axes.push_back(Vec3f(0, 1, 0));
+        axes.push_back(Vec3f(0, -1, 0));
+        axes.push_back(Vec3f(0, 0, 1));
+        axes.push_back(Vec3f(0, 0, -1));
+
+        CPPUNIT_ASSERT_EQUAL(0.0, maxOctahedralError<AttributeOct16>(axes));
+        CPPUNIT_ASSERT_EQUAL(0.0, maxOctahedralError<AttributeOct32>(axes));
+        CPPUNIT_ASSERT_EQUAL(0.0, maxOctahedralError<AttributeOctH>(axes));
+    }
+
+    { // random directions
+        math::Random01 randNumber(0);
+
+        std::vector<Vec3f> values;
+        for (int i = 0; i < 10000; i++) {
+            Vec3f value(float(randNumber()) * 2.0f - 1.0f,
+                        float(randNumber()) * 2.0f - 1.0f,
+                        float(randNumber()) * 2.0f - 1.0f);
+            if (!value.normalize())     continue;
+            values.push_back(value);
+        }
+
+        const double error16 = maxOctahedralError<AttributeOct16>(values);
+        const double error32 = maxOctahedralError<AttributeOct32>(values);
+        const double errorH = maxOctahedralError<AttributeOctH>(values);
+
+        CPPUNIT_ASSERT(error16 < 0.02);
+        CPPUNIT_ASSERT(error32 < 1e-4);
+        CPPUNIT_ASSERT(errorH < 2e-3);
+        CPPUNIT_ASSERT(error32 < errorH);
+        CPPUNIT_ASSERT(errorH < error16);
+    }
+
+    { // zero-length vectors decode to a valid unit vector
+        AttributeOct16 attr(1);
+        attr.set(0, Vec3f(0, 0, 0));
+        CPPUNIT_ASSERT_EQUAL(Vec3f(0, 0, 1), attr.get(0));
+    }
+}
+
+
+namespace {
+
+/// Return the maximum component error of smallest-three encoded quaternions,
+/// comparing against both q and -q as these represent the same rotation
+double
+maxSmallestThreeError(const std::vector<openvdb::math::Quat<float> >& values)
+{
+    using namespace openvdb;
+    using namespace openvdb::tools;
+
+    TypedAttributeArray<math::Quat<float>, SmallestThreeAttributeCodec> attr(values.size());
+
+    double maxError = 0.0;
+
+    for (Index i = 0; i < Index(values.size()); i++) {
+        attr.set(i, values[i]);
+        const math::Quat<float> value = attr.get(i);
+
+        const double lengthSqr = value.x() * value.x() + value.y() * value.y() +
+                                 value.z() * value.z() + value.w() * value.w();
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, lengthSqr, 1e-5);
+
+        double error = 0.0, errorNegated = 0.0;
+        for (int j = 0; j < 4; j++) {
+            const float a = j == 0 ? value.x() : j == 1 ? value.y() : j == 2 ? value.z() : value.w();
+            const float b = j == 0 ? values[i].x() : j == 1 ? values[i].y() : j == 2 ? values[i].z() : values[i].w();
+            error = std::max(error, double(std::abs(a - b)));
+            errorNegated = std::max(errorNegated, double(std::abs(a + b)));
+        }
+        maxError = std::max(maxError, std::min(error, errorNegated));
+    }
+
+    return maxError;
+}
+
+} // namespace
+
+
+void
+TestAttributeArray::testQuaternionAndMatrix()
+{
+    using namespace openvdb;
+    using namespace openvdb::tools;
+
+    typedef math::Quat<float>                                                   Quatf;
+    typedef TypedAttributeArray<Quatf>                                          AttributeQuat;
+    typedef TypedAttributeArray<Quatf, SmallestThreeAttributeCodec>             AttributeQuatSm3;
+    typedef TypedAttributeArray<math::Vec4<float> >                             AttributeVec4;
+    typedef TypedAttributeArray<math::Mat3<double> >                            AttributeMat3;
+
+    CPPUNIT_ASSERT(matchingNamePairs(AttributeQuat::attributeType(), NamePair("quats", "null_quats")));
+    CPPUNIT_ASSERT(matchingNamePairs(AttributeQuatSm3::attributeType(), NamePair("quats", "sm3_uint32")));
+    CPPUNIT_ASSERT(matchingNamePairs(AttributeVec4::attributeType(), NamePair("vec4s", "null_vec4s")));
+    CPPUNIT_ASSERT(matchingNamePairs(AttributeMat3::attributeType(), NamePair("mat3d", "null_mat3d")));
+
+    { // uncompressed values are stored and serialized as one unit
+        const Index count = 20;
+
+        AttributeQuat attrQ(count);
+        AttributeVec4 attrV(count);
+        AttributeMat3 attrM(count);
+
+        for (Index i = 0; i < count; i++) {
+            const float f(static_cast<float>(i));
+            const double d(static_cast<double>(i));
+            attrQ.set(i, Quatf(f, f + 1.0f, f + 2.0f, f + 3.0f));
+            attrV.set(i, math::Vec4<float>(f, -f, 2.0f * f, 1.0f));
+            attrM.set(i, math::Mat3<double>(d, 1.0, 2.0, 3.0, d, 5.0, 6.0, 7.0, d));
+        }
+
+        CPPUNIT_ASSERT(attrQ.get(3) == Quatf(3, 4, 5, 6));
+        CPPUNIT_ASSERT(attrV.get(3) == math::Vec4<float>(3, -3, 6, 1));
+        CPPUNIT_ASSERT(attrM.get(3) == math::Mat3<double>(3, 1, 2, 3, 3, 5, 6, 7, 3));
+
+        std::ostringstream ostr(std::ios_base::binary);
+        io::setDataCompression(ostr, io::COMPRESS_BLOSC);
+
+        attrQ.write(ostr);
+        attrM.write(ostr);
+
+        AttributeQuat attrQB;
+        AttributeMat3 attrMB;
+
+        std::istringstream istr(ostr.str(), std::ios_base::binary);
+        attrQB.read(istr);
+        attrMB.read(istr);
+
+        CPPUNIT_ASSERT(attrQ == attrQB);
+        CPPUNIT_ASSERT(attrM == attrMB);
+
+        // collapsing to a zero value uses the zero quaternion and matrix
+
+        attrQ.collapse();
+        attrM.collapse();
+
+        CPPUNIT_ASSERT(attrQ.isUniform());
+        CPPUNIT_ASSERT(attrQ.get(0) == zeroVal<Quatf>());
+        CPPUNIT_ASSERT(attrM.get(0) == zeroVal<math::Mat3<double> >());
+    }
+
+    { // identity and axis rotations are exact
+        std::vector<Quatf> values;
+        values.push_back(Quatf(0, 0, 0, 1));
+        values.push_back(Quatf(1, 0, 0, 0));
+        values.push_back(Quatf(0, -1, 0, 0));
+        values.push_back(Quatf(0, 0, 1, 0));
+        values.push_back(Quatf(0, 0, 0, -1));
+
+        CPPUNIT_ASSERT_EQUAL(0.0, maxSmallestThreeError(values));
+
+        // the largest component is decoded as positive
+
+        AttributeQuatSm3 attr(1);
+        attr.set(0, Quatf(0, 0, 0, -1));
+        CPPUNIT_ASSERT(attr.get(0) == Quatf(0, 0, 0, 1));
+    }
+
+    { // random rotations
+        math::Random01 randNumber(0);
+
+        std::vector<Quatf> values;
+        for (int i = 0; i < 10000; i++) {
+            Quatf value(float(randNumber()) * 2.0f - 1.0f,
+                        float(randNumber()) * 2.0f - 1.0f,
+                        float(randNumber()) * 2.0f - 1.0f,
+                        float(randNumber()) * 2.0f - 1.0f);
+            const float length = std::sqrt(value.x() * value.x() + value.y() * value.y() +
+                                           value.z() * value.z() + value.w() * value.w());
+            if (length < 1e-3f)     continue;
+            values.push_back(Quatf(value.x() / length, value.y() / length,
+                                   value.z() / length, value.w() / length));
+        }
+
+        CPPUNIT_ASSERT(maxSmallestThreeError(values) < 3e-3);
+    }
+
+    { // zero-length and non-unit quaternions are normalized
+        AttributeQuatSm3 attr(2);
+        attr.set(0, Quatf(0, 0, 0, 0));
+        attr.set(1, Quatf(0, 0, 0, 2));
+        CPPUNIT_ASSERT(attr.get(0) == Quatf(0, 0, 0, 1));
+        CPPUNIT_ASSERT(attr.get(1) == Quatf(0, 0, 0, 1));
+    }
 }
 
 
@@ -951,6 +1381,133 @@ TestAttributeArray::testAttributeHandle()
     }
 }
 
+void
+TestAttributeArray::testPagedCompression()
+{
+    using namespace openvdb;
+    using namespace openvdb::tools;
+
+    typedef TypedAttributeArray<int32_t, DeltaAttributeCodec<int32_t> >   AttributeDeltaI;
+    typedef TypedAttributeArray<float>                                    AttributeF;
+
+    AttributeDeltaI::registerType();
+    AttributeF::registerType();
+
+    const Index count(5000);
+
+    AttributeDeltaI reference(count);
+
+    for (Index i = 0; i < count; ++i) {
+        reference.set(i, int32_t(1000 + i * 3));
+    }
+
+    CPPUNIT_ASSERT_THROW(AttributeDeltaI(reference).compressPaged(0), openvdb::ValueError);
+
+    { // uniform arrays are not paged
+        AttributeF attr(count, 5.0f);
+        CPPUNIT_ASSERT(!attr.compressPaged(256));
+        CPPUNIT_ASSERT(!attr.isPaged());
+    }
+
+#ifdef OPENVDB_USE_BLOSC
+    const bool wasEnabled = instrumentation::isEnabled();
+    instrumentation::setEnabled(true);
+
+    { // random access decompresses only the touched pages
+        AttributeDeltaI attr(reference);
+
+        CPPUNIT_ASSERT(attr.compressPaged(256));
+        CPPUNIT_ASSERT(attr.isCompressed());
+        CPPUNIT_ASSERT(attr.isPaged());
+        CPPUNIT_ASSERT(attr.memUsage() < reference.memUsage());
+
+        instrumentation::reset();
+
+        CPPUNIT_ASSERT_EQUAL(attr.get(0), int32_t(1000));
+        CPPUNIT_ASSERT_EQUAL(attr.get(300), int32_t(1900));
+        CPPUNIT_ASSERT_EQUAL(attr.get(301), int32_t(1903));
+        CPPUNIT_ASSERT_EQUAL(attr.get(count - 1), int32_t(1000 + (count - 1) * 3));
+
+        CPPUNIT_ASSERT_EQUAL(instrumentation::count(instrumentation::PAGES_DECOMPRESSED), Index64(3));
+        CPPUNIT_ASSERT_EQUAL(instrumentation::count(instrumentation::PAGE_CACHE_HITS), Index64(1));
+
+        CPPUNIT_ASSERT_THROW(attr.get(count), openvdb::IndexError);
+
+        // read handles leave the array compressed
+
+        {
+            AttributeHandle<int32_t> handle(attr);
+            for (Index i = 0; i < count; i += 97) {
+                CPPUNIT_ASSERT_EQUAL(handle.get(i), reference.get(i));
+            }
+        }
+
+        CPPUNIT_ASSERT(attr.isPaged());
+
+        // copies share the pages unless uncompressed
+
+        AttributeDeltaI attrB(attr);
+        CPPUNIT_ASSERT(attrB.isPaged());
+        CPPUNIT_ASSERT(attr == attrB);
+
+        AttributeDeltaI attrC(attr, /*uncompress=*/true);
+        CPPUNIT_ASSERT(!attrC.isCompressed());
+        CPPUNIT_ASSERT(attrC == reference);
+
+        // setting a value decompresses the array
+
+        attrB.set(2, int32_t(5));
+        CPPUNIT_ASSERT(!attrB.isCompressed());
+        CPPUNIT_ASSERT(!attrB.isPaged());
+        CPPUNIT_ASSERT_EQUAL(attrB.get(2), int32_t(5));
+        CPPUNIT_ASSERT_EQUAL(attrB.get(3), int32_t(1009));
+
+        // re-paging with a different page size
+
+        CPPUNIT_ASSERT(!attr.compressPaged(256));
+        CPPUNIT_ASSERT(attr.compressPaged(100));
+        CPPUNIT_ASSERT_EQUAL(attr.get(4321), reference.get(4321));
+
+        CPPUNIT_ASSERT(attr.decompress());
+        CPPUNIT_ASSERT(!attr.isCompressed());
+        CPPUNIT_ASSERT(attr == reference);
+    }
+
+    { // compaction of a paged array
+        AttributeF attr(count);
+        attr.expand();
+        attr.fill(2.0f);
+
+        CPPUNIT_ASSERT(attr.compressPaged(64));
+        CPPUNIT_ASSERT(attr.compact());
+        CPPUNIT_ASSERT(attr.isUniform());
+        CPPUNIT_ASSERT(!attr.isCompressed());
+        CPPUNIT_ASSERT_EQUAL(attr.get(10), 2.0f);
+    }
+
+    { // paging is not serialized
+        AttributeDeltaI attr(reference);
+        CPPUNIT_ASSERT(attr.compressPaged());
+
+        std::ostringstream ostr(std::ios_base::binary);
+        attr.write(ostr);
+
+        AttributeDeltaI attrB;
+        std::istringstream istr(ostr.str(), std::ios_base::binary);
+        attrB.read(istr);
+
+        CPPUNIT_ASSERT(!attrB.isPaged());
+        CPPUNIT_ASSERT(attrB == reference);
+    }
+
+    instrumentation::setEnabled(wasEnabled);
+#else
+    AttributeDeltaI attr(reference);
+    CPPUNIT_ASSERT(!attr.compressPaged(256));
+    CPPUNIT_ASSERT(!attr.isCompressed());
+#endif
+}
+
 void
 TestAttributeArray::testDelayedLoad()
 {
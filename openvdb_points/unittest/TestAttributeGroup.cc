@@ -52,12 +52,14 @@ public:
     CPPUNIT_TEST(testAttributeGroup);
     CPPUNIT_TEST(testAttributeGroupHandle);
     CPPUNIT_TEST(testAttributeGroupFilter);
+    CPPUNIT_TEST(testAttributeGroupSparse);
 
     CPPUNIT_TEST_SUITE_END();
 
     void testAttributeGroup();
     void testAttributeGroupHandle();
     void testAttributeGroupFilter();
+    void testAttributeGroupSparse();
 }; // class TestAttributeGroup
 
 CPPUNIT_TEST_SUITE_REGISTRATION(TestAttributeGroup);
@@ -146,6 +148,15 @@ TestAttributeGroup::testAttributeGroup()
 
         CPPUNIT_ASSERT_NO_THROW(GroupAttributeArray::cast(groupArray));
         CPPUNIT_ASSERT_NO_THROW(GroupAttributeArray::cast(constGroupArray));
+
+        // groups have a type distinct from uint8 attributes
+
+        TypedAttributeArray<GroupType> uint8Attr(4);
+        AttributeArray& uint8Array = uint8Attr;
+
+        CPPUNIT_ASSERT(!matchingNamePairs(groupAttr.type(), uint8Attr.type()));
+        CPPUNIT_ASSERT_THROW(GroupAttributeArray::cast(uint8Array), TypeError);
+        CPPUNIT_ASSERT(!GroupAttributeArray::isGroup(uint8Array));
     }
 
     { // IO
@@ -527,6 +538,216 @@ TestAttributeGroup::testAttributeGroupFilter()
 }
 
 
+void
+TestAttributeGroup::testAttributeGroupSparse()
+{
+    using namespace openvdb;
+    using namespace openvdb::tools;
+
+    const size_t count = 1000;
+
+    GroupAttributeArray attr(count);
+    attr.setSparseThreshold(4);
+
+    CPPUNIT_ASSERT_EQUAL(attr.sparseThreshold(), Index(4));
+    CPPUNIT_ASSERT(attr.isUniform());
+    CPPUNIT_ASSERT(!attr.isSparse());
+
+    GroupWriteHandle writeHandle3(attr, 3);
+    GroupWriteHandle writeHandle6(attr, 6);
+
+    { // setting a few members stores the array sparsely
+        writeHandle3.set(10, true);
+        writeHandle3.set(500, true);
+        writeHandle6.set(10, true);
+
+        CPPUNIT_ASSERT(attr.isSparse());
+        CPPUNIT_ASSERT(!attr.isUniform());
+        CPPUNIT_ASSERT_EQUAL(attr.sparseCount(), Index(2));
+
+        GroupHandle handle3(attr, 3);
+        GroupHandle handle6(attr, 6);
+
+        CPPUNIT_ASSERT(handle3.get(10));
+        CPPUNIT_ASSERT(handle3.get(500));
+        CPPUNIT_ASSERT(!handle3.get(11));
+        CPPUNIT_ASSERT(handle6.get(10));
+        CPPUNIT_ASSERT(!handle6.get(500));
+
+        CPPUNIT_ASSERT_EQUAL(attr.get(10), GroupType((1 << 3) | (1 << 6)));
+        CPPUNIT_ASSERT_EQUAL(attr.get(999), GroupType(0));
+
+        CPPUNIT_ASSERT_THROW(attr.get(Index(count)), IndexError);
+
+        // sparse storage uses much less memory than dense storage
+
+        GroupAttributeArray dense(attr);
+        dense.expand();
+
+        CPPUNIT_ASSERT(!dense.isSparse());
+        CPPUNIT_ASSERT(attr.memUsage() < dense.memUsage());
+        CPPUNIT_ASSERT(attr == dense);
+
+        // removing a member restores the background value
+
+        writeHandle3.set(500, false);
+
+        CPPUNIT_ASSERT_EQUAL(attr.sparseCount(), Index(1));
+        CPPUNIT_ASSERT(!handle3.get(500));
+    }
+
+    { // filtering
+        GroupFilter filter(GroupHandle(attr, 6));
+
+        IndexIter indexIter(0, Index32(count));
+        FilterIndexIter<IndexIter, GroupFilter> iter(indexIter, filter);
+
+        CPPUNIT_ASSERT(iter);
+        CPPUNIT_ASSERT_EQUAL(*iter, Index32(10));
+        CPPUNIT_ASSERT(!iter.next());
+    }
+
+    { // attribute handle access
+        AttributeHandle<GroupType>::Ptr handle = AttributeHandle<GroupType>::create(attr);
+
+        CPPUNIT_ASSERT_EQUAL(handle->get(10), GroupType((1 << 3) | (1 << 6)));
+        CPPUNIT_ASSERT_EQUAL(handle->get(11), GroupType(0));
+    }
+
+    { // IO
+        attr.setHidden(true);
+
+        std::ostringstream ostr(std::ios_base::binary);
+        attr.write(ostr);
+
+        GroupAttributeArray dense(attr);
+        dense.expand();
+
+        std::ostringstream ostrDense(std::ios_base::binary);
+        dense.write(ostrDense);
+
+        CPPUNIT_ASSERT(ostr.str().size() < ostrDense.str().size());
+
+        GroupAttributeArray attrB;
+
+        std::istringstream istr(ostr.str(), std::ios_base::binary);
+        attrB.read(istr);
+
+        CPPUNIT_ASSERT(attrB.isSparse());
+        CPPUNIT_ASSERT_EQUAL(attrB.size(), attr.size());
+        CPPUNIT_ASSERT_EQUAL(attrB.sparseCount(), attr.sparseCount());
+        CPPUNIT_ASSERT_EQUAL(attrB.sparseThreshold(), attr.sparseThreshold());
+        CPPUNIT_ASSERT_EQUAL(attrB.isHidden(), attr.isHidden());
+        CPPUNIT_ASSERT_EQUAL(attrB.isGroup(), attr.isGroup());
+        CPPUNIT_ASSERT(attrB == attr);
+
+        // the threshold also persists for dense arrays
+
+        std::istringstream istrDense(ostrDense.str(), std::ios_base::binary);
+        attrB.read(istrDense);
+
+        CPPUNIT_ASSERT(!attrB.isSparse());
+        CPPUNIT_ASSERT_EQUAL(attrB.sparseThreshold(), attr.sparseThreshold());
+        CPPUNIT_ASSERT(attrB == attr);
+
+        // groups stored as uint8 arrays are converted on read
+
+        std::ostringstream ostrLegacy(std::ios_base::binary);
+        dense.GroupAttributeArray::BaseT::write(ostrLegacy);
+
+        TypedAttributeArray<GroupType> legacy;
+
+        std::istringstream istrLegacy(ostrLegacy.str(), std::ios_base::binary);
+        legacy.read(istrLegacy);
+
+        GroupAttributeArray::Ptr converted = GroupAttributeArray::convertLegacy(legacy);
+
+        CPPUNIT_ASSERT(GroupAttributeArray::isGroup(*converted));
+        CPPUNIT_ASSERT_EQUAL(converted->sparseThreshold(), Index(0));
+        CPPUNIT_ASSERT(*converted == attr);
+
+        // a group array read at the initial file format version has no sparse threshold
+
+        std::istringstream istrInitial(ostrLegacy.str(), std::ios_base::binary);
+        setPointsFormatVersion(istrInitial, OPENVDB_POINTS_FILE_VERSION_INITIAL);
+
+        GroupAttributeArray initial;
+        initial.read(istrInitial);
+
+        CPPUNIT_ASSERT_EQUAL(initial.sparseThreshold(), Index(0));
+        CPPUNIT_ASSERT(initial == attr);
+
+        attr.setHidden(false);
+    }
+
+    { // collapse applies to background and sparse values
+        CPPUNIT_ASSERT(!writeHandle3.collapse(true));
+
+        CPPUNIT_ASSERT(attr.isSparse());
+        CPPUNIT_ASSERT(writeHandle3.get(0));
+        CPPUNIT_ASSERT(writeHandle3.get(10));
+        CPPUNIT_ASSERT(writeHandle6.get(10));
+        CPPUNIT_ASSERT(!writeHandle6.get(0));
+
+        CPPUNIT_ASSERT(writeHandle6.collapse(false));
+
+        CPPUNIT_ASSERT(!attr.isSparse());
+        CPPUNIT_ASSERT(attr.isUniform());
+    }
+
+    { // promotion to dense storage when exceeding the threshold
+        attr.collapse();
+
+        for (Index i = 0; i < 4; i++)   writeHandle3.set(i * 100, true);
+
+        CPPUNIT_ASSERT(attr.isSparse());
+        CPPUNIT_ASSERT_EQUAL(attr.sparseCount(), Index(4));
+
+        writeHandle3.set(999, true);
+
+        CPPUNIT_ASSERT(!attr.isSparse());
+        CPPUNIT_ASSERT(!attr.isUniform());
+
+        for (Index i = 0; i < 4; i++)   CPPUNIT_ASSERT(writeHandle3.get(i * 100));
+        CPPUNIT_ASSERT(writeHandle3.get(999));
+        CPPUNIT_ASSERT(!writeHandle3.get(998));
+
+        // demotion to sparse storage on compaction
+
+        writeHandle3.set(0, false);
+        writeHandle3.set(100, false);
+
+        CPPUNIT_ASSERT(!attr.isSparse());
+        CPPUNIT_ASSERT(!writeHandle3.compact());
+        CPPUNIT_ASSERT(attr.isSparse());
+        CPPUNIT_ASSERT_EQUAL(attr.sparseCount(), Index(3));
+
+        for (Index i = 2; i < 4; i++)   CPPUNIT_ASSERT(writeHandle3.get(i * 100));
+        CPPUNIT_ASSERT(writeHandle3.get(999));
+        CPPUNIT_ASSERT(!writeHandle3.get(0));
+
+        // a mostly-set group stores the non-members sparsely
+
+        writeHandle3.collapse(true);
+        writeHandle3.set(5, false);
+
+        CPPUNIT_ASSERT(attr.isSparse());
+        CPPUNIT_ASSERT_EQUAL(attr.sparseCount(), Index(1));
+        CPPUNIT_ASSERT(!writeHandle3.get(5));
+        CPPUNIT_ASSERT(writeHandle3.get(6));
+    }
+
+    { // disabling sparse storage expands the array
+        attr.setSparseThreshold(0);
+
+        CPPUNIT_ASSERT(!attr.isSparse());
+        CPPUNIT_ASSERT(!attr.isUniform());
+        CPPUNIT_ASSERT(!writeHandle3.get(5));
+        CPPUNIT_ASSERT(writeHandle3.get(6));
+    }
+}
+
+
 // Copyright (c) 2015-2016 Double Negative Visual Effects
 // All rights reserved. This software is distributed under the
 // Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
@@ -505,6 +505,25 @@ TestAttributeSet::testAttributeSetDescriptor()
 
     CPPUNIT_ASSERT_EQUAL(descrA->size(), inputDescr.size());
     CPPUNIT_ASSERT(*descrA == inputDescr);
+
+    // the file format version is set on the stream and not kept in the metadata
+
+    CPPUNIT_ASSERT_EQUAL(openvdb::tools::getPointsFormatVersion(istr), uint32_t(OPENVDB_POINTS_FILE_VERSION));
+    CPPUNIT_ASSERT(!inputDescr.getMetadata()[openvdb::META_FILE_VERSION]);
+
+    // a descriptor without a stored version is the initial version
+
+    std::ostringstream ostrInitial(std::ios_base::binary);
+    const openvdb::Index64 zero(0);
+    ostrInitial.write(reinterpret_cast<const char*>(&zero), sizeof(openvdb::Index64));
+    ostrInitial.write(reinterpret_cast<const char*>(&zero), sizeof(openvdb::Index64));
+    openvdb::MetaMap().writeMeta(ostrInitial);
+
+    std::istringstream istrInitial(ostrInitial.str(), std::ios_base::binary);
+    inputDescr.read(istrInitial);
+
+    CPPUNIT_ASSERT_EQUAL(openvdb::tools::getPointsFormatVersion(istrInitial),
+        uint32_t(OPENVDB_POINTS_FILE_VERSION_INITIAL));
 }
 
 
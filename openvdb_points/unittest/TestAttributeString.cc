@@ -0,0 +1,386 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2015-2016 Double Negative Visual Effects
+//
+// All rights reserved. This software is distributed under the
+// Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
+//
+// Redistributions of source code must retain the above copyright
+// and license notice and the following restrictions and disclaimer.
+//
+// *     Neither the name of Double Negative Visual Effects nor the names
+// of its contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// IN NO EVENT SHALL THE COPYRIGHT HOLDERS' AND CONTRIBUTORS' AGGREGATE
+// LIABILITY FOR ALL CLAIMS REGARDLESS OF THEIR BASIS EXCEED US$250.00.
+//
+///////////////////////////////////////////////////////////////////////////
+
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <openvdb_points/tools/AttributeArray.h>
+#include <openvdb_points/tools/AttributeString.h>
+
+#include <openvdb_points/openvdb.h>
+#include <openvdb/openvdb.h>
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+using namespace openvdb;
+using namespace openvdb::tools;
+
+class TestAttributeString: public CppUnit::TestCase
+{
+public:
+    virtual void setUp() { openvdb::initialize(); openvdb::points::initialize(); }
+    virtual void tearDown() { openvdb::uninitialize(); openvdb::points::uninitialize(); }
+
+    CPPUNIT_TEST_SUITE(TestAttributeString);
+    CPPUNIT_TEST(testStringMetaInserter);
+    CPPUNIT_TEST(testStringAttribute);
+    CPPUNIT_TEST(testStringAttributeHandle);
+    CPPUNIT_TEST(testRemapStrings);
+
+    CPPUNIT_TEST_SUITE_END();
+
+    void testStringMetaInserter();
+    void testStringAttribute();
+    void testStringAttributeHandle();
+    void testRemapStrings();
+}; // class TestAttributeString
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TestAttributeString);
+
+
+////////////////////////////////////////
+
+
+void
+TestAttributeString::testStringMetaInserter()
+{
+    using namespace openvdb;
+    using namespace openvdb::tools;
+
+    MetaMap metadata;
+
+    StringMetaInserter inserter(metadata);
+
+    { // insert one value
+        CPPUNIT_ASSERT_EQUAL(Index(1), inserter.insert("test"));
+        CPPUNIT_ASSERT_EQUAL(size_t(1), metadata.metaCount());
+        StringMetadata::Ptr meta = metadata.getMetadata<StringMetadata>("string:0");
+        CPPUNIT_ASSERT(meta);
+        CPPUNIT_ASSERT_EQUAL(Name("test"), meta->value());
+    }
+
+    { // the empty string and existing strings are not inserted
+        CPPUNIT_ASSERT_EQUAL(Index(0), inserter.insert(""));
+        CPPUNIT_ASSERT_EQUAL(Index(1), inserter.insert("test"));
+        CPPUNIT_ASSERT_EQUAL(size_t(1), metadata.metaCount());
+    }
+
+    { // insert further values
+        CPPUNIT_ASSERT_EQUAL(Index(2), inserter.insert("cat"));
+        CPPUNIT_ASSERT_EQUAL(Index(3), inserter.insert("dog"));
+        CPPUNIT_ASSERT_EQUAL(size_t(3), metadata.metaCount());
+        CPPUNIT_ASSERT_EQUAL(Name("string:2"), stringMetaKey(3));
+    }
+
+    { // other metadata is ignored
+        metadata.insertMeta("default:test", StringMetadata("fish"));
+        metadata.insertMeta("string:x", StringMetadata("bird"));
+        metadata.insertMeta("string:10", FloatMetadata(1.0f));
+
+        StringMetaCache cache(metadata);
+
+        CPPUNIT_ASSERT_EQUAL(size_t(4), cache.size());
+        CPPUNIT_ASSERT_EQUAL(Name(""), cache.get(0));
+        CPPUNIT_ASSERT_EQUAL(Name("test"), cache.get(1));
+        CPPUNIT_ASSERT_EQUAL(Name("dog"), cache.get(3));
+        CPPUNIT_ASSERT_EQUAL(Index(2), cache.find("cat"));
+        CPPUNIT_ASSERT_EQUAL(Index(0), cache.find(""));
+        CPPUNIT_ASSERT(cache.has("cat"));
+        CPPUNIT_ASSERT(!cache.has("fish"));
+
+        CPPUNIT_ASSERT_THROW(cache.get(4), LookupError);
+        CPPUNIT_ASSERT_THROW(cache.find("fish"), LookupError);
+    }
+
+    { // unused indices in the string table
+        metadata.insertMeta("string:5", StringMetadata("horse"));
+
+        StringMetaCache cache(metadata);
+
+        CPPUNIT_ASSERT_EQUAL(size_t(7), cache.size());
+        CPPUNIT_ASSERT(!cache.isValid(4));
+        CPPUNIT_ASSERT_THROW(cache.get(4), LookupError);
+        CPPUNIT_ASSERT_EQUAL(Name("horse"), cache.get(6));
+
+        // the inserter is unaware of strings inserted externally until reset
+
+        inserter.resetCache();
+
+        CPPUNIT_ASSERT_EQUAL(Index(6), inserter.insert("horse"));
+        CPPUNIT_ASSERT_EQUAL(Index(7), inserter.insert("cow"));
+    }
+}
+
+
+void
+TestAttributeString::testStringAttribute()
+{
+    using namespace openvdb;
+    using namespace openvdb::tools;
+
+    { // type name and registration
+        CPPUNIT_ASSERT_EQUAL(Name("str"), Name(StringAttributeCodec::name()));
+        CPPUNIT_ASSERT(StringAttributeArray::isRegistered());
+
+        StringAttributeArray attr(10);
+
+        CPPUNIT_ASSERT(isString(attr));
+        CPPUNIT_ASSERT(!isString(TypedAttributeArray<Index>(10)));
+
+        // a new string attribute is a uniform empty string
+
+        CPPUNIT_ASSERT(attr.isUniform());
+        CPPUNIT_ASSERT_EQUAL(Index(0), attr.get(0));
+    }
+
+    { // compression and IO
+        StringAttributeArray attrA(100);
+
+        for (Index i = 0; i < 100; i++)    attrA.set(i, i % 4);
+
+        StringAttributeArray attrB(attrA);
+
+        attrB.compress();
+
+#ifdef OPENVDB_USE_BLOSC
+        CPPUNIT_ASSERT(attrB.isCompressed());
+        CPPUNIT_ASSERT(attrB.memUsage() < attrA.memUsage());
+#endif
+
+        std::ostringstream ostr(std::ios_base::binary);
+        attrB.write(ostr);
+
+        StringAttributeArray attrC;
+
+        std::istringstream istr(ostr.str(), std::ios_base::binary);
+        attrC.read(istr);
+
+        for (Index i = 0; i < 100; i++) {
+            CPPUNIT_ASSERT_EQUAL(i % 4, attrC.get(i));
+        }
+    }
+}
+
+
+void
+TestAttributeString::testStringAttributeHandle()
+{
+    using namespace openvdb;
+    using namespace openvdb::tools;
+
+    MetaMap metadata;
+
+    StringMetaInserter inserter(metadata);
+    inserter.insert("emitter1");
+    inserter.insert("emitter2");
+
+    StringAttributeArray attr(4);
+
+    { // read and write strings
+        StringAttributeWriteHandle handle(attr, metadata);
+
+        CPPUNIT_ASSERT_EQUAL(size_t(4), handle.size());
+        CPPUNIT_ASSERT(handle.isUniform());
+        CPPUNIT_ASSERT_EQUAL(Name(""), handle.get(0));
+
+        handle.set(1, "emitter2");
+        handle.set(2, "emitter1");
+
+        CPPUNIT_ASSERT(!handle.isUniform());
+        CPPUNIT_ASSERT_EQUAL(Name(""), handle.get(0));
+        CPPUNIT_ASSERT_EQUAL(Name("emitter2"), handle.get(1));
+        CPPUNIT_ASSERT_EQUAL(Name("emitter1"), handle.get(2));
+        CPPUNIT_ASSERT_EQUAL(Index(2), handle.index(1));
+
+        Name name;
+        handle.get(name, 2);
+        CPPUNIT_ASSERT_EQUAL(Name("emitter1"), name);
+
+        // strings must be inserted before they are set
+
+        CPPUNIT_ASSERT_THROW(handle.set(3, "emitter3"), LookupError);
+    }
+
+    { // shared string table cache
+        StringMetaCache cache(metadata);
+
+        StringAttributeHandle handle(attr, cache);
+
+        CPPUNIT_ASSERT_EQUAL(Name("emitter2"), handle.get(1));
+        CPPUNIT_ASSERT(&cache == &handle.cache());
+    }
+
+    { // collapse, fill and compact
+        StringAttributeWriteHandle handle(attr, metadata);
+
+        handle.fill("emitter1");
+
+        CPPUNIT_ASSERT(!handle.isUniform());
+        CPPUNIT_ASSERT_EQUAL(Name("emitter1"), handle.get(3));
+
+        CPPUNIT_ASSERT(handle.compact());
+        CPPUNIT_ASSERT(handle.isUniform());
+        CPPUNIT_ASSERT_EQUAL(Name("emitter1"), handle.get(0));
+
+        handle.expand();
+
+        CPPUNIT_ASSERT(!handle.isUniform());
+
+        handle.collapse("emitter2");
+
+        CPPUNIT_ASSERT(handle.isUniform());
+        CPPUNIT_ASSERT_EQUAL(Name("emitter2"), handle.get(2));
+
+        handle.collapse();
+
+        CPPUNIT_ASSERT_EQUAL(Name(""), handle.get(2));
+    }
+
+    { // a string handle requires a string attribute
+        TypedAttributeArray<Index> indexAttr(4);
+
+        CPPUNIT_ASSERT_THROW(StringAttributeHandle(indexAttr, metadata), TypeError);
+        CPPUNIT_ASSERT_THROW(StringAttributeWriteHandle(indexAttr, metadata), TypeError);
+    }
+}
+
+
+void
+TestAttributeString::testRemapStrings()
+{
+    using namespace openvdb;
+    using namespace openvdb::tools;
+
+    MetaMap metadataA, metadataB;
+
+    StringMetaInserter inserterA(metadataA);
+    inserterA.insert("metal");
+    inserterA.insert("wood");
+
+    StringMetaInserter inserterB(metadataB);
+    inserterB.insert("glass");
+    inserterB.insert("wood");
+
+    { // merge the string table of B into A
+        std::vector<Index> indices;
+        inserterA.insert(metadataB, indices);
+
+        CPPUNIT_ASSERT_EQUAL(size_t(3), indices.size());
+        CPPUNIT_ASSERT_EQUAL(Index(0), indices[0]);
+        CPPUNIT_ASSERT_EQUAL(Index(3), indices[1]);
+        CPPUNIT_ASSERT_EQUAL(Index(2), indices[2]);
+        CPPUNIT_ASSERT_EQUAL(size_t(3), metadataA.metaCount());
+        CPPUNIT_ASSERT(!isIdentityRemap(indices));
+
+        // strings of A are already in A
+
+        inserterA.insert(metadataA, indices);
+
+        CPPUNIT_ASSERT(isIdentityRemap(indices));
+
+        inserterA.insert(metadataB, indices);
+
+        // remap a string attribute of B onto the string table of A
+
+        StringAttributeArray attr(4);
+
+        {
+            StringAttributeWriteHandle handle(attr, metadataB);
+            handle.set(0, "glass");
+            handle.set(1, "wood");
+        }
+
+        remapStrings(attr, indices);
+
+        StringAttributeHandle handle(attr, metadataA);
+
+        CPPUNIT_ASSERT_EQUAL(Name("glass"), handle.get(0));
+        CPPUNIT_ASSERT_EQUAL(Name("wood"), handle.get(1));
+        CPPUNIT_ASSERT_EQUAL(Name(""), handle.get(2));
+
+        // uniform arrays remain uniform
+
+        StringAttributeArray uniformAttr(4);
+        StringAttributeWriteHandle(uniformAttr, metadataB).collapse("wood");
+
+        remapStrings(uniformAttr, indices);
+
+        CPPUNIT_ASSERT(uniformAttr.isUniform());
+        CPPUNIT_ASSERT_EQUAL(Name("wood"), StringAttributeHandle(uniformAttr, metadataA).get(3));
+
+        // compressed arrays remain compressed
+
+        StringAttributeArray compressedAttr(100);
+
+        for (Index i = 0; i < 100; i++)    compressedAttr.set(i, i % 3);
+
+        const bool compressed = compressedAttr.compress();
+
+        remapStrings(compressedAttr, indices);
+
+        CPPUNIT_ASSERT_EQUAL(compressed, compressedAttr.isCompressed());
+        CPPUNIT_ASSERT_EQUAL(Index(3), compressedAttr.get(1));
+        CPPUNIT_ASSERT_EQUAL(Index(2), compressedAttr.get(2));
+
+        // remap a range, a uniform array is expanded when the range does not cover it
+
+        StringAttributeArray rangeAttr(4);
+        StringAttributeWriteHandle(rangeAttr, metadataB).collapse("glass");
+
+        remapStrings(rangeAttr, indices, 1, 2);
+
+        CPPUNIT_ASSERT(!rangeAttr.isUniform());
+        CPPUNIT_ASSERT_EQUAL(Name("glass"), StringAttributeHandle(rangeAttr, metadataA).get(1));
+        CPPUNIT_ASSERT_EQUAL(Name("glass"), StringAttributeHandle(rangeAttr, metadataA).get(2));
+        CPPUNIT_ASSERT_EQUAL(Name("glass"), StringAttributeHandle(rangeAttr, metadataB).get(0));
+        CPPUNIT_ASSERT_EQUAL(Name("glass"), StringAttributeHandle(rangeAttr, metadataB).get(3));
+
+        CPPUNIT_ASSERT_THROW(remapStrings(rangeAttr, indices, 3, 2), IndexError);
+    }
+
+    { // invalid arrays and indices
+        std::vector<Index> indices(2, Index(0));
+
+        StringAttributeArray attr(4);
+        attr.set(0, Index(2));
+
+        CPPUNIT_ASSERT_THROW(remapStrings(attr, indices), LookupError);
+
+        TypedAttributeArray<Index> indexAttr(4);
+
+        CPPUNIT_ASSERT_THROW(remapStrings(indexAttr, indices), TypeError);
+    }
+}
+
+
+// Copyright (c) 2015-2016 Double Negative Visual Effects
+// All rights reserved. This software is distributed under the
+// Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
@@ -0,0 +1,535 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2015-2016 Double Negative Visual Effects
+//
+// All rights reserved. This software is distributed under the
+// Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
+//
+// Redistributions of source code must retain the above copyright
+// and license notice and the following restrictions and disclaimer.
+//
+// *     Neither the name of Double Negative Visual Effects nor the names
+// of its contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// IN NO EVENT SHALL THE COPYRIGHT HOLDERS' AND CONTRIBUTORS' AGGREGATE
+// LIABILITY FOR ALL CLAIMS REGARDLESS OF THEIR BASIS EXCEED US$250.00.
+//
+///////////////////////////////////////////////////////////////////////////
+
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <openvdb_points/tools/AttributeArray.h>
+#include <openvdb_points/tools/AttributeSet.h>
+#include <openvdb_points/tools/AttributeVariable.h>
+
+#include <openvdb_points/openvdb.h>
+#include <openvdb/openvdb.h>
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+using namespace openvdb;
+using namespace openvdb::tools;
+
+class TestAttributeVariable: public CppUnit::TestCase
+{
+public:
+    virtual void setUp() { openvdb::initialize(); openvdb::points::initialize(); }
+    virtual void tearDown() { openvdb::uninitialize(); openvdb::points::uninitialize(); }
+
+    CPPUNIT_TEST_SUITE(TestAttributeVariable);
+    CPPUNIT_TEST(testAttributeVariable);
+    CPPUNIT_TEST(testAttributeVariableResize);
+    CPPUNIT_TEST(testAttributeVariableCopy);
+    CPPUNIT_TEST(testAttributeVariableIO);
+
+    CPPUNIT_TEST_SUITE_END();
+
+    void testAttributeVariable();
+    void testAttributeVariableResize();
+    void testAttributeVariableCopy();
+    void testAttributeVariableIO();
+}; // class TestAttributeVariable
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TestAttributeVariable);
+
+
+////////////////////////////////////////
+
+
+void
+TestAttributeVariable::testAttributeVariable()
+{
+    using namespace openvdb;
+    using namespace openvdb::tools;
+
+    typedef VariableAttributeArray<float> AttributeVariableF;
+    typedef VariableAttributeArray<math::Vec3<float> > AttributeVariableVec3s;
+
+    { // type names and registration
+        CPPUNIT_ASSERT_EQUAL(Name("float[]"), AttributeVariableF::attributeType().first);
+        CPPUNIT_ASSERT_EQUAL(Name("null_float"), AttributeVariableF::attributeType().second);
+        CPPUNIT_ASSERT_EQUAL(Name("vec3s[]"), AttributeVariableVec3s::attributeType().first);
+
+        CPPUNIT_ASSERT(AttributeVariableF::isRegistered());
+        CPPUNIT_ASSERT(AttributeVariableVec3s::isRegistered());
+
+        AttributeArray::Ptr array = AttributeArray::create(AttributeVariableF::attributeType(), 10);
+
+        CPPUNIT_ASSERT(array->isType<AttributeVariableF>());
+        CPPUNIT_ASSERT_EQUAL(size_t(10), array->size());
+    }
+
+    { // empty lists
+        AttributeVariableF attr(5);
+
+        CPPUNIT_ASSERT_EQUAL(size_t(5), attr.size());
+        CPPUNIT_ASSERT(attr.isUniform());
+        CPPUNIT_ASSERT_EQUAL(Index(0), attr.totalLength());
+
+        for (Index n = 0; n < 5; n++) {
+            CPPUNIT_ASSERT_EQUAL(Index(0), attr.length(n));
+        }
+
+        CPPUNIT_ASSERT_THROW(attr.length(5), IndexError);
+        CPPUNIT_ASSERT_THROW(attr.get(0, 0), IndexError);
+        CPPUNIT_ASSERT_THROW(attr.set(0, 0, 1.0f), IndexError);
+    }
+
+    { // get and set lists
+        AttributeVariableF attr(4);
+
+        std::vector<float> values;
+        values.push_back(1.0f);
+        values.push_back(2.0f);
+        values.push_back(3.0f);
+
+        attr.set(1, values);
+
+        values.resize(1);
+        values[0] = 5.0f;
+
+        attr.set(3, values);
+
+        CPPUNIT_ASSERT(!attr.isUniform());
+        CPPUNIT_ASSERT_EQUAL(Index(4), attr.totalLength());
+
+        CPPUNIT_ASSERT_EQUAL(Index(0), attr.length(0));
+        CPPUNIT_ASSERT_EQUAL(Index(3), attr.length(1));
+        CPPUNIT_ASSERT_EQUAL(Index(0), attr.length(2));
+        CPPUNIT_ASSERT_EQUAL(Index(1), attr.length(3));
+
+        CPPUNIT_ASSERT_EQUAL(Index(0), attr.offset(1));
+        CPPUNIT_ASSERT_EQUAL(Index(3), attr.offset(2));
+        CPPUNIT_ASSERT_EQUAL(Index(3), attr.offset(3));
+
+        CPPUNIT_ASSERT_EQUAL(1.0f, attr.get(1, 0));
+        CPPUNIT_ASSERT_EQUAL(2.0f, attr.get(1, 1));
+        CPPUNIT_ASSERT_EQUAL(3.0f, attr.get(1, 2));
+        CPPUNIT_ASSERT_EQUAL(5.0f, attr.get(3, 0));
+
+        CPPUNIT_ASSERT_THROW(attr.get(1, 3), IndexError);
+
+        attr.set(1, 1, 7.0f);
+
+        attr.get(1, values);
+
+        CPPUNIT_ASSERT_EQUAL(size_t(3), values.size());
+        CPPUNIT_ASSERT_EQUAL(1.0f, values[0]);
+        CPPUNIT_ASSERT_EQUAL(7.0f, values[1]);
+        CPPUNIT_ASSERT_EQUAL(3.0f, values[2]);
+
+        // set a list from another array
+
+        AttributeVariableF attrB(2);
+        attrB.set(0, attr, 1);
+
+        CPPUNIT_ASSERT_EQUAL(Index(3), attrB.length(0));
+        CPPUNIT_ASSERT_EQUAL(7.0f, attrB.get(0, 1));
+        CPPUNIT_ASSERT_EQUAL(Index(0), attrB.length(1));
+
+        // deep copy
+
+        AttributeArray::Ptr attrC = attr.copy();
+
+        CPPUNIT_ASSERT(*attrC == attr);
+
+        attr.set(3, 0, 6.0f);
+
+        CPPUNIT_ASSERT(*attrC != attr);
+        CPPUNIT_ASSERT_EQUAL(5.0f, AttributeVariableF::cast(*attrC).get(3, 0));
+
+        // collapse to empty lists
+
+        attr.collapse();
+
+        CPPUNIT_ASSERT(attr.isUniform());
+        CPPUNIT_ASSERT_EQUAL(size_t(4), attr.size());
+        CPPUNIT_ASSERT_EQUAL(Index(0), attr.totalLength());
+    }
+
+    { // bulk construction
+        AttributeVariableVec3s attr(3);
+
+        std::vector<Index> lengths;
+        lengths.push_back(2);
+        lengths.push_back(0);
+        lengths.push_back(1);
+
+        attr.setLengths(lengths);
+
+        CPPUNIT_ASSERT_EQUAL(Index(3), attr.totalLength());
+        CPPUNIT_ASSERT_EQUAL(Index(2), attr.length(0));
+        CPPUNIT_ASSERT_EQUAL(Index(1), attr.length(2));
+        CPPUNIT_ASSERT_EQUAL(math::Vec3<float>(0), attr.get(0, 1));
+
+        attr.set(2, 0, math::Vec3<float>(1, 2, 3));
+
+        CPPUNIT_ASSERT_EQUAL(math::Vec3<float>(1, 2, 3), attr.values().get(attr.offset(2)));
+
+        lengths.push_back(1);
+
+        CPPUNIT_ASSERT_THROW(attr.setLengths(lengths), ValueError);
+    }
+
+    { // a variable-length array cannot be bound to a handle
+        AttributeVariableF attr(4);
+
+        CPPUNIT_ASSERT_THROW(AttributeHandle<float>::create(attr), TypeError);
+    }
+
+    { // casting
+        TypedAttributeArray<float> floatAttr(4);
+        AttributeVariableF variableAttr(4);
+
+        CPPUNIT_ASSERT_THROW(AttributeVariableF::cast(floatAttr), TypeError);
+        CPPUNIT_ASSERT_NO_THROW(AttributeVariableF::cast(variableAttr));
+        CPPUNIT_ASSERT_THROW(TypedAttributeArray<float>::cast(variableAttr), TypeError);
+    }
+}
+
+
+void
+TestAttributeVariable::testAttributeVariableResize()
+{
+    using namespace openvdb;
+    using namespace openvdb::tools;
+
+    typedef VariableAttributeArray<int32_t> AttributeVariableI;
+
+    { // appending in element order grows the value buffer geometrically
+        const Index count = 100;
+        AttributeVariableI attr(count);
+
+        std::vector<int32_t> values;
+
+        for (Index n = 0; n < count; n++) {
+            values.resize(n % 4);
+            for (size_t i = 0; i < values.size(); i++)  values[i] = int32_t(n * 10 + i);
+            attr.set(n, values);
+        }
+
+        CPPUNIT_ASSERT_EQUAL(Index(150), attr.totalLength());
+        CPPUNIT_ASSERT(attr.values().size() >= size_t(150));
+        CPPUNIT_ASSERT(attr.values().size() < size_t(300));
+
+        for (Index n = 0; n < count; n++) {
+            CPPUNIT_ASSERT_EQUAL(n % 4, attr.length(n));
+            for (Index i = 0; i < attr.length(n); i++) {
+                CPPUNIT_ASSERT_EQUAL(int32_t(n * 10 + i), attr.get(n, i));
+            }
+        }
+
+        // compacting releases the unused capacity
+
+        CPPUNIT_ASSERT(!attr.compact());
+        CPPUNIT_ASSERT_EQUAL(size_t(150), attr.values().size());
+        CPPUNIT_ASSERT_EQUAL(int32_t(992), attr.get(99, 2));
+    }
+
+    { // resizing a list in the middle of the array moves the following values
+        AttributeVariableI attr(3);
+
+        std::vector<int32_t> values(2);
+        values[0] = 1; values[1] = 2;
+        attr.set(0, values);
+        values[0] = 3; values[1] = 4;
+        attr.set(1, values);
+        values[0] = 5; values[1] = 6;
+        attr.set(2, values);
+
+        attr.resize(1, 4);
+
+        CPPUNIT_ASSERT_EQUAL(Index(8), attr.totalLength());
+        CPPUNIT_ASSERT_EQUAL(Index(2), attr.offset(1));
+        CPPUNIT_ASSERT_EQUAL(Index(6), attr.offset(2));
+        CPPUNIT_ASSERT_EQUAL(int32_t(2), attr.get(0, 1));
+        CPPUNIT_ASSERT_EQUAL(int32_t(3), attr.get(1, 0));
+        CPPUNIT_ASSERT_EQUAL(int32_t(4), attr.get(1, 1));
+        CPPUNIT_ASSERT_EQUAL(int32_t(0), attr.get(1, 2));
+        CPPUNIT_ASSERT_EQUAL(int32_t(0), attr.get(1, 3));
+        CPPUNIT_ASSERT_EQUAL(int32_t(5), attr.get(2, 0));
+        CPPUNIT_ASSERT_EQUAL(int32_t(6), attr.get(2, 1));
+
+        attr.resize(0, 0);
+
+        CPPUNIT_ASSERT_EQUAL(Index(6), attr.totalLength());
+        CPPUNIT_ASSERT_EQUAL(Index(0), attr.length(0));
+        CPPUNIT_ASSERT_EQUAL(int32_t(3), attr.get(1, 0));
+        CPPUNIT_ASSERT_EQUAL(int32_t(6), attr.get(2, 1));
+
+        // shrinking the last list retains the capacity
+
+        attr.resize(2, 1);
+
+        CPPUNIT_ASSERT_EQUAL(Index(5), attr.totalLength());
+        CPPUNIT_ASSERT_EQUAL(int32_t(5), attr.get(2, 0));
+
+        attr.resize(1, 0);
+        attr.resize(2, 0);
+
+        CPPUNIT_ASSERT_EQUAL(Index(0), attr.totalLength());
+
+        // compacting empty lists collapses the array
+
+        CPPUNIT_ASSERT(attr.compact());
+        CPPUNIT_ASSERT(attr.isUniform());
+    }
+}
+
+
+void
+TestAttributeVariable::testAttributeVariableCopy()
+{
+    using namespace openvdb;
+    using namespace openvdb::tools;
+
+    typedef VariableAttributeArray<int32_t> AttributeVariableI;
+
+    const Index count = 1000;
+
+    AttributeVariableI source(count);
+
+    std::vector<int32_t> values;
+
+    for (Index n = 0; n < count; n++) {
+        values.resize(n % 4);
+        for (size_t i = 0; i < values.size(); i++)  values[i] = int32_t(n * 10 + i);
+        source.set(n, values);
+    }
+
+    { // copy one element at a time in element order
+        AttributeVariableI attr(count);
+
+        for (Index n = 0; n < count; n++) {
+            attr.set(n, source, n);
+        }
+
+        CPPUNIT_ASSERT(attr == source);
+        CPPUNIT_ASSERT_EQUAL(Index(1500), attr.totalLength());
+
+        for (Index n = 0; n < count; n++) {
+            CPPUNIT_ASSERT_EQUAL(source.offsets().get(n), attr.offsets().get(n));
+        }
+    }
+
+    { // the end offsets of trailing empty lists are deferred while appending
+        AttributeVariableI attr(10);
+
+        attr.set(2, source, 3);
+
+        std::ostringstream ostr(std::ios_base::binary);
+        attr.write(ostr);
+
+        AttributeVariableI attrB;
+
+        std::istringstream istr(ostr.str(), std::ios_base::binary);
+        attrB.read(istr);
+
+        CPPUNIT_ASSERT(attrB == attr);
+        CPPUNIT_ASSERT_EQUAL(Index(0), attrB.length(9));
+        CPPUNIT_ASSERT_EQUAL(Index32(3), attrB.offsets().get(9));
+        CPPUNIT_ASSERT_EQUAL(Index32(3), attr.offsets().get(9));
+    }
+
+    { // copy runs of elements
+        AttributeVariableI attr(count + 5);
+
+        attr.copyValuesUnsafe(0, source, 0, 1);
+        attr.copyValuesUnsafe(1, source, 1, 400);
+        attr.copyValuesUnsafe(401, source, 401, 599);
+
+        CPPUNIT_ASSERT_EQUAL(Index(1500), attr.totalLength());
+
+        for (Index n = 0; n < count; n++) {
+            CPPUNIT_ASSERT_EQUAL(n % 4, attr.length(n));
+            for (Index i = 0; i < attr.length(n); i++) {
+                CPPUNIT_ASSERT_EQUAL(int32_t(n * 10 + i), attr.get(n, i));
+            }
+        }
+        for (Index n = count; n < count + 5; n++) {
+            CPPUNIT_ASSERT_EQUAL(Index(0), attr.length(n));
+        }
+    }
+
+    { // copy a run into the middle of the array moves the following values
+        AttributeVariableI attr(10);
+
+        for (Index n = 0; n < 10; n++) {
+            attr.set(n, source, 3);
+        }
+
+        attr.copyValuesUnsafe(2, source, 4, 3);
+
+        CPPUNIT_ASSERT_EQUAL(Index(24), attr.totalLength());
+        CPPUNIT_ASSERT_EQUAL(Index(3), attr.length(1));
+        CPPUNIT_ASSERT_EQUAL(Index(0), attr.length(2));
+        CPPUNIT_ASSERT_EQUAL(Index(1), attr.length(3));
+        CPPUNIT_ASSERT_EQUAL(Index(2), attr.length(4));
+        CPPUNIT_ASSERT_EQUAL(int32_t(50), attr.get(3, 0));
+        CPPUNIT_ASSERT_EQUAL(int32_t(61), attr.get(4, 1));
+        CPPUNIT_ASSERT_EQUAL(int32_t(32), attr.get(5, 2));
+
+        // a uniform source provides empty lists
+
+        AttributeVariableI empty(20);
+        attr.copyValuesUnsafe(0, empty, 0, 10);
+
+        CPPUNIT_ASSERT_EQUAL(Index(0), attr.totalLength());
+
+        // copying from a different type is not supported
+
+        CPPUNIT_ASSERT_THROW(attr.copyValuesUnsafe(0, VariableAttributeArray<float>(10), 0, 1),
+            openvdb::TypeError);
+        CPPUNIT_ASSERT_THROW(attr.set(0, VariableAttributeArray<float>(10), 0), openvdb::TypeError);
+    }
+}
+
+
+void
+TestAttributeVariable::testAttributeVariableIO()
+{
+    using namespace openvdb;
+    using namespace openvdb::tools;
+
+    typedef VariableAttributeArray<float> AttributeVariableF;
+
+    const Index count = 50;
+
+    AttributeVariableF attrA(count);
+
+    std::vector<float> values;
+
+    for (Index n = 0; n < count; n++) {
+        values.resize(n % 3);
+        for (size_t i = 0; i < values.size(); i++)  values[i] = float(n) + float(i) * 0.5f;
+        attrA.set(n, values);
+    }
+
+    attrA.setHidden(true);
+
+    { // write and read, unused value buffer capacity is not written
+        CPPUNIT_ASSERT(attrA.values().size() > size_t(attrA.totalLength()));
+
+        std::ostringstream ostr(std::ios_base::binary);
+        attrA.write(ostr);
+
+        AttributeVariableF attrB;
+
+        std::istringstream istr(ostr.str(), std::ios_base::binary);
+        attrB.read(istr);
+
+        CPPUNIT_ASSERT_EQUAL(attrA.size(), attrB.size());
+        CPPUNIT_ASSERT_EQUAL(attrA.isHidden(), attrB.isHidden());
+        CPPUNIT_ASSERT_EQUAL(size_t(attrA.totalLength()), attrB.values().size());
+        CPPUNIT_ASSERT(attrA == attrB);
+
+        for (Index n = 0; n < count; n++) {
+            CPPUNIT_ASSERT_EQUAL(attrA.length(n), attrB.length(n));
+            for (Index i = 0; i < attrA.length(n); i++) {
+                CPPUNIT_ASSERT_EQUAL(attrA.get(n, i), attrB.get(n, i));
+            }
+        }
+    }
+
+    { // compression
+        AttributeVariableF attrB(attrA);
+
+        attrB.compress();
+
+#ifdef OPENVDB_USE_BLOSC
+        CPPUNIT_ASSERT(attrB.isCompressed());
+#endif
+
+        CPPUNIT_ASSERT_EQUAL(Index(2), attrB.length(count - 1));
+        CPPUNIT_ASSERT_EQUAL(float(count - 1) + 0.5f, attrB.get(count - 1, 1));
+        CPPUNIT_ASSERT(!attrB.isCompressed());
+
+        attrB.compress();
+
+        std::ostringstream ostr(std::ios_base::binary);
+        attrB.write(ostr);
+
+        AttributeVariableF attrC;
+
+        std::istringstream istr(ostr.str(), std::ios_base::binary);
+        attrC.read(istr);
+
+        attrC.decompress();
+
+        CPPUNIT_ASSERT_EQUAL(attrA.totalLength(), attrC.totalLength());
+        CPPUNIT_ASSERT_EQUAL(float(count - 1) + 0.5f, attrC.get(count - 1, 1));
+    }
+
+    { // attribute set
+        typedef AttributeSet::Descriptor Descriptor;
+
+        Descriptor::Ptr descr = Descriptor::create(Descriptor::Inserter()
+            .add("P", TypedAttributeArray<math::Vec3<float> >::attributeType()).vec);
+
+        AttributeSet attrSetA(descr, count);
+
+        attrSetA.appendAttribute(AttributeSet::Util::NameAndType(
+            "samples", AttributeVariableF::attributeType()));
+
+        AttributeVariableF& samples = AttributeVariableF::cast(*attrSetA.get("samples"));
+
+        CPPUNIT_ASSERT_EQUAL(size_t(count), samples.size());
+
+        values.resize(2);
+        values[0] = 1.0f; values[1] = 2.0f;
+        samples.set(10, values);
+
+        std::ostringstream ostr(std::ios_base::binary);
+        attrSetA.write(ostr);
+
+        AttributeSet attrSetB;
+
+        std::istringstream istr(ostr.str(), std::ios_base::binary);
+        attrSetB.read(istr);
+
+        const AttributeVariableF& samplesB = AttributeVariableF::cast(*attrSetB.getConst("samples"));
+
+        CPPUNIT_ASSERT_EQUAL(size_t(count), samplesB.size());
+        CPPUNIT_ASSERT_EQUAL(Index(2), samplesB.length(10));
+        CPPUNIT_ASSERT_EQUAL(2.0f, samplesB.get(10, 1));
+    }
+}
+
+
+// Copyright (c) 2015-2016 Double Negative Visual Effects
+// All rights reserved. This software is distributed under the
+// Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
@@ -407,6 +407,83 @@ TestIndexFilter::testRandomLeafFilter()
 
             CPPUNIT_ASSERT(it == values.end());
         }
+
+        { // leaf index lookup
+            data.leafArray.push_back(std::make_pair(Coord(0, 0, 0), std::pair<Index, Index>(0, 10)));
+            data.leafArray.push_back(std::make_pair(Coord(0, 8, 0), std::pair<Index, Index>(2, 50)));
+
+            CPPUNIT_ASSERT(data.seedCount(1, Coord(0, 8, 0)));
+            CPPUNIT_ASSERT(!data.seedCount(1, Coord(0, 0, 0)));
+            CPPUNIT_ASSERT(!data.seedCount(2, Coord(0, 8, 0)));
+
+            RandFilter filter = RandFilter::create(OriginLeaf(Coord(0, 8, 0), 100), data, 1);
+            RandFilter filter2 = RandFilter::create(OriginLeaf(Coord(0, 8, 0), 100), data);
+
+            int count = 0;
+            for (SimpleIter iter; *iter < 100; ++iter) {
+                CPPUNIT_ASSERT_EQUAL(filter.valid(iter), filter2.valid(iter));
+                if (filter.valid(iter))     count++;
+            }
+            CPPUNIT_ASSERT_EQUAL(count, 50);
+
+            // mismatched index falls back to the origin lookup
+
+            RandFilter filter3 = RandFilter::create(OriginLeaf(Coord(0, 0, 8), 100), data, 0);
+
+            count = 0;
+            for (SimpleIter iter; *iter < 100; ++iter) {
+                if (filter3.valid(iter))    count++;
+            }
+            CPPUNIT_ASSERT_EQUAL(count, 1);
+        }
+    }
+
+    { // populate from tree
+        typedef TypedAttributeArray<Vec3s>   AttributeVec3s;
+        typedef RandomLeafFilter<boost::mt11213b> RandFilter;
+
+        AttributeVec3s::registerType();
+
+        std::vector<Vec3s> positions;
+        for (int i = 0; i < 10; i++)    positions.push_back(Vec3s(1, 1, 1));
+        for (int i = 0; i < 30; i++)    positions.push_back(Vec3s(11, 11, 11));
+        for (int i = 0; i < 60; i++)    positions.push_back(Vec3s(21, 21, 21));
+
+        math::Transform::Ptr transform(math::Transform::createLinearTransform(1.0));
+
+        PointDataGrid::Ptr grid = createPointDataGrid<PointDataGrid>(positions, AttributeVec3s::attributeType(), *transform);
+        PointDataTree& tree = grid->tree();
+
+        CPPUNIT_ASSERT_EQUAL(tree.leafCount(), Index32(3));
+
+        RandFilter::Data data;
+        data.populateByTargetPoints(tree, 33);
+
+        CPPUNIT_ASSERT_EQUAL(data.leafArray.size(), size_t(3));
+        CPPUNIT_ASSERT_EQUAL(data.leafMap.size(), size_t(3));
+
+        Index total = 0;
+        Index leafIndex = 0;
+        for (PointDataTree::LeafCIter leafIter = tree.cbeginLeaf(); leafIter; ++leafIter, ++leafIndex) {
+            CPPUNIT_ASSERT_EQUAL(data.leafArray[leafIndex].first, leafIter->origin());
+            CPPUNIT_ASSERT(data.leafMap[leafIter->origin()] == data.leafArray[leafIndex].second);
+            total += data.leafArray[leafIndex].second.second;
+        }
+        CPPUNIT_ASSERT_EQUAL(total, Index(33));
+
+        // allocation proportional to the leaf point counts
+
+        CPPUNIT_ASSERT_EQUAL(data.leafArray[0].second.second, Index(3));
+        CPPUNIT_ASSERT_EQUAL(data.leafArray[1].second.second, Index(10));
+        CPPUNIT_ASSERT_EQUAL(data.leafArray[2].second.second, Index(20));
+
+        data.populateByPercentagePoints(tree, 50.0f);
+
+        total = 0;
+        for (size_t n = 0; n < data.leafArray.size(); n++) {
+            total += data.leafArray[n].second.second;
+        }
+        CPPUNIT_ASSERT_EQUAL(total, Index(50));
     }
 }
 
@@ -0,0 +1,190 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2015-2016 Double Negative Visual Effects
+//
+// All rights reserved. This software is distributed under the
+// Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
+//
+// Redistributions of source code must retain the above copyright
+// and license notice and the following restrictions and disclaimer.
+//
+// *     Neither the name of Double Negative Visual Effects nor the names
+// of its contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// IN NO EVENT SHALL THE COPYRIGHT HOLDERS' AND CONTRIBUTORS' AGGREGATE
+// LIABILITY FOR ALL CLAIMS REGARDLESS OF THEIR BASIS EXCEED US$250.00.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <openvdb_points/openvdb.h>
+#include <openvdb_points/tools/AttributeArray.h>
+#include <openvdb_points/tools/Instrumentation.h>
+#include <openvdb/Types.h>
+
+#include <sstream>
+
+class TestInstrumentation: public CppUnit::TestCase
+{
+public:
+    virtual void setUp() { openvdb::initialize(); openvdb::points::initialize(); }
+    virtual void tearDown() { openvdb::uninitialize(); openvdb::points::uninitialize(); }
+
+    CPPUNIT_TEST_SUITE(TestInstrumentation);
+    CPPUNIT_TEST(testCounters);
+    CPPUNIT_TEST(testTimers);
+
+    CPPUNIT_TEST_SUITE_END();
+
+    void testCounters();
+    void testTimers();
+}; // class TestInstrumentation
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TestInstrumentation);
+
+
+////////////////////////////////////////
+
+
+void
+TestInstrumentation::testCounters()
+{
+    using namespace openvdb;
+    using namespace openvdb::tools;
+
+    const bool wasEnabled = instrumentation::isEnabled();
+
+    { // disabled
+        instrumentation::setEnabled(false);
+        instrumentation::reset();
+
+        CPPUNIT_ASSERT(!instrumentation::isEnabled());
+
+        TypedAttributeArray<float> attr(50);
+        attr.expand();
+        attr.collapse(1.0f);
+        AttributeArray::isRegistered(TypedAttributeArray<float>::attributeType());
+
+        for (int i = 0; i < instrumentation::NUM_COUNTERS; i++) {
+            CPPUNIT_ASSERT_EQUAL(instrumentation::count(instrumentation::Counter(i)), Index64(0));
+        }
+    }
+
+    { // enabled
+        instrumentation::setEnabled(true);
+        instrumentation::reset();
+
+        CPPUNIT_ASSERT(instrumentation::isEnabled());
+
+        TypedAttributeArray<int> attr(1000);
+        attr.expand();
+        for (int i = 0; i < 1000; i++)  attr.set(i, i / 10);
+
+        CPPUNIT_ASSERT_EQUAL(instrumentation::count(instrumentation::EXPAND_CALLS), Index64(1));
+
+        AttributeArray::isRegistered(TypedAttributeArray<int>::attributeType());
+        AttributeArray::Ptr created = AttributeArray::create(TypedAttributeArray<int>::attributeType(), 10);
+
+        CPPUNIT_ASSERT_EQUAL(instrumentation::count(instrumentation::REGISTRY_LOOKUPS), Index64(2));
+
+#ifdef OPENVDB_USE_BLOSC
+        CPPUNIT_ASSERT(attr.compress());
+        CPPUNIT_ASSERT_EQUAL(instrumentation::count(instrumentation::BYTES_COMPRESSED),
+            Index64(1000 * sizeof(int)));
+
+        CPPUNIT_ASSERT(attr.decompress());
+        CPPUNIT_ASSERT_EQUAL(instrumentation::count(instrumentation::BYTES_DECOMPRESSED),
+            Index64(1000 * sizeof(int)));
+#endif
+
+        attr.collapse(5);
+
+        CPPUNIT_ASSERT_EQUAL(instrumentation::count(instrumentation::COLLAPSE_CALLS), Index64(1));
+
+        instrumentation::reset();
+
+        for (int i = 0; i < instrumentation::NUM_COUNTERS; i++) {
+            CPPUNIT_ASSERT_EQUAL(instrumentation::count(instrumentation::Counter(i)), Index64(0));
+        }
+    }
+
+    instrumentation::setEnabled(wasEnabled);
+}
+
+
+void
+TestInstrumentation::testTimers()
+{
+    using namespace openvdb;
+    using namespace openvdb::tools;
+
+    const bool wasEnabled = instrumentation::isEnabled();
+
+    instrumentation::setEnabled(true);
+    instrumentation::reset();
+
+    TypedAttributeArray<float> attr(100);
+    attr.expand();
+
+    std::ostringstream ostr(std::ios_base::binary);
+    attr.write(ostr);
+
+    CPPUNIT_ASSERT_EQUAL(instrumentation::calls(instrumentation::WRITE_TIMER), Index64(1));
+    CPPUNIT_ASSERT_EQUAL(instrumentation::calls(instrumentation::READ_TIMER), Index64(0));
+
+    TypedAttributeArray<float> attrB;
+
+    std::istringstream istr(ostr.str(), std::ios_base::binary);
+    attrB.read(istr);
+
+    CPPUNIT_ASSERT_EQUAL(instrumentation::calls(instrumentation::READ_TIMER), Index64(1));
+    CPPUNIT_ASSERT(instrumentation::seconds(instrumentation::READ_TIMER) >= 0.0);
+
+    { // scoped timer is inactive while disabled
+        instrumentation::setEnabled(false);
+        instrumentation::ScopedTimer timer(instrumentation::COMPRESS_TIMER);
+        instrumentation::setEnabled(true);
+    }
+
+    CPPUNIT_ASSERT_EQUAL(instrumentation::calls(instrumentation::COMPRESS_TIMER), Index64(0));
+
+    { // scoped timer is active while enabled
+        instrumentation::ScopedTimer timer(instrumentation::COMPRESS_TIMER);
+    }
+
+    CPPUNIT_ASSERT_EQUAL(instrumentation::calls(instrumentation::COMPRESS_TIMER), Index64(1));
+
+    // print
+
+    std::ostringstream printStr;
+    instrumentation::print(printStr);
+
+    CPPUNIT_ASSERT(printStr.str().find("expand calls") != std::string::npos);
+    CPPUNIT_ASSERT(printStr.str().find("decompress") != std::string::npos);
+
+    CPPUNIT_ASSERT_EQUAL(std::string(instrumentation::name(instrumentation::BYTES_LOADED)),
+        std::string("bytes loaded"));
+    CPPUNIT_ASSERT_EQUAL(std::string(instrumentation::name(instrumentation::WRITE_TIMER)),
+        std::string("write"));
+
+    instrumentation::reset();
+    instrumentation::setEnabled(wasEnabled);
+}
+
+
+// Copyright (c) 2015-2016 Double Negative Visual Effects
+// All rights reserved. This software is distributed under the
+// Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
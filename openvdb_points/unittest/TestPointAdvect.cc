@@ -0,0 +1,202 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2015-2016 Double Negative Visual Effects
+//
+// All rights reserved. This software is distributed under the
+// Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
+//
+// Redistributions of source code must retain the above copyright
+// and license notice and the following restrictions and disclaimer.
+//
+// *     Neither the name of Double Negative Visual Effects nor the names
+// of its contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// IN NO EVENT SHALL THE COPYRIGHT HOLDERS' AND CONTRIBUTORS' AGGREGATE
+// LIABILITY FOR ALL CLAIMS REGARDLESS OF THEIR BASIS EXCEED US$250.00.
+//
+///////////////////////////////////////////////////////////////////////////
+
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <openvdb_points/openvdb.h>
+#include <openvdb_points/tools/PointDataGrid.h>
+#include <openvdb_points/tools/PointConversion.h>
+#include <openvdb_points/tools/PointAttribute.h>
+#include <openvdb_points/tools/PointCount.h>
+#include <openvdb_points/tools/PointGroup.h>
+#include <openvdb_points/tools/PointAdvect.h>
+#include <openvdb_points/tools/AttributeArray.h>
+#include <openvdb/Types.h>
+#include <openvdb/math/Transform.h>
+
+#include <algorithm>
+
+class TestPointAdvect: public CppUnit::TestCase
+{
+public:
+    virtual void setUp() { openvdb::initialize(); openvdb::points::initialize(); }
+    virtual void tearDown() { openvdb::uninitialize(); openvdb::points::uninitialize(); }
+
+    CPPUNIT_TEST_SUITE(TestPointAdvect);
+    CPPUNIT_TEST(testAdvect);
+
+    CPPUNIT_TEST_SUITE_END();
+
+    void testAdvect();
+}; // class TestPointAdvect
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TestPointAdvect);
+
+
+////////////////////////////////////////
+
+
+namespace {
+
+    /// Set the id of each point to its rounded world-space x position
+    void setIds(openvdb::tools::PointDataTree& tree, const openvdb::math::Transform& transform)
+    {
+        using namespace openvdb;
+        using namespace openvdb::tools;
+
+        for (PointDataTree::LeafIter leafIter = tree.beginLeaf(); leafIter; ++leafIter) {
+            AttributeHandle<Vec3f> positionHandle(leafIter->constAttributeArray("P"));
+            AttributeWriteHandle<int> idHandle(leafIter->attributeArray("id"));
+            for (PointDataTree::LeafNodeType::IndexAllIter iter = leafIter->beginIndexAll(); iter; ++iter) {
+                const Vec3d xyz = iter.getCoord().asVec3d() + Vec3d(positionHandle.get(Index(*iter)));
+                idHandle.set(Index(*iter), int(math::Round(transform.indexToWorld(xyz).x())));
+            }
+        }
+    }
+
+    /// Check that every point has moved by the given offset from the position denoted by its id
+    bool checkPositions(const openvdb::tools::PointDataTree& tree, const openvdb::math::Transform& transform,
+                        const openvdb::Vec3d& offset, const std::vector<int>& groupIds)
+    {
+        using namespace openvdb;
+        using namespace openvdb::tools;
+
+        for (PointDataTree::LeafCIter leafIter = tree.cbeginLeaf(); leafIter; ++leafIter) {
+            AttributeHandle<Vec3f> positionHandle(leafIter->constAttributeArray("P"));
+            AttributeHandle<int> idHandle(leafIter->constAttributeArray("id"));
+            GroupHandle groupHandle = leafIter->groupHandle("test");
+            for (PointDataTree::LeafNodeType::IndexAllIter iter = leafIter->beginIndexAll(); iter; ++iter) {
+                const Vec3d xyz = iter.getCoord().asVec3d() + Vec3d(positionHandle.get(Index(*iter)));
+                const Vec3d world = transform.indexToWorld(xyz);
+                const int id = idHandle.get(Index(*iter));
+                if (!math::isApproxEqual(world.x(), double(id) + offset.x(), 1e-5))   return false;
+                if (!math::isApproxEqual(world.y(), 1.0 + offset.y(), 1e-5))          return false;
+                const bool inGroup = std::find(groupIds.begin(), groupIds.end(), id) != groupIds.end();
+                if (groupHandle.get(Index(*iter)) != inGroup)                           return false;
+            }
+        }
+
+        return true;
+    }
+
+} // namespace
+
+
+void
+TestPointAdvect::testAdvect()
+{
+    using namespace openvdb;
+    using namespace openvdb::tools;
+
+    typedef TypedAttributeArray<Vec3s>   AttributeVec3s;
+    typedef TypedAttributeArray<int>     AttributeI;
+
+    const float voxelSize(1.0);
+    math::Transform::Ptr transform(math::Transform::createLinearTransform(voxelSize));
+
+    std::vector<Vec3s> positions;
+    positions.push_back(Vec3s(1, 1, 1));
+    positions.push_back(Vec3s(2, 1, 1));
+    positions.push_back(Vec3s(3, 1, 1));
+    positions.push_back(Vec3s(4, 1, 1));
+    positions.push_back(Vec3s(5, 1, 1));
+
+    const PointAttributeVector<Vec3s> pointList(positions);
+
+    PointIndexGrid::Ptr pointIndexGrid =
+        openvdb::tools::createPointIndexGrid<PointIndexGrid>(pointList, *transform);
+
+    PointDataGrid::Ptr points = createPointDataGrid<PointDataGrid>(*pointIndexGrid, pointList,
+                                                                   AttributeVec3s::attributeType(), *transform);
+
+    appendAttribute(points->tree(), AttributeSet::Descriptor::NameAndType("id", AttributeI::attributeType()));
+
+    setIds(points->tree(), *transform);
+
+    // points with ids 1 and 3 are in the test group
+
+    appendGroup(points->tree(), "test");
+
+    std::vector<short> membership(positions.size(), short(0));
+    membership[0] = short(1);
+    membership[2] = short(1);
+
+    setGroup(points->tree(), pointIndexGrid->tree(), membership, "test");
+
+    std::vector<int> groupIds;
+    groupIds.push_back(1);
+    groupIds.push_back(3);
+
+    CPPUNIT_ASSERT_EQUAL(points->tree().leafCount(), Index32(1));
+
+    { // invalid integration order
+        Vec3SGrid::Ptr velocity = Vec3SGrid::create(Vec3s(0, 0, 0));
+
+        CPPUNIT_ASSERT_THROW(advectPoints(*points, *velocity, 1.0, 0), ValueError);
+        CPPUNIT_ASSERT_THROW(advectPoints(*points, *velocity, 1.0, 5), ValueError);
+    }
+
+    { // forward euler moving points across voxel and leaf boundaries
+        Vec3SGrid::Ptr velocity = Vec3SGrid::create(Vec3s(5, 0, 0));
+
+        advectPoints(*points, *velocity, /*dt=*/1.0);
+
+        CPPUNIT_ASSERT_EQUAL(pointCount(points->tree()), Index64(5));
+        CPPUNIT_ASSERT_EQUAL(groupPointCount(points->tree(), "test"), Index64(2));
+        CPPUNIT_ASSERT_EQUAL(points->tree().leafCount(), Index32(2));
+        CPPUNIT_ASSERT(checkPositions(points->tree(), *transform, Vec3d(5, 0, 0), groupIds));
+
+        // all leaves share the same descriptor
+
+        PointDataTree::LeafCIter leafIter = points->tree().cbeginLeaf();
+        const AttributeSet::Descriptor* descriptor = &leafIter->attributeSet().descriptor();
+        for (++leafIter; leafIter; ++leafIter) {
+            CPPUNIT_ASSERT_EQUAL(descriptor, &leafIter->attributeSet().descriptor());
+            leafIter->validateOffsets();
+        }
+    }
+
+    { // fourth-order runge-kutta back to the start with sub-voxel offsets
+        Vec3SGrid::Ptr velocity = Vec3SGrid::create(Vec3s(-2, 0.25f, 0));
+
+        advectPoints(*points, *velocity, /*dt=*/2.5, /*integrationOrder=*/4);
+
+        CPPUNIT_ASSERT_EQUAL(pointCount(points->tree()), Index64(5));
+        CPPUNIT_ASSERT_EQUAL(points->tree().leafCount(), Index32(1));
+        CPPUNIT_ASSERT(checkPositions(points->tree(), *transform, Vec3d(0, 0.625, 0), groupIds));
+        CPPUNIT_ASSERT_EQUAL(points->tree().activeVoxelCount(), Index64(5));
+    }
+}
+
+
+// Copyright (c) 2015-2016 Double Negative Visual Effects
+// All rights reserved. This software is distributed under the
+// Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
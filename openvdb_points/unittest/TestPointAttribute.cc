@@ -434,6 +434,26 @@ TestPointAttribute::testBloscCompress()
 
     CPPUNIT_ASSERT(leafIter->attributeArray("id").memUsage() < leafIter->attributeArray("id2").memUsage());
 #endif
+
+    CPPUNIT_ASSERT_THROW(pagedCompressAttribute(tree, "id2", /*pageSize=*/0), openvdb::ValueError);
+    CPPUNIT_ASSERT_THROW(pagedCompressAttribute(tree, "unknown"), openvdb::KeyError);
+
+    pagedCompressAttribute(tree, "id2", /*pageSize=*/32);
+
+#ifdef OPENVDB_USE_BLOSC
+    CPPUNIT_ASSERT(leafIter2->attributeArray("id2").isPaged());
+    CPPUNIT_ASSERT(!leafIter2->attributeArray("id").isPaged());
+
+    { // reading values leaves the arrays compressed
+        AttributeHandle<int> handleId2(leafIter2->attributeArray("id2"));
+
+        for (int i = 0; i < 102; i++) {
+            CPPUNIT_ASSERT_EQUAL(handleId2.get(i), i);
+        }
+    }
+
+    CPPUNIT_ASSERT(leafIter2->attributeArray("id2").isPaged());
+#endif
 }
 
 
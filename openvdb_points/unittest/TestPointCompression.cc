@@ -0,0 +1,268 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2015-2016 Double Negative Visual Effects
+//
+// All rights reserved. This software is distributed under the
+// Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
+//
+// Redistributions of source code must retain the above copyright
+// and license notice and the following restrictions and disclaimer.
+//
+// *     Neither the name of Double Negative Visual Effects nor the names
+// of its contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// IN NO EVENT SHALL THE COPYRIGHT HOLDERS' AND CONTRIBUTORS' AGGREGATE
+// LIABILITY FOR ALL CLAIMS REGARDLESS OF THEIR BASIS EXCEED US$250.00.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <openvdb_points/openvdb.h>
+#include <openvdb_points/tools/PointDataGrid.h>
+#include <openvdb_points/tools/PointAttribute.h>
+#include <openvdb_points/tools/PointConversion.h>
+#include <openvdb_points/tools/PointCompression.h>
+#include <openvdb_points/tools/AttributeArray.h>
+#include <openvdb/Types.h>
+#include <openvdb/math/Transform.h>
+
+class TestPointCompression: public CppUnit::TestCase
+{
+public:
+    virtual void setUp() { openvdb::initialize(); openvdb::points::initialize(); }
+    virtual void tearDown() { openvdb::uninitialize(); openvdb::points::uninitialize(); }
+
+    CPPUNIT_TEST_SUITE(TestPointCompression);
+    CPPUNIT_TEST(testChooseCodec);
+    CPPUNIT_TEST(testOptimize);
+
+    CPPUNIT_TEST_SUITE_END();
+
+    void testChooseCodec();
+    void testOptimize();
+}; // class TestPointCompression
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TestPointCompression);
+
+
+////////////////////////////////////////
+
+
+void
+TestPointCompression::testChooseCodec()
+{
+    using namespace openvdb;
+    using namespace openvdb::tools;
+
+    typedef TypedAttributeArray<float>                                              AttributeF;
+    typedef TypedAttributeArray<float, NullAttributeCodec<half> >                   AttributeFH;
+    typedef TypedAttributeArray<Vec3f>                                              AttributeVec3f;
+    typedef TypedAttributeArray<Vec3f, NullAttributeCodec<math::Vec3<half> > >      AttributeVec3h;
+    typedef TypedAttributeArray<Vec3f, FixedPointAttributeCodec<math::Vec3<uint8_t> > >   AttributeFP8;
+    typedef TypedAttributeArray<Vec3f, FixedPointAttributeCodec<math::Vec3<uint16_t> > >  AttributeFP16;
+    typedef TypedAttributeArray<Vec3f, UnitVecAttributeCodec>                       AttributeUVec;
+
+    math::Random01 randNumber(0);
+
+    { // float
+        std::vector<float> values;
+        for (int i = 0; i < 100; i++)   values.push_back(float(randNumber()));
+
+        CPPUNIT_ASSERT(chooseCodec(values, 0.01) == AttributeFH::attributeType());
+        CPPUNIT_ASSERT(chooseCodec(values, 0.0) == AttributeF::attributeType());
+
+        // out of half-precision range
+
+        values.push_back(1e6f);
+
+        CPPUNIT_ASSERT(chooseCodec(values, 0.01) == AttributeF::attributeType());
+
+        // empty
+
+        CPPUNIT_ASSERT(chooseCodec(std::vector<float>(), 0.0) == AttributeFH::attributeType());
+    }
+
+    { // position offsets
+        std::vector<Vec3f> values;
+        for (int i = 0; i < 100; i++) {
+            values.push_back(Vec3f(float(randNumber()), float(randNumber()), float(randNumber())) - Vec3f(0.5f));
+        }
+
+        CPPUNIT_ASSERT(chooseCodec(values, 0.01) == AttributeFP8::attributeType());
+        CPPUNIT_ASSERT(chooseCodec(values, 1e-4) == AttributeFP16::attributeType());
+        CPPUNIT_ASSERT(chooseCodec(values, 0.0) == AttributeVec3f::attributeType());
+    }
+
+    { // unit vectors
+        std::vector<Vec3f> values;
+        for (int i = 0; i < 100; i++) {
+            Vec3f value(float(randNumber()) - 0.5f, float(randNumber()) - 0.5f, float(randNumber()) - 0.5f);
+            value.normalize();
+            values.push_back(value);
+        }
+
+        CPPUNIT_ASSERT(chooseCodec(values, 0.05) == AttributeUVec::attributeType());
+    }
+
+    { // large vectors
+        std::vector<Vec3f> values;
+        for (int i = 0; i < 100; i++) {
+            values.push_back(Vec3f(float(randNumber()), float(randNumber()), float(randNumber())) * 100.0f);
+        }
+
+        CPPUNIT_ASSERT(chooseCodec(values, 0.1) == AttributeVec3h::attributeType());
+        CPPUNIT_ASSERT(chooseCodec(values, 1e-6) == AttributeVec3f::attributeType());
+    }
+}
+
+
+void
+TestPointCompression::testOptimize()
+{
+    using namespace openvdb;
+    using namespace openvdb::tools;
+
+    typedef TypedAttributeArray<float>                                              AttributeF;
+    typedef TypedAttributeArray<float, NullAttributeCodec<half> >                   AttributeFH;
+    typedef TypedAttributeArray<int32_t>                                            AttributeI;
+    typedef TypedAttributeArray<Vec3f>                                              AttributeVec3f;
+    typedef TypedAttributeArray<Vec3f, FixedPointAttributeCodec<math::Vec3<uint16_t> > >  AttributeFP16;
+    typedef TypedAttributeArray<Vec3f, OctahedralAttributeCodec<math::Vec2<half> > >      AttributeOctH;
+    typedef AttributeSet::Descriptor                                                Descriptor;
+
+    math::Random01 randNumber(0);
+
+    std::vector<Vec3f> positions;
+    for (int i = 0; i < 1000; i++) {
+        positions.push_back(Vec3f(float(randNumber()), float(randNumber()), float(randNumber())) * 20.0f);
+    }
+
+    math::Transform::Ptr transform(math::Transform::createLinearTransform(1.0));
+
+    PointDataGrid::Ptr grid = createPointDataGrid<PointDataGrid>(positions, AttributeVec3f::attributeType(), *transform);
+    PointDataTree& tree = grid->tree();
+
+    appendAttribute(tree, Descriptor::NameAndType("pscale", AttributeF::attributeType()));
+    appendAttribute(tree, Descriptor::NameAndType("id", AttributeI::attributeType()));
+
+    // set pscale values and store the original values of each leaf
+
+    std::vector<Vec3f> originalP;
+    std::vector<float> originalPscale;
+
+    for (PointDataTree::LeafIter leaf = tree.beginLeaf(); leaf; ++leaf) {
+        AttributeHandle<Vec3f> positionHandle(leaf->constAttributeArray("P"));
+        AttributeWriteHandle<float> pscaleHandle(leaf->attributeArray("pscale"));
+
+        for (Index n = 0; n < Index(positionHandle.size()); n++) {
+            const float pscale = float(randNumber());
+            pscaleHandle.set(n, pscale);
+            originalPscale.push_back(pscale);
+            originalP.push_back(positionHandle.get(n));
+        }
+    }
+
+    { // invalid requests
+        std::map<Name, double> tolerances;
+        tolerances["missing"] = 0.1;
+
+        CPPUNIT_ASSERT_THROW(optimizeAttributeCodecs(tree, tolerances), KeyError);
+
+        tolerances.clear();
+        tolerances["id"] = 0.1;
+
+        CPPUNIT_ASSERT_THROW(optimizeAttributeCodecs(tree, tolerances), TypeError);
+
+        tolerances.clear();
+        tolerances["pscale"] = -1.0;
+
+        CPPUNIT_ASSERT_THROW(optimizeAttributeCodecs(tree, tolerances), ValueError);
+    }
+
+    { // zero tolerance leaves the attributes unchanged
+        std::map<Name, double> tolerances;
+        tolerances["P"] = 0.0;
+
+        optimizeAttributeCodecs(tree, tolerances);
+
+        const Descriptor& descriptor = tree.cbeginLeaf()->attributeSet().descriptor();
+        CPPUNIT_ASSERT(descriptor.type(descriptor.find("P")) == AttributeVec3f::attributeType());
+    }
+
+    { // a codec that is not a candidate is not replaced by one with larger storage
+        appendAttribute(tree, Descriptor::NameAndType("N", AttributeOctH::attributeType()));
+
+        std::map<Name, double> tolerances;
+        tolerances["N"] = 0.0;
+
+        optimizeAttributeCodecs(tree, tolerances);
+
+        const Descriptor& descriptor = tree.cbeginLeaf()->attributeSet().descriptor();
+        CPPUNIT_ASSERT(descriptor.type(descriptor.find("N")) == AttributeOctH::attributeType());
+
+        dropAttribute(tree, "N");
+    }
+
+    const double positionTolerance = 1e-4;
+    const double pscaleTolerance = 1e-2;
+
+    std::map<Name, double> tolerances;
+    tolerances["P"] = positionTolerance;
+    tolerances["pscale"] = pscaleTolerance;
+
+    optimizeAttributeCodecs(tree, tolerances);
+
+    const Descriptor& descriptor = tree.cbeginLeaf()->attributeSet().descriptor();
+
+    CPPUNIT_ASSERT(descriptor.type(descriptor.find("P")) == AttributeFP16::attributeType());
+    CPPUNIT_ASSERT(descriptor.type(descriptor.find("pscale")) == AttributeFH::attributeType());
+    CPPUNIT_ASSERT(descriptor.type(descriptor.find("id")) == AttributeI::attributeType());
+
+    // verify all leaves share the new descriptor and values are within tolerance
+
+    size_t index = 0;
+
+    for (PointDataTree::LeafCIter leaf = tree.cbeginLeaf(); leaf; ++leaf) {
+        CPPUNIT_ASSERT(leaf->attributeSet().descriptor() == descriptor);
+        CPPUNIT_ASSERT(leaf->constAttributeArray("P").isType<AttributeFP16>());
+
+        AttributeHandle<Vec3f> positionHandle(leaf->constAttributeArray("P"));
+        AttributeHandle<float> pscaleHandle(leaf->constAttributeArray("pscale"));
+
+        for (Index n = 0; n < Index(positionHandle.size()); n++, index++) {
+            const Vec3f position = positionHandle.get(n);
+            for (int i = 0; i < 3; i++) {
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(originalP[index][i], position[i], positionTolerance);
+            }
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(originalPscale[index], pscaleHandle.get(n), pscaleTolerance);
+        }
+    }
+
+    CPPUNIT_ASSERT_EQUAL(index, originalP.size());
+
+    // optimizing again with the same tolerances is a no-op
+
+    const Descriptor::Ptr descriptorPtr = tree.cbeginLeaf()->attributeSet().descriptorPtr();
+
+    optimizeAttributeCodecs(tree, tolerances);
+
+    CPPUNIT_ASSERT(tree.cbeginLeaf()->attributeSet().descriptorPtr() == descriptorPtr);
+}
+
+
+// Copyright (c) 2015-2016 Double Negative Visual Effects
+// All rights reserved. This software is distributed under the
+// Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
@@ -49,10 +49,14 @@ public:
 
     CPPUNIT_TEST_SUITE(TestPointConversion);
     CPPUNIT_TEST(testPointConversion);
+    CPPUNIT_TEST(testComputeVoxelSize);
+    CPPUNIT_TEST(testQuatMat3Conversion);
 
     CPPUNIT_TEST_SUITE_END();
 
     void testPointConversion();
+    void testComputeVoxelSize();
+    void testQuatMat3Conversion();
 
 }; // class TestPointConversion
 
@@ -106,6 +110,39 @@ private:
 }; // struct AttributeWrapper
 
 
+// Attribute wrapper that stores the components of each value contiguously and reads
+// quaternions and matrices through dedicated overloads (as the Houdini attribute does)
+template <typename T>
+struct ComponentWrapper
+{
+    typedef T value_type;
+
+    ComponentWrapper(const std::vector<float>& components, const size_t stride)
+        : mComponents(components)
+        , mStride(stride) { }
+
+    size_t size() const { return mComponents.size() / mStride; }
+
+    template <typename ElementType>
+    void get(size_t n, openvdb::math::Quat<ElementType>& value) const {
+        const float* data = &mComponents[n * mStride];
+        value = openvdb::math::Quat<ElementType>(data[0], data[1], data[2], data[3]);
+    }
+
+    template <typename ElementType>
+    void get(size_t n, openvdb::math::Mat3<ElementType>& value) const {
+        const float* data = &mComponents[n * mStride];
+        for (int i = 0; i < 3; ++i) {
+            for (int j = 0; j < 3; ++j)     value(i, j) = data[i * 3 + j];
+        }
+    }
+
+private:
+    const std::vector<float>& mComponents;
+    const size_t mStride;
+}; // struct ComponentWrapper
+
+
 struct GroupWrapper
 {
     GroupWrapper() { }
@@ -376,6 +413,154 @@ TestPointConversion::testPointConversion()
     }
 }
 
+
+
+////////////////////////////////////////
+
+
+void
+TestPointConversion::testComputeVoxelSize()
+{
+    typedef TypedAttributeArray<Vec3s>   AttributeVec3s;
+
+    math::Random01 randNumber(0);
+
+    { // points uniformly distributed through a volume
+        std::vector<Vec3s> positions;
+        for (int i = 0; i < 100000; i++) {
+            positions.push_back(Vec3s(randNumber(), randNumber(), randNumber()) * 10.0f);
+        }
+
+        const PointAttributeVector<Vec3s> wrapper(positions);
+
+        // the expected voxel size has eight points in a voxel on average
+
+        const float voxelSize = computeVoxelSize(wrapper, /*pointsPerVoxel=*/8.0f);
+
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(voxelSize, std::pow(0.08, 1.0 / 3.0), 0.04);
+
+        math::Transform::Ptr transform(math::Transform::createLinearTransform(voxelSize));
+
+        PointDataGrid::Ptr points = createPointDataGrid<PointDataGrid>(
+            positions, AttributeVec3s::attributeType(), *transform);
+
+        const double pointsPerVoxel = double(pointCount(points->tree())) /
+                                      double(points->tree().activeVoxelCount());
+
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(pointsPerVoxel, 8.0, 1.0);
+
+        // the expected voxel size has a leaf of 512 points on average, with few leaves
+        // in the bounds the estimate is coarse
+
+        const float leafVoxelSize = computeLeafVoxelSize<PointDataTree>(wrapper, /*pointsPerLeaf=*/512.0f);
+
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(leafVoxelSize, std::pow(5.12, 1.0 / 3.0) / 8.0, 0.08);
+    }
+
+    { // points uniformly distributed over a plane
+        std::vector<Vec3s> positions;
+        for (int i = 0; i < 100000; i++) {
+            positions.push_back(Vec3s(randNumber() * 10.0f, randNumber() * 10.0f, 0.0f));
+        }
+
+        const PointAttributeVector<Vec3s> wrapper(positions);
+
+        const float voxelSize = computeVoxelSize(wrapper, /*pointsPerVoxel=*/8.0f);
+
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(voxelSize, std::sqrt(0.008), 0.01);
+    }
+
+    { // degenerate positions
+        std::vector<Vec3s> positions;
+        positions.push_back(Vec3s(1, 2, 3));
+
+        const PointAttributeVector<Vec3s> wrapper(positions);
+
+        CPPUNIT_ASSERT_EQUAL(computeVoxelSize(wrapper, 8.0f), 0.0f);
+
+        positions.push_back(Vec3s(1, 2, 3));
+
+        CPPUNIT_ASSERT_EQUAL(computeVoxelSize(wrapper, 8.0f), 0.0f);
+
+        CPPUNIT_ASSERT_THROW(computeVoxelSize(wrapper, 0.5f), ValueError);
+    }
+}
+
+
+void
+TestPointConversion::testQuatMat3Conversion()
+{
+    typedef TypedAttributeArray<Vec3s>              AttributeVec3s;
+    typedef TypedAttributeArray<math::Quat<float> > AttributeQuatF;
+    typedef TypedAttributeArray<math::Mat3<float> > AttributeMat3F;
+
+    const int count = 4;
+
+    std::vector<Vec3s> positions;
+    std::vector<float> quats;
+    std::vector<float> matrices;
+
+    for (int n = 0; n < count; n++) {
+        positions.push_back(Vec3s(float(n), 0.0f, 0.0f));
+        for (int i = 0; i < 4; i++)     quats.push_back(float(n * 4 + i));
+        for (int i = 0; i < 9; i++)     matrices.push_back(float(n * 9 + i));
+    }
+
+    const PointAttributeVector<Vec3s> pointList(positions);
+
+    math::Transform::Ptr transform(math::Transform::createLinearTransform(1.0));
+
+    PointIndexGrid::Ptr pointIndexGrid = createPointIndexGrid<PointIndexGrid>(pointList, *transform);
+    PointDataGrid::Ptr pointDataGrid = createPointDataGrid<PointDataGrid>(*pointIndexGrid, pointList,
+                                            AttributeVec3s::attributeType(), *transform);
+
+    PointDataTree& tree = pointDataGrid->tree();
+
+    appendAttribute(tree, AttributeSet::Util::NameAndType("orient", AttributeQuatF::attributeType()));
+    appendAttribute(tree, AttributeSet::Util::NameAndType("transform", AttributeMat3F::attributeType()));
+
+    populateAttribute(tree, pointIndexGrid->tree(), "orient", ComponentWrapper<math::Quat<float> >(quats, 4));
+    populateAttribute(tree, pointIndexGrid->tree(), "transform", ComponentWrapper<math::Mat3<float> >(matrices, 9));
+
+    // the point index grid stores the index of each point in the source list
+
+    Index64 total = 0;
+
+    for (PointDataTree::LeafCIter leafIter = tree.cbeginLeaf(); leafIter; ++leafIter) {
+
+        const PointIndexTree::LeafNodeType* indexLeaf =
+            pointIndexGrid->tree().probeConstLeaf(leafIter->origin());
+
+        CPPUNIT_ASSERT(indexLeaf);
+
+        AttributeHandle<math::Quat<float> > quatHandle(leafIter->constAttributeArray("orient"));
+        AttributeHandle<math::Mat3<float> > matrixHandle(leafIter->constAttributeArray("transform"));
+
+        for (PointDataTree::LeafNodeType::IndexAllIter iter = leafIter->beginIndexAll(); iter; ++iter) {
+
+            const Index index = Index(*iter);
+            const size_t n = indexLeaf->indices()[index];
+
+            const math::Quat<float> quat = quatHandle.get(index);
+            const math::Mat3<float> matrix = matrixHandle.get(index);
+
+            for (int i = 0; i < 4; i++) {
+                CPPUNIT_ASSERT_EQUAL(quat[i], quats[n * 4 + i]);
+            }
+
+            for (int i = 0; i < 3; i++) {
+                for (int j = 0; j < 3; j++) {
+                    CPPUNIT_ASSERT_EQUAL(matrix(i, j), matrices[n * 9 + i * 3 + j]);
+                }
+            }
+
+            total++;
+        }
+    }
+
+    CPPUNIT_ASSERT_EQUAL(total, Index64(count));
+}
+
 // Copyright (c) 2015-2016 Double Negative Visual Effects
 // All rights reserved. This software is distributed under the
 // Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
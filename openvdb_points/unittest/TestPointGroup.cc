@@ -52,7 +52,9 @@ public:
     CPPUNIT_TEST(testAppendDrop);
     CPPUNIT_TEST(testCompact);
     CPPUNIT_TEST(testSet);
+    CPPUNIT_TEST(testSetGroups);
     CPPUNIT_TEST(testFilter);
+    CPPUNIT_TEST(testOperations);
 
     CPPUNIT_TEST_SUITE_END();
 
@@ -60,7 +62,9 @@ public:
     void testAppendDrop();
     void testCompact();
     void testSet();
+    void testSetGroups();
     void testFilter();
+    void testOperations();
 }; // class TestPointGroup
 
 CPPUNIT_TEST_SUITE_REGISTRATION(TestPointGroup);
@@ -523,6 +527,127 @@ TestPointGroup::testSet()
 }
 
 
+void
+TestPointGroup::testSetGroups()
+{
+    using namespace openvdb;
+    using namespace openvdb::tools;
+
+    typedef TypedAttributeArray<Vec3s>   AttributeVec3s;
+
+    typedef PointIndexGrid PointIndexGrid;
+
+    std::vector<Vec3s> positions;
+    positions.push_back(Vec3s(1, 1, 1));
+    positions.push_back(Vec3s(1, 2, 1));
+    positions.push_back(Vec3s(2, 1, 1));
+    positions.push_back(Vec3s(2, 2, 1));
+    positions.push_back(Vec3s(100, 100, 100));
+    positions.push_back(Vec3s(100, 101, 100));
+
+    const float voxelSize(1.0);
+    math::Transform::Ptr transform(math::Transform::createLinearTransform(voxelSize));
+
+    const PointAttributeVector<Vec3s> pointList(positions);
+
+    PointIndexGrid::Ptr pointIndexGrid =
+        openvdb::tools::createPointIndexGrid<PointIndexGrid>(pointList, *transform);
+
+    PointDataGrid::Ptr grid = createPointDataGrid<PointDataGrid>(*pointIndexGrid, pointList,
+                                                                 AttributeVec3s::attributeType(), *transform);
+    PointDataTree& tree = grid->tree();
+
+    // ten groups spanning two group attribute arrays
+
+    std::vector<Name> groups;
+    for (int i = 0; i < 10; i++) {
+        std::stringstream ss;
+        ss << "group" << i;
+        groups.push_back(ss.str());
+    }
+
+    appendGroups(tree, groups);
+
+    const size_t bytesPerPoint = 2;
+
+    // point i is a member of group g if i is divisible by g + 1
+
+    std::vector<GroupType> membership(positions.size() * bytesPerPoint, GroupType(0));
+
+    for (size_t i = 0; i < positions.size(); i++) {
+        for (size_t g = 0; g < groups.size(); g++) {
+            if (i % (g + 1) == 0) {
+                membership[i * bytesPerPoint + g / 8] |= GroupType(1) << (g % 8);
+            }
+        }
+    }
+
+    { // invalid membership size
+        std::vector<GroupType> invalid(positions.size(), GroupType(0));
+        CPPUNIT_ASSERT_THROW(setGroups(tree, pointIndexGrid->tree(), invalid, groups), LookupError);
+    }
+
+    { // missing group
+        std::vector<Name> missing(groups);
+        missing.back() = "missing";
+        CPPUNIT_ASSERT_THROW(setGroups(tree, pointIndexGrid->tree(), membership, missing), LookupError);
+    }
+
+    // existing membership is retained unless removal is requested
+
+    setGroup(tree, "group1", true);
+
+    CPPUNIT_ASSERT_EQUAL(groupPointCount(tree, "group1"), Index64(6));
+
+    setGroups(tree, pointIndexGrid->tree(), membership, groups);
+
+    CPPUNIT_ASSERT_EQUAL(groupPointCount(tree, "group0"), Index64(6));
+    CPPUNIT_ASSERT_EQUAL(groupPointCount(tree, "group1"), Index64(6));
+    CPPUNIT_ASSERT_EQUAL(groupPointCount(tree, "group2"), Index64(2));
+
+    setGroups(tree, pointIndexGrid->tree(), membership, groups, /*remove=*/true);
+
+    CPPUNIT_ASSERT_EQUAL(pointCount(tree), Index64(6));
+    CPPUNIT_ASSERT_EQUAL(groupPointCount(tree, "group0"), Index64(6));
+    CPPUNIT_ASSERT_EQUAL(groupPointCount(tree, "group1"), Index64(3));
+    CPPUNIT_ASSERT_EQUAL(groupPointCount(tree, "group2"), Index64(2));
+    CPPUNIT_ASSERT_EQUAL(groupPointCount(tree, "group3"), Index64(2));
+    CPPUNIT_ASSERT_EQUAL(groupPointCount(tree, "group4"), Index64(2));
+    CPPUNIT_ASSERT_EQUAL(groupPointCount(tree, "group5"), Index64(1));
+    CPPUNIT_ASSERT_EQUAL(groupPointCount(tree, "group8"), Index64(1));
+    CPPUNIT_ASSERT_EQUAL(groupPointCount(tree, "group9"), Index64(1));
+
+    // results match setting each group individually
+
+    PointDataGrid::Ptr grid2 = createPointDataGrid<PointDataGrid>(*pointIndexGrid, pointList,
+                                                                  AttributeVec3s::attributeType(), *transform);
+    PointDataTree& tree2 = grid2->tree();
+
+    appendGroups(tree2, groups);
+
+    for (size_t g = 0; g < groups.size(); g++) {
+        std::vector<short> single(positions.size(), short(0));
+        for (size_t i = 0; i < positions.size(); i++) {
+            single[i] = short((membership[i * bytesPerPoint + g / 8] >> (g % 8)) & 1);
+        }
+        setGroup(tree2, pointIndexGrid->tree(), single, groups[g]);
+    }
+
+    PointDataTree::LeafCIter iter = tree.cbeginLeaf();
+    PointDataTree::LeafCIter iter2 = tree2.cbeginLeaf();
+
+    for (; iter && iter2; ++iter, ++iter2) {
+        for (size_t g = 0; g < groups.size(); g++) {
+            GroupHandle handle = iter->groupHandle(groups[g]);
+            GroupHandle handle2 = iter2->groupHandle(groups[g]);
+            for (Index n = 0; n < iter->pointCount(); n++) {
+                CPPUNIT_ASSERT_EQUAL(handle.get(n), handle2.get(n));
+            }
+        }
+    }
+}
+
+
 void
 TestPointGroup::testFilter()
 {
@@ -672,6 +797,152 @@ TestPointGroup::testFilter()
 }
 
 
+void
+TestPointGroup::testOperations()
+{
+    using namespace openvdb;
+    using namespace openvdb::tools;
+
+    typedef TypedAttributeArray<Vec3s>   AttributeVec3s;
+
+    typedef PointIndexGrid PointIndexGrid;
+
+    // four points in one leaf, two points in another
+
+    std::vector<Vec3s> positions;
+    positions.push_back(Vec3s(1, 1, 1));
+    positions.push_back(Vec3s(1, 2, 1));
+    positions.push_back(Vec3s(2, 1, 1));
+    positions.push_back(Vec3s(2, 2, 1));
+    positions.push_back(Vec3s(100, 100, 100));
+    positions.push_back(Vec3s(100, 101, 100));
+
+    const float voxelSize(1.0);
+    math::Transform::Ptr transform(math::Transform::createLinearTransform(voxelSize));
+
+    const PointAttributeVector<Vec3s> pointList(positions);
+
+    PointIndexGrid::Ptr pointIndexGrid =
+        openvdb::tools::createPointIndexGrid<PointIndexGrid>(pointList, *transform);
+
+    PointDataGrid::Ptr grid = createPointDataGrid<PointDataGrid>(*pointIndexGrid, pointList,
+                                                                 AttributeVec3s::attributeType(), *transform);
+    PointDataTree& tree = grid->tree();
+
+    // ten groups results in the target groups spanning two group attributes
+
+    std::vector<Name> groups;
+    groups.push_back("a");
+    groups.push_back("b");
+    groups.push_back("all");
+    groups.push_back("none");
+    groups.push_back("union");
+    groups.push_back("intersect");
+    groups.push_back("subtract");
+    groups.push_back("uniform");
+    groups.push_back("copy");
+    groups.push_back("invert");
+
+    appendGroups(tree, groups);
+
+    const AttributeSet& attributeSet = tree.cbeginLeaf()->attributeSet();
+
+    CPPUNIT_ASSERT(attributeSet.groupIndex("a").first != attributeSet.groupIndex("copy").first);
+
+    std::vector<short> membership(6, short(0));
+    membership[0] = 1; membership[2] = 1; membership[3] = 1; membership[5] = 1;
+    setGroup(tree, pointIndexGrid->tree(), membership, "a");
+
+    membership.assign(6, short(0));
+    membership[0] = 1; membership[1] = 1; membership[5] = 1;
+    setGroup(tree, pointIndexGrid->tree(), membership, "b");
+
+    setGroup(tree, "all", true);
+
+    CPPUNIT_ASSERT_EQUAL(groupPointCount(tree, "a"), Index64(4));
+    CPPUNIT_ASSERT_EQUAL(groupPointCount(tree, "b"), Index64(3));
+
+    unionGroups(tree, "a", "b", "union");
+    intersectGroups(tree, "a", "b", "intersect");
+    subtractGroups(tree, "a", "b", "subtract");
+    copyGroup(tree, "a", "copy");
+    copyGroup(tree, "a", "invert");
+    invertGroup(tree, "invert");
+
+    CPPUNIT_ASSERT_EQUAL(groupPointCount(tree, "union"), Index64(5));
+    CPPUNIT_ASSERT_EQUAL(groupPointCount(tree, "intersect"), Index64(2));
+    CPPUNIT_ASSERT_EQUAL(groupPointCount(tree, "subtract"), Index64(2));
+    CPPUNIT_ASSERT_EQUAL(groupPointCount(tree, "copy"), Index64(4));
+    CPPUNIT_ASSERT_EQUAL(groupPointCount(tree, "invert"), Index64(2));
+
+    // source groups are unchanged
+
+    CPPUNIT_ASSERT_EQUAL(groupPointCount(tree, "a"), Index64(4));
+    CPPUNIT_ASSERT_EQUAL(groupPointCount(tree, "b"), Index64(3));
+
+    // per-point membership
+
+    for (PointDataTree::LeafCIter leafIter = tree.cbeginLeaf(); leafIter; ++leafIter) {
+        GroupHandle a = leafIter->groupHandle("a");
+        GroupHandle b = leafIter->groupHandle("b");
+        GroupHandle unionHandle = leafIter->groupHandle("union");
+        GroupHandle intersectHandle = leafIter->groupHandle("intersect");
+        GroupHandle subtractHandle = leafIter->groupHandle("subtract");
+        GroupHandle copyHandle = leafIter->groupHandle("copy");
+        GroupHandle invertHandle = leafIter->groupHandle("invert");
+
+        for (IndexIter iter = leafIter->beginIndex(); iter; ++iter) {
+            CPPUNIT_ASSERT_EQUAL(unionHandle.get(*iter), a.get(*iter) || b.get(*iter));
+            CPPUNIT_ASSERT_EQUAL(intersectHandle.get(*iter), a.get(*iter) && b.get(*iter));
+            CPPUNIT_ASSERT_EQUAL(subtractHandle.get(*iter), a.get(*iter) && !b.get(*iter));
+            CPPUNIT_ASSERT_EQUAL(copyHandle.get(*iter), a.get(*iter));
+            CPPUNIT_ASSERT_EQUAL(invertHandle.get(*iter), !a.get(*iter));
+        }
+    }
+
+    // in-place operation
+
+    unionGroups(tree, "b", "subtract", "b");
+
+    CPPUNIT_ASSERT_EQUAL(groupPointCount(tree, "b"), Index64(5));
+
+    // uniform sources remain uniform
+
+    {
+        dropGroups(tree);
+
+        appendGroup(tree, "all");
+        appendGroup(tree, "none");
+        appendGroup(tree, "uniform");
+
+        setGroup(tree, "all", true);
+
+        unionGroups(tree, "all", "none", "uniform");
+
+        CPPUNIT_ASSERT_EQUAL(groupPointCount(tree, "uniform"), Index64(6));
+
+        const size_t index = tree.cbeginLeaf()->attributeSet().groupIndex("uniform").first;
+
+        for (PointDataTree::LeafCIter leafIter = tree.cbeginLeaf(); leafIter; ++leafIter) {
+            CPPUNIT_ASSERT(leafIter->constAttributeArray(index).isUniform());
+        }
+
+        invertGroup(tree, "uniform");
+
+        CPPUNIT_ASSERT_EQUAL(groupPointCount(tree, "uniform"), Index64(0));
+
+        for (PointDataTree::LeafCIter leafIter = tree.cbeginLeaf(); leafIter; ++leafIter) {
+            CPPUNIT_ASSERT(leafIter->constAttributeArray(index).isUniform());
+        }
+    }
+
+    // missing groups
+
+    CPPUNIT_ASSERT_THROW(unionGroups(tree, "missing", "all", "uniform"), LookupError);
+    CPPUNIT_ASSERT_THROW(copyGroup(tree, "all", "missing"), LookupError);
+}
+
+
 // Copyright (c) 2015-2016 Double Negative Visual Effects
 // All rights reserved. This software is distributed under the
 // Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
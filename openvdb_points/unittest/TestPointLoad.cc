@@ -172,7 +172,13 @@ TestPointLoad::testLoad()
 
         BBoxd bbox(Vec3i(0, 0, 0), Vec3i(4, 30, 4));
 
-        loadPoints(*grid, bbox);
+        const Index64 bytes = loadPoints(*grid, bbox);
+
+        CPPUNIT_ASSERT(bytes > Index64(0));
+
+        // leaves already loaded are not loaded again
+
+        CPPUNIT_ASSERT_EQUAL(loadPoints(*grid, bbox), Index64(0));
 
         leafIter = grid->tree().cbeginLeaf();
 
@@ -215,7 +221,9 @@ TestPointLoad::testLoad()
         mask->tree().touchLeaf(Coord(0, 0, 0));
         mask->tree().touchLeaf(Coord(1, 1, 20));
 
-        loadPoints(*grid, *mask);
+        // serial loading
+
+        CPPUNIT_ASSERT(loadPoints(*grid, *mask, /*concurrency=*/1) > Index64(0));
 
         leafIter = grid->tree().cbeginLeaf();
 
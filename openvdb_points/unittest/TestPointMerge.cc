@@ -0,0 +1,494 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2015-2016 Double Negative Visual Effects
+//
+// All rights reserved. This software is distributed under the
+// Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
+//
+// Redistributions of source code must retain the above copyright
+// and license notice and the following restrictions and disclaimer.
+//
+// *     Neither the name of Double Negative Visual Effects nor the names
+// of its contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// IN NO EVENT SHALL THE COPYRIGHT HOLDERS' AND CONTRIBUTORS' AGGREGATE
+// LIABILITY FOR ALL CLAIMS REGARDLESS OF THEIR BASIS EXCEED US$250.00.
+//
+///////////////////////////////////////////////////////////////////////////
+
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <openvdb_points/openvdb.h>
+#include <openvdb_points/tools/PointDataGrid.h>
+#include <openvdb_points/tools/PointConversion.h>
+#include <openvdb_points/tools/PointAttribute.h>
+#include <openvdb_points/tools/PointCount.h>
+#include <openvdb_points/tools/PointGroup.h>
+#include <openvdb_points/tools/PointMerge.h>
+#include <openvdb_points/tools/AttributeArray.h>
+#include <openvdb_points/tools/AttributeString.h>
+#include <openvdb/Types.h>
+#include <openvdb/math/Transform.h>
+
+#include <limits>
+#include <map>
+
+class TestPointMerge: public CppUnit::TestCase
+{
+public:
+    virtual void setUp() { openvdb::initialize(); openvdb::points::initialize(); }
+    virtual void tearDown() { openvdb::uninitialize(); openvdb::points::uninitialize(); }
+
+    CPPUNIT_TEST_SUITE(TestPointMerge);
+    CPPUNIT_TEST(testMerge);
+    CPPUNIT_TEST(testMergeDescriptors);
+    CPPUNIT_TEST(testMergeTransforms);
+    CPPUNIT_TEST(testMergeStrings);
+    CPPUNIT_TEST(testMergeCodecs);
+
+    CPPUNIT_TEST_SUITE_END();
+
+    void testMerge();
+    void testMergeDescriptors();
+    void testMergeTransforms();
+    void testMergeStrings();
+    void testMergeCodecs();
+}; // class TestPointMerge
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TestPointMerge);
+
+
+////////////////////////////////////////
+
+
+namespace {
+
+    /// Create a grid of points at the given positions with an id attribute starting at the given value
+    openvdb::tools::PointDataGrid::Ptr
+    createPoints(const std::vector<openvdb::Vec3s>& positions, const double voxelSize, const int id,
+                 const openvdb::NamePair& positionType =
+                    openvdb::tools::TypedAttributeArray<openvdb::Vec3s>::attributeType())
+    {
+        using namespace openvdb;
+        using namespace openvdb::tools;
+
+        typedef TypedAttributeArray<int>     AttributeI;
+
+        math::Transform::Ptr transform(math::Transform::createLinearTransform(voxelSize));
+
+        const PointAttributeVector<Vec3s> pointList(positions);
+
+        PointIndexGrid::Ptr pointIndexGrid =
+            openvdb::tools::createPointIndexGrid<PointIndexGrid>(pointList, *transform);
+
+        PointDataGrid::Ptr points = createPointDataGrid<PointDataGrid>(*pointIndexGrid, pointList,
+                                                                       positionType, *transform);
+
+        appendAttribute(points->tree(), AttributeSet::Descriptor::NameAndType("id", AttributeI::attributeType()));
+
+        std::vector<int> ids;
+        for (size_t i = 0; i < positions.size(); i++)   ids.push_back(id + int(i));
+
+        // point index grids store the index of each point in the source list
+
+        for (PointDataTree::LeafIter leafIter = points->tree().beginLeaf(); leafIter; ++leafIter) {
+            const PointIndexTree::LeafNodeType* indexLeaf =
+                pointIndexGrid->tree().probeConstLeaf(leafIter->origin());
+            AttributeWriteHandle<int> idHandle(leafIter->attributeArray("id"));
+            for (PointDataTree::LeafNodeType::IndexAllIter iter = leafIter->beginIndexAll(); iter; ++iter) {
+                idHandle.set(Index(*iter), ids[indexLeaf->indices()[Index(*iter)]]);
+            }
+        }
+
+        return points;
+    }
+
+    /// Return the ids of the points in a voxel in order
+    std::vector<int>
+    voxelIds(const openvdb::tools::PointDataTree& tree, const openvdb::Coord& ijk)
+    {
+        using namespace openvdb;
+        using namespace openvdb::tools;
+
+        std::vector<int> ids;
+
+        const PointDataTree::LeafNodeType* leaf = tree.probeConstLeaf(ijk);
+
+        if (!leaf)  return ids;
+
+        AttributeHandle<int> idHandle(leaf->constAttributeArray("id"));
+
+        for (PointDataTree::LeafNodeType::IndexAllIter iter = leaf->beginIndexAll(); iter; ++iter) {
+            if (iter.getCoord() == ijk)     ids.push_back(idHandle.get(Index(*iter)));
+        }
+
+        return ids;
+    }
+
+    /// Return the world-space position of the point with the given id
+    openvdb::Vec3d
+    worldPosition(const openvdb::tools::PointDataGrid& grid, const int id)
+    {
+        using namespace openvdb;
+        using namespace openvdb::tools;
+
+        for (PointDataTree::LeafCIter leafIter = grid.tree().cbeginLeaf(); leafIter; ++leafIter) {
+            AttributeHandle<Vec3f> positionHandle(leafIter->constAttributeArray("P"));
+            AttributeHandle<int> idHandle(leafIter->constAttributeArray("id"));
+            for (PointDataTree::LeafNodeType::IndexAllIter iter = leafIter->beginIndexAll(); iter; ++iter) {
+                if (idHandle.get(Index(*iter)) != id)     continue;
+                const Vec3d xyz = iter.getCoord().asVec3d() + Vec3d(positionHandle.get(Index(*iter)));
+                return grid.transform().indexToWorld(xyz);
+            }
+        }
+
+        return Vec3d(std::numeric_limits<double>::max());
+    }
+
+    /// Append a string attribute and set the string of each point with an id in the map
+    void
+    appendStrings(openvdb::tools::PointDataTree& tree, const std::map<int, openvdb::Name>& strings)
+    {
+        using namespace openvdb;
+        using namespace openvdb::tools;
+
+        appendAttribute(tree, AttributeSet::Descriptor::NameAndType("material",
+            StringAttributeArray::attributeType()));
+
+        // insert the strings into the string table of the shared descriptor
+
+        makeDescriptorUnique(tree);
+
+        MetaMap& metadata = tree.cbeginLeaf()->attributeSet().descriptorPtr()->getMetadata();
+
+        StringMetaInserter inserter(metadata);
+
+        for (std::map<int, Name>::const_iterator it = strings.begin(); it != strings.end(); ++it) {
+            inserter.insert(it->second);
+        }
+
+        for (PointDataTree::LeafIter leafIter = tree.beginLeaf(); leafIter; ++leafIter) {
+            StringAttributeWriteHandle stringHandle(leafIter->attributeArray("material"), metadata);
+            AttributeHandle<int> idHandle(leafIter->constAttributeArray("id"));
+            for (PointDataTree::LeafNodeType::IndexAllIter iter = leafIter->beginIndexAll(); iter; ++iter) {
+                std::map<int, Name>::const_iterator it = strings.find(idHandle.get(Index(*iter)));
+                if (it != strings.end())    stringHandle.set(Index(*iter), it->second);
+            }
+        }
+    }
+
+} // namespace
+
+
+void
+TestPointMerge::testMerge()
+{
+    using namespace openvdb;
+    using namespace openvdb::tools;
+
+    std::vector<Vec3s> positionsA;
+    positionsA.push_back(Vec3s(1, 1, 1));
+    positionsA.push_back(Vec3s(2, 1, 1));
+
+    std::vector<Vec3s> positionsB;
+    positionsB.push_back(Vec3s(1, 1, 1));
+    positionsB.push_back(Vec3s(20, 1, 1));
+
+    std::vector<Vec3s> positionsC;
+    positionsC.push_back(Vec3s(1, 1, 1));
+
+    PointDataGrid::Ptr points = createPoints(positionsA, 1.0, 0);
+
+    std::vector<PointDataGrid::Ptr> sources;
+    sources.push_back(createPoints(positionsB, 1.0, 100));
+    sources.push_back(PointDataGrid::Ptr());
+    sources.push_back(createPoints(positionsC, 1.0, 200));
+
+    mergePoints(*points, sources);
+
+    CPPUNIT_ASSERT_EQUAL(pointCount(points->tree()), Index64(5));
+    CPPUNIT_ASSERT_EQUAL(points->tree().leafCount(), Index32(2));
+    CPPUNIT_ASSERT_EQUAL(points->tree().activeVoxelCount(), Index64(3));
+
+    for (PointDataTree::LeafCIter leafIter = points->tree().cbeginLeaf(); leafIter; ++leafIter) {
+        leafIter->validateOffsets();
+    }
+
+    // target points precede source points in the order they are supplied
+
+    std::vector<int> ids = voxelIds(points->tree(), Coord(1, 1, 1));
+
+    CPPUNIT_ASSERT_EQUAL(ids.size(), size_t(3));
+    CPPUNIT_ASSERT_EQUAL(ids[0], 0);
+    CPPUNIT_ASSERT_EQUAL(ids[1], 100);
+    CPPUNIT_ASSERT_EQUAL(ids[2], 200);
+
+    CPPUNIT_ASSERT(worldPosition(*points, 101).eq(Vec3d(20, 1, 1)));
+
+    // source grids are left intact
+
+    CPPUNIT_ASSERT_EQUAL(pointCount(sources[0]->tree()), Index64(2));
+
+    { // merging into an empty grid
+        PointDataGrid::Ptr empty = PointDataGrid::create();
+
+        mergePoints(*empty, *sources[2]);
+
+        CPPUNIT_ASSERT_EQUAL(pointCount(empty->tree()), Index64(1));
+        CPPUNIT_ASSERT(worldPosition(*empty, 200).eq(Vec3d(1, 1, 1)));
+    }
+
+    CPPUNIT_ASSERT_THROW(mergePoints(*points, *points), ValueError);
+}
+
+
+void
+TestPointMerge::testMergeDescriptors()
+{
+    using namespace openvdb;
+    using namespace openvdb::tools;
+
+    typedef TypedAttributeArray<float>   AttributeF;
+
+    std::vector<Vec3s> positionsA;
+    positionsA.push_back(Vec3s(1, 1, 1));
+    positionsA.push_back(Vec3s(2, 1, 1));
+
+    std::vector<Vec3s> positionsB;
+    positionsB.push_back(Vec3s(2, 1, 1));
+    positionsB.push_back(Vec3s(3, 1, 1));
+    positionsB.push_back(Vec3s(4, 1, 1));
+
+    PointDataGrid::Ptr points = createPoints(positionsA, 1.0, 0);
+    PointDataGrid::Ptr source = createPoints(positionsB, 1.0, 100);
+
+    // target has group "a" containing all of its points
+
+    appendGroup(points->tree(), "a");
+
+    for (PointDataTree::LeafIter leafIter = points->tree().beginLeaf(); leafIter; ++leafIter) {
+        leafIter->groupWriteHandle("a").collapse(true);
+    }
+
+    // source has a density attribute and groups "b" and "a" in a different order
+
+    appendAttribute(source->tree(), AttributeSet::Descriptor::NameAndType("density", AttributeF::attributeType()),
+        Metadata::Ptr(new FloatMetadata(2.0f)));
+    appendGroup(source->tree(), "b");
+    appendGroup(source->tree(), "a");
+
+    for (PointDataTree::LeafIter leafIter = source->tree().beginLeaf(); leafIter; ++leafIter) {
+        leafIter->groupWriteHandle("b").collapse(true);
+        AttributeWriteHandle<float> densityHandle(leafIter->attributeArray("density"));
+        for (PointDataTree::LeafNodeType::IndexAllIter iter = leafIter->beginIndexAll(); iter; ++iter) {
+            densityHandle.set(Index(*iter), 5.0f);
+        }
+    }
+
+    mergePoints(*points, *source);
+
+    CPPUNIT_ASSERT_EQUAL(pointCount(points->tree()), Index64(5));
+    CPPUNIT_ASSERT_EQUAL(groupPointCount(points->tree(), "a"), Index64(2));
+    CPPUNIT_ASSERT_EQUAL(groupPointCount(points->tree(), "b"), Index64(3));
+
+    const AttributeSet::Descriptor& descriptor = points->tree().cbeginLeaf()->attributeSet().descriptor();
+
+    CPPUNIT_ASSERT(descriptor.find("density") != AttributeSet::INVALID_POS);
+    CPPUNIT_ASSERT(descriptor.hasDefaultValue("density"));
+
+    // points from the target have a zero density
+
+    for (PointDataTree::LeafCIter leafIter = points->tree().cbeginLeaf(); leafIter; ++leafIter) {
+        AttributeHandle<float> densityHandle(leafIter->constAttributeArray("density"));
+        AttributeHandle<int> idHandle(leafIter->constAttributeArray("id"));
+        GroupHandle groupHandle = leafIter->groupHandle("a");
+        for (PointDataTree::LeafNodeType::IndexAllIter iter = leafIter->beginIndexAll(); iter; ++iter) {
+            const bool fromSource = idHandle.get(Index(*iter)) >= 100;
+            CPPUNIT_ASSERT_EQUAL(densityHandle.get(Index(*iter)), fromSource ? 5.0f : 0.0f);
+            CPPUNIT_ASSERT_EQUAL(groupHandle.get(Index(*iter)), !fromSource);
+        }
+    }
+
+    { // attributes with the same name and a different type
+        PointDataGrid::Ptr invalid = createPoints(positionsB, 1.0, 100);
+        dropAttribute(invalid->tree(), "id");
+        appendAttribute(invalid->tree(), AttributeSet::Descriptor::NameAndType("id", AttributeF::attributeType()));
+
+        CPPUNIT_ASSERT_THROW(mergePoints(*points, *invalid), TypeError);
+    }
+}
+
+
+void
+TestPointMerge::testMergeTransforms()
+{
+    using namespace openvdb;
+    using namespace openvdb::tools;
+
+    std::vector<Vec3s> positionsA;
+    positionsA.push_back(Vec3s(1, 1, 1));
+
+    std::vector<Vec3s> positionsB;
+    positionsB.push_back(Vec3s(1.25f, 1, 1));
+    positionsB.push_back(Vec3s(5.75f, 1, 1));
+
+    PointDataGrid::Ptr points = createPoints(positionsA, 1.0, 0);
+    PointDataGrid::Ptr source = createPoints(positionsB, 0.25, 100);
+
+    mergePoints(*points, *source);
+
+    CPPUNIT_ASSERT_EQUAL(pointCount(points->tree()), Index64(3));
+    CPPUNIT_ASSERT_EQUAL(points->tree().activeVoxelCount(), Index64(2));
+
+    CPPUNIT_ASSERT(worldPosition(*points, 0).eq(Vec3d(1, 1, 1)));
+    CPPUNIT_ASSERT(worldPosition(*points, 100).eq(Vec3d(1.25, 1, 1)));
+    CPPUNIT_ASSERT(worldPosition(*points, 101).eq(Vec3d(5.75, 1, 1)));
+
+    std::vector<int> ids = voxelIds(points->tree(), Coord(1, 1, 1));
+
+    CPPUNIT_ASSERT_EQUAL(ids.size(), size_t(2));
+    CPPUNIT_ASSERT_EQUAL(ids[0], 0);
+    CPPUNIT_ASSERT_EQUAL(ids[1], 100);
+}
+
+
+void
+TestPointMerge::testMergeStrings()
+{
+    using namespace openvdb;
+    using namespace openvdb::tools;
+
+    std::vector<Vec3s> positionsA;
+    positionsA.push_back(Vec3s(1, 1, 1));
+    positionsA.push_back(Vec3s(2, 1, 1));
+
+    std::vector<Vec3s> positionsB;
+    positionsB.push_back(Vec3s(1, 1, 1));
+    positionsB.push_back(Vec3s(3, 1, 1));
+    positionsB.push_back(Vec3s(20, 1, 1));
+
+    PointDataGrid::Ptr points = createPoints(positionsA, 1.0, 0);
+    PointDataGrid::Ptr source = createPoints(positionsB, 1.0, 100);
+
+    // the string tables store the strings in a different order
+
+    std::map<int, Name> stringsA;
+    stringsA[0] = "wood";
+    stringsA[1] = "metal";
+
+    std::map<int, Name> stringsB;
+    stringsB[100] = "glass";
+    stringsB[101] = "wood";
+
+    appendStrings(points->tree(), stringsA);
+    appendStrings(source->tree(), stringsB);
+
+    mergePoints(*points, *source);
+
+    CPPUNIT_ASSERT_EQUAL(pointCount(points->tree()), Index64(5));
+
+    const MetaMap& metadata = points->tree().cbeginLeaf()->attributeSet().descriptor().getMetadata();
+
+    const StringMetaCache cache(metadata);
+
+    CPPUNIT_ASSERT_EQUAL(cache.size(), size_t(4));
+
+    std::map<int, Name> expected(stringsA);
+    expected.insert(stringsB.begin(), stringsB.end());
+
+    for (PointDataTree::LeafCIter leafIter = points->tree().cbeginLeaf(); leafIter; ++leafIter) {
+        StringAttributeHandle stringHandle(leafIter->constAttributeArray("material"), cache);
+        AttributeHandle<int> idHandle(leafIter->constAttributeArray("id"));
+        for (PointDataTree::LeafNodeType::IndexAllIter iter = leafIter->beginIndexAll(); iter; ++iter) {
+            const int id = idHandle.get(Index(*iter));
+            const Name name = expected.count(id) ? expected[id] : Name();
+            CPPUNIT_ASSERT_EQUAL(stringHandle.get(Index(*iter)), name);
+        }
+    }
+
+    // the string table of the source is unchanged
+
+    const StringMetaCache sourceCache(source->tree().cbeginLeaf()->attributeSet().descriptor().getMetadata());
+
+    CPPUNIT_ASSERT_EQUAL(sourceCache.size(), size_t(3));
+    CPPUNIT_ASSERT_EQUAL(sourceCache.get(1), Name("glass"));
+}
+
+
+void
+TestPointMerge::testMergeCodecs()
+{
+    using namespace openvdb;
+    using namespace openvdb::tools;
+
+    typedef TypedAttributeArray<Vec3s, FixedPointAttributeCodec<Vec3<uint16_t> > >  AttributeVec3sFxpt16;
+    typedef TypedAttributeArray<float>                                              AttributeF;
+    typedef TypedAttributeArray<float, NullAttributeCodec<half> >                   AttributeH;
+
+    std::vector<Vec3s> positionsA;
+    positionsA.push_back(Vec3s(1, 1, 1));
+    positionsA.push_back(Vec3s(20, 1, 1));
+
+    std::vector<Vec3s> positionsB;
+    positionsB.push_back(Vec3s(1.25f, 1, 1));
+    positionsB.push_back(Vec3s(20.25f, 1, 1));
+
+    // float positions in the target and fixed point positions in the source
+
+    PointDataGrid::Ptr points = createPoints(positionsA, 1.0, 0);
+    PointDataGrid::Ptr source = createPoints(positionsB, 1.0, 100, AttributeVec3sFxpt16::attributeType());
+
+    // a float attribute that is truncated to half in the source
+
+    appendAttribute(points->tree(), AttributeSet::Descriptor::NameAndType("pscale", AttributeF::attributeType()));
+    appendAttribute(source->tree(), AttributeSet::Descriptor::NameAndType("pscale", AttributeH::attributeType()));
+
+    for (PointDataTree::LeafIter leafIter = source->tree().beginLeaf(); leafIter; ++leafIter) {
+        AttributeWriteHandle<float> pscaleHandle(leafIter->attributeArray("pscale"));
+        for (PointDataTree::LeafNodeType::IndexAllIter iter = leafIter->beginIndexAll(); iter; ++iter) {
+            pscaleHandle.set(Index(*iter), 0.25f);
+        }
+    }
+
+    mergePoints(*points, *source);
+
+    CPPUNIT_ASSERT_EQUAL(pointCount(points->tree()), Index64(4));
+
+    // the codecs of the target are retained
+
+    const AttributeSet& attributeSet = points->tree().cbeginLeaf()->attributeSet();
+
+    CPPUNIT_ASSERT(attributeSet.getConst("P")->type() == TypedAttributeArray<Vec3s>::attributeType());
+    CPPUNIT_ASSERT(attributeSet.getConst("pscale")->type() == AttributeF::attributeType());
+
+    CPPUNIT_ASSERT(worldPosition(*points, 0).eq(Vec3d(1, 1, 1)));
+    CPPUNIT_ASSERT(worldPosition(*points, 1).eq(Vec3d(20, 1, 1)));
+    CPPUNIT_ASSERT(worldPosition(*points, 100).eq(Vec3d(1.25, 1, 1), 1e-4));
+    CPPUNIT_ASSERT(worldPosition(*points, 101).eq(Vec3d(20.25, 1, 1), 1e-4));
+
+    for (PointDataTree::LeafCIter leafIter = points->tree().cbeginLeaf(); leafIter; ++leafIter) {
+        AttributeHandle<float> pscaleHandle(leafIter->constAttributeArray("pscale"));
+        AttributeHandle<int> idHandle(leafIter->constAttributeArray("id"));
+        for (PointDataTree::LeafNodeType::IndexAllIter iter = leafIter->beginIndexAll(); iter; ++iter) {
+            const float pscale = idHandle.get(Index(*iter)) < 100 ? 0.0f : 0.25f;
+            CPPUNIT_ASSERT_EQUAL(pscaleHandle.get(Index(*iter)), pscale);
+        }
+    }
+}
+
+// Copyright (c) 2015-2016 Double Negative Visual Effects
+// All rights reserved. This software is distributed under the
+// Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
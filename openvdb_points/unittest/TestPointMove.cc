@@ -0,0 +1,358 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2015-2016 Double Negative Visual Effects
+//
+// All rights reserved. This software is distributed under the
+// Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
+//
+// Redistributions of source code must retain the above copyright
+// and license notice and the following restrictions and disclaimer.
+//
+// *     Neither the name of Double Negative Visual Effects nor the names
+// of its contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// IN NO EVENT SHALL THE COPYRIGHT HOLDERS' AND CONTRIBUTORS' AGGREGATE
+// LIABILITY FOR ALL CLAIMS REGARDLESS OF THEIR BASIS EXCEED US$250.00.
+//
+///////////////////////////////////////////////////////////////////////////
+
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <openvdb_points/openvdb.h>
+#include <openvdb_points/tools/PointDataGrid.h>
+#include <openvdb_points/tools/PointConversion.h>
+#include <openvdb_points/tools/PointAttribute.h>
+#include <openvdb_points/tools/PointCount.h>
+#include <openvdb_points/tools/PointMove.h>
+#include <openvdb_points/tools/AttributeArray.h>
+#include <openvdb/Types.h>
+#include <openvdb/math/Transform.h>
+
+class TestPointMove: public CppUnit::TestCase
+{
+public:
+    virtual void setUp() { openvdb::initialize(); openvdb::points::initialize(); }
+    virtual void tearDown() { openvdb::uninitialize(); openvdb::points::uninitialize(); }
+
+    CPPUNIT_TEST_SUITE(TestPointMove);
+    CPPUNIT_TEST(testMove);
+    CPPUNIT_TEST(testReorder);
+    CPPUNIT_TEST(testResample);
+
+    CPPUNIT_TEST_SUITE_END();
+
+    void testMove();
+    void testReorder();
+    void testResample();
+}; // class TestPointMove
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TestPointMove);
+
+
+////////////////////////////////////////
+
+
+namespace {
+
+    /// Deformer that translates every point by a constant offset
+    struct OffsetDeformer
+    {
+        explicit OffsetDeformer(const openvdb::Vec3d& offset)
+            : mOffset(offset) { }
+
+        template <typename LeafT>
+        void reset(const LeafT&, size_t) { }
+
+        template <typename IterT>
+        void apply(openvdb::Vec3d& position, const IterT&) const
+        {
+            position += mOffset;
+        }
+
+        openvdb::Vec3d mOffset;
+    };
+
+    openvdb::tools::PointDataGrid::Ptr
+    createPoints(const std::vector<openvdb::Vec3s>& positions, const openvdb::math::Transform& transform)
+    {
+        using namespace openvdb;
+        using namespace openvdb::tools;
+
+        typedef TypedAttributeArray<Vec3s>   AttributeVec3s;
+        typedef TypedAttributeArray<int>     AttributeI;
+
+        const PointAttributeVector<Vec3s> pointList(positions);
+
+        PointIndexGrid::Ptr pointIndexGrid =
+            openvdb::tools::createPointIndexGrid<PointIndexGrid>(pointList, transform);
+
+        PointDataGrid::Ptr points = createPointDataGrid<PointDataGrid>(*pointIndexGrid, pointList,
+                                                                       AttributeVec3s::attributeType(), transform);
+
+        appendAttribute(points->tree(), AttributeSet::Descriptor::NameAndType("id", AttributeI::attributeType()));
+
+        // set the id of each point to its rounded x position
+
+        for (PointDataTree::LeafIter leafIter = points->tree().beginLeaf(); leafIter; ++leafIter) {
+            AttributeHandle<Vec3f> positionHandle(leafIter->constAttributeArray("P"));
+            AttributeWriteHandle<int> idHandle(leafIter->attributeArray("id"));
+            for (PointDataTree::LeafNodeType::IndexAllIter iter = leafIter->beginIndexAll(); iter; ++iter) {
+                const Vec3d xyz = iter.getCoord().asVec3d() + Vec3d(positionHandle.get(Index(*iter)));
+                idHandle.set(Index(*iter), int(math::Round(transform.indexToWorld(xyz).x())));
+            }
+        }
+
+        return points;
+    }
+
+    /// Check that every point has moved by the given offset from the position denoted by its id
+    bool checkPositions(const openvdb::tools::PointDataTree& tree, const openvdb::math::Transform& transform,
+                        const openvdb::Vec3d& offset)
+    {
+        using namespace openvdb;
+        using namespace openvdb::tools;
+
+        for (PointDataTree::LeafCIter leafIter = tree.cbeginLeaf(); leafIter; ++leafIter) {
+            leafIter->validateOffsets();
+            AttributeHandle<Vec3f> positionHandle(leafIter->constAttributeArray("P"));
+            AttributeHandle<int> idHandle(leafIter->constAttributeArray("id"));
+            for (PointDataTree::LeafNodeType::IndexAllIter iter = leafIter->beginIndexAll(); iter; ++iter) {
+                const Vec3f voxelPosition = positionHandle.get(Index(*iter));
+                for (int i = 0; i < 3; i++) {
+                    if (voxelPosition[i] < -0.5f || voxelPosition[i] > 0.5f)           return false;
+                }
+                const Vec3d world = transform.indexToWorld(iter.getCoord().asVec3d() + Vec3d(voxelPosition));
+                const int id = idHandle.get(Index(*iter));
+                if (!math::isApproxEqual(world.x(), double(id) + offset.x(), 1e-5))   return false;
+                if (!math::isApproxEqual(world.y(), 1.0 + offset.y(), 1e-5))          return false;
+            }
+        }
+
+        return true;
+    }
+
+} // namespace
+
+
+void
+TestPointMove::testMove()
+{
+    using namespace openvdb;
+    using namespace openvdb::tools;
+
+    math::Transform::Ptr transform(math::Transform::createLinearTransform(1.0));
+
+    std::vector<Vec3s> positions;
+    positions.push_back(Vec3s(1, 1, 1));
+    positions.push_back(Vec3s(2, 1, 1));
+    positions.push_back(Vec3s(3, 1, 1));
+    positions.push_back(Vec3s(4, 1, 1));
+    positions.push_back(Vec3s(5, 1, 1));
+
+    PointDataGrid::Ptr points = createPoints(positions, *transform);
+
+    CPPUNIT_ASSERT_EQUAL(points->tree().leafCount(), Index32(1));
+
+    { // null deformer leaves the points untouched
+        movePoints(*points, NullDeformer());
+
+        CPPUNIT_ASSERT_EQUAL(pointCount(points->tree()), Index64(5));
+        CPPUNIT_ASSERT_EQUAL(points->tree().leafCount(), Index32(1));
+        CPPUNIT_ASSERT(checkPositions(points->tree(), *transform, Vec3d(0, 0, 0)));
+    }
+
+    { // move within voxels updates positions in place
+        const PointDataTree::LeafNodeType* leaf = points->tree().probeConstLeaf(Coord(0));
+
+        movePoints(*points, OffsetDeformer(Vec3d(0.25, 0.25, 0)));
+
+        CPPUNIT_ASSERT_EQUAL(pointCount(points->tree()), Index64(5));
+        CPPUNIT_ASSERT_EQUAL(leaf, points->tree().probeConstLeaf(Coord(0)));
+        CPPUNIT_ASSERT(checkPositions(points->tree(), *transform, Vec3d(0.25, 0.25, 0)));
+    }
+
+    { // move across voxel and leaf boundaries
+        movePoints(*points, OffsetDeformer(Vec3d(4.75, -0.25, 0)));
+
+        CPPUNIT_ASSERT_EQUAL(pointCount(points->tree()), Index64(5));
+        CPPUNIT_ASSERT_EQUAL(points->tree().leafCount(), Index32(2));
+        CPPUNIT_ASSERT_EQUAL(points->tree().activeVoxelCount(), Index64(5));
+        CPPUNIT_ASSERT(checkPositions(points->tree(), *transform, Vec3d(5, 0, 0)));
+
+        // all leaves share the same descriptor
+
+        PointDataTree::LeafCIter leafIter = points->tree().cbeginLeaf();
+        const AttributeSet::Descriptor* descriptor = &leafIter->attributeSet().descriptor();
+        for (++leafIter; leafIter; ++leafIter) {
+            CPPUNIT_ASSERT_EQUAL(descriptor, &leafIter->attributeSet().descriptor());
+        }
+    }
+
+    { // move points from two leaves into a single leaf
+        movePoints(*points, OffsetDeformer(Vec3d(-100, 0, 0)));
+
+        CPPUNIT_ASSERT_EQUAL(pointCount(points->tree()), Index64(5));
+        CPPUNIT_ASSERT_EQUAL(points->tree().leafCount(), Index32(1));
+        CPPUNIT_ASSERT(checkPositions(points->tree(), *transform, Vec3d(-95, 0, 0)));
+    }
+
+    { // uniform attributes remain uniform when every source shares the same value
+        appendAttribute(points->tree(), AttributeSet::Descriptor::NameAndType("uniform",
+            TypedAttributeArray<float>::attributeType()));
+
+        for (PointDataTree::LeafIter leafIter = points->tree().beginLeaf(); leafIter; ++leafIter) {
+            AttributeWriteHandle<float>(leafIter->attributeArray("uniform")).collapse(3.0f);
+        }
+
+        movePoints(*points, OffsetDeformer(Vec3d(4, 0, 0)));
+
+        CPPUNIT_ASSERT_EQUAL(pointCount(points->tree()), Index64(5));
+        CPPUNIT_ASSERT_EQUAL(points->tree().leafCount(), Index32(2));
+        CPPUNIT_ASSERT(checkPositions(points->tree(), *transform, Vec3d(-91, 0, 0)));
+
+        for (PointDataTree::LeafCIter leafIter = points->tree().cbeginLeaf(); leafIter; ++leafIter) {
+            const AttributeArray& array = leafIter->constAttributeArray("uniform");
+            CPPUNIT_ASSERT(array.isUniform());
+            CPPUNIT_ASSERT_EQUAL(AttributeHandle<float>(array).get(0), 3.0f);
+        }
+    }
+}
+
+
+void
+TestPointMove::testReorder()
+{
+    using namespace openvdb;
+    using namespace openvdb::tools;
+
+    math::Transform::Ptr transform(math::Transform::createLinearTransform(0.5));
+
+    std::vector<Vec3s> positions;
+    positions.push_back(Vec3s(1, 1, 1));
+    positions.push_back(Vec3s(2, 1, 1));
+    positions.push_back(Vec3s(3, 1, 1));
+
+    PointDataGrid::Ptr points = createPoints(positions, *transform);
+
+    CPPUNIT_ASSERT_EQUAL(points->tree().activeVoxelCount(), Index64(3));
+
+    // offset the voxel-space positions in place beyond their voxels
+
+    for (PointDataTree::LeafIter leafIter = points->tree().beginLeaf(); leafIter; ++leafIter) {
+        AttributeWriteHandle<Vec3f> positionHandle(leafIter->attributeArray("P"));
+        for (PointDataTree::LeafNodeType::IndexAllIter iter = leafIter->beginIndexAll(); iter; ++iter) {
+            positionHandle.set(Index(*iter), positionHandle.get(Index(*iter)) + Vec3f(20, 0, 0));
+        }
+    }
+
+    reorderPoints(*points);
+
+    CPPUNIT_ASSERT_EQUAL(pointCount(points->tree()), Index64(3));
+    CPPUNIT_ASSERT_EQUAL(points->tree().activeVoxelCount(), Index64(3));
+    CPPUNIT_ASSERT(checkPositions(points->tree(), *transform, Vec3d(10, 0, 0)));
+}
+
+
+void
+TestPointMove::testResample()
+{
+    using namespace openvdb;
+    using namespace openvdb::tools;
+
+    math::Transform::Ptr transform(math::Transform::createLinearTransform(1.0));
+
+    std::vector<Vec3s> positions;
+    positions.push_back(Vec3s(1, 1, 1));
+    positions.push_back(Vec3s(2, 1, 1));
+    positions.push_back(Vec3s(3, 1, 1));
+
+    PointDataGrid::Ptr points = createPoints(positions, *transform);
+
+    { // resample to a smaller voxel size
+        math::Transform::Ptr newTransform(math::Transform::createLinearTransform(0.25));
+
+        resamplePoints(*points, *newTransform);
+
+        CPPUNIT_ASSERT(points->transform() == *newTransform);
+        CPPUNIT_ASSERT_EQUAL(pointCount(points->tree()), Index64(3));
+        CPPUNIT_ASSERT_EQUAL(points->tree().activeVoxelCount(), Index64(3));
+        CPPUNIT_ASSERT_EQUAL(points->tree().leafCount(), Index32(2));
+        CPPUNIT_ASSERT(checkPositions(points->tree(), *newTransform, Vec3d(0, 0, 0)));
+    }
+
+    { // resample to a larger voxel size with points sharing voxels
+        math::Transform::Ptr newTransform(math::Transform::createLinearTransform(10.0));
+
+        resamplePoints(*points, *newTransform);
+
+        CPPUNIT_ASSERT_EQUAL(pointCount(points->tree()), Index64(3));
+        CPPUNIT_ASSERT_EQUAL(points->tree().activeVoxelCount(), Index64(1));
+        CPPUNIT_ASSERT(checkPositions(points->tree(), *newTransform, Vec3d(0, 0, 0)));
+    }
+
+    { // resample to a target number of points per voxel
+        std::vector<Vec3s> cube;
+        for (int i = 0; i < 8; i++) {
+            cube.push_back(Vec3s(   (i & 1) ? 1.125f : 0.875f,
+                                    (i & 2) ? 1.125f : 0.875f,
+                                    (i & 4) ? 1.125f : 0.875f));
+        }
+
+        math::Transform::Ptr cubeTransform(math::Transform::createLinearTransform(0.25));
+
+        PointDataGrid::Ptr cubePoints = createPoints(cube, *cubeTransform);
+
+        CPPUNIT_ASSERT_EQUAL(cubePoints->tree().activeVoxelCount(), Index64(8));
+
+        resamplePoints(*cubePoints, /*pointsPerVoxel=*/8.0f);
+
+        CPPUNIT_ASSERT_EQUAL(pointCount(cubePoints->tree()), Index64(8));
+        CPPUNIT_ASSERT_EQUAL(cubePoints->tree().activeVoxelCount(), Index64(1));
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(cubePoints->voxelSize()[0], 0.5, 1e-6);
+
+        CPPUNIT_ASSERT_THROW(resamplePoints(*cubePoints, 0.0f), ValueError);
+    }
+
+    { // resample a lattice of points to the voxel size estimated from its positions
+        std::vector<Vec3s> lattice;
+        for (int i = 0; i < 16; i++) {
+            for (int j = 0; j < 16; j++) {
+                for (int k = 0; k < 16; k++) {
+                    lattice.push_back(Vec3s(0.05f + 0.1f * float(i),
+                                            0.05f + 0.1f * float(j),
+                                            0.05f + 0.1f * float(k)));
+                }
+            }
+        }
+
+        const float voxelSize = computeVoxelSize(PointAttributeVector<Vec3s>(lattice), 8.0f);
+
+        math::Transform::Ptr latticeTransform(math::Transform::createLinearTransform(0.1));
+
+        PointDataGrid::Ptr latticePoints = createPoints(lattice, *latticeTransform);
+
+        resamplePoints(*latticePoints, /*pointsPerVoxel=*/8.0f);
+
+        CPPUNIT_ASSERT_EQUAL(pointCount(latticePoints->tree()), Index64(4096));
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(latticePoints->voxelSize()[0], double(voxelSize), 1e-5);
+        CPPUNIT_ASSERT_EQUAL(latticePoints->tree().activeVoxelCount(), Index64(512));
+    }
+}
+
+
+// Copyright (c) 2015-2016 Double Negative Visual Effects
+// All rights reserved. This software is distributed under the
+// Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
@@ -0,0 +1,322 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2015-2016 Double Negative Visual Effects
+//
+// All rights reserved. This software is distributed under the
+// Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
+//
+// Redistributions of source code must retain the above copyright
+// and license notice and the following restrictions and disclaimer.
+//
+// *     Neither the name of Double Negative Visual Effects nor the names
+// of its contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// IN NO EVENT SHALL THE COPYRIGHT HOLDERS' AND CONTRIBUTORS' AGGREGATE
+// LIABILITY FOR ALL CLAIMS REGARDLESS OF THEIR BASIS EXCEED US$250.00.
+//
+///////////////////////////////////////////////////////////////////////////
+
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <openvdb_points/openvdb.h>
+#include <openvdb_points/tools/PointDataGrid.h>
+#include <openvdb_points/tools/PointConversion.h>
+#include <openvdb_points/tools/PointAttribute.h>
+#include <openvdb_points/tools/PointRasterize.h>
+#include <openvdb_points/tools/AttributeArray.h>
+#include <openvdb/Types.h>
+#include <openvdb/math/Transform.h>
+
+class TestPointRasterize: public CppUnit::TestCase
+{
+public:
+    virtual void setUp() { openvdb::initialize(); openvdb::points::initialize(); }
+    virtual void tearDown() { openvdb::uninitialize(); openvdb::points::uninitialize(); }
+
+    CPPUNIT_TEST_SUITE(TestPointRasterize);
+    CPPUNIT_TEST(testDensity);
+    CPPUNIT_TEST(testSpheres);
+
+    CPPUNIT_TEST_SUITE_END();
+
+    void testDensity();
+    void testSpheres();
+}; // class TestPointRasterize
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TestPointRasterize);
+
+
+////////////////////////////////////////
+
+
+namespace {
+
+    double densitySum(const openvdb::FloatGrid& grid)
+    {
+        double sum = 0.0;
+        for (openvdb::FloatTree::ValueOnCIter iter = grid.tree().cbeginValueOn(); iter; ++iter) {
+            sum += *iter;
+        }
+        return sum;
+    }
+
+} // namespace
+
+
+void
+TestPointRasterize::testDensity()
+{
+    using namespace openvdb;
+    using namespace openvdb::tools;
+
+    typedef TypedAttributeArray<Vec3s>   AttributeVec3s;
+    typedef TypedAttributeArray<float>   AttributeF;
+    typedef TypedAttributeArray<int>     AttributeI;
+
+    const float voxelSize(1.0);
+    math::Transform::Ptr transform(math::Transform::createLinearTransform(voxelSize));
+
+    // six points, two of which share a voxel
+
+    std::vector<Vec3s> positions;
+    positions.push_back(Vec3s(1, 1, 1));
+    positions.push_back(Vec3s(1, 2, 1));
+    positions.push_back(Vec3s(2, 1, 1));
+    positions.push_back(Vec3s(2, 2, 1));
+    positions.push_back(Vec3s(1, 1, 1.2f));
+    positions.push_back(Vec3s(100, 100, 100));
+
+    PointDataGrid::Ptr grid = createPointDataGrid<PointDataGrid>(positions, AttributeVec3s::attributeType(), *transform);
+    PointDataTree& tree = grid->tree();
+
+    { // nearest kernel with matching transform
+        FloatGrid::Ptr density = rasterizeDensity(*grid, *transform);
+
+        CPPUNIT_ASSERT_EQUAL(density->tree().activeVoxelCount(), Index64(5));
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0f, density->tree().getValue(Coord(1, 1, 1)), 1e-6);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0f, density->tree().getValue(Coord(1, 2, 1)), 1e-6);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0f, density->tree().getValue(Coord(100, 100, 100)), 1e-6);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(6.0, densitySum(*density), 1e-6);
+        CPPUNIT_ASSERT_EQUAL(density->getGridClass(), GRID_FOG_VOLUME);
+    }
+
+    { // nearest kernel with a different transform
+        math::Transform::Ptr transform2(math::Transform::createLinearTransform(10.0));
+
+        FloatGrid::Ptr density = rasterizeDensity(*grid, *transform2);
+
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(5.0f, density->tree().getValue(Coord(0, 0, 0)), 1e-6);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0f, density->tree().getValue(Coord(10, 10, 10)), 1e-6);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(6.0, densitySum(*density), 1e-6);
+    }
+
+    { // trilinear and smooth kernels conserve the total weight
+        math::Transform::Ptr transform2(math::Transform::createLinearTransform(0.3));
+
+        FloatGrid::Ptr trilinear = rasterizeDensity(*grid, *transform2, DENSITY_TRILINEAR);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(6.0, densitySum(*trilinear), 1e-4);
+
+        FloatGrid::Ptr smooth = rasterizeDensity(*grid, *transform2, DENSITY_SMOOTH, "", 2.5f);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(6.0, densitySum(*smooth), 1e-4);
+        CPPUNIT_ASSERT(smooth->tree().activeVoxelCount() > trilinear->tree().activeVoxelCount());
+    }
+
+    { // trilinear kernel splits a point between neighboring voxels
+        std::vector<Vec3s> positions2;
+        positions2.push_back(Vec3s(1.5f, 1, 1));
+
+        PointDataGrid::Ptr grid2 = createPointDataGrid<PointDataGrid>(positions2, AttributeVec3s::attributeType(), *transform);
+
+        FloatGrid::Ptr density = rasterizeDensity(*grid2, *transform, DENSITY_TRILINEAR);
+
+        CPPUNIT_ASSERT_EQUAL(density->tree().activeVoxelCount(), Index64(2));
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5f, density->tree().getValue(Coord(1, 1, 1)), 1e-6);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5f, density->tree().getValue(Coord(2, 1, 1)), 1e-6);
+    }
+
+    { // smooth kernel falls off symmetrically with distance
+        std::vector<Vec3s> positions2;
+        positions2.push_back(Vec3s(1, 1, 1));
+
+        PointDataGrid::Ptr grid2 = createPointDataGrid<PointDataGrid>(positions2, AttributeVec3s::attributeType(), *transform);
+
+        FloatGrid::Ptr density = rasterizeDensity(*grid2, *transform, DENSITY_SMOOTH, "", 1.0f);
+
+        CPPUNIT_ASSERT_EQUAL(density->tree().activeVoxelCount(), Index64(1));
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0f, density->tree().getValue(Coord(1, 1, 1)), 1e-6);
+
+        density = rasterizeDensity(*grid2, *transform, DENSITY_SMOOTH, "", 2.0f);
+
+        const float center = density->tree().getValue(Coord(1, 1, 1));
+        const float neighbor = density->tree().getValue(Coord(2, 1, 1));
+
+        CPPUNIT_ASSERT(center > neighbor);
+        CPPUNIT_ASSERT(neighbor > 0.0f);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(neighbor, density->tree().getValue(Coord(1, 0, 1)), 1e-6);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(neighbor, density->tree().getValue(Coord(1, 1, 2)), 1e-6);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, densitySum(*density), 1e-4);
+    }
+
+    { // weight attribute
+        appendAttribute(tree, AttributeSet::Descriptor::NameAndType("weight", AttributeF::attributeType()));
+        appendAttribute(tree, AttributeSet::Descriptor::NameAndType("id", AttributeI::attributeType()));
+
+        for (PointDataTree::LeafIter leafIter = tree.beginLeaf(); leafIter; ++leafIter) {
+            AttributeWriteHandle<float> handle(leafIter->attributeArray("weight"));
+            handle.collapse(2.0f);
+        }
+
+        FloatGrid::Ptr density = rasterizeDensity(*grid, *transform, DENSITY_NEAREST, "weight");
+
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(4.0f, density->tree().getValue(Coord(1, 1, 1)), 1e-6);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(12.0, densitySum(*density), 1e-6);
+
+        density = rasterizeDensity(*grid, *transform, DENSITY_TRILINEAR, "weight");
+
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(12.0, densitySum(*density), 1e-4);
+
+        CPPUNIT_ASSERT_THROW(rasterizeDensity(*grid, *transform, DENSITY_NEAREST, "missing"), KeyError);
+        CPPUNIT_ASSERT_THROW(rasterizeDensity(*grid, *transform, DENSITY_NEAREST, "id"), TypeError);
+        CPPUNIT_ASSERT_THROW(rasterizeDensity(*grid, *transform, DENSITY_SMOOTH, "", 0.0f), ValueError);
+    }
+
+    { // empty grid
+        PointDataGrid::Ptr empty = PointDataGrid::create();
+
+        FloatGrid::Ptr density = rasterizeDensity(*empty, *transform);
+
+        CPPUNIT_ASSERT(density->tree().empty());
+    }
+}
+
+
+void
+TestPointRasterize::testSpheres()
+{
+    using namespace openvdb;
+    using namespace openvdb::tools;
+
+    typedef TypedAttributeArray<Vec3s>   AttributeVec3s;
+    typedef TypedAttributeArray<float>   AttributeF;
+
+    math::Transform::Ptr transform(math::Transform::createLinearTransform(1.0));
+    math::Transform::Ptr transform2(math::Transform::createLinearTransform(0.5));
+
+    std::vector<Vec3s> positions;
+    positions.push_back(Vec3s(0, 0, 0));
+
+    PointDataGrid::Ptr grid = createPointDataGrid<PointDataGrid>(positions, AttributeVec3s::attributeType(), *transform);
+    PointDataTree& tree = grid->tree();
+
+    { // uniform radius
+        FloatGrid::Ptr levelSet = rasterizeSpheres(*grid, *transform2, /*radius=*/2.0f);
+
+        CPPUNIT_ASSERT_EQUAL(levelSet->getGridClass(), GRID_LEVEL_SET);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(1.5f, levelSet->background(), 1e-6);
+
+        const FloatTree& levelSetTree = levelSet->tree();
+
+        // interior beyond the narrow band
+
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(-1.5f, levelSetTree.getValue(Coord(0, 0, 0)), 1e-6);
+        CPPUNIT_ASSERT(!levelSetTree.isValueOn(Coord(0, 0, 0)));
+
+        // narrow band
+
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(-1.0f, levelSetTree.getValue(Coord(2, 0, 0)), 1e-6);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0f, levelSetTree.getValue(Coord(4, 0, 0)), 1e-6);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0f, levelSetTree.getValue(Coord(0, -4, 0)), 1e-6);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0f, levelSetTree.getValue(Coord(0, 0, 6)), 1e-6);
+        CPPUNIT_ASSERT(levelSetTree.isValueOn(Coord(4, 0, 0)));
+
+        // exterior
+
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(1.5f, levelSetTree.getValue(Coord(20, 0, 0)), 1e-6);
+        CPPUNIT_ASSERT(!levelSetTree.isValueOn(Coord(20, 0, 0)));
+    }
+
+    { // radius attribute
+        appendAttribute(tree, AttributeSet::Descriptor::NameAndType("pscale", AttributeF::attributeType()));
+
+        for (PointDataTree::LeafIter leafIter = tree.beginLeaf(); leafIter; ++leafIter) {
+            AttributeWriteHandle<float> handle(leafIter->attributeArray("pscale"));
+            handle.collapse(4.0f);
+        }
+
+        FloatGrid::Ptr levelSet = rasterizeSpheres(*grid, *transform2, /*radius=*/0.5f, "pscale");
+
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0f, levelSet->tree().getValue(Coord(4, 0, 0)), 1e-6);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0f, levelSet->tree().getValue(Coord(0, 0, 6)), 1e-6);
+
+        CPPUNIT_ASSERT_THROW(rasterizeSpheres(*grid, *transform2, 0.5f, "missing"), KeyError);
+        CPPUNIT_ASSERT_THROW(rasterizeSpheres(*grid, *transform2, 0.5f, "", 0.0f), ValueError);
+    }
+
+    { // union of overlapping spheres in different leaves
+        std::vector<Vec3s> positions2;
+        positions2.push_back(Vec3s(0, 0, 0));
+        positions2.push_back(Vec3s(10, 0, 0));
+        positions2.push_back(Vec3s(20, 0, 0));
+
+        PointDataGrid::Ptr grid2 = createPointDataGrid<PointDataGrid>(positions2, AttributeVec3s::attributeType(), *transform);
+
+        FloatGrid::Ptr levelSet = rasterizeSpheres(*grid2, *transform, /*radius=*/6.0f);
+
+        const FloatTree& levelSetTree = levelSet->tree();
+
+        // the point of overlap is inside both spheres
+
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(-1.0f, levelSetTree.getValue(Coord(5, 0, 0)), 1e-6);
+        CPPUNIT_ASSERT(levelSetTree.getValue(Coord(10, 0, 0)) < 0.0f);
+        CPPUNIT_ASSERT(levelSetTree.getValue(Coord(15, 0, 0)) < 0.0f);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0f, levelSetTree.getValue(Coord(26, 0, 0)), 1e-6);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0f, levelSetTree.getValue(Coord(-6, 0, 0)), 1e-6);
+    }
+
+    { // narrow band of one sphere inside the interior of another
+        std::vector<Vec3s> positions2;
+        positions2.push_back(Vec3s(0, 0, 0));
+        positions2.push_back(Vec3s(4, 0, 0));
+
+        PointDataGrid::Ptr grid2 = createPointDataGrid<PointDataGrid>(positions2, AttributeVec3s::attributeType(), *transform);
+
+        FloatGrid::Ptr levelSet = rasterizeSpheres(*grid2, *transform, /*radius=*/10.0f);
+
+        const FloatTree& levelSetTree = levelSet->tree();
+
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(-3.0f, levelSetTree.getValue(Coord(10, 0, 0)), 1e-6);
+        CPPUNIT_ASSERT(!levelSetTree.isValueOn(Coord(10, 0, 0)));
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(-3.0f, levelSetTree.getValue(Coord(-6, 0, 0)), 1e-6);
+        CPPUNIT_ASSERT(!levelSetTree.isValueOn(Coord(-6, 0, 0)));
+
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0f, levelSetTree.getValue(Coord(14, 0, 0)), 1e-6);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0f, levelSetTree.getValue(Coord(-10, 0, 0)), 1e-6);
+
+        // no exterior values remain inside the union
+
+        for (FloatTree::ValueOnCIter iter = levelSetTree.cbeginValueOn(); iter; ++iter) {
+            const Vec3d xyz = iter.getCoord().asVec3d();
+            if (xyz.length() < 7.0 || (xyz - Vec3d(4, 0, 0)).length() < 7.0) {
+                CPPUNIT_ASSERT(*iter < 0.0f);
+            }
+        }
+    }
+}
+
+
+// Copyright (c) 2015-2016 Double Negative Visual Effects
+// All rights reserved. This software is distributed under the
+// Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
@@ -0,0 +1,412 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2015-2016 Double Negative Visual Effects
+//
+// All rights reserved. This software is distributed under the
+// Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
+//
+// Redistributions of source code must retain the above copyright
+// and license notice and the following restrictions and disclaimer.
+//
+// *     Neither the name of Double Negative Visual Effects nor the names
+// of its contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// IN NO EVENT SHALL THE COPYRIGHT HOLDERS' AND CONTRIBUTORS' AGGREGATE
+// LIABILITY FOR ALL CLAIMS REGARDLESS OF THEIR BASIS EXCEED US$250.00.
+//
+///////////////////////////////////////////////////////////////////////////
+
+
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <openvdb_points/openvdb.h>
+#include <openvdb_points/tools/PointDataGrid.h>
+#include <openvdb_points/tools/PointAttribute.h>
+#include <openvdb_points/tools/PointConversion.h>
+#include <openvdb_points/tools/PointRayIntersector.h>
+#include <openvdb_points/tools/AttributeArray.h>
+#include <openvdb/Types.h>
+#include <openvdb/math/Transform.h>
+#include <openvdb/tools/PointIndexGrid.h>
+
+#include <cmath>
+#include <limits>
+
+class TestPointRayIntersector: public CppUnit::TestCase
+{
+public:
+    virtual void setUp() { openvdb::initialize(); openvdb::points::initialize(); }
+    virtual void tearDown() { openvdb::uninitialize(); openvdb::points::uninitialize(); }
+
+    CPPUNIT_TEST_SUITE(TestPointRayIntersector);
+    CPPUNIT_TEST(testIntersect);
+    CPPUNIT_TEST(testPackets);
+    CPPUNIT_TEST(testMotionBlur);
+
+    CPPUNIT_TEST_SUITE_END();
+
+    void testIntersect();
+    void testPackets();
+    void testMotionBlur();
+}; // class TestPointRayIntersector
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TestPointRayIntersector);
+
+
+////////////////////////////////////////
+
+
+namespace {
+
+    typedef openvdb::tools::PointRayIntersector<openvdb::tools::PointDataGrid> PointRayIntersector;
+    typedef PointRayIntersector::RayT RayT;
+
+    openvdb::tools::PointDataGrid::Ptr
+    createPoints(const std::vector<openvdb::Vec3s>& positions, const double voxelSize = 0.5)
+    {
+        using namespace openvdb;
+        using namespace openvdb::tools;
+
+        typedef TypedAttributeArray<Vec3s>   AttributeVec3s;
+
+        math::Transform::Ptr transform(math::Transform::createLinearTransform(voxelSize));
+
+        return createPointDataGrid<PointDataGrid>(positions, AttributeVec3s::attributeType(), *transform);
+    }
+
+    /// Return the distance along the ray to the nearest sphere or -1 if the ray misses
+    double
+    bruteForceIntersect(const std::vector<openvdb::Vec3s>& positions, const RayT& ray, const double radius)
+    {
+        using namespace openvdb;
+
+        double result = std::numeric_limits<double>::max();
+
+        for (size_t i = 0; i < positions.size(); i++) {
+            const Vec3d offset = ray.eye() - Vec3d(positions[i]);
+            const double a = ray.dir().lengthSqr();
+            const double b = offset.dot(ray.dir());
+            const double c = offset.lengthSqr() - radius * radius;
+            const double discriminant = b * b - a * c;
+            if (discriminant < 0.0)     continue;
+            double t = (-b - std::sqrt(discriminant)) / a;
+            if (t < ray.t0())   t = (-b + std::sqrt(discriminant)) / a;
+            if (t >= ray.t0() && t < result)   result = t;
+        }
+
+        return result == std::numeric_limits<double>::max() ? -1.0 : result;
+    }
+
+} // namespace
+
+
+void
+TestPointRayIntersector::testIntersect()
+{
+    using namespace openvdb;
+    using namespace openvdb::tools;
+
+    std::vector<Vec3s> positions;
+    positions.push_back(Vec3s(0, 0, 0));
+    positions.push_back(Vec3s(5, 0, 0));
+    positions.push_back(Vec3s(20, 1, 1));
+
+    PointDataGrid::Ptr points = createPoints(positions);
+
+    { // invalid arguments
+        CPPUNIT_ASSERT_THROW(PointRayIntersector(*points, 0.0), openvdb::ValueError);
+        CPPUNIT_ASSERT_THROW(PointRayIntersector(*points, 0.25, "pscale"), openvdb::KeyError);
+        CPPUNIT_ASSERT_THROW(PointRayIntersector(*points, 0.25, "", "", 1.0, 0.0), openvdb::ValueError);
+    }
+
+    const PointRayIntersector intersector(*points, 0.25);
+
+    CPPUNIT_ASSERT_EQUAL(size_t(3), intersector.leafCount());
+
+    const BBoxd bbox = intersector.worldBBox();
+    CPPUNIT_ASSERT(math::isApproxEqual(bbox.min(), Vec3d(-0.25, -0.25, -0.25)));
+    CPPUNIT_ASSERT(math::isApproxEqual(bbox.max(), Vec3d(20.25, 1.25, 1.25)));
+
+    PointRayIntersector::Hit hit;
+
+    { // nearest of two spheres along the x-axis
+        const RayT ray(Vec3d(-10, 0, 0), Vec3d(1, 0, 0));
+
+        CPPUNIT_ASSERT(intersector.intersectsWS(ray, hit));
+        CPPUNIT_ASSERT(hit.valid());
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(9.75, hit.t, 1e-5);
+        CPPUNIT_ASSERT(math::isApproxEqual(hit.normal, Vec3d(-1, 0, 0), Vec3d(1e-5)));
+    }
+
+    { // reverse direction
+        const RayT ray(Vec3d(10, 0, 0), Vec3d(-1, 0, 0));
+
+        CPPUNIT_ASSERT(intersector.intersectsWS(ray, hit));
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(4.75, hit.t, 1e-5);
+        CPPUNIT_ASSERT(math::isApproxEqual(hit.normal, Vec3d(1, 0, 0), Vec3d(1e-5)));
+    }
+
+    { // unnormalized direction
+        const RayT ray(Vec3d(20, 1, 11), Vec3d(0, 0, -2));
+
+        CPPUNIT_ASSERT(intersector.intersectsWS(ray, hit));
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(4.875, hit.t, 1e-5);
+        CPPUNIT_ASSERT(math::isApproxEqual(hit.normal, Vec3d(0, 0, 1), Vec3d(1e-5)));
+    }
+
+    { // miss
+        const RayT ray(Vec3d(-10, 0.5, 0), Vec3d(1, 0, 0));
+
+        CPPUNIT_ASSERT(!intersector.intersectsWS(ray, hit));
+        CPPUNIT_ASSERT(!hit.valid());
+    }
+
+    { // axis-aligned ray grazing the bounds of a sphere with its eye on the bounding planes
+        const RayT ray(Vec3d(-10, -0.25, 0), Vec3d(1, 0, 0));
+
+        CPPUNIT_ASSERT(intersector.intersectsWS(ray, hit));
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(10.0, hit.t, 1e-5);
+    }
+
+    { // hit beyond the end of the ray
+        const RayT ray(Vec3d(-10, 0, 0), Vec3d(1, 0, 0), math::Delta<double>::value(), 5.0);
+
+        CPPUNIT_ASSERT(!intersector.intersectsWS(ray, hit));
+    }
+
+    { // eye inside a sphere
+        const RayT ray(Vec3d(0, 0, 0), Vec3d(0, 1, 0));
+
+        CPPUNIT_ASSERT(intersector.intersectsWS(ray, hit));
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(0.25, hit.t, 1e-5);
+    }
+
+    { // radius scale attribute
+        typedef TypedAttributeArray<float> AttributeF;
+
+        appendAttribute(points->tree(), AttributeSet::Descriptor::NameAndType("pscale", AttributeF::attributeType()));
+
+        for (PointDataTree::LeafIter leafIter = points->tree().beginLeaf(); leafIter; ++leafIter) {
+            AttributeWriteHandle<float>::Ptr handle =
+                AttributeWriteHandle<float>::create(leafIter->attributeArray("pscale"));
+            for (size_t n = 0; n < handle->size(); n++)  handle->set(n, 2.0f);
+        }
+
+        const PointRayIntersector scaledIntersector(*points, 0.25, "pscale");
+
+        const RayT ray(Vec3d(-10, 0, 0), Vec3d(1, 0, 0));
+
+        CPPUNIT_ASSERT(scaledIntersector.intersectsWS(ray, hit));
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(9.5, hit.t, 1e-5);
+    }
+
+    { // empty grid
+        PointDataGrid::Ptr empty = PointDataGrid::create();
+
+        const PointRayIntersector emptyIntersector(*empty, 0.25);
+
+        CPPUNIT_ASSERT_EQUAL(size_t(0), emptyIntersector.leafCount());
+        CPPUNIT_ASSERT(!emptyIntersector.intersectsWS(RayT(Vec3d(-10, 0, 0), Vec3d(1, 0, 0)), hit));
+    }
+}
+
+
+void
+TestPointRayIntersector::testPackets()
+{
+    using namespace openvdb;
+    using namespace openvdb::tools;
+
+    math::Random01 randNumber(0);
+
+    std::vector<Vec3s> positions;
+    for (int i = 0; i < 2000; i++) {
+        positions.push_back(Vec3s(randNumber(), randNumber(), randNumber()) * 20.0f);
+    }
+
+    PointDataGrid::Ptr points = createPoints(positions);
+
+    const double radius = 0.2;
+
+    const PointRayIntersector intersector(*points, radius);
+
+    // rays from outside the points towards random targets
+
+    std::vector<RayT> rays;
+    for (int i = 0; i < 203; i++) {
+        const Vec3d eye = Vec3d(randNumber(), randNumber(), randNumber()) * 40.0 - Vec3d(10.0);
+        const Vec3d target = Vec3d(randNumber(), randNumber(), randNumber()) * 20.0;
+        rays.push_back(RayT(eye, (target - eye).unit()));
+    }
+
+    std::vector<PointRayIntersector::Hit> hits;
+    intersector.intersectsWS(rays, hits);
+
+    CPPUNIT_ASSERT_EQUAL(rays.size(), hits.size());
+
+    int hitCount = 0;
+
+    for (size_t i = 0; i < rays.size(); i++) {
+
+        const double expected = bruteForceIntersect(positions, rays[i], radius);
+
+        // single ray
+
+        PointRayIntersector::Hit hit;
+        const bool result = intersector.intersectsWS(rays[i], hit);
+
+        CPPUNIT_ASSERT_EQUAL(expected >= 0.0, result);
+        CPPUNIT_ASSERT_EQUAL(expected >= 0.0, hits[i].valid());
+
+        if (!result)    continue;
+
+        hitCount++;
+
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(expected, hit.t, 1e-4);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(expected, hits[i].t, 1e-4);
+        CPPUNIT_ASSERT_EQUAL(hit.leaf, hits[i].leaf);
+        CPPUNIT_ASSERT_EQUAL(hit.index, hits[i].index);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, hit.normal.length(), 1e-5);
+    }
+
+    CPPUNIT_ASSERT(hitCount > 0);
+
+    { // partial packet of four rays
+        PointRayIntersector::Hit packetHits[4];
+
+        const Index32 mask = intersector.intersectsWS<4>(&rays[0], packetHits, NULL, 3);
+
+        for (Index r = 0; r < 3; r++) {
+            CPPUNIT_ASSERT_EQUAL(hits[r].valid(), bool(mask & (1 << r)));
+            CPPUNIT_ASSERT_EQUAL(hits[r].leaf, packetHits[r].leaf);
+            CPPUNIT_ASSERT_EQUAL(hits[r].index, packetHits[r].index);
+        }
+
+        CPPUNIT_ASSERT(!(mask & (1 << 3)));
+    }
+}
+
+
+void
+TestPointRayIntersector::testMotionBlur()
+{
+    using namespace openvdb;
+    using namespace openvdb::tools;
+
+    typedef TypedAttributeArray<Vec3s>   AttributeVec3s;
+
+    math::Transform::Ptr transform(math::Transform::createLinearTransform(0.5));
+
+    std::vector<Vec3s> positions;
+    positions.push_back(Vec3s(0, 0, 0));
+
+    const PointAttributeVector<Vec3s> pointList(positions);
+
+    PointIndexGrid::Ptr pointIndexGrid =
+        openvdb::tools::createPointIndexGrid<PointIndexGrid>(pointList, *transform);
+
+    PointDataGrid::Ptr points = createPointDataGrid<PointDataGrid>(*pointIndexGrid, pointList,
+                                                                   AttributeVec3s::attributeType(), *transform);
+
+    appendAttribute(points->tree(), AttributeSet::Descriptor::NameAndType("v", AttributeVec3s::attributeType()));
+
+    // the point moves four units along the y-axis per unit time
+
+    std::vector<Vec3s> velocities;
+    velocities.push_back(Vec3s(0, 4, 0));
+
+    populateAttribute(points->tree(), pointIndexGrid->tree(), "v", PointAttributeVector<Vec3s>(velocities));
+
+    CPPUNIT_ASSERT_THROW(PointRayIntersector(*points, 0.25, "", "velocity", 0.0, 1.0), openvdb::KeyError);
+
+    const PointRayIntersector intersector(*points, 0.25, "", "v", -0.5, 0.5);
+
+    const BBoxd bbox = intersector.worldBBox();
+    CPPUNIT_ASSERT(math::isApproxEqual(bbox.min(), Vec3d(-0.25, -2.25, -0.25)));
+    CPPUNIT_ASSERT(math::isApproxEqual(bbox.max(), Vec3d(0.25, 2.25, 0.25)));
+
+    PointRayIntersector::Hit hit;
+
+    const RayT ray0(Vec3d(-10, 0, 0), Vec3d(1, 0, 0));
+    const RayT ray1(Vec3d(-10, 1, 0), Vec3d(1, 0, 0));
+
+    CPPUNIT_ASSERT(intersector.intersectsWS(ray0, hit, 0.0));
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(9.75, hit.t, 1e-5);
+    CPPUNIT_ASSERT(!intersector.intersectsWS(ray1, hit, 0.0));
+
+    CPPUNIT_ASSERT(!intersector.intersectsWS(ray0, hit, 0.25));
+    CPPUNIT_ASSERT(intersector.intersectsWS(ray1, hit, 0.25));
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(9.75, hit.t, 1e-5);
+
+    // times outside of the shutter interval are clamped
+
+    CPPUNIT_ASSERT(intersector.intersectsWS(RayT(Vec3d(-10, 2, 0), Vec3d(1, 0, 0)), hit, 1.0));
+    CPPUNIT_ASSERT(!intersector.intersectsWS(RayT(Vec3d(-10, 3, 0), Vec3d(1, 0, 0)), hit, 1.0));
+
+    { // parallel intersection with per-ray times
+        std::vector<RayT> rays;
+        rays.push_back(ray0);
+        rays.push_back(ray1);
+        rays.push_back(ray0);
+        rays.push_back(ray1);
+
+        std::vector<double> times;
+        times.push_back(0.0);
+        times.push_back(0.0);
+        times.push_back(0.25);
+        times.push_back(0.25);
+
+        std::vector<PointRayIntersector::Hit> hits;
+        intersector.intersectsWS(rays, hits, times);
+
+        CPPUNIT_ASSERT(hits[0].valid());
+        CPPUNIT_ASSERT(!hits[1].valid());
+        CPPUNIT_ASSERT(!hits[2].valid());
+        CPPUNIT_ASSERT(hits[3].valid());
+
+        times.pop_back();
+        CPPUNIT_ASSERT_THROW(intersector.intersectsWS(rays, hits, times), openvdb::ValueError);
+    }
+
+    { // world-space velocities with a rotated transform
+        math::Transform::Ptr rotated(math::Transform::createLinearTransform(0.5));
+        rotated->postRotate(M_PI / 2.0, math::Z_AXIS);
+
+        PointIndexGrid::Ptr rotatedIndexGrid =
+            openvdb::tools::createPointIndexGrid<PointIndexGrid>(pointList, *rotated);
+
+        PointDataGrid::Ptr rotatedPoints = createPointDataGrid<PointDataGrid>(*rotatedIndexGrid, pointList,
+                                                                       AttributeVec3s::attributeType(), *rotated);
+
+        appendAttribute(rotatedPoints->tree(),
+            AttributeSet::Descriptor::NameAndType("v", AttributeVec3s::attributeType()));
+
+        populateAttribute(rotatedPoints->tree(), rotatedIndexGrid->tree(), "v",
+            PointAttributeVector<Vec3s>(velocities));
+
+        const PointRayIntersector rotatedIntersector(*rotatedPoints, 0.25, "", "v", -0.5, 0.5);
+
+        CPPUNIT_ASSERT(rotatedIntersector.intersectsWS(ray0, hit, 0.0));
+        CPPUNIT_ASSERT(!rotatedIntersector.intersectsWS(ray0, hit, 0.25));
+        CPPUNIT_ASSERT(rotatedIntersector.intersectsWS(ray1, hit, 0.25));
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(9.75, hit.t, 1e-5);
+    }
+}
+
+
+// Copyright (c) 2015-2016 Double Negative Visual Effects
+// All rights reserved. This software is distributed under the
+// Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
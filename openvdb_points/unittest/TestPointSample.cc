@@ -0,0 +1,194 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2015-2016 Double Negative Visual Effects
+//
+// All rights reserved. This software is distributed under the
+// Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
+//
+// Redistributions of source code must retain the above copyright
+// and license notice and the following restrictions and disclaimer.
+//
+// *     Neither the name of Double Negative Visual Effects nor the names
+// of its contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// IN NO EVENT SHALL THE COPYRIGHT HOLDERS' AND CONTRIBUTORS' AGGREGATE
+// LIABILITY FOR ALL CLAIMS REGARDLESS OF THEIR BASIS EXCEED US$250.00.
+//
+///////////////////////////////////////////////////////////////////////////
+
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <openvdb_points/openvdb.h>
+#include <openvdb_points/tools/PointDataGrid.h>
+#include <openvdb_points/tools/PointConversion.h>
+#include <openvdb_points/tools/PointGroup.h>
+#include <openvdb_points/tools/PointSample.h>
+#include <openvdb_points/tools/AttributeArray.h>
+#include <openvdb/Types.h>
+#include <openvdb/math/Transform.h>
+#include <openvdb/tools/Interpolation.h>
+
+class TestPointSample: public CppUnit::TestCase
+{
+public:
+    virtual void setUp() { openvdb::initialize(); openvdb::points::initialize(); }
+    virtual void tearDown() { openvdb::uninitialize(); openvdb::points::uninitialize(); }
+
+    CPPUNIT_TEST_SUITE(TestPointSample);
+    CPPUNIT_TEST(testSample);
+
+    CPPUNIT_TEST_SUITE_END();
+
+    void testSample();
+}; // class TestPointSample
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TestPointSample);
+
+
+////////////////////////////////////////
+
+
+namespace {
+
+    template <typename ValueType>
+    ValueType attributeSum(const openvdb::tools::PointDataTree& tree, const openvdb::Name& name)
+    {
+        using namespace openvdb::tools;
+
+        ValueType sum = openvdb::zeroVal<ValueType>();
+
+        for (PointDataTree::LeafCIter leafIter = tree.cbeginLeaf(); leafIter; ++leafIter) {
+            AttributeHandle<ValueType> handle(leafIter->constAttributeArray(name));
+            for (PointDataTree::LeafNodeType::IndexOnIter iter = leafIter->beginIndexOn(); iter; ++iter) {
+                sum += handle.get(openvdb::Index(*iter));
+            }
+        }
+
+        return sum;
+    }
+
+} // namespace
+
+
+void
+TestPointSample::testSample()
+{
+    using namespace openvdb;
+    using namespace openvdb::tools;
+
+    typedef TypedAttributeArray<Vec3s>   AttributeVec3s;
+    typedef TypedAttributeArray<int>     AttributeI;
+
+    const float voxelSize(1.0);
+    math::Transform::Ptr transform(math::Transform::createLinearTransform(voxelSize));
+
+    std::vector<Vec3s> positions;
+    positions.push_back(Vec3s(1, 1, 1));
+    positions.push_back(Vec3s(2, 1, 1));
+    positions.push_back(Vec3s(3, 1, 1));
+    positions.push_back(Vec3s(10.5f, 1, 1));
+
+    const PointAttributeVector<Vec3s> pointList(positions);
+
+    PointIndexGrid::Ptr pointIndexGrid =
+        openvdb::tools::createPointIndexGrid<PointIndexGrid>(pointList, *transform);
+
+    PointDataGrid::Ptr points = createPointDataGrid<PointDataGrid>(*pointIndexGrid, pointList,
+                                                                   AttributeVec3s::attributeType(), *transform);
+    PointDataTree& tree = points->tree();
+
+    // scalar grid with values matching the x coordinate
+
+    FloatGrid::Ptr grid = FloatGrid::create(0.0f);
+
+    {
+        FloatGrid::Accessor accessor = grid->getAccessor();
+        for (int x = -2; x < 30; x++) {
+            for (int y = -2; y < 4; y++) {
+                for (int z = -2; z < 4; z++) {
+                    accessor.setValue(Coord(x, y, z), float(x));
+                }
+            }
+        }
+    }
+
+    { // point sampler
+        sampleGrid<PointSampler>(*points, *grid, "point");
+
+        CPPUNIT_ASSERT(tree.cbeginLeaf()->attributeSet().descriptor().find("point") !=
+            AttributeSet::INVALID_POS);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(17.0f, attributeSum<float>(tree, "point"), 1e-6);
+    }
+
+    { // box and quadratic samplers reproduce a linear field
+        sampleGrid(*points, *grid, "box");
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(16.5f, attributeSum<float>(tree, "box"), 1e-5);
+
+        sampleGrid<QuadraticSampler>(*points, *grid, "quadratic");
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(16.5f, attributeSum<float>(tree, "quadratic"), 1e-5);
+    }
+
+    { // sampling respects a different grid transform
+        FloatGrid::Ptr grid2 = grid->deepCopy();
+        grid2->setTransform(math::Transform::createLinearTransform(0.5));
+
+        sampleGrid(*points, *grid2, "scaled");
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(33.0f, attributeSum<float>(tree, "scaled"), 1e-5);
+    }
+
+    { // vector grid with a staggered sampler
+        Vec3SGrid::Ptr vectorGrid = Vec3SGrid::create(Vec3s(1, 2, 3));
+
+        sampleGrid<StaggeredBoxSampler>(*points, *vectorGrid, "vector");
+
+        const Vec3s sum = attributeSum<Vec3s>(tree, "vector");
+
+        CPPUNIT_ASSERT(math::isApproxEqual(sum, Vec3s(4, 8, 12)));
+    }
+
+    { // group filtering retains values of points that are not sampled
+        appendGroup(tree, "a");
+
+        std::vector<short> membership;
+        membership.push_back(short(1));
+        membership.push_back(short(0));
+        membership.push_back(short(0));
+        membership.push_back(short(1));
+
+        setGroup(tree, pointIndexGrid->tree(), membership, "a");
+
+        std::vector<Name> includeGroups;
+        std::vector<Name> excludeGroups;
+        includeGroups.push_back("a");
+
+        sampleGrid(*points, *grid, "group", includeGroups, excludeGroups);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(11.5f, attributeSum<float>(tree, "group"), 1e-5);
+
+        sampleGrid(*points, *grid, "group", excludeGroups, includeGroups);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(16.5f, attributeSum<float>(tree, "group"), 1e-5);
+    }
+
+    { // mis-matching attribute type
+        appendAttribute(tree, AttributeSet::Descriptor::NameAndType("id", AttributeI::attributeType()));
+
+        CPPUNIT_ASSERT_THROW(sampleGrid(*points, *grid, "id"), TypeError);
+    }
+}
+
+
+// Copyright (c) 2015-2016 Double Negative Visual Effects
+// All rights reserved. This software is distributed under the
+// Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
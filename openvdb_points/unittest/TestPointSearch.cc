@@ -0,0 +1,251 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2015-2016 Double Negative Visual Effects
+//
+// All rights reserved. This software is distributed under the
+// Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
+//
+// Redistributions of source code must retain the above copyright
+// and license notice and the following restrictions and disclaimer.
+//
+// *     Neither the name of Double Negative Visual Effects nor the names
+// of its contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// IN NO EVENT SHALL THE COPYRIGHT HOLDERS' AND CONTRIBUTORS' AGGREGATE
+// LIABILITY FOR ALL CLAIMS REGARDLESS OF THEIR BASIS EXCEED US$250.00.
+//
+///////////////////////////////////////////////////////////////////////////
+
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <openvdb_points/openvdb.h>
+#include <openvdb_points/tools/PointDataGrid.h>
+#include <openvdb_points/tools/PointConversion.h>
+#include <openvdb_points/tools/PointSearch.h>
+#include <openvdb_points/tools/AttributeArray.h>
+#include <openvdb/Types.h>
+#include <openvdb/math/Transform.h>
+
+#include <algorithm>
+
+class TestPointSearch: public CppUnit::TestCase
+{
+public:
+    virtual void setUp() { openvdb::initialize(); openvdb::points::initialize(); }
+    virtual void tearDown() { openvdb::uninitialize(); openvdb::points::uninitialize(); }
+
+    CPPUNIT_TEST_SUITE(TestPointSearch);
+    CPPUNIT_TEST(testRadius);
+    CPPUNIT_TEST(testNearest);
+
+    CPPUNIT_TEST_SUITE_END();
+
+    void testRadius();
+    void testNearest();
+}; // class TestPointSearch
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TestPointSearch);
+
+
+////////////////////////////////////////
+
+
+namespace {
+
+    typedef openvdb::tools::PointSearch<openvdb::tools::PointDataGrid> PointSearch;
+
+    std::vector<openvdb::Vec3s>
+    randomPositions(const int count)
+    {
+        openvdb::math::Random01 randNumber(0);
+
+        std::vector<openvdb::Vec3s> positions;
+        for (int i = 0; i < count; i++) {
+            positions.push_back(openvdb::Vec3s(randNumber(), randNumber(), randNumber()) * 10.0f);
+        }
+
+        return positions;
+    }
+
+    openvdb::tools::PointDataGrid::Ptr
+    createPoints(const std::vector<openvdb::Vec3s>& positions)
+    {
+        using namespace openvdb;
+        using namespace openvdb::tools;
+
+        typedef TypedAttributeArray<Vec3s>   AttributeVec3s;
+
+        math::Transform::Ptr transform(math::Transform::createLinearTransform(0.5));
+
+        return createPointDataGrid<PointDataGrid>(positions, AttributeVec3s::attributeType(), *transform);
+    }
+
+    /// Return the sorted squared distances of all positions to a query position
+    std::vector<double>
+    bruteForceDistances(const std::vector<openvdb::Vec3s>& positions, const openvdb::Vec3d& query)
+    {
+        std::vector<double> distances;
+        for (size_t i = 0; i < positions.size(); i++) {
+            distances.push_back((openvdb::Vec3d(positions[i]) - query).lengthSqr());
+        }
+        std::sort(distances.begin(), distances.end());
+        return distances;
+    }
+
+} // namespace
+
+
+void
+TestPointSearch::testRadius()
+{
+    using namespace openvdb;
+    using namespace openvdb::tools;
+
+    const std::vector<Vec3s> positions = randomPositions(2000);
+
+    PointDataGrid::Ptr points = createPoints(positions);
+
+    const PointSearch search(*points);
+
+    std::vector<Vec3d> queries;
+    queries.push_back(Vec3d(5, 5, 5));
+    queries.push_back(Vec3d(0, 0, 0));
+    queries.push_back(Vec3d(9.5, 2.25, 7.75));
+    queries.push_back(Vec3d(20, 20, 20));
+
+    const double radius = 1.3;
+
+    for (size_t i = 0; i < queries.size(); i++) {
+
+        std::vector<double> distances = bruteForceDistances(positions, queries[i]);
+        distances.erase(std::upper_bound(distances.begin(), distances.end(), radius * radius), distances.end());
+
+        PointSearch::NeighbourList neighbours;
+        search.searchRadius(queries[i], radius, neighbours);
+
+        CPPUNIT_ASSERT_EQUAL(distances.size(), neighbours.size());
+
+        for (size_t j = 0; j < neighbours.size(); j++) {
+
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(distances[j], neighbours[j].distanceSqr, 1e-5);
+
+            // read the position attribute directly from the handle
+
+            AttributeHandle<Vec3f> positionHandle(neighbours[j].leaf->constAttributeArray("P"));
+            CPPUNIT_ASSERT(positionHandle.get(neighbours[j].index).x() >= -0.5f);
+
+            const Vec3d position = search.worldPosition(neighbours[j]);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(distances[j], (position - queries[i]).lengthSqr(), 1e-5);
+        }
+    }
+
+    // batch queries match individual queries
+
+    std::vector<PointSearch::NeighbourList> batch;
+    search.searchRadius(queries, radius, batch);
+
+    CPPUNIT_ASSERT_EQUAL(batch.size(), queries.size());
+
+    for (size_t i = 0; i < queries.size(); i++) {
+        PointSearch::NeighbourList neighbours;
+        search.searchRadius(queries[i], radius, neighbours);
+        CPPUNIT_ASSERT_EQUAL(neighbours.size(), batch[i].size());
+        for (size_t j = 0; j < neighbours.size(); j++) {
+            CPPUNIT_ASSERT_EQUAL(neighbours[j].leaf, batch[i][j].leaf);
+            CPPUNIT_ASSERT_EQUAL(neighbours[j].index, batch[i][j].index);
+        }
+    }
+
+    { // empty grid
+        PointDataGrid::Ptr empty = PointDataGrid::create();
+        const PointSearch emptySearch(*empty);
+
+        PointSearch::NeighbourList neighbours;
+        emptySearch.searchRadius(Vec3d(0, 0, 0), 10.0, neighbours);
+        CPPUNIT_ASSERT(neighbours.empty());
+    }
+
+    { // non-uniform scale
+        math::Mat4d matrix = math::Mat4d::identity();
+        matrix.preScale(Vec3d(1, 2, 3));
+
+        points->setTransform(math::Transform::createLinearTransform(matrix));
+
+        CPPUNIT_ASSERT_THROW(PointSearch invalidSearch(*points), ValueError);
+    }
+}
+
+
+void
+TestPointSearch::testNearest()
+{
+    using namespace openvdb;
+    using namespace openvdb::tools;
+
+    const std::vector<Vec3s> positions = randomPositions(2000);
+
+    PointDataGrid::Ptr points = createPoints(positions);
+
+    const PointSearch search(*points, /*cacheSize=*/4);
+
+    std::vector<Vec3d> queries;
+    queries.push_back(Vec3d(5, 5, 5));
+    queries.push_back(Vec3d(0.1, 9.9, 0.1));
+    queries.push_back(Vec3d(-30, 5, 5));
+
+    const size_t ks[] = { 1, 7, 100 };
+
+    for (size_t i = 0; i < queries.size(); i++) {
+
+        const std::vector<double> distances = bruteForceDistances(positions, queries[i]);
+
+        for (size_t n = 0; n < 3; n++) {
+
+            PointSearch::NeighbourList neighbours;
+            search.searchNearest(queries[i], ks[n], neighbours);
+
+            CPPUNIT_ASSERT_EQUAL(ks[n], neighbours.size());
+
+            for (size_t j = 0; j < neighbours.size(); j++) {
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(distances[j], neighbours[j].distanceSqr, 1e-3);
+            }
+        }
+    }
+
+    { // more neighbours requested than points in the grid
+        PointSearch::NeighbourList neighbours;
+        search.searchNearest(Vec3d(5, 5, 5), 5000, neighbours);
+        CPPUNIT_ASSERT_EQUAL(positions.size(), neighbours.size());
+    }
+
+    { // batch queries
+        std::vector<PointSearch::NeighbourList> batch;
+        search.searchNearest(queries, 7, batch);
+
+        CPPUNIT_ASSERT_EQUAL(batch.size(), queries.size());
+
+        for (size_t i = 0; i < queries.size(); i++) {
+            CPPUNIT_ASSERT_EQUAL(size_t(7), batch[i].size());
+            const std::vector<double> distances = bruteForceDistances(positions, queries[i]);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(distances[6], batch[i][6].distanceSqr, 1e-3);
+        }
+    }
+}
+
+
+// Copyright (c) 2015-2016 Double Negative Visual Effects
+// All rights reserved. This software is distributed under the
+// Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
@@ -68,6 +68,9 @@ enum COMPRESSION_TYPE
     NONE = 0,
     TRUNCATE_16,
     UNIT_VECTOR,
+    OCTAHEDRAL_16,
+    OCTAHEDRAL_32,
+    SMALLEST_THREE,
     FIXED_POSITION_16,
     FIXED_POSITION_8
 };
@@ -153,10 +156,8 @@ attrTypeFromGAAttribute(GA_Attribute const * attribute, const int compression =
             return TypedAttributeArray<Vec2<double> >::attributeType();
         }
     }
-    else if (width == 3 || width == 4)
+    else if (width == 3)
     {
-        // note: process 4-component vectors as 3-component vectors for now
-
         if (storage == GA_STORE_REAL16) {
             return TypedAttributeArray<Vec3<half> >::attributeType();
         }
@@ -171,11 +172,49 @@ attrTypeFromGAAttribute(GA_Attribute const * attribute, const int compression =
             else if (compression == UNIT_VECTOR) {
                 return TypedAttributeArray<Vec3<float>, UnitVecAttributeCodec>::attributeType();
             }
+            else if (compression == OCTAHEDRAL_16) {
+                return TypedAttributeArray<Vec3<float>, OctahedralAttributeCodec<uint16_t> >::attributeType();
+            }
+            else if (compression == OCTAHEDRAL_32) {
+                return TypedAttributeArray<Vec3<float>, OctahedralAttributeCodec<uint32_t> >::attributeType();
+            }
         }
         else if (storage == GA_STORE_REAL64) {
             return TypedAttributeArray<Vec3<double> >::attributeType();
         }
     }
+    else if (width == 4)
+    {
+        // note: half-precision 4-component attributes are promoted to single-precision
+
+        const bool quaternion = attribute->getTypeInfo() == GA_TYPE_QUATERNION;
+
+        if (storage == GA_STORE_REAL16 || storage == GA_STORE_REAL32)
+        {
+            if (!quaternion) {
+                return TypedAttributeArray<Vec4<float> >::attributeType();
+            }
+            else if (compression == SMALLEST_THREE) {
+                return TypedAttributeArray<Quat<float>, SmallestThreeAttributeCodec>::attributeType();
+            }
+            else {
+                return TypedAttributeArray<Quat<float> >::attributeType();
+            }
+        }
+        else if (storage == GA_STORE_REAL64) {
+            if (!quaternion)    return TypedAttributeArray<Vec4<double> >::attributeType();
+            else                return TypedAttributeArray<Quat<double> >::attributeType();
+        }
+    }
+    else if (width == 9)
+    {
+        if (storage == GA_STORE_REAL16 || storage == GA_STORE_REAL32) {
+            return TypedAttributeArray<Mat3<float> >::attributeType();
+        }
+        else if (storage == GA_STORE_REAL64) {
+            return TypedAttributeArray<Mat3<double> >::attributeType();
+        }
+    }
 
     std::stringstream ss; ss << "Unknown attribute type - " << attribute->getName();
     throw std::runtime_error(ss.str());
@@ -216,14 +255,26 @@ attrStringTypeFromGAAttribute(GA_Attribute const * attribute)
         else if (storage == GA_STORE_REAL32)    return "vec2s";
         else if (storage == GA_STORE_REAL64)    return "vec2d";
     }
-    else if (width == 3 || width == 4)
+    else if (width == 3)
     {
-        // note: process 4-component vectors as 3-component vectors for now
-
         if (storage == GA_STORE_REAL16)         return "vec3h";
         else if (storage == GA_STORE_REAL32)    return "vec3s";
         else if (storage == GA_STORE_REAL64)    return "vec3d";
     }
+    else if (width == 4)
+    {
+        const bool quaternion = attribute->getTypeInfo() == GA_TYPE_QUATERNION;
+
+        if (storage == GA_STORE_REAL16 ||
+            storage == GA_STORE_REAL32)         return quaternion ? "quats" : "vec4s";
+        else if (storage == GA_STORE_REAL64)    return quaternion ? "quatd" : "vec4d";
+    }
+    else if (width == 9)
+    {
+        if (storage == GA_STORE_REAL16 ||
+            storage == GA_STORE_REAL32)         return "mat3s";
+        else if (storage == GA_STORE_REAL64)    return "mat3d";
+    }
 
     std::stringstream ss; ss << "Unknown attribute type - " << attribute->getName();
     throw std::runtime_error(ss.str());
@@ -300,10 +351,8 @@ defaultMetadataFromGAAttribute(GA_Attribute const * attribute)
             return defaultMetadataFromGADefault<Vec2<double> >(defaults);
         }
     }
-    else if (width == 3 || width == 4)
+    else if (width == 3)
     {
-        // note: process 4-component vectors as 3-component vectors for now
-
         if (storage == GA_STORE_REAL16) {
             return defaultMetadataFromGADefault<Vec3<half> >(defaults);
         }
@@ -314,6 +363,12 @@ defaultMetadataFromGAAttribute(GA_Attribute const * attribute)
             return defaultMetadataFromGADefault<Vec3<double> >(defaults);
         }
     }
+    else if (width == 4 || width == 9)
+    {
+        // note: default values are not stored for 4-component and matrix attributes
+
+        return Metadata::Ptr();
+    }
 
     std::stringstream ss; ss << "Unknown attribute type - " << attribute->getName();
     throw std::runtime_error(ss.str());
@@ -380,32 +435,35 @@ createPointDataGrid(const GU_Detail& ptGeo, const openvdb::NamePair& positionAtt
 
     appendGroups(tree, groupNames);
 
-    // Set group membership in tree
+    // Set group membership in tree (packed into one bit per group for each point)
 
     const int64_t numPoints = ptGeo.getNumPoints();
-    std::vector<short> inGroup(numPoints, short(0));
+    const size_t bytesPerPoint = (groupNames.size() + 7) / 8;
+    std::vector<GroupType> inGroups(numPoints * bytesPerPoint, GroupType(0));
+
+    size_t groupIndex = 0;
 
     for (GA_ElementGroupTable::iterator it = elementGroups.beginTraverse(),
-                                        itEnd = elementGroups.endTraverse(); it != itEnd; ++it)
+                                        itEnd = elementGroups.endTraverse(); it != itEnd; ++it, ++groupIndex)
     {
         // insert group offsets
 
+        const size_t byte = groupIndex >> 3;
+        const GroupType bit = GroupType(1) << (groupIndex & 7);
+
         GA_Offset start, end;
         GA_Range range(**it);
         for (GA_Iterator rangeIt = range.begin(); rangeIt.blockAdvance(start, end); ) {
             end = std::min(end, numPoints);
             for (GA_Offset off = start; off < end; ++off) {
                 assert(off < numPoints);
-                inGroup[off] = short(1);
+                inGroups[off * bytesPerPoint + byte] |= bit;
             }
         }
-
-        const Name groupName = (*it)->getName().toStdString();
-        setGroup(tree, indexTree, inGroup, groupName);
-
-        std::fill(inGroup.begin(), inGroup.end(), short(0));
     }
 
+    setGroups(tree, indexTree, inGroups, groupNames);
+
     // Add other attributes to PointDataGrid
 
     for (AttributeInfoVec::const_iterator it = attributes.begin(),
@@ -489,6 +547,30 @@ createPointDataGrid(const GU_Detail& ptGeo, const openvdb::NamePair& positionAtt
             hvdbp::HoudiniReadAttribute<Vec3<double> > attribute(*gaAttribute, offsets);
             populateAttribute(tree, indexTree, name, attribute);
         }
+        else if (type == "vec4s") {
+            hvdbp::HoudiniReadAttribute<Vec4<float> > attribute(*gaAttribute, offsets);
+            populateAttribute(tree, indexTree, name, attribute);
+        }
+        else if (type == "vec4d") {
+            hvdbp::HoudiniReadAttribute<Vec4<double> > attribute(*gaAttribute, offsets);
+            populateAttribute(tree, indexTree, name, attribute);
+        }
+        else if (type == "quats") {
+            hvdbp::HoudiniReadAttribute<Quat<float> > attribute(*gaAttribute, offsets);
+            populateAttribute(tree, indexTree, name, attribute);
+        }
+        else if (type == "quatd") {
+            hvdbp::HoudiniReadAttribute<Quat<double> > attribute(*gaAttribute, offsets);
+            populateAttribute(tree, indexTree, name, attribute);
+        }
+        else if (type == "mat3s") {
+            hvdbp::HoudiniReadAttribute<Mat3<float> > attribute(*gaAttribute, offsets);
+            populateAttribute(tree, indexTree, name, attribute);
+        }
+        else if (type == "mat3d") {
+            hvdbp::HoudiniReadAttribute<Mat3<double> > attribute(*gaAttribute, offsets);
+            populateAttribute(tree, indexTree, name, attribute);
+        }
         else {
             throw std::runtime_error("Unknown Attribute Type for Conversion: " + type);
         }
@@ -649,6 +731,16 @@ newSopOperator(OP_OperatorTable* table)
         .setDefault("points")
         .setHelpText("Output grid name."));
 
+    parms.add(hutil::ParmFactory(PRM_TOGGLE, "computevoxelsize", "Compute Voxel Size")
+        .setDefault(PRMzeroDefaults)
+        .setHelpText("Compute the voxel size from a target number of points per voxel."));
+
+    parms.add(hutil::ParmFactory(PRM_FLT_J, "pointspervoxel", "Points Per Voxel")
+        .setDefault(8.0f)
+        .setHelpText("The target average number of points per active voxel of the new "
+            "VDB Points grid when computing the voxel size.")
+        .setRange(PRM_RANGE_RESTRICTED, 1, PRM_RANGE_UI, 64));
+
     parms.add(hutil::ParmFactory(PRM_FLT_J, "voxelsize", "Voxel Size")
         .setDefault(PRMpointOneDefaults)
         .setHelpText("The desired voxel size of the new VDB Points grid.")
@@ -703,13 +795,17 @@ newSopOperator(OP_OperatorTable* table)
         .setSpareData(&SOP_Node::theFirstInput)
         .setHelpText("Select a point attribute to transfer. "
             "Supports integer and floating point attributes of "
-            "arbitrary precisions and tuple sizes."));
+            "arbitrary precisions and tuple sizes, quaternions "
+            "and 3x3 matrices."));
 
     {
         const char* items[] = {
             "none", "None",
             "truncate", "16-bit Truncate",
             UnitVecAttributeCodec::name(), "Unit Vector",
+            "oct16", "16-bit Octahedral Unit Vector",
+            "oct32", "32-bit Octahedral Unit Vector",
+            SmallestThreeAttributeCodec::name(), "32-bit Smallest Three Quaternion",
             NULL
         };
 
@@ -782,7 +878,15 @@ SOP_OpenVDB_Points::updateParmsFlags()
     changed |= enableParm("refvdb", refexists);
     changed |= setVisibleState("refvdb", toVdbPoints);
 
-    changed |= enableParm("voxelsize", !refexists && toVdbPoints);
+    const bool computeVoxelSize = evalInt("computevoxelsize", 0, 0) != 0;
+
+    changed |= enableParm("computevoxelsize", !refexists && toVdbPoints);
+    changed |= setVisibleState("computevoxelsize", toVdbPoints);
+
+    changed |= enableParm("pointspervoxel", !refexists && toVdbPoints && computeVoxelSize);
+    changed |= setVisibleState("pointspervoxel", toVdbPoints);
+
+    changed |= enableParm("voxelsize", !refexists && toVdbPoints && !computeVoxelSize);
     changed |= setVisibleState("voxelsize", toVdbPoints);
 
     changed |= setVisibleState("transferHeading", toVdbPoints);
@@ -878,6 +982,24 @@ SOP_OpenVDB_Points::cookMySop(OP_Context& context)
         }
         else {
             float voxelSize = evalFloat("voxelsize", 0, time);
+
+            if (evalInt("computevoxelsize", 0, time)) {
+
+                const float pointsPerVoxel = evalFloat("pointspervoxel", 0, time);
+
+                hvdbp::OffsetListPtr offsets;
+                hvdbp::HoudiniReadAttribute<openvdb::Vec3d> positions(*ptGeo->getP(), offsets);
+
+                const float computedVoxelSize = computeVoxelSize(positions, pointsPerVoxel);
+
+                if (computedVoxelSize > 0.0f) {
+                    voxelSize = computedVoxelSize;
+                }
+                else {
+                    addWarning(SOP_MESSAGE, "Unable to compute voxel size, using the Voxel Size parameter.");
+                }
+            }
+
             transform = Transform::createLinearTransform(voxelSize);
         }
 
@@ -918,13 +1040,22 @@ SOP_OpenVDB_Points::cookMySop(OP_Context& context)
                             addWarning(SOP_MESSAGE, ss.str().c_str());
                         }
                     }
-                    else if (valueCompression == UNIT_VECTOR)
+                    else if (valueCompression == UNIT_VECTOR ||
+                             valueCompression == OCTAHEDRAL_16 ||
+                             valueCompression == OCTAHEDRAL_32)
                     {
                         if (type != "vec3s") {
                             valueCompression = 0;
                             addWarning(SOP_MESSAGE, ss.str().c_str());
                         }
                     }
+                    else if (valueCompression == SMALLEST_THREE)
+                    {
+                        if (type != "quats") {
+                            valueCompression = 0;
+                            addWarning(SOP_MESSAGE, ss.str().c_str());
+                        }
+                    }
 
                     const bool bloscCompression = evalIntInst("blosccompression#", &i, 0, 0);
 
@@ -38,7 +38,10 @@
 #define OPENVDB_POINTS_HOUDINI_UTILS_HAS_BEEN_INCLUDED
 
 
+#include <openvdb/math/Mat3.h>
+#include <openvdb/math/Quat.h>
 #include <openvdb/math/Vec3.h>
+#include <openvdb/math/Vec4.h>
 #include <openvdb/Types.h>
 #include <openvdb_points/tools/PointCount.h>
 #include <openvdb_points/tools/PointConversion.h>
@@ -78,6 +81,9 @@ namespace {
 ///
 template <typename T> struct GAHandleTraits { typedef GA_RWHandleF RW; };
 template <typename T> struct GAHandleTraits<openvdb::math::Vec3<T> > { typedef GA_RWHandleV3 RW; };
+template <typename T> struct GAHandleTraits<openvdb::math::Vec4<T> > { typedef GA_RWHandleV4 RW; };
+template <typename T> struct GAHandleTraits<openvdb::math::Quat<T> > { typedef GA_RWHandleQ RW; };
+template <typename T> struct GAHandleTraits<openvdb::math::Mat3<T> > { typedef GA_RWHandleM3 RW; };
 template <> struct GAHandleTraits<bool> { typedef GA_RWHandleI RW; };
 template <> struct GAHandleTraits<int16_t> { typedef GA_RWHandleI RW; };
 template <> struct GAHandleTraits<int32_t> { typedef GA_RWHandleI RW; };
@@ -185,10 +191,33 @@ gaStorageFromAttrString(const openvdb::Name& type)
     else if (type == "vec3h")       return GA_STORE_REAL16;
     else if (type == "vec3s")       return GA_STORE_REAL32;
     else if (type == "vec3d")       return GA_STORE_REAL64;
+    else if (type == "vec4s")       return GA_STORE_REAL32;
+    else if (type == "vec4d")       return GA_STORE_REAL64;
+    else if (type == "quats")       return GA_STORE_REAL32;
+    else if (type == "quatd")       return GA_STORE_REAL64;
+    else if (type == "mat3s")       return GA_STORE_REAL32;
+    else if (type == "mat3d")       return GA_STORE_REAL64;
 
     return GA_STORE_INVALID;
 }
 
+inline GA_TypeInfo
+gaTypeInfoFromAttrString(const openvdb::Name& type)
+{
+    if (type == "quats" ||
+        type == "quatd")
+    {
+        return GA_TYPE_QUATERNION;
+    }
+    else if (type == "mat3s" ||
+             type == "mat3d")
+    {
+        return GA_TYPE_TRANSFORM;
+    }
+
+    return GA_TYPE_VOID;
+}
+
 inline unsigned
 widthFromAttrString(const openvdb::Name& type)
 {
@@ -208,6 +237,18 @@ widthFromAttrString(const openvdb::Name& type)
     {
         return 3;
     }
+    else if (type == "vec4s" ||
+             type == "vec4d" ||
+             type == "quats" ||
+             type == "quatd")
+    {
+        return 4;
+    }
+    else if (type == "mat3s" ||
+             type == "mat3d")
+    {
+        return 9;
+    }
 
     return 0;
 }
@@ -240,6 +281,24 @@ struct HoudiniWriteAttribute
             mHandle.set(GA_Offset(offset), UT_Vector3(value.x(), value.y(), value.z()));
         }
 
+        template <typename ValueType>
+        void set(openvdb::Index offset, const openvdb::math::Vec4<ValueType>& value) {
+            mHandle.set(GA_Offset(offset), UT_Vector4(value.x(), value.y(), value.z(), value.w()));
+        }
+
+        template <typename ValueType>
+        void set(openvdb::Index offset, const openvdb::math::Quat<ValueType>& value) {
+            mHandle.set(GA_Offset(offset), UT_QuaternionF(value.x(), value.y(), value.z(), value.w()));
+        }
+
+        template <typename ValueType>
+        void set(openvdb::Index offset, const openvdb::math::Mat3<ValueType>& value) {
+            mHandle.set(GA_Offset(offset), UT_Matrix3(
+                value(0, 0), value(0, 1), value(0, 2),
+                value(1, 0), value(1, 1), value(1, 2),
+                value(2, 0), value(2, 1), value(2, 2)));
+        }
+
     private:
         typename GAHandleTraits<T>::RW mHandle;
     }; // struct Handle
@@ -275,30 +334,59 @@ struct HoudiniReadAttribute
         : mAttribute(attribute)
         , mOffsets(offsets) { }
 
-    // Return the value of the nth point in the array (scalar type only)
+    // Return the value of the nth point in the array, dispatched on the value type so that
+    // quaternion and matrix types are selected even with an explicit template argument
+    template <typename ValueType>
+    void get(size_t n, ValueType& value) const { this->getValue(n, value); }
+
+    // Only provided to match the required interface for the PointPartitioner
+    void getPos(size_t n, T& xyz) const { this->getValue(n, xyz); }
+
+    size_t size() const { return mAttribute.getIndexMap().indexSize(); }
+
+private:
+    GA_Offset getOffset(size_t n) const {
+        return mOffsets ? (*mOffsets)[n] : mAttribute.getIndexMap().offsetFromIndex(GA_Index(n));
+    }
+
+    // Read the value of the nth point in the array (scalar type only)
     template <typename ValueType> typename boost::disable_if_c<openvdb::VecTraits<ValueType>::IsVec, void>::type
-    get(size_t n, ValueType& value) const
+    getValue(size_t n, ValueType& value) const
     {
         value = attributeValue<ValueType>(mAttribute, getOffset(n), 0);
     }
 
-    // Return the value of the nth point in the array (vector type only)
+    // Read the value of the nth point in the array (vector type only)
     template <typename ValueType> typename boost::enable_if_c<openvdb::VecTraits<ValueType>::IsVec, void>::type
-    get(size_t n, ValueType& value) const
+    getValue(size_t n, ValueType& value) const
     {
         for (unsigned i = 0; i < openvdb::VecTraits<ValueType>::Size; ++i) {
             value[i] = attributeValue<typename openvdb::VecTraits<ValueType>::ElementType>(mAttribute, getOffset(n), i);
         }
     }
 
-    // Only provided to match the required interface for the PointPartitioner
-    void getPos(size_t n, T& xyz) const { return this->get<T>(n, xyz); }
-
-    size_t size() const { return mAttribute.getIndexMap().indexSize(); }
+    // Read the value of the nth point in the array (quaternion type only)
+    template <typename ElementType>
+    void getValue(size_t n, openvdb::math::Quat<ElementType>& value) const
+    {
+        const GA_Offset offset = getOffset(n);
+        value = openvdb::math::Quat<ElementType>(
+            attributeValue<ElementType>(mAttribute, offset, 0),
+            attributeValue<ElementType>(mAttribute, offset, 1),
+            attributeValue<ElementType>(mAttribute, offset, 2),
+            attributeValue<ElementType>(mAttribute, offset, 3));
+    }
 
-private:
-    GA_Offset getOffset(size_t n) const {
-        return mOffsets ? (*mOffsets)[n] : mAttribute.getIndexMap().offsetFromIndex(GA_Index(n));
+    // Read the value of the nth point in the array (3x3 matrix type only)
+    template <typename ElementType>
+    void getValue(size_t n, openvdb::math::Mat3<ElementType>& value) const
+    {
+        const GA_Offset offset = getOffset(n);
+        for (unsigned i = 0; i < 3; ++i) {
+            for (unsigned j = 0; j < 3; ++j) {
+                value(i, j) = attributeValue<ElementType>(mAttribute, offset, i * 3 + j);
+            }
+        }
     }
 
     const GA_Attribute& mAttribute;
@@ -401,6 +489,10 @@ convertPointDataGridToHoudini(GU_Detail& detail,
                                 "Unable to create Houdini Points Attribute with name '" + name +
                                 "'. '|' and ':' characters are not supported by Houdini.");
             }
+
+            const GA_TypeInfo typeInfo = gaTypeInfoFromAttrString(type);
+
+            if (typeInfo != GA_TYPE_VOID)   attributeRef.getAttribute()->setTypeInfo(typeInfo);
         }
 
         const unsigned index = it->second;
@@ -445,6 +537,30 @@ convertPointDataGridToHoudini(GU_Detail& detail,
             HoudiniWriteAttribute<openvdb::math::Vec3<double> > attribute(*attributeRef.getAttribute());
             convertPointDataGridAttribute(attribute, tree, pointOffsets, startOffset, index, includeGroups, excludeGroups);
         }
+        else if (type == "vec4s") {
+            HoudiniWriteAttribute<openvdb::math::Vec4<float> > attribute(*attributeRef.getAttribute());
+            convertPointDataGridAttribute(attribute, tree, pointOffsets, startOffset, index, includeGroups, excludeGroups);
+        }
+        else if (type == "vec4d") {
+            HoudiniWriteAttribute<openvdb::math::Vec4<double> > attribute(*attributeRef.getAttribute());
+            convertPointDataGridAttribute(attribute, tree, pointOffsets, startOffset, index, includeGroups, excludeGroups);
+        }
+        else if (type == "quats") {
+            HoudiniWriteAttribute<openvdb::math::Quat<float> > attribute(*attributeRef.getAttribute());
+            convertPointDataGridAttribute(attribute, tree, pointOffsets, startOffset, index, includeGroups, excludeGroups);
+        }
+        else if (type == "quatd") {
+            HoudiniWriteAttribute<openvdb::math::Quat<double> > attribute(*attributeRef.getAttribute());
+            convertPointDataGridAttribute(attribute, tree, pointOffsets, startOffset, index, includeGroups, excludeGroups);
+        }
+        else if (type == "mat3s") {
+            HoudiniWriteAttribute<openvdb::math::Mat3<float> > attribute(*attributeRef.getAttribute());
+            convertPointDataGridAttribute(attribute, tree, pointOffsets, startOffset, index, includeGroups, excludeGroups);
+        }
+        else if (type == "mat3d") {
+            HoudiniWriteAttribute<openvdb::math::Mat3<double> > attribute(*attributeRef.getAttribute());
+            convertPointDataGridAttribute(attribute, tree, pointOffsets, startOffset, index, includeGroups, excludeGroups);
+        }
         else {
             throw std::runtime_error("Unknown Attribute Type for Conversion: " + type);
         }